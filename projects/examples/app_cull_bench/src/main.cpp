@@ -0,0 +1,200 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/program_options.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/variate_generator.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/core.h>
+#include <scm/log.h>
+#include <scm/core/math.h>
+#include <scm/core/pointer_types.h>
+#include <scm/core/time/cpu_timer.h>
+
+#include <scm/gl_core/math.h>
+#include <scm/gl_core/primitives/box.h>
+#include <scm/gl_core/primitives/box_culling.h>
+#include <scm/gl_core/primitives/frustum.h>
+
+namespace  {
+
+int                         bench_box_count;
+int                         bench_iterations;
+float                       bench_scene_extent;
+unsigned                    bench_seed;
+
+} // namespace
+
+static const std::string    scm_application_name = "schism batched frustum culling benchmark";
+
+static bool initialize_cmd_line(scm::core& c)
+{
+    using boost::program_options::options_description;
+    using boost::program_options::value;
+
+    options_description  cmd_options("program options");
+
+    cmd_options.add_options()
+        ("?",                                                                                   "show this help message")
+        ("boxes,n",         value<int>(&bench_box_count)->default_value(100000),                "number of boxes")
+        ("iterations,i",    value<int>(&bench_iterations)->default_value(100),                  "culling runs per method (one frustum per run)")
+        ("extent,e",        value<float>(&bench_scene_extent)->default_value(500.0f),           "scene extent, the boxes are placed in [-extent, extent]^3")
+        ("seed,s",          value<unsigned>(&bench_seed)->default_value(5489u),                 "random seed");
+
+    c.add_command_line_options(cmd_options, scm_application_name);
+
+    return true;
+}
+
+static void init_module()
+{
+    scm::module::initializer::add_pre_core_init_function(initialize_cmd_line);
+}
+
+static scm::module::static_initializer  static_initialize(init_module);
+
+static void report(const std::string& name, scm::time::nanosec_type elapsed, int runs, int boxes, scm::size_t visible, double scalar_msec)
+{
+    using namespace scm;
+
+    const double msec   = time::time_io::to_time_unit(time::time_io::msec, elapsed) / runs;
+    const double mboxps = (static_cast<double>(boxes) / 1.0e6) / (msec / 1000.0);
+
+    out() << log::info
+          << std::left  << std::setw(24) << name
+          << std::right << std::fixed << std::setprecision(3)
+          << std::setw(10) << msec << "ms/run "
+          << std::setw(10) << mboxps << "Mboxes/s "
+          << std::setw(8)  << std::setprecision(2) << (scalar_msec > 0.0 ? scalar_msec / msec : 1.0) << "x "
+          << "(visible " << visible << ")" << log::end;
+}
+
+int main(int argc, char **argv)
+{
+    std::ios_base::sync_with_stdio(false);
+
+    using namespace scm;
+    using namespace scm::gl;
+    using namespace scm::math;
+
+    shared_ptr<core> scm_core(new core(argc, argv));
+
+    if (bench_box_count < 1 || bench_iterations < 1) {
+        err() << log::error << "invalid box count or iterations" << log::end;
+        return -1;
+    }
+
+    typedef boost::variate_generator<boost::mt19937&, boost::uniform_real<float> > random_float;
+
+    boost::mt19937  rng(bench_seed);
+    random_float    rand_pos(rng,  boost::uniform_real<float>(-bench_scene_extent, bench_scene_extent));
+    random_float    rand_size(rng, boost::uniform_real<float>(0.1f, 10.0f));
+    random_float    rand_unit(rng, boost::uniform_real<float>(-1.0f, 1.0f));
+
+    // scene
+    std::vector<boxf>   boxes_aos;
+    box_soa_array       boxes_soa;
+
+    boxes_aos.reserve(bench_box_count);
+    boxes_soa.reserve(bench_box_count);
+    for (int b = 0; b < bench_box_count; ++b) {
+        const vec3f p(rand_pos(), rand_pos(), rand_pos());
+        const vec3f s(rand_size(), rand_size(), rand_size());
+        boxes_aos.push_back(boxf(p, p + s));
+        boxes_soa.push_back(boxes_aos.back());
+    }
+
+    // one random camera per run, looking into the scene from inside
+    std::vector<frustumf> frusta;
+    const mat4f proj = make_perspective_matrix(60.0f, 16.0f / 9.0f, 0.1f, bench_scene_extent);
+    for (int r = 0; r < bench_iterations; ++r) {
+        const vec3f eye(rand_unit() * bench_scene_extent * 0.5f, rand_unit() * bench_scene_extent * 0.5f, rand_unit() * bench_scene_extent * 0.5f);
+        vec3f       dir(rand_unit(), rand_unit(), rand_unit());
+        if (length(dir) < 0.01f) {
+            dir = vec3f(0.0f, 0.0f, -1.0f);
+        }
+        const vec3f up = abs(normalize(dir).y) > 0.99f ? vec3f(1.0f, 0.0f, 0.0f) : vec3f(0.0f, 1.0f, 0.0f);
+        frusta.push_back(frustumf(proj * make_look_at_matrix(eye, eye + dir, up)));
+    }
+
+    std::vector<scm::uint8>  ref_results(bench_box_count);
+    std::vector<scm::uint8>  batch_results(bench_box_count);
+    std::vector<scm::uint32> visible_indices(bench_box_count);
+
+    // correctness against the per box frustum classification
+    scm::size_t mismatches = 0;
+    for (int r = 0; r < bench_iterations; ++r) {
+        const frustumf& f = frusta[r];
+        for (int b = 0; b < bench_box_count; ++b) {
+            ref_results[b] = static_cast<scm::uint8>(f.classify(boxes_aos[b]));
+        }
+        classify_boxes(f, boxes_soa, &batch_results.front());
+        const scm::size_t vc = cull_boxes(f, boxes_soa, &visible_indices.front());
+
+        scm::size_t ref_visible = 0;
+        for (int b = 0; b < bench_box_count; ++b) {
+            if (ref_results[b] != batch_results[b]) {
+                ++mismatches;
+            }
+            if (ref_results[b] != frustumf::outside) {
+                if (ref_visible >= vc || visible_indices[ref_visible] != static_cast<scm::uint32>(b)) {
+                    ++mismatches;
+                }
+                ++ref_visible;
+            }
+        }
+        if (ref_visible != vc) {
+            ++mismatches;
+        }
+    }
+
+    out() << log::info
+          << "culling " << bench_box_count << " boxes against " << bench_iterations << " frusta "
+          << "(batched instruction set: " << box_culling_instruction_set() << ", mismatches: " << mismatches << ")" << log::end;
+
+    // scalar reference loop
+    scm::size_t visible = 0;
+    time::cpu_timer t;
+    for (int r = 0; r < bench_iterations; ++r) {
+        const frustumf& f = frusta[r];
+        for (int b = 0; b < bench_box_count; ++b) {
+            if (f.classify(boxes_aos[b]) != frustumf::outside) {
+                visible_indices[visible % bench_box_count] = static_cast<scm::uint32>(b);
+                ++visible;
+            }
+        }
+    }
+    t.stop();
+    const double scalar_msec = time::time_io::to_time_unit(time::time_io::msec, t.elapsed()) / bench_iterations;
+    report("frustum::classify", t.elapsed(), bench_iterations, bench_box_count, visible / bench_iterations, 0.0);
+
+    // batched classification
+    t.start();
+    for (int r = 0; r < bench_iterations; ++r) {
+        classify_boxes(frusta[r], boxes_soa, &batch_results.front());
+    }
+    t.stop();
+    visible = bench_box_count - std::count(batch_results.begin(), batch_results.end(), static_cast<scm::uint8>(frustumf::outside));
+    report("classify_boxes", t.elapsed(), bench_iterations, bench_box_count, visible, scalar_msec);
+
+    // batched culling to index list
+    visible = 0;
+    t.start();
+    for (int r = 0; r < bench_iterations; ++r) {
+        visible += cull_boxes(frusta[r], boxes_soa, &visible_indices.front());
+    }
+    t.stop();
+    report("cull_boxes", t.elapsed(), bench_iterations, bench_box_count, visible / bench_iterations, scalar_msec);
+
+    return mismatches == 0 ? 0 : -1;
+}
@@ -0,0 +1,433 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "io_benchmark.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/variate_generator.hpp>
+
+#include <scm/log.h>
+#include <scm/core/memory.h>
+#include <scm/core/io/file.h>
+#include <scm/core/time/cpu_timer.h>
+
+#include <scm/gl_core/data_formats.h>
+
+#include <scm/gl_util/data/volume/volume_reader_raw.h>
+#include <scm/gl_util/data/volume/volume_reader_segy.h>
+#include <scm/gl_util/data/volume/volume_reader_vgeo.h>
+
+namespace {
+
+const scm::int64 io_buffer_alignment = 4096;
+
+typedef boost::variate_generator<boost::mt19937&, boost::uniform_int<scm::int64> > random_index_gen;
+
+std::string
+cache_mode_string(bool disable_system_cache)
+{
+    return disable_system_cache ? "unbuffered" : "buffered";
+}
+
+scm::int64
+align_block_size(const scm::io::file& f, scm::int64 s)
+{
+    // unbuffered i/o requires volume sector aligned block sizes and offsets
+    if (f.volume_sector_size() > 0) {
+        return f.vss_align_ceil(s);
+    }
+    return s;
+}
+
+bool
+prepare_test_file(const scm::data::file_benchmark_desc& desc,
+                  std::ostream&                         csv_out)
+{
+    using namespace scm;
+    using namespace scm::io;
+
+    namespace bfs = boost::filesystem;
+
+    if (   bfs::exists(desc._file_path)
+        && static_cast<scm::int64>(bfs::file_size(desc._file_path)) >= desc._file_size) {
+        return true;
+    }
+
+    out() << log::info << "prepare_test_file(): generating " << (desc._file_size / (1024 * 1024)) << "MiB "
+          << "test file '" << desc._file_path << "'" << log::end;
+
+    file out_file;
+    if (!out_file.open(desc._file_path, std::ios_base::out | std::ios_base::trunc, false)) {
+        err() << log::error << "prepare_test_file(): unable to open test file '" << desc._file_path << "'" << log::end;
+        return false;
+    }
+
+    const scm::int64    block_size = 4 * 1024 * 1024;
+    std::vector<char>   block(static_cast<std::size_t>(block_size));
+
+    boost::mt19937                  rand_gen(desc._random_seed);
+    boost::uniform_int<scm::int64>  rand_dist(0, 255);
+    random_index_gen                die(rand_gen, rand_dist);
+
+    std::generate(block.begin(), block.end(), die);
+
+    data::benchmark_result  r;
+    time::cpu_timer         t;
+
+    t.start();
+    for (scm::int64 pos = 0; pos < desc._file_size; pos += block_size) {
+        const scm::int64 ws = math::min(block_size, desc._file_size - pos);
+        if (out_file.write(&block.front(), pos, ws) != ws) {
+            err() << log::error << "prepare_test_file(): error writing to test file at position " << pos << log::end;
+            return false;
+        }
+        r._bytes += ws;
+        ++r._operations;
+    }
+    out_file.flush_buffers();
+    t.stop();
+    out_file.close();
+
+    r._test         = "file_write";
+    r._target       = desc._file_path;
+    r._cache_mode   = cache_mode_string(false);
+    r._pattern      = scm::data::access_pattern_string(scm::data::ACCESS_SEQUENTIAL);
+    r._block_size   = block_size;
+    r._seconds      = time::time_io::to_time_unit(time::time_io::sec, t.elapsed());
+
+    scm::data::write_csv_row(csv_out, r);
+
+    return true;
+}
+
+void
+generate_offsets(scm::data::access_pattern   p,
+                 scm::int64                  block_count,
+                 scm::int64                  op_count,
+                 int                         stride_blocks,
+                 unsigned                    seed,
+                 std::vector<scm::int64>&    block_indices)
+{
+    using namespace scm::data;
+
+    block_indices.resize(static_cast<std::size_t>(op_count));
+
+    switch (p) {
+        case ACCESS_SEQUENTIAL:
+            for (scm::int64 i = 0; i < op_count; ++i) {
+                block_indices[i] = i % block_count;
+            }
+            break;
+        case ACCESS_RANDOM: {
+                boost::mt19937                  rand_gen(seed);
+                boost::uniform_int<scm::int64>  rand_dist(0, block_count - 1);
+                random_index_gen                die(rand_gen, rand_dist);
+
+                std::generate(block_indices.begin(), block_indices.end(), die);
+            }
+            break;
+        case ACCESS_STRIDED: {
+                // walk the file with the stride, start the next pass one block further
+                const scm::int64 stride = scm::math::max<scm::int64>(1, stride_blocks);
+                const scm::int64 passes = scm::math::max<scm::int64>(1, block_count / stride);
+                for (scm::int64 i = 0; i < op_count; ++i) {
+                    block_indices[i] = ((i % passes) * stride + (i / passes)) % block_count;
+                }
+            }
+            break;
+    }
+}
+
+bool
+run_file_benchmark(const scm::data::file_benchmark_desc&   desc,
+                   bool                                    disable_system_cache,
+                   scm::int64                              block_size,
+                   int                                     async_requests,
+                   scm::data::access_pattern               pattern,
+                   std::ostream&                           csv_out)
+{
+    using namespace scm;
+    using namespace scm::io;
+
+    file in_file;
+    if (!in_file.open(desc._file_path,
+                      std::ios_base::in,
+                      disable_system_cache,
+                      static_cast<scm::uint32>(block_size),
+                      static_cast<scm::uint32>(async_requests))) {
+        err() << log::error << "run_file_benchmark(): unable to open test file '" << desc._file_path << "'" << log::end;
+        return false;
+    }
+
+    const scm::int64    bsize   = align_block_size(in_file, block_size);
+    const scm::int64    bcount  = in_file.size() / bsize;
+    const scm::int64    opcount = math::min(bcount, math::max<scm::int64>(1, desc._max_bytes_per_run / bsize));
+
+    if (bcount < 1) {
+        err() << log::warning << "run_file_benchmark(): test file smaller than block size " << bsize << log::end;
+        return true;
+    }
+
+    std::vector<scm::int64> block_indices;
+    generate_offsets(pattern, bcount, opcount, desc._stride_blocks, desc._random_seed, block_indices);
+
+    // sector aligned destination buffer for unbuffered reads
+    scoped_array<char>  buffer_mem(new char[static_cast<std::size_t>(bsize + io_buffer_alignment)]);
+    char*               buffer = reinterpret_cast<char*>(align_address(buffer_mem.get(), io_buffer_alignment));
+
+    data::benchmark_result  r;
+    time::cpu_timer         t;
+
+    t.start();
+    for (scm::int64 i = 0; i < opcount; ++i) {
+        if (in_file.read(buffer, block_indices[i] * bsize, bsize) != bsize) {
+            err() << log::error << "run_file_benchmark(): error reading from test file at position " << block_indices[i] * bsize << log::end;
+            return false;
+        }
+        r._bytes += bsize;
+        ++r._operations;
+    }
+    t.stop();
+    in_file.close();
+
+    r._test             = "file_read";
+    r._target           = desc._file_path;
+    r._cache_mode       = cache_mode_string(disable_system_cache);
+    r._pattern          = scm::data::access_pattern_string(pattern);
+    r._block_size       = bsize;
+    r._async_requests   = async_requests;
+    r._seconds          = time::time_io::to_time_unit(time::time_io::sec, t.elapsed());
+
+    scm::data::write_csv_row(csv_out, r);
+
+    return true;
+}
+
+scm::shared_ptr<scm::gl::volume_reader>
+open_volume_reader(const std::string& file_name, bool disable_system_cache)
+{
+    using namespace scm::gl;
+    using boost::filesystem::path;
+
+    scm::shared_ptr<volume_reader>  vol_reader;
+    std::string                     file_extension = path(file_name).extension().string();
+
+    boost::algorithm::to_lower(file_extension);
+
+    if (file_extension == ".raw") {
+        vol_reader.reset(new volume_reader_raw(file_name, disable_system_cache));
+    }
+    else if (file_extension == ".vol") {
+        vol_reader.reset(new volume_reader_vgeo(file_name, disable_system_cache));
+    }
+    else if (file_extension == ".segy" || file_extension == ".sgy") {
+        vol_reader.reset(new volume_reader_segy(file_name, disable_system_cache));
+    }
+    else {
+        scm::err() << scm::log::error
+                   << "open_volume_reader(): unsupported volume file format ('" << file_extension << "')." << scm::log::end;
+        return scm::shared_ptr<volume_reader>();
+    }
+
+    if (!(*vol_reader)) {
+        scm::err() << scm::log::error
+                   << "open_volume_reader(): unable to open volume file ('" << file_name << "')." << scm::log::end;
+        return scm::shared_ptr<volume_reader>();
+    }
+
+    return vol_reader;
+}
+
+} // namespace
+
+namespace scm {
+namespace data {
+
+std::string
+access_pattern_string(access_pattern p)
+{
+    switch (p) {
+        case ACCESS_SEQUENTIAL: return "sequential";
+        case ACCESS_RANDOM:     return "random";
+        case ACCESS_STRIDED:    return "strided";
+    }
+    return "unknown";
+}
+
+benchmark_result::benchmark_result()
+  : _block_size(0)
+  , _async_requests(0)
+  , _operations(0)
+  , _bytes(0)
+  , _seconds(0.0)
+{
+}
+
+double
+benchmark_result::mib_per_second() const
+{
+    return _seconds > 0.0 ? (static_cast<double>(_bytes) / (1024.0 * 1024.0)) / _seconds : 0.0;
+}
+
+double
+benchmark_result::io_per_second() const
+{
+    return _seconds > 0.0 ? static_cast<double>(_operations) / _seconds : 0.0;
+}
+
+void
+write_csv_header(std::ostream& os)
+{
+    os << "test,target,cache_mode,pattern,block_size,async_requests,operations,bytes,seconds,mib_per_s,iops" << std::endl;
+}
+
+void
+write_csv_row(std::ostream& os, const benchmark_result& r)
+{
+    os << r._test           << ","
+       << r._target         << ","
+       << r._cache_mode     << ","
+       << r._pattern        << ","
+       << r._block_size     << ","
+       << r._async_requests << ","
+       << r._operations     << ","
+       << r._bytes          << ","
+       << std::fixed << std::setprecision(6) << r._seconds << ","
+       << std::fixed << std::setprecision(2) << r.mib_per_second() << ","
+       << std::fixed << std::setprecision(2) << r.io_per_second()
+       << std::endl;
+
+    out() << log::info
+          << r._test << " " << r._cache_mode << " " << r._pattern
+          << " (block size " << r._block_size << ", async requests " << r._async_requests << "): "
+          << std::fixed << std::setprecision(2) << r.mib_per_second() << "MiB/s, "
+          << std::fixed << std::setprecision(2) << r.io_per_second()  << "IOPS" << log::end;
+}
+
+file_benchmark_desc::file_benchmark_desc()
+  : _file_size(1024ll * 1024 * 1024)
+  , _max_bytes_per_run(256ll * 1024 * 1024)
+  , _stride_blocks(16)
+  , _random_seed(5489u)
+{
+}
+
+volume_benchmark_desc::volume_benchmark_desc()
+  : _bricks_per_shape(16)
+  , _random_seed(5489u)
+{
+}
+
+bool
+run_file_benchmarks(const file_benchmark_desc& desc, std::ostream& csv_out)
+{
+    if (!prepare_test_file(desc, csv_out)) {
+        return false;
+    }
+
+    for (std::size_t c = 0; c < desc._disable_system_cache.size(); ++c) {
+        for (std::size_t b = 0; b < desc._block_sizes.size(); ++b) {
+            for (std::size_t a = 0; a < desc._async_requests.size(); ++a) {
+                for (std::size_t p = 0; p < desc._patterns.size(); ++p) {
+                    if (!run_file_benchmark(desc,
+                                            desc._disable_system_cache[c],
+                                            desc._block_sizes[b],
+                                            desc._async_requests[a],
+                                            desc._patterns[p],
+                                            csv_out)) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool
+run_volume_benchmarks(const volume_benchmark_desc& desc, std::ostream& csv_out)
+{
+    using namespace scm::gl;
+    using namespace scm::math;
+
+    for (std::size_t v = 0; v < desc._volume_files.size(); ++v) {
+        for (std::size_t c = 0; c < desc._disable_system_cache.size(); ++c) {
+            const std::string&      vfile       = desc._volume_files[v];
+            shared_ptr<volume_reader> vol_reader = open_volume_reader(vfile, desc._disable_system_cache[c]);
+
+            if (!vol_reader) {
+                return false;
+            }
+
+            const vec3ui            vdim        = vol_reader->dimensions();
+            const scm::int64        voxel_size  = static_cast<scm::int64>(size_of_format(vol_reader->format()));
+
+            boost::mt19937          rand_gen(desc._random_seed);
+
+            for (std::size_t s = 0; s < desc._brick_shapes.size(); ++s) {
+                vec3ui bshape = desc._brick_shapes[s];
+                for (int d = 0; d < 3; ++d) {
+                    bshape[d] = (bshape[d] == 0) ? vdim[d] : math::min(bshape[d], vdim[d]);
+                }
+
+                const scm::int64    brick_size =   static_cast<scm::int64>(bshape.x)
+                                                 * static_cast<scm::int64>(bshape.y)
+                                                 * static_cast<scm::int64>(bshape.z)
+                                                 * voxel_size;
+                std::vector<char>   brick_data(static_cast<std::size_t>(brick_size));
+
+                // random brick origins inside the volume
+                std::vector<vec3ui> origins(desc._bricks_per_shape);
+                for (int d = 0; d < 3; ++d) {
+                    boost::uniform_int<scm::int64>  rand_dist(0, vdim[d] - bshape[d]);
+                    random_index_gen                die(rand_gen, rand_dist);
+                    for (std::size_t o = 0; o < origins.size(); ++o) {
+                        origins[o][d] = static_cast<unsigned>(die());
+                    }
+                }
+
+                benchmark_result    r;
+                time::cpu_timer     t;
+
+                t.start();
+                for (std::size_t o = 0; o < origins.size(); ++o) {
+                    if (!vol_reader->read(origins[o], bshape, &brick_data.front())) {
+                        err() << log::error << "run_volume_benchmarks(): error reading brick "
+                              << origins[o] << " " << bshape << " from volume '" << vfile << "'" << log::end;
+                        return false;
+                    }
+                    r._bytes += brick_size;
+                    ++r._operations;
+                }
+                t.stop();
+
+                std::ostringstream  shape_string;
+                shape_string << bshape.x << "x" << bshape.y << "x" << bshape.z;
+
+                r._test         = "volume_read";
+                r._target       = vfile;
+                r._cache_mode   = cache_mode_string(desc._disable_system_cache[c]);
+                r._pattern      = shape_string.str();
+                r._block_size   = brick_size;
+                r._seconds      = time::time_io::to_time_unit(time::time_io::sec, t.elapsed());
+
+                write_csv_row(csv_out, r);
+            }
+        }
+    }
+
+    return true;
+}
+
+} // namespace data
+} // namespace scm
@@ -0,0 +1,80 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_IO_BENCH_IO_BENCHMARK_H_INCLUDED
+#define SCM_IO_BENCH_IO_BENCHMARK_H_INCLUDED
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <scm/core/math.h>
+#include <scm/core/numeric_types.h>
+
+namespace scm {
+namespace data {
+
+enum access_pattern {
+    ACCESS_SEQUENTIAL   = 0x00,
+    ACCESS_RANDOM,
+    ACCESS_STRIDED
+}; // enum access_pattern
+
+std::string access_pattern_string(access_pattern p);
+
+struct benchmark_result
+{
+    benchmark_result();
+
+    double                  mib_per_second() const;
+    double                  io_per_second() const;
+
+    std::string             _test;
+    std::string             _target;
+    std::string             _cache_mode;
+    std::string             _pattern;
+    scm::int64              _block_size;
+    int                     _async_requests;
+    scm::int64              _operations;
+    scm::int64              _bytes;
+    double                  _seconds;
+}; // struct benchmark_result
+
+void write_csv_header(std::ostream& os);
+void write_csv_row(std::ostream& os, const benchmark_result& r);
+
+struct file_benchmark_desc
+{
+    file_benchmark_desc();
+
+    std::string                 _file_path;
+    scm::int64                  _file_size;
+    scm::int64                  _max_bytes_per_run;
+    std::vector<scm::int64>     _block_sizes;
+    std::vector<int>            _async_requests;
+    std::vector<access_pattern> _patterns;
+    std::vector<bool>           _disable_system_cache;
+    int                         _stride_blocks;
+    unsigned                    _random_seed;
+}; // struct file_benchmark_desc
+
+struct volume_benchmark_desc
+{
+    volume_benchmark_desc();
+
+    std::vector<std::string>    _volume_files;
+    std::vector<math::vec3ui>   _brick_shapes;  // 0 components are replaced by the volume extent
+    int                         _bricks_per_shape;
+    std::vector<bool>           _disable_system_cache;
+    unsigned                    _random_seed;
+}; // struct volume_benchmark_desc
+
+// all runs write one csv row each to csv_out as soon as they finish
+bool run_file_benchmarks(const file_benchmark_desc& desc, std::ostream& csv_out);
+bool run_volume_benchmarks(const volume_benchmark_desc& desc, std::ostream& csv_out);
+
+} // namespace data
+} // namespace scm
+
+#endif // SCM_IO_BENCH_IO_BENCHMARK_H_INCLUDED
@@ -0,0 +1,196 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/program_options.hpp>
+#include <boost/spirit/include/qi.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/core.h>
+#include <scm/log.h>
+#include <scm/core/math.h>
+#include <scm/core/pointer_types.h>
+
+#include <benchmark/io_benchmark.h>
+
+namespace  {
+
+std::string                 bench_file_path;
+scm::int64                  bench_file_size;
+scm::int64                  bench_run_size;
+std::vector<scm::int64>     bench_block_sizes;
+std::vector<int>            bench_async_requests;
+std::string                 bench_cache_mode;
+int                         bench_stride;
+std::vector<std::string>    bench_volumes;
+std::vector<std::string>    bench_brick_shapes;
+int                         bench_bricks;
+std::string                 bench_output;
+bool                        bench_skip_file;
+
+} // namespace
+
+static const std::string    scm_application_name = "schism file and volume i/o benchmark";
+
+static bool initialize_cmd_line(scm::core& c)
+{
+    using boost::program_options::options_description;
+    using boost::program_options::value;
+
+    options_description  cmd_options("program options");
+
+    std::vector<scm::int64>     default_block_sizes;
+    std::vector<int>            default_async_requests;
+    std::vector<std::string>    default_brick_shapes;
+
+    default_block_sizes.push_back(4);
+    default_block_sizes.push_back(64);
+    default_block_sizes.push_back(512);
+    default_block_sizes.push_back(4096);
+
+    default_async_requests.push_back(1);
+    default_async_requests.push_back(8);
+
+    default_brick_shapes.push_back("32x32x32");
+    default_brick_shapes.push_back("64x64x64");
+    default_brick_shapes.push_back("128x128x128");
+    default_brick_shapes.push_back("256x256x256");
+    default_brick_shapes.push_back("0x0x16");
+    default_brick_shapes.push_back("16x16x0");
+
+    cmd_options.add_options()
+        ("?",                                                                                                                   "show this help message")
+        ("file,f",          value<std::string>(&bench_file_path)->default_value("scm_io_bench.data"),                          "file benchmark test file (generated if missing or too small)")
+        ("file_size",       value<scm::int64>(&bench_file_size)->default_value(1024),                                          "file benchmark test file size (MiB)")
+        ("run_size",        value<scm::int64>(&bench_run_size)->default_value(256),                                            "maximum amount of data read per run (MiB)")
+        ("block_sizes,b",   value<std::vector<scm::int64> >(&bench_block_sizes)->multitoken()
+                                ->default_value(default_block_sizes, "4 64 512 4096"),                                          "read block sizes (KiB)")
+        ("async_requests,a",value<std::vector<int> >(&bench_async_requests)->multitoken()
+                                ->default_value(default_async_requests, "1 8"),                                                 "asynchronous request depths (windows only)")
+        ("cache,c",         value<std::string>(&bench_cache_mode)->default_value("both"),                                      "system cache mode (buffered, unbuffered, both)")
+        ("stride",          value<int>(&bench_stride)->default_value(16),                                                      "stride in blocks for strided access")
+        ("volume,v",        value<std::vector<std::string> >(&bench_volumes)->multitoken(),                                    "volume files for sub-volume read benchmarks (.raw, .vol, .sgy, .segy)")
+        ("bricks",          value<std::vector<std::string> >(&bench_brick_shapes)->multitoken()
+                                ->default_value(default_brick_shapes, "32x32x32 64x64x64 128x128x128 256x256x256 0x0x16 16x16x0"),
+                                                                                                                                "brick shapes read from the volumes (0 selects the full volume extent)")
+        ("brick_count",     value<int>(&bench_bricks)->default_value(16),                                                      "number of randomly placed bricks read per shape")
+        ("output,o",        value<std::string>(&bench_output)->default_value("scm_io_bench.csv"),                              "csv output file")
+        ("skip_file",       value<bool>(&bench_skip_file)->zero_tokens()->default_value(false),                                "skip the file benchmarks");
+
+    c.add_command_line_options(cmd_options, scm_application_name);
+
+    return true;
+}
+
+static void init_module()
+{
+    scm::module::initializer::add_pre_core_init_function(initialize_cmd_line);
+}
+
+static scm::module::static_initializer  static_initialize(init_module);
+
+static bool parse_brick_shape(const std::string& s, scm::math::vec3ui& shape)
+{
+    namespace qi = boost::spirit::qi;
+
+    std::string::const_iterator b = s.begin();
+    std::string::const_iterator e = s.end();
+
+    return    qi::parse(b, e, qi::uint_ >> 'x' >> qi::uint_ >> 'x' >> qi::uint_, shape.x, shape.y, shape.z)
+           && b == e;
+}
+
+int main(int argc, char **argv)
+{
+    std::ios_base::sync_with_stdio(false);
+
+    using namespace scm;
+    using namespace scm::data;
+
+    shared_ptr<core> scm_core(new core(argc, argv));
+
+    std::ofstream csv_out(bench_output.c_str());
+    if (!csv_out) {
+        err() << log::error << "unable to open csv output file '" << bench_output << "'" << log::end;
+        return -1;
+    }
+    write_csv_header(csv_out);
+
+    std::vector<bool> cache_modes;
+    if (bench_cache_mode == "buffered" || bench_cache_mode == "both") {
+        cache_modes.push_back(false);
+    }
+    if (bench_cache_mode == "unbuffered" || bench_cache_mode == "both") {
+        cache_modes.push_back(true);
+    }
+    if (cache_modes.empty()) {
+        err() << log::error << "unknown cache mode '" << bench_cache_mode << "'" << log::end;
+        return -1;
+    }
+
+#if SCM_PLATFORM != SCM_PLATFORM_WINDOWS
+    // only the windows file core implements asynchronous requests, elsewhere
+    // the request depth has no effect and the axis is not swept
+    if (   bench_async_requests.size() > 1
+        || (!bench_async_requests.empty() && bench_async_requests.front() != 1)) {
+        out() << log::info << "asynchronous i/o not implemented on this platform, "
+              << "ignoring async_requests (running with a request depth of 1)" << log::end;
+    }
+    bench_async_requests.assign(1, 1);
+#endif // SCM_PLATFORM != SCM_PLATFORM_WINDOWS
+
+    if (!bench_skip_file) {
+        file_benchmark_desc fdesc;
+
+        fdesc._file_path                = bench_file_path;
+        fdesc._file_size                = bench_file_size * 1024 * 1024;
+        fdesc._max_bytes_per_run        = bench_run_size  * 1024 * 1024;
+        fdesc._async_requests           = bench_async_requests;
+        fdesc._disable_system_cache     = cache_modes;
+        fdesc._stride_blocks            = bench_stride;
+
+        for (std::size_t b = 0; b < bench_block_sizes.size(); ++b) {
+            fdesc._block_sizes.push_back(bench_block_sizes[b] * 1024);
+        }
+        fdesc._patterns.push_back(ACCESS_SEQUENTIAL);
+        fdesc._patterns.push_back(ACCESS_RANDOM);
+        fdesc._patterns.push_back(ACCESS_STRIDED);
+
+        if (!run_file_benchmarks(fdesc, csv_out)) {
+            err() << log::error << "file benchmarks failed" << log::end;
+            return -1;
+        }
+    }
+
+    if (!bench_volumes.empty()) {
+        volume_benchmark_desc vdesc;
+
+        vdesc._volume_files             = bench_volumes;
+        vdesc._bricks_per_shape         = bench_bricks;
+        vdesc._disable_system_cache     = cache_modes;
+
+        for (std::size_t s = 0; s < bench_brick_shapes.size(); ++s) {
+            math::vec3ui shape;
+            if (!parse_brick_shape(bench_brick_shapes[s], shape)) {
+                err() << log::error << "malformed brick shape '" << bench_brick_shapes[s] << "' (expected WxHxD)" << log::end;
+                return -1;
+            }
+            vdesc._brick_shapes.push_back(shape);
+        }
+
+        if (!run_volume_benchmarks(vdesc, csv_out)) {
+            err() << log::error << "volume benchmarks failed" << log::end;
+            return -1;
+        }
+    }
+
+    out() << log::info << "results written to '" << bench_output << "'" << log::end;
+
+    return 0;
+}
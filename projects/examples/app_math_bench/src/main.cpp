@@ -0,0 +1,106 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include <iostream>
+#include <string>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/program_options.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/core.h>
+#include <scm/log.h>
+#include <scm/core/math.h>
+#include <scm/core/pointer_types.h>
+
+#include "math_bench.h"
+#include "math_checks.h"
+
+namespace  {
+
+int                         check_count;
+int                         bench_count;
+int                         bench_iterations;
+unsigned                    bench_seed;
+bool                        skip_checks;
+bool                        skip_bench;
+
+} // namespace
+
+static const std::string    scm_application_name = "schism math benchmark and correctness suite";
+
+static bool initialize_cmd_line(scm::core& c)
+{
+    using boost::program_options::options_description;
+    using boost::program_options::value;
+    using boost::program_options::bool_switch;
+
+    options_description  cmd_options("program options");
+
+    cmd_options.add_options()
+        ("?",                                                                                   "show this help message")
+        ("checks,c",        value<int>(&check_count)->default_value(100000),                    "number of random cases per correctness check")
+        ("elements,n",      value<int>(&bench_count)->default_value(4096),                      "number of operands per benchmark loop")
+        ("iterations,i",    value<int>(&bench_iterations)->default_value(500),                  "benchmark runs over all operands")
+        ("seed,s",          value<unsigned>(&bench_seed)->default_value(5489u),                 "random seed")
+        ("no-checks",       bool_switch(&skip_checks),                                          "skip the correctness checks")
+        ("no-bench",        bool_switch(&skip_bench),                                           "skip the benchmarks");
+
+    c.add_command_line_options(cmd_options, scm_application_name);
+
+    return true;
+}
+
+static void init_module()
+{
+    scm::module::initializer::add_pre_core_init_function(initialize_cmd_line);
+}
+
+static scm::module::static_initializer  static_initialize(init_module);
+
+int main(int argc, char **argv)
+{
+    std::ios_base::sync_with_stdio(false);
+
+    using namespace scm;
+
+    shared_ptr<core> scm_core(new core(argc, argv));
+
+    if (check_count < 1 || bench_count < 1 || bench_iterations < 1) {
+        err() << log::error << "invalid check count, element count or iterations" << log::end;
+        return -1;
+    }
+
+    out() << log::info
+          << "scm::math sse code paths: " << (SCM_CORE_MATH_SIMD_SSE ? "enabled" : "disabled") << log::end;
+
+    math_bench::check_report report;
+
+    if (!skip_checks) {
+        math_bench::math_checks<float>(report,  bench_seed, static_cast<unsigned>(check_count)).run();
+        math_bench::math_checks<double>(report, bench_seed, static_cast<unsigned>(check_count)).run();
+
+        if (report.failed_checks() > 0) {
+            err() << log::error
+                  << report.failed_checks() << " correctness checks failed" << log::end;
+        }
+        else {
+            out() << log::info
+                  << "all correctness checks passed" << log::end;
+        }
+    }
+
+    if (!skip_bench) {
+        math_bench::math_bench<float>  bf(bench_seed, static_cast<unsigned>(bench_count), static_cast<unsigned>(bench_iterations));
+        math_bench::math_bench<double> bd(bench_seed, static_cast<unsigned>(bench_count), static_cast<unsigned>(bench_iterations));
+
+        bf.run();
+        bd.run();
+
+        out() << log::info
+              << "(sink " << bf.sink() + bd.sink() << ")" << log::end;
+    }
+
+    return report.failed_checks() == 0 ? 0 : -1;
+}
@@ -0,0 +1,419 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_MATH_BENCH_MATH_BENCH_H_INCLUDED
+#define SCM_MATH_BENCH_MATH_BENCH_H_INCLUDED
+
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/variate_generator.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/log.h>
+#include <scm/core/math.h>
+#include <scm/core/math/bit_magic.h>
+#include <scm/core/time/cpu_timer.h>
+
+#include <scm/gl_core/math.h>
+#include <scm/gl_core/primitives/box.h>
+#include <scm/gl_core/primitives/frustum.h>
+#include <scm/gl_core/primitives/plane.h>
+#include <scm/gl_core/primitives/ray.h>
+
+#include "math_checks.h"
+
+namespace math_bench {
+
+// throughput of the scm::math operations over arrays of random operands, every
+// operation runs over the whole array per iteration, results go to a sink so
+// the loops are not optimized away
+template<typename scal_type>
+class math_bench
+{
+public:
+    typedef scm::math::vec<scal_type, 3>    vec3_type;
+    typedef scm::math::vec<scal_type, 4>    vec4_type;
+    typedef scm::math::mat<scal_type, 4, 4> mat4_type;
+    typedef scm::math::quat<scal_type>      quat_type;
+    typedef scm::gl::box_impl<scal_type>    box_type;
+    typedef scm::gl::frustum_impl<scal_type> frustum_type;
+    typedef scm::gl::ray_impl<scal_type>    ray_type;
+
+public:
+    math_bench(unsigned seed, unsigned count, unsigned iterations)
+      : _count(count)
+      , _iterations(iterations)
+      , _sink(0.0)
+    {
+        using namespace scm::math;
+
+        boost::mt19937 rng(seed);
+        boost::variate_generator<boost::mt19937&, boost::uniform_real<double> > rnd(rng, boost::uniform_real<double>(-1.0, 1.0));
+
+        _v3a.resize(_count); _v3b.resize(_count); _v3o.resize(_count);
+        _v4a.resize(_count); _v4o.resize(_count);
+        _m4a.resize(_count); _m4b.resize(_count); _m4o.resize(_count);
+        _qa.resize(_count);  _qb.resize(_count);  _qo.resize(_count);
+        _u32.resize(_count); _u64.resize(_count);
+        _boxes.resize(_count);
+        _rays.resize(_count);
+
+        for (unsigned i = 0; i < _count; ++i) {
+            _v3a[i] = vec3_type(scal_type(rnd()), scal_type(rnd()), scal_type(rnd()));
+            _v3b[i] = vec3_type(scal_type(rnd()), scal_type(rnd()), scal_type(rnd()));
+            _v4a[i] = vec4_type(scal_type(rnd()), scal_type(rnd()), scal_type(rnd()), scal_type(1));
+            for (unsigned e = 0; e < 16; ++e) {
+                _m4a[i].data_array[e] = scal_type(rnd());
+                _m4b[i].data_array[e] = scal_type(rnd());
+            }
+            _qa[i] = normalize(quat_type(scal_type(rnd()), scal_type(rnd()), scal_type(rnd()), scal_type(rnd())));
+            _qb[i] = normalize(quat_type(scal_type(rnd()), scal_type(rnd()), scal_type(rnd()), scal_type(rnd())));
+            _u32[i] = static_cast<scm::uint32>((rnd() * 0.5 + 0.5) * 4294967295.0);
+            _u64[i] = (static_cast<scm::uint64>(_u32[i]) << 32) | static_cast<scm::uint32>(~_u32[i]);
+
+            const vec3_type bmin(scal_type(rnd() * 100.0), scal_type(rnd() * 100.0), scal_type(rnd() * 100.0));
+            _boxes[i] = box_type(bmin, bmin + vec3_type(scal_type(1 + (rnd() + 1.0) * 4.0)));
+            _rays[i]  = ray_type(vec3_type(scal_type(0)), bmin + vec3_type(scal_type(0.5)));
+        }
+
+        const mat4_type proj = make_perspective_matrix(scal_type(60), scal_type(16.0 / 9.0), scal_type(0.1), scal_type(150));
+        _frustum = frustum_type(proj * make_look_at_matrix(vec3_type(scal_type(0)), vec3_type(scal_type(1), scal_type(0.2), scal_type(-1)),
+                                                           vec3_type(scal_type(0), scal_type(1), scal_type(0))));
+    }
+
+    void run()
+    {
+        using namespace scm::math;
+
+        const unsigned n = _count;
+        scm::time::cpu_timer t;
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            scal_type s = scal_type(0);
+            for (unsigned i = 0; i < n; ++i) {
+                s += dot(_v3a[i], _v3b[i]);
+            }
+            _sink += s;
+        }
+        end(t, "vec3 dot");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _v3o[i] = cross(_v3a[i], _v3b[i]);
+            }
+            _sink += _v3o[r % n].x;
+        }
+        end(t, "vec3 cross");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _v3o[i] = normalize(_v3a[i]);
+            }
+            _sink += _v3o[r % n].x;
+        }
+        end(t, "vec3 normalize");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _m4o[i] = operator*<scal_type, 4>(_m4a[i], _m4b[i]);
+            }
+            _sink += _m4o[r % n].m00;
+        }
+        end(t, "mat4 * mat4 (generic)");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _m4o[i] = _m4a[i] * _m4b[i];
+            }
+            _sink += _m4o[r % n].m00;
+        }
+        end(t, "mat4 * mat4");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _v4o[i] = operator*<scal_type, 4>(_m4a[i], _v4a[i]);
+            }
+            _sink += _v4o[r % n].x;
+        }
+        end(t, "mat4 * vec4 (generic)");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _v4o[i] = _m4a[i] * _v4a[i];
+            }
+            _sink += _v4o[r % n].x;
+        }
+        end(t, "mat4 * vec4");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _m4o[i] = transpose(_m4a[i]);
+            }
+            _sink += _m4o[r % n].m01;
+        }
+        end(t, "mat4 transpose");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            scal_type s = scal_type(0);
+            for (unsigned i = 0; i < n; ++i) {
+                s += determinant<scal_type, 4>(_m4a[i]);
+            }
+            _sink += s;
+        }
+        end(t, "mat4 determinant (cofactor)");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            scal_type s = scal_type(0);
+            for (unsigned i = 0; i < n; ++i) {
+                s += determinant(_m4a[i]);
+            }
+            _sink += s;
+        }
+        end(t, "mat4 determinant");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _m4o[i] = inverse<scal_type, 4>(_m4a[i]);
+            }
+            _sink += _m4o[r % n].m00;
+        }
+        end(t, "mat4 inverse (cofactor)");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _m4o[i] = inverse(_m4a[i]);
+            }
+            _sink += _m4o[r % n].m00;
+        }
+        end(t, "mat4 inverse");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _qo[i] = _qa[i] * _qb[i];
+            }
+            _sink += _qo[r % n].w;
+        }
+        end(t, "quat * quat");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _qo[i] = slerp(_qa[i], _qb[i], scal_type(0.3));
+            }
+            _sink += _qo[r % n].w;
+        }
+        end(t, "quat slerp");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            for (unsigned i = 0; i < n; ++i) {
+                _m4o[i] = _qa[i].to_matrix();
+            }
+            _sink += _m4o[r % n].m00;
+        }
+        end(t, "quat to_matrix");
+
+        run_simd();
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            unsigned s = 0;
+            for (unsigned i = 0; i < n; ++i) {
+                const unsigned x = _u32[i];
+                s += butterfly_1(x) ^ butterfly_2(x) ^ butterfly_4(x) ^ butterfly_8(x) ^ butterfly_16(x);
+            }
+            _sink += s;
+        }
+        end(t, "butterfly_1..16");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            unsigned s = 0;
+            for (unsigned i = 0; i < n; ++i) {
+                s += bit_count(_u32[i]);
+            }
+            _sink += s;
+        }
+        end(t, "bit_count");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            scm::int32 s = 0;
+            for (unsigned i = 0; i < n; ++i) {
+                s += floor_log2(_u32[i]) + floor_log2(_u64[i]);
+            }
+            _sink += s;
+        }
+        end(t, "floor_log2 (32 + 64 bit)");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            unsigned s = 0;
+            for (unsigned i = 0; i < n; ++i) {
+                s += next_power_of_two(_u32[i] >> 1);
+            }
+            _sink += s;
+        }
+        end(t, "next_power_of_two");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            scal_type s = scal_type(0);
+            for (unsigned i = 0; i < n; ++i) {
+                s += clamp(_v3a[i].x, _v3b[i].y, _v3b[i].z) + fract(_v3a[i].y * scal_type(10)) + scm::math::round(_v3a[i].z * scal_type(10));
+            }
+            _sink += s;
+        }
+        end(t, "clamp, fract, round");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            scal_type s = scal_type(0);
+            for (unsigned i = 0; i < n; ++i) {
+                s += _frustum.get_plane(i % 6).distance(_v3a[i]);
+            }
+            _sink += s;
+        }
+        end(t, "plane distance");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            unsigned s = 0;
+            for (unsigned i = 0; i < n; ++i) {
+                s += _frustum.classify(_boxes[i]);
+            }
+            _sink += s;
+        }
+        end(t, "frustum classify box");
+
+        begin(t);
+        for (unsigned r = 0; r < _iterations; ++r) {
+            unsigned s = 0;
+            for (unsigned i = 0; i < n; ++i) {
+                vec3_type entry;
+                vec3_type exit;
+                s += _boxes[i].intersect(_rays[i], entry, exit) ? 1 : 0;
+            }
+            _sink += s;
+        }
+        end(t, "box intersect ray");
+    }
+
+    double sink() const { return _sink; }
+
+protected:
+    void begin(scm::time::cpu_timer& t)
+    {
+        t.start();
+    }
+    void end(scm::time::cpu_timer& t, const std::string& name)
+    {
+        using namespace scm;
+
+        t.stop();
+        const double nsec = time::time_io::to_time_unit(time::time_io::nsec, t.elapsed())
+                          / (static_cast<double>(_count) * _iterations);
+        out() << log::info
+              << std::left  << std::setw(8)  << type_name<scal_type>::get()
+              << std::setw(32) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << nsec << "ns/op "
+              << std::setw(10) << (nsec > 0.0 ? 1.0e3 / nsec : 0.0) << "Mops/s" << log::end;
+    }
+
+    void run_simd();
+
+protected:
+    unsigned                    _count;
+    unsigned                    _iterations;
+    double                      _sink;
+
+    std::vector<vec3_type>      _v3a;
+    std::vector<vec3_type>      _v3b;
+    std::vector<vec3_type>      _v3o;
+    std::vector<vec4_type>      _v4a;
+    std::vector<vec4_type>      _v4o;
+    std::vector<mat4_type>      _m4a;
+    std::vector<mat4_type>      _m4b;
+    std::vector<mat4_type>      _m4o;
+    std::vector<quat_type>      _qa;
+    std::vector<quat_type>      _qb;
+    std::vector<quat_type>      _qo;
+    std::vector<scm::uint32>    _u32;
+    std::vector<scm::uint64>    _u64;
+    std::vector<box_type>       _boxes;
+    std::vector<ray_type>       _rays;
+    frustum_type                _frustum;
+
+}; // class math_bench
+
+template<typename scal_type>
+inline
+void
+math_bench<scal_type>::run_simd()
+{
+}
+
+template<>
+inline
+void
+math_bench<float>::run_simd()
+{
+    using namespace scm::math;
+
+    const unsigned n = _count;
+    scm::time::cpu_timer t;
+
+    begin(t);
+    for (unsigned r = 0; r < _iterations; ++r) {
+        transform_points(_m4a[r % n], &_v3a.front(), &_v3o.front(), n);
+        _sink += _v3o[r % n].x;
+    }
+    end(t, "transform_points (vec3)");
+
+    begin(t);
+    for (unsigned r = 0; r < _iterations; ++r) {
+        transform_points(_m4a[r % n], &_v4a.front(), &_v4o.front(), n);
+        _sink += _v4o[r % n].x;
+    }
+    end(t, "transform_points (vec4)");
+
+    begin(t);
+    for (unsigned r = 0; r < _iterations; ++r) {
+        transform_matrices(_m4a[r % n], &_m4b.front(), &_m4o.front(), n);
+        _sink += _m4o[r % n].m00;
+    }
+    end(t, "transform_matrices");
+
+    begin(t);
+    for (unsigned r = 0; r < _iterations; ++r) {
+        for (unsigned i = 0; i < n; ++i) {
+            _qo[i] = slerp(quatf_simd(_qa[i]), quatf_simd(_qb[i]), 0.3f).to_quatf();
+        }
+        _sink += _qo[r % n].w;
+    }
+    end(t, "quatf_simd slerp");
+}
+
+} // namespace math_bench
+
+#endif // SCM_MATH_BENCH_MATH_BENCH_H_INCLUDED
@@ -0,0 +1,781 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_MATH_BENCH_MATH_CHECKS_H_INCLUDED
+#define SCM_MATH_BENCH_MATH_CHECKS_H_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <scm/core/utilities/boost_warning_disable.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <boost/random/uniform_real.hpp>
+#include <boost/random/variate_generator.hpp>
+#include <scm/core/utilities/boost_warning_enable.h>
+
+#include <scm/log.h>
+#include <scm/core/math.h>
+#include <scm/core/math/bit_magic.h>
+
+#include <scm/gl_core/math.h>
+#include <scm/gl_core/primitives/box.h>
+#include <scm/gl_core/primitives/frustum.h>
+#include <scm/gl_core/primitives/plane.h>
+#include <scm/gl_core/primitives/ray.h>
+
+#include "reference.h"
+
+namespace math_bench {
+
+// maximum error of one check in units of the machine epsilon of the tested type,
+// checks with a tolerance of 0 require bit identical or exact results
+struct check_result
+{
+    check_result(const std::string& n, double tol) : _name(n), _tolerance(tol), _tests(0), _failures(0), _max_error(0.0) {}
+
+    void        error(double e) { ++_tests; _max_error = std::max(_max_error, e); if (!(e <= _tolerance)) ++_failures; }
+    void        exact(bool ok)  { ++_tests; if (!ok) { ++_failures; _max_error = std::max(_max_error, 1.0); } }
+
+    std::string _name;
+    double      _tolerance;
+    scm::size_t _tests;
+    scm::size_t _failures;
+    double      _max_error;
+}; // struct check_result
+
+class check_report
+{
+public:
+    check_report() : _failed_checks(0) {}
+
+    void add(const std::string& type_name, const check_result& r)
+    {
+        using namespace scm;
+
+        if (r._failures > 0) {
+            ++_failed_checks;
+        }
+        std::ostringstream os;
+        os << std::left  << std::setw(8)  << type_name
+           << std::setw(36) << r._name
+           << std::right << std::setw(9) << r._tests << " tests "
+           << std::setw(7) << r._failures << " failed  max error "
+           << std::scientific << std::setprecision(2) << std::setw(9) << r._max_error << " eps"
+           << " (tolerance " << std::setw(9) << r._tolerance << ")";
+
+        if (r._failures > 0) {
+            err() << log::error << os.str() << log::end;
+        }
+        else {
+            out() << log::info << os.str() << log::end;
+        }
+    }
+    unsigned failed_checks() const { return _failed_checks; }
+
+private:
+    unsigned    _failed_checks;
+}; // class check_report
+
+template<typename scal_type>
+struct type_name {};
+template<> struct type_name<float>  { static const char* get() { return "float"; } };
+template<> struct type_name<double> { static const char* get() { return "double"; } };
+
+// absolute error below 1, relative above, in units of epsilon
+template<typename scal_type>
+double
+scaled_error(scal_type v, ref::real r, ref::real scale = 1)
+{
+    const ref::real eps = std::numeric_limits<scal_type>::epsilon();
+    return static_cast<double>(std::fabs(static_cast<ref::real>(v) - r) / (eps * std::max(ref::real(1), std::max(std::fabs(r), scale))));
+}
+
+template<typename scal_type>
+class math_checks
+{
+public:
+    typedef scm::math::vec<scal_type, 2>    vec2_type;
+    typedef scm::math::vec<scal_type, 3>    vec3_type;
+    typedef scm::math::vec<scal_type, 4>    vec4_type;
+    typedef scm::math::mat<scal_type, 2, 2> mat2_type;
+    typedef scm::math::mat<scal_type, 3, 3> mat3_type;
+    typedef scm::math::mat<scal_type, 4, 4> mat4_type;
+    typedef scm::math::quat<scal_type>      quat_type;
+
+    typedef boost::variate_generator<boost::mt19937&, boost::uniform_real<double> > random_real;
+
+public:
+    math_checks(check_report& report, unsigned seed, unsigned count)
+      : _report(report)
+      , _rng(seed)
+      , _rand(_rng, boost::uniform_real<double>(-1.0, 1.0))
+      , _count(count)
+    {
+    }
+
+    void run()
+    {
+        check_vectors();
+        check_matrices<2>();
+        check_matrices<3>();
+        check_matrices<4>();
+        check_matrix_builders();
+        check_quaternions();
+        check_common();
+        check_primitives();
+    }
+
+protected:
+    scal_type rnd(double s = 1.0) { return static_cast<scal_type>(_rand() * s); }
+
+    template<unsigned order>
+    scm::math::mat<scal_type, order, order> random_mat(double s = 1.0)
+    {
+        scm::math::mat<scal_type, order, order> m;
+        for (unsigned i = 0; i < order * order; ++i) {
+            m.data_array[i] = rnd(s);
+        }
+        return m;
+    }
+    template<unsigned dim>
+    scm::math::vec<scal_type, dim> random_vec(double s = 1.0)
+    {
+        scm::math::vec<scal_type, dim> v;
+        for (unsigned i = 0; i < dim; ++i) {
+            v.data_array[i] = rnd(s);
+        }
+        return v;
+    }
+    const quat_type random_quat()
+    {
+        quat_type q;
+        do {
+            q = quat_type(rnd(), rnd(), rnd(), rnd());
+        } while (scm::math::magnitude(q) < scal_type(0.1));
+        return scm::math::normalize(q);
+    }
+    static ref::rquat to_ref_quat(const quat_type& q)
+    {
+        ref::rquat r;
+        r.q[0] = q.w; r.q[1] = q.x; r.q[2] = q.y; r.q[3] = q.z;
+        return r;
+    }
+    void report(const check_result& r) { _report.add(type_name<scal_type>::get(), r); }
+
+    void check_vectors()
+    {
+        using namespace scm::math;
+
+        check_result arith("vec4 +, -, * (exact)", 0.0);
+        check_result dot3("vec3 dot", 4.0);
+        check_result dot4("vec4 dot", 4.0);
+        check_result crs("vec3 cross", 4.0);
+        check_result len("vec3 length", 4.0);
+        check_result nrm("vec3 normalize", 4.0);
+
+        for (unsigned i = 0; i < _count; ++i) {
+            const vec4_type a = random_vec<4>();
+            const vec4_type b = random_vec<4>();
+            const scal_type s = rnd();
+            const vec4_type r0 = a + b;
+            const vec4_type r1 = a - b;
+            const vec4_type r2 = a * s;
+            bool ok = true;
+            for (unsigned c = 0; c < 4; ++c) {
+                ok =    ok
+                     && r0[c] == a[c] + b[c]
+                     && r1[c] == a[c] - b[c]
+                     && r2[c] == a[c] * s;
+            }
+            arith.exact(ok);
+
+            // cancellation makes the relative error unbounded, scale by the input magnitude
+            dot4.error(scaled_error(dot(a, b), ref::dot(ref::to_ref_vec<4>(a), ref::to_ref_vec<4>(b)), 4));
+
+            const vec3_type a3 = random_vec<3>();
+            const vec3_type b3 = random_vec<3>();
+            const ref::rvec<3> ra = ref::to_ref_vec<3>(a3);
+            const ref::rvec<3> rb = ref::to_ref_vec<3>(b3);
+
+            dot3.error(scaled_error(dot(a3, b3), ref::dot(ra, rb), 3));
+
+            const vec3_type    c3 = cross(a3, b3);
+            const ref::rvec<3> rc = ref::cross(ra, rb);
+            for (unsigned c = 0; c < 3; ++c) {
+                crs.error(scaled_error(c3[c], rc.v[c], 2));
+            }
+
+            len.error(scaled_error(length(a3), std::sqrt(ref::dot(ra, ra))));
+
+            if (length(a3) > scal_type(1.0e-3)) {
+                const vec3_type    n3 = normalize(a3);
+                const ref::rvec<3> rn = ref::normalize(ra);
+                for (unsigned c = 0; c < 3; ++c) {
+                    nrm.error(scaled_error(n3[c], rn.v[c]));
+                }
+            }
+        }
+
+        report(arith);
+        report(dot4);
+        report(dot3);
+        report(crs);
+        report(len);
+        report(nrm);
+    }
+
+    template<unsigned order>
+    void check_matrices()
+    {
+        using namespace scm::math;
+
+        typedef mat<scal_type, order, order>    mat_type;
+        typedef vec<scal_type, order>           vec_type;
+
+        const std::string   on = std::string("mat") + char('0' + order);
+        check_result        mul(on + " * " + on, 2.0 * order);
+        check_result        mvl(on + " * vec", 2.0 * order);
+        check_result        trp(on + " transpose (exact)", 0.0);
+        check_result        det(on + " determinant", 16.0 * order);
+        check_result        inv(on + " inverse", 16.0 * order);
+
+        for (unsigned i = 0; i < _count; ++i) {
+            const mat_type      a  = random_mat<order>();
+            const mat_type      b  = random_mat<order>();
+            const vec_type      v  = random_vec<order>();
+            const ref::rmat<order> ra = ref::to_ref<order>(a);
+            const ref::rmat<order> rb = ref::to_ref<order>(b);
+
+            const mat_type         ab  = a * b;
+            const ref::rmat<order> rab = ref::mul(ra, rb);
+            for (unsigned e = 0; e < order * order; ++e) {
+                mul.error(scaled_error(ab.data_array[e], rab.m[e], order));
+            }
+
+            const vec_type         av  = a * v;
+            const ref::rvec<order> rav = ref::mul(ra, ref::to_ref_vec<order>(v));
+            for (unsigned e = 0; e < order; ++e) {
+                mvl.error(scaled_error(av.data_array[e], rav.v[e], order));
+            }
+
+            const mat_type         at  = transpose(a);
+            const ref::rmat<order> rat = ref::transpose(ra);
+            bool ok = true;
+            for (unsigned e = 0; e < order * order; ++e) {
+                ok = ok && (static_cast<ref::real>(at.data_array[e]) == rat.m[e]);
+            }
+            trp.exact(ok);
+
+            // errors scaled by the hadamard bound of the determinant and the
+            // condition of the matrix for the inverse
+            ref::rmat<order> rinv;
+            const ref::real  rdet = ref::invert(ra, rinv);
+            ref::real        hadamard = 1;
+            for (unsigned r = 0; r < order; ++r) {
+                ref::real rn = 0;
+                for (unsigned c = 0; c < order; ++c) {
+                    rn += ra.m[r + c * order] * ra.m[r + c * order];
+                }
+                hadamard *= std::sqrt(rn);
+            }
+            det.error(scaled_error(determinant(a), rdet, hadamard));
+
+            if (std::fabs(rdet) > ref::real(1.0e-3)) {
+                const mat_type  ai   = inverse(a);
+                const ref::real cond = ref::norm_inf(ra) * ref::norm_inf(rinv);
+                for (unsigned e = 0; e < order * order; ++e) {
+                    inv.error(scaled_error(ai.data_array[e], rinv.m[e], ref::norm_inf(rinv)) / static_cast<double>(cond));
+                }
+            }
+        }
+
+        report(mul);
+        report(mvl);
+        report(trp);
+        report(det);
+        report(inv);
+
+        if (order == 4) {
+            check_simd();
+        }
+    }
+
+    // the generic templates are the reference for the specialized paths
+    void check_simd();
+
+    void check_matrix_builders()
+    {
+        using namespace scm::math;
+
+        check_result prs("make_perspective_matrix", 64.0);
+        check_result lat("make_look_at_matrix", 64.0);
+        check_result lti("make_look_at_matrix_inv", 64.0);
+
+        for (unsigned i = 0; i < _count; ++i) {
+            const scal_type fovy   = static_cast<scal_type>(20.0 + 70.0 * (_rand() * 0.5 + 0.5));
+            const scal_type aspect = static_cast<scal_type>(0.5 + 1.5 * (_rand() * 0.5 + 0.5));
+            const scal_type near_z = static_cast<scal_type>(0.01 + (_rand() * 0.5 + 0.5));
+            const scal_type far_z  = near_z + static_cast<scal_type>(10.0 + 1000.0 * (_rand() * 0.5 + 0.5));
+
+            const mat4_type    p  = make_perspective_matrix(fovy, aspect, near_z, far_z);
+            const ref::rmat<4> rp = ref::perspective(fovy, aspect, near_z, far_z);
+            for (unsigned e = 0; e < 16; ++e) {
+                prs.error(scaled_error(p.data_array[e], rp.m[e]));
+            }
+
+            const vec3_type eye    = random_vec<3>(100.0);
+            const vec3_type center = eye + random_vec<3>(10.0);
+            vec3_type       up     = random_vec<3>();
+            if (   length(center - eye) < scal_type(0.1)
+                || length(up) < scal_type(0.1)
+                || abs(dot(normalize(center - eye), normalize(up))) > scal_type(0.9)) {
+                continue;
+            }
+
+            const mat4_type    l  = make_look_at_matrix(eye, center, up);
+            const mat4_type    li = make_look_at_matrix_inv(eye, center, up);
+            const ref::rmat<4> rl = ref::look_at(ref::to_ref_vec<3>(eye), ref::to_ref_vec<3>(center), ref::to_ref_vec<3>(up));
+            ref::rmat<4>       rli;
+            ref::invert(rl, rli);
+            for (unsigned e = 0; e < 16; ++e) {
+                lat.error(scaled_error(l.data_array[e],  rl.m[e],  100));
+                lti.error(scaled_error(li.data_array[e], rli.m[e], 100));
+            }
+        }
+
+        report(prs);
+        report(lat);
+        report(lti);
+    }
+
+    void check_quaternions()
+    {
+        using namespace scm::math;
+
+        check_result qml("quat * quat", 8.0);
+        check_result qnr("quat normalize", 8.0);
+        check_result qsl("quat slerp", 256.0);
+        check_result qtm("quat to_matrix", 16.0);
+        check_result qvr("quat * vec3 (rotation)", 32.0);
+
+        for (unsigned i = 0; i < _count; ++i) {
+            const quat_type  a  = random_quat();
+            const quat_type  b  = random_quat();
+            const ref::rquat ra = to_ref_quat(a);
+            const ref::rquat rb = to_ref_quat(b);
+
+            const ref::rquat rab = ref::mul(ra, rb);
+            const ref::rquat qab = to_ref_quat(a * b);
+            for (unsigned c = 0; c < 4; ++c) {
+                qml.error(scaled_error(static_cast<scal_type>(qab.q[c]), rab.q[c], 2));
+            }
+
+            const quat_type  c = quat_type(rnd(10.0), rnd(10.0), rnd(10.0), rnd(10.0));
+            if (magnitude(c) > scal_type(0.1)) {
+                const ref::rquat rn = ref::normalize(to_ref_quat(c));
+                const ref::rquat qn = to_ref_quat(normalize(c));
+                for (unsigned e = 0; e < 4; ++e) {
+                    qnr.error(scaled_error(static_cast<scal_type>(qn.q[e]), rn.q[e]));
+                }
+            }
+
+            // nearly parallel quaternions are ill conditioned in acos, for nearly
+            // orthogonal ones the shortest path (sign of q) is ambiguous
+            const ref::real cd = std::fabs(ra.q[0] * rb.q[0] + ra.q[1] * rb.q[1] + ra.q[2] * rb.q[2] + ra.q[3] * rb.q[3]);
+            if (cd < ref::real(0.99) && cd > ref::real(1.0e-3)) {
+                const scal_type  u  = static_cast<scal_type>(_rand() * 0.5 + 0.5);
+                const ref::rquat rs = ref::slerp(ra, rb, u);
+                const ref::rquat qs = to_ref_quat(slerp(a, b, u));
+                for (unsigned e = 0; e < 4; ++e) {
+                    qsl.error(scaled_error(static_cast<scal_type>(qs.q[e]), rs.q[e]));
+                }
+            }
+
+            const mat4_type    m  = a.to_matrix();
+            const ref::rmat<4> rm = ref::to_matrix(ra);
+            for (unsigned e = 0; e < 16; ++e) {
+                qtm.error(scaled_error(m.data_array[e], rm.m[e], 2));
+            }
+
+            const vec3_type    v  = random_vec<3>();
+            const vec3_type    av = a * v;
+            ref::rvec<4>       rv4;
+            rv4.v[0] = v.x; rv4.v[1] = v.y; rv4.v[2] = v.z; rv4.v[3] = 1;
+            const ref::rvec<4> rav = ref::mul(rm, rv4);
+            for (unsigned e = 0; e < 3; ++e) {
+                qvr.error(scaled_error(av[e], rav.v[e], 2));
+            }
+        }
+
+        report(qml);
+        report(qnr);
+        report(qsl);
+        report(qtm);
+        report(qvr);
+    }
+
+    void check_common()
+    {
+        using namespace scm::math;
+
+        typedef boost::variate_generator<boost::mt19937&, boost::uniform_int<scm::uint32> > random_uint;
+        random_uint rand_u32(_rng, boost::uniform_int<scm::uint32>(0u, 0xffffffffu));
+
+        check_result sgn("sign, min, max, clamp (exact)", 0.0);
+        check_result frc("fract, round", 1.0);
+        check_result lrp("lerp, shoothstep", 8.0);
+        check_result ang("rad2deg, deg2rad", 4.0);
+        check_result bts("bit_count, first_zero_bit (exact)", 0.0);
+        check_result pot("is_power_of_two, next_power_of_two (exact)", 0.0);
+        check_result flg("floor_log2 (exact)", 0.0);
+        check_result bfl("butterfly_1..16 (exact)", 0.0);
+
+        for (unsigned i = 0; i < _count; ++i) {
+            const scal_type a = rnd(100.0);
+            const scal_type b = rnd(100.0);
+            const scal_type x = rnd(200.0);
+            const scal_type lo = scm::math::min(a, b);
+            const scal_type hi = scm::math::max(a, b);
+
+            sgn.exact(   sign(a) == (a < scal_type(0) ? -1 : 1)
+                      && lo == (a < b ? a : b)
+                      && hi == (a > b ? a : b)
+                      && clamp(x, lo, hi) == (x < lo ? lo : (x > hi ? hi : x)));
+
+            // a - floor(a) rounds for negative values, round is checked away from the
+            // rounding of the fractional part at 0.5
+            const ref::real ra  = a;
+            const ref::real rfl = std::floor(ra);
+            const ref::real rfr = ra - rfl;
+            frc.error(scaled_error(fract(a), rfr, std::fabs(ra)));
+            if (std::fabs(rfr - ref::real(0.5)) > 4 * std::numeric_limits<scal_type>::epsilon() * std::max(ref::real(1), std::fabs(ra))) {
+                frc.error(static_cast<ref::real>(scm::math::round(a)) == (rfr < ref::real(0.5) ? rfl : rfl + 1) ? 0.0 : HUGE_VAL);
+            }
+
+            const scal_type u = static_cast<scal_type>(_rand() * 0.5 + 0.5);
+            lrp.error(scaled_error(lerp(a, b, u), ref::real(b) * u + ref::real(a) * (1 - ref::real(u)), 100));
+            if (hi - lo > scal_type(1)) {
+                ref::real t = (ref::real(x) - lo) / (ref::real(hi) - lo);
+                t = std::min(ref::real(1), std::max(ref::real(0), t));
+                lrp.error(scaled_error(shoothstep(lo, hi, x), t * t * (3 - 2 * t)));
+            }
+
+            const ref::real pi = 3.14159265358979323846264338327950288L;
+            ang.error(scaled_error(rad2deg(a), ref::real(a) * 180 / pi));
+            ang.error(scaled_error(deg2rad(a), ref::real(a) * pi / 180));
+
+            const scm::uint32 v = (i < 64) ? ((i < 32) ? (1u << i) : ~(1u << (i - 32))) : rand_u32();
+            const scm::uint32 s = v >> (rand_u32() % 32);
+
+            bts.exact(   bit_count(v) == ref::bit_count(v)
+                      && bit_count(s) == ref::bit_count(s)
+                      && first_zero_bit(v) == ((~v) ? ref::floor_log2((~v) & (0u - ~v)) : 32u));
+
+            const scm::uint32 p = (s & 0x7fffffffu) + 1u;
+            pot.exact(   is_power_of_two(p) == (ref::bit_count(p) == 1)
+                      && next_power_of_two(p) == ref::next_power_of_two(p));
+
+            const scm::uint64 v64 = (static_cast<scm::uint64>(rand_u32()) << 32 | rand_u32()) >> (rand_u32() % 64);
+            flg.exact(   floor_log2(v) == ref::floor_log2(v)
+                      && floor_log2(s) == ref::floor_log2(s)
+                      && floor_log2(v64) == ref::floor_log2(v64));
+
+            bfl.exact(   butterfly_1(v)  == ref::butterfly(v, 1)
+                      && butterfly_2(v)  == ref::butterfly(v, 2)
+                      && butterfly_4(v)  == ref::butterfly(v, 4)
+                      && butterfly_8(v)  == ref::butterfly(v, 8)
+                      && butterfly_16(v) == ref::butterfly(v, 16));
+        }
+
+        report(sgn);
+        report(frc);
+        report(lrp);
+        report(ang);
+        report(bts);
+        report(pot);
+        report(flg);
+        report(bfl);
+    }
+
+    void check_primitives()
+    {
+        using namespace scm::math;
+        using namespace scm::gl;
+
+        typedef plane_impl<scal_type>   plane_type;
+        typedef frustum_impl<scal_type> frustum_type;
+        typedef box_impl<scal_type>     box_type;
+        typedef ray_impl<scal_type>     ray_type;
+
+        const scal_type e = scm::gl::epsilon<scal_type>::value();
+
+        check_result pld("plane distance", 8.0);
+        check_result frp("frustum planes", 512.0);
+        check_result frc("frustum classify box (exact)", 0.0);
+        check_result bxc("box classify box, point (exact)", 0.0);
+        check_result rbx("box intersect ray", 4096.0);
+        check_result rpl("plane intersect ray", 4096.0);
+
+        const mat4_type proj = make_perspective_matrix(scal_type(60), scal_type(16.0 / 9.0), scal_type(0.1), scal_type(100));
+
+        for (unsigned i = 0; i < _count / 10 + 1; ++i) {
+            const vec3_type eye = random_vec<3>(20.0);
+            const vec3_type dir = random_vec<3>();
+            if (length(dir) < scal_type(0.1) || abs(normalize(dir).y) > scal_type(0.9)) {
+                continue;
+            }
+
+            const mat4_type    vp = proj * make_look_at_matrix(eye, eye + dir, vec3_type(scal_type(0), scal_type(1), scal_type(0)));
+            const frustum_type f(vp);
+            ref::rvec<4>       rp[6];
+            ref::frustum_planes(ref::to_ref<4>(vp), rp);
+
+            for (unsigned p = 0; p < 6; ++p) {
+                for (unsigned c = 0; c < 4; ++c) {
+                    frp.error(scaled_error(f.get_plane(p).vector()[c], rp[p].v[c], 100));
+                }
+            }
+
+            for (unsigned b = 0; b < 64; ++b) {
+                const vec3_type bmin = eye + random_vec<3>(60.0);
+                const vec3_type bmax = bmin + (random_vec<3>(5.0) + vec3_type(scal_type(5)));
+                const box_type  bx(bmin, bmax);
+
+                // reference classification over all corners, skipped near the epsilon band
+                bool outside   = false;
+                bool intersect = false;
+                bool ambiguous = false;
+                for (unsigned p = 0; p < 6; ++p) {
+                    ref::real dmin =  HUGE_VALL;
+                    ref::real dmax = -HUGE_VALL;
+                    for (unsigned c = 0; c < 8; ++c) {
+                        ref::rvec<3> cv;
+                        cv.v[0] = (c & 1) ? bmax.x : bmin.x;
+                        cv.v[1] = (c & 2) ? bmax.y : bmin.y;
+                        cv.v[2] = (c & 4) ? bmax.z : bmin.z;
+                        const ref::real d = ref::plane_distance(rp[p], cv);
+                        dmin = std::min(dmin, d);
+                        dmax = std::max(dmax, d);
+                    }
+                    ambiguous = ambiguous || std::fabs(dmin - e) < 1.0e-2 || std::fabs(dmax - e) < 1.0e-2;
+                    if (dmax <= e) {
+                        outside = true;
+                    }
+                    else if (dmin <= e) {
+                        intersect = true;
+                    }
+                }
+                if (!ambiguous) {
+                    const typename frustum_type::classification_result rr =
+                        outside ? frustum_type::outside : (intersect ? frustum_type::intersecting : frustum_type::inside);
+                    frc.exact(f.classify(bx) == rr);
+                }
+
+                // plane distances of the box center
+                const vec3_type    bc  = bx.center();
+                const ref::rvec<3> rbc = ref::to_ref_vec<3>(bc);
+                for (unsigned p = 0; p < 6; ++p) {
+                    const ref::real rd = ref::plane_distance(ref::to_ref_vec<4>(f.get_plane(p).vector()), rbc);
+                    pld.error(scaled_error(f.get_plane(p).distance(bc), rd, 100));
+                }
+
+                // box against box and point
+                const box_type  ob(bmin + random_vec<3>(10.0), bmax + random_vec<3>(10.0));
+                bool            overlap = true;
+                bool            inside  = true;
+                const vec3_type pt      = bc + random_vec<3>(5.0);
+                for (unsigned c = 0; c < 3; ++c) {
+                    overlap = overlap && !(bmin[c] > ob.max_vertex()[c] || bmax[c] < ob.min_vertex()[c]);
+                    inside  = inside  && !(bmin[c] > pt[c] || bmax[c] < pt[c]);
+                }
+                bxc.exact(   (bx.classify(ob) == box_type::overlaping) == overlap
+                          && (bx.classify(pt) == box_type::inside)     == inside);
+
+                // rays from the eye towards the box
+                const vec3_type target = bc + random_vec<3>(5.0);
+                if (length(target - eye) < scal_type(1)) {
+                    continue;
+                }
+                const ray_type     r(eye, target - eye);
+                ref::real          tmin;
+                ref::real          tmax;
+                const bool         rhit = ref::ray_box(ref::to_ref_vec<3>(r.origin()), ref::to_ref_vec<3>(r.direction()),
+                                                       ref::to_ref_vec<3>(bmin), ref::to_ref_vec<3>(bmax), tmin, tmax);
+                vec3_type          entry;
+                vec3_type          exit;
+                const bool         hit  = bx.intersect(r, entry, exit);
+                if (std::fabs(tmax - tmin) > ref::real(1.0e-2) && std::fabs(tmin) > ref::real(1.0e-2)) {
+                    if (hit != (rhit && tmin > 0)) {
+                        rbx.exact(false);
+                    }
+                    else if (hit) {
+                        for (unsigned c = 0; c < 3; ++c) {
+                            rbx.error(scaled_error(entry[c], ref::real(r.origin()[c]) + tmin * r.direction()[c], 100));
+                            rbx.error(scaled_error(exit[c],  ref::real(r.origin()[c]) + tmax * r.direction()[c], 100));
+                        }
+                    }
+                }
+
+                // ray against the near plane
+                const plane_type& np = f.get_plane(frustum_type::near_plane);
+                vec3_type         ph;
+                if (np.intersect(r, ph)) {
+                    const ref::rvec<4> rnp = ref::to_ref_vec<4>(np.vector());
+                    const ref::real    dn  =   rnp.v[0] * r.direction().x + rnp.v[1] * r.direction().y + rnp.v[2] * r.direction().z;
+                    const ref::real    t   = -ref::plane_distance(rnp, ref::to_ref_vec<3>(r.origin())) / dn;
+                    // the error grows with the inverse of the incidence angle
+                    for (unsigned c = 0; c < 3; ++c) {
+                        rpl.error(scaled_error(ph[c], ref::real(r.origin()[c]) + t * r.direction()[c], 100) * static_cast<double>(std::fabs(dn)));
+                    }
+                }
+            }
+        }
+
+        report(pld);
+        report(frp);
+        report(frc);
+        report(bxc);
+        report(rbx);
+        report(rpl);
+    }
+
+protected:
+    check_report&       _report;
+    boost::mt19937      _rng;
+    random_real         _rand;
+    unsigned            _count;
+
+}; // class math_checks
+
+template<typename scal_type>
+inline
+void
+math_checks<scal_type>::check_simd()
+{
+}
+
+// single precision sse paths, the results of the products and transforms have to be
+// bit identical to the generic templates
+template<>
+inline
+void
+math_checks<float>::check_simd()
+{
+    using namespace scm::math;
+
+    check_result mml("mat4 * mat4 simd (bit identical)", 0.0);
+    check_result mvl("mat4 * vec simd (bit identical)", 0.0);
+    check_result tpt("transform_points (bit identical)", 0.0);
+    check_result tmt("transform_matrices (bit identical)", 0.0);
+    check_result inv("mat4f_simd inverse", 64.0);
+    check_result qml("quatf_simd *", 8.0);
+    check_result qsl("quatf_simd slerp", 256.0);
+
+    std::vector<vec3f> p3(16);
+    std::vector<vec4f> p4(16);
+    std::vector<mat4f> mt(4);
+
+    for (unsigned i = 0; i < _count; ++i) {
+        const mat4f a = random_mat<4>();
+        const mat4f b = random_mat<4>();
+
+        const mat4f r0 = operator*<float, 4>(a, b);
+        const mat4f r1 = a * b;
+        const mat4f r2 = (mat4f_simd(a) * mat4f_simd(b)).to_mat4f();
+        mat4f       r3 = a;
+        r3 *= b;
+        mml.exact(   0 == std::memcmp(r0.data_array, r1.data_array, sizeof(r0.data_array))
+                  && 0 == std::memcmp(r0.data_array, r2.data_array, sizeof(r0.data_array))
+                  && 0 == std::memcmp(r0.data_array, r3.data_array, sizeof(r0.data_array)));
+
+        const vec4f v  = random_vec<4>();
+        const vec3f v3 = random_vec<3>();
+        const vec4f v0 = operator*<float, 4>(a, v);
+        const vec4f v1 = a * v;
+        const vec4f v2 = (mat4f_simd(a) * vec4f_simd(v)).to_vec4f();
+        const vec4f w0 = operator*<float, 4>(a, v3);
+        const vec4f w1 = a * v3;
+        mvl.exact(   0 == std::memcmp(v0.data_array, v1.data_array, sizeof(v0.data_array))
+                  && 0 == std::memcmp(v0.data_array, v2.data_array, sizeof(v0.data_array))
+                  && 0 == std::memcmp(w0.data_array, w1.data_array, sizeof(w0.data_array)));
+
+        for (unsigned p = 0; p < p3.size(); ++p) {
+            p3[p] = random_vec<3>(100.0);
+            p4[p] = random_vec<4>(100.0);
+        }
+        std::vector<vec3f> o3(p3.size());
+        std::vector<vec4f> o4(p4.size());
+        transform_points(a, &p3.front(), &o3.front(), p3.size());
+        transform_points(a, &p4.front(), &o4.front(), p4.size());
+        bool ok = true;
+        for (unsigned p = 0; p < p3.size(); ++p) {
+            const vec4f e3 = operator*<float, 4>(a, p3[p]);
+            const vec4f e4 = operator*<float, 4>(a, p4[p]);
+            ok =    ok
+                 && e3.x == o3[p].x && e3.y == o3[p].y && e3.z == o3[p].z
+                 && 0 == std::memcmp(e4.data_array, o4[p].data_array, sizeof(e4.data_array));
+        }
+        tpt.exact(ok);
+
+        for (unsigned m = 0; m < mt.size(); ++m) {
+            mt[m] = random_mat<4>();
+        }
+        std::vector<mat4f> om(mt.size());
+        transform_matrices(a, &mt.front(), &om.front(), mt.size());
+        ok = true;
+        for (unsigned m = 0; m < mt.size(); ++m) {
+            const mat4f e = operator*<float, 4>(a, mt[m]);
+            ok = ok && 0 == std::memcmp(e.data_array, om[m].data_array, sizeof(e.data_array));
+        }
+        tmt.exact(ok);
+
+        ref::rmat<4>    rinv;
+        const ref::real rdet = ref::invert(ref::to_ref<4>(a), rinv);
+        if (std::fabs(rdet) > ref::real(1.0e-3)) {
+            const mat4f     ai   = inverse(mat4f_simd(a)).to_mat4f();
+            const ref::real cond = ref::norm_inf(ref::to_ref<4>(a)) * ref::norm_inf(rinv);
+            for (unsigned e = 0; e < 16; ++e) {
+                inv.error(scaled_error(ai.data_array[e], rinv.m[e], ref::norm_inf(rinv)) / static_cast<double>(cond));
+            }
+        }
+
+        const quatf      qa  = random_quat();
+        const quatf      qb  = random_quat();
+        const ref::rquat rqa = to_ref_quat(qa);
+        const ref::rquat rqb = to_ref_quat(qb);
+        const ref::rquat rm  = ref::mul(rqa, rqb);
+        const ref::rquat qm  = to_ref_quat((quatf_simd(qa) * quatf_simd(qb)).to_quatf());
+        for (unsigned c = 0; c < 4; ++c) {
+            qml.error(scaled_error(static_cast<float>(qm.q[c]), rm.q[c], 2));
+        }
+        const ref::real cd = std::fabs(rqa.q[0] * rqb.q[0] + rqa.q[1] * rqb.q[1] + rqa.q[2] * rqb.q[2] + rqa.q[3] * rqb.q[3]);
+        if (cd < ref::real(0.99) && cd > ref::real(1.0e-3)) {
+            const float      u  = static_cast<float>(_rand() * 0.5 + 0.5);
+            const ref::rquat rs = ref::slerp(rqa, rqb, u);
+            const ref::rquat qs = to_ref_quat(slerp(quatf_simd(qa), quatf_simd(qb), u).to_quatf());
+            for (unsigned c = 0; c < 4; ++c) {
+                qsl.error(scaled_error(static_cast<float>(qs.q[c]), rs.q[c]));
+            }
+        }
+    }
+
+    report(mml);
+    report(mvl);
+    report(tpt);
+    report(tmt);
+    report(inv);
+    report(qml);
+    report(qsl);
+}
+
+} // namespace math_bench
+
+#endif // SCM_MATH_BENCH_MATH_CHECKS_H_INCLUDED
@@ -0,0 +1,445 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_MATH_BENCH_REFERENCE_H_INCLUDED
+#define SCM_MATH_BENCH_REFERENCE_H_INCLUDED
+
+#include <algorithm>
+#include <cmath>
+
+#include <scm/core/numeric_types.h>
+
+// straight forward extended precision reference implementations, independent
+// of scm::math, all matrices are column major like the scm::math matrices
+namespace ref {
+
+typedef long double real;
+
+template<unsigned dim>
+struct rvec
+{
+    real        v[dim];
+}; // struct rvec
+
+template<unsigned order>
+struct rmat
+{
+    real        m[order * order];
+}; // struct rmat
+
+// w, x, y, z
+struct rquat
+{
+    real        q[4];
+}; // struct rquat
+
+template<unsigned order, class mat_type>
+rmat<order>
+to_ref(const mat_type& in)
+{
+    rmat<order> r;
+    for (unsigned i = 0; i < order * order; ++i) {
+        r.m[i] = static_cast<real>(in.data_array[i]);
+    }
+    return r;
+}
+
+template<unsigned dim, class vec_type>
+rvec<dim>
+to_ref_vec(const vec_type& in)
+{
+    rvec<dim> r;
+    for (unsigned i = 0; i < dim; ++i) {
+        r.v[i] = static_cast<real>(in.data_array[i]);
+    }
+    return r;
+}
+
+template<unsigned order>
+rmat<order>
+mul(const rmat<order>& a, const rmat<order>& b)
+{
+    rmat<order> r;
+    for (unsigned c = 0; c < order; ++c) {
+        for (unsigned w = 0; w < order; ++w) {
+            real s = 0;
+            for (unsigned d = 0; d < order; ++d) {
+                s += a.m[w + d * order] * b.m[d + c * order];
+            }
+            r.m[w + c * order] = s;
+        }
+    }
+    return r;
+}
+
+template<unsigned order>
+rvec<order>
+mul(const rmat<order>& a, const rvec<order>& b)
+{
+    rvec<order> r;
+    for (unsigned w = 0; w < order; ++w) {
+        real s = 0;
+        for (unsigned d = 0; d < order; ++d) {
+            s += a.m[w + d * order] * b.v[d];
+        }
+        r.v[w] = s;
+    }
+    return r;
+}
+
+template<unsigned order>
+rmat<order>
+transpose(const rmat<order>& a)
+{
+    rmat<order> r;
+    for (unsigned c = 0; c < order; ++c) {
+        for (unsigned w = 0; w < order; ++w) {
+            r.m[c + w * order] = a.m[w + c * order];
+        }
+    }
+    return r;
+}
+
+// gauss jordan elimination with partial pivoting, returns the determinant,
+// out_inverse is only valid for a non zero determinant
+template<unsigned order>
+real
+invert(const rmat<order>& a, rmat<order>& out_inverse)
+{
+    real l[order][order];
+    real r[order][order];
+
+    for (unsigned i = 0; i < order; ++i) {
+        for (unsigned j = 0; j < order; ++j) {
+            l[i][j] = a.m[i + j * order];
+            r[i][j] = (i == j) ? real(1) : real(0);
+        }
+    }
+
+    real det = 1;
+    for (unsigned c = 0; c < order; ++c) {
+        unsigned p = c;
+        for (unsigned i = c + 1; i < order; ++i) {
+            if (std::fabs(l[i][c]) > std::fabs(l[p][c])) {
+                p = i;
+            }
+        }
+        if (l[p][c] == real(0)) {
+            return real(0);
+        }
+        if (p != c) {
+            for (unsigned j = 0; j < order; ++j) {
+                std::swap(l[p][j], l[c][j]);
+                std::swap(r[p][j], r[c][j]);
+            }
+            det = -det;
+        }
+        const real pv = l[c][c];
+        det *= pv;
+        for (unsigned j = 0; j < order; ++j) {
+            l[c][j] /= pv;
+            r[c][j] /= pv;
+        }
+        for (unsigned i = 0; i < order; ++i) {
+            if (i != c) {
+                const real f = l[i][c];
+                for (unsigned j = 0; j < order; ++j) {
+                    l[i][j] -= f * l[c][j];
+                    r[i][j] -= f * r[c][j];
+                }
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < order; ++i) {
+        for (unsigned j = 0; j < order; ++j) {
+            out_inverse.m[i + j * order] = r[i][j];
+        }
+    }
+    return det;
+}
+
+template<unsigned order>
+real
+norm_inf(const rmat<order>& a)
+{
+    real n = 0;
+    for (unsigned i = 0; i < order; ++i) {
+        real s = 0;
+        for (unsigned j = 0; j < order; ++j) {
+            s += std::fabs(a.m[i + j * order]);
+        }
+        n = std::max(n, s);
+    }
+    return n;
+}
+
+template<unsigned dim>
+real
+dot(const rvec<dim>& a, const rvec<dim>& b)
+{
+    real s = 0;
+    for (unsigned i = 0; i < dim; ++i) {
+        s += a.v[i] * b.v[i];
+    }
+    return s;
+}
+
+inline
+rvec<3>
+cross(const rvec<3>& a, const rvec<3>& b)
+{
+    rvec<3> r;
+    r.v[0] = a.v[1] * b.v[2] - a.v[2] * b.v[1];
+    r.v[1] = a.v[2] * b.v[0] - a.v[0] * b.v[2];
+    r.v[2] = a.v[0] * b.v[1] - a.v[1] * b.v[0];
+    return r;
+}
+
+template<unsigned dim>
+rvec<dim>
+normalize(const rvec<dim>& a)
+{
+    const real l = std::sqrt(dot(a, a));
+    rvec<dim>  r = a;
+    if (l > real(0)) {
+        for (unsigned i = 0; i < dim; ++i) {
+            r.v[i] /= l;
+        }
+    }
+    return r;
+}
+
+inline
+rquat
+mul(const rquat& a, const rquat& b)
+{
+    // w, x, y, z
+    rquat r;
+    r.q[0] = a.q[0] * b.q[0] - a.q[1] * b.q[1] - a.q[2] * b.q[2] - a.q[3] * b.q[3];
+    r.q[1] = a.q[0] * b.q[1] + a.q[1] * b.q[0] + a.q[2] * b.q[3] - a.q[3] * b.q[2];
+    r.q[2] = a.q[0] * b.q[2] - a.q[1] * b.q[3] + a.q[2] * b.q[0] + a.q[3] * b.q[1];
+    r.q[3] = a.q[0] * b.q[3] + a.q[1] * b.q[2] - a.q[2] * b.q[1] + a.q[3] * b.q[0];
+    return r;
+}
+
+inline
+rquat
+normalize(const rquat& a)
+{
+    const real l = std::sqrt(a.q[0] * a.q[0] + a.q[1] * a.q[1] + a.q[2] * a.q[2] + a.q[3] * a.q[3]);
+    rquat      r = a;
+    if (l > real(0)) {
+        for (unsigned i = 0; i < 4; ++i) {
+            r.q[i] /= l;
+        }
+    }
+    return r;
+}
+
+// shortest path spherical interpolation
+inline
+rquat
+slerp(const rquat& a, const rquat& b, real u)
+{
+    real       c = a.q[0] * b.q[0] + a.q[1] * b.q[1] + a.q[2] * b.q[2] + a.q[3] * b.q[3];
+    const real s = c < real(0) ? real(-1) : real(1);
+    c *= s;
+
+    real wa = real(1) - u;
+    real wb = u;
+    if (c < real(1)) {
+        const real t  = std::acos(c);
+        const real st = std::sin(t);
+        wa = std::sin((real(1) - u) * t) / st;
+        wb = s * std::sin(u * t) / st;
+    }
+
+    rquat r;
+    for (unsigned i = 0; i < 4; ++i) {
+        r.q[i] = wa * a.q[i] + wb * b.q[i];
+    }
+    return normalize(r);
+}
+
+// rotation matrix of a unit quaternion
+inline
+rmat<4>
+to_matrix(const rquat& a)
+{
+    const real w = a.q[0];
+    const real x = a.q[1];
+    const real y = a.q[2];
+    const real z = a.q[3];
+
+    rmat<4> r;
+    r.m[0]  = 1 - 2 * (y * y + z * z);  r.m[4]  = 2 * (x * y - w * z);      r.m[8]  = 2 * (x * z + w * y);      r.m[12] = 0;
+    r.m[1]  = 2 * (x * y + w * z);      r.m[5]  = 1 - 2 * (x * x + z * z);  r.m[9]  = 2 * (y * z - w * x);      r.m[13] = 0;
+    r.m[2]  = 2 * (x * z - w * y);      r.m[6]  = 2 * (y * z + w * x);      r.m[10] = 1 - 2 * (x * x + y * y);  r.m[14] = 0;
+    r.m[3]  = 0;                        r.m[7]  = 0;                        r.m[11] = 0;                        r.m[15] = 1;
+    return r;
+}
+
+// opengl style perspective projection (gluPerspective)
+inline
+rmat<4>
+perspective(real fovy_deg, real aspect, real n, real f)
+{
+    const real pi  = 3.14159265358979323846264338327950288L;
+    const real cot = real(1) / std::tan(fovy_deg * pi / real(360));
+
+    rmat<4> r;
+    for (unsigned i = 0; i < 16; ++i) {
+        r.m[i] = 0;
+    }
+    r.m[0]  = cot / aspect;
+    r.m[5]  = cot;
+    r.m[10] = (f + n) / (n - f);
+    r.m[11] = -1;
+    r.m[14] = (real(2) * f * n) / (n - f);
+    return r;
+}
+
+// opengl style view matrix (gluLookAt)
+inline
+rmat<4>
+look_at(const rvec<3>& eye, const rvec<3>& center, const rvec<3>& up)
+{
+    rvec<3> f;
+    for (unsigned i = 0; i < 3; ++i) {
+        f.v[i] = center.v[i] - eye.v[i];
+    }
+    f = normalize(f);
+    const rvec<3> s = normalize(cross(f, normalize(up)));
+    const rvec<3> u = cross(s, f);
+
+    rmat<4> r;
+    for (unsigned i = 0; i < 3; ++i) {
+        r.m[i * 4 + 0] =  s.v[i];
+        r.m[i * 4 + 1] =  u.v[i];
+        r.m[i * 4 + 2] = -f.v[i];
+        r.m[i * 4 + 3] =  0;
+    }
+    r.m[12] = -dot(s, eye);
+    r.m[13] = -dot(u, eye);
+    r.m[14] =  dot(f, eye);
+    r.m[15] =  1;
+    return r;
+}
+
+// normalized frustum plane vectors (left, right, top, bottom, near, far like
+// frustum_impl::plane_identifier) of a projection matrix, normals pointing inside
+inline
+void
+frustum_planes(const rmat<4>& m, rvec<4> out_planes[6])
+{
+    static const unsigned rows[6]  = { 0, 0, 1, 1, 2, 2 };
+    static const int      signs[6] = { 1, -1, -1, 1, 1, -1 };
+
+    for (unsigned p = 0; p < 6; ++p) {
+        const unsigned r = rows[p];
+        const real     s = static_cast<real>(signs[p]);
+        for (unsigned c = 0; c < 4; ++c) {
+            out_planes[p].v[c] = m.m[3 + c * 4] + s * m.m[r + c * 4];
+        }
+        const real l = std::sqrt(  out_planes[p].v[0] * out_planes[p].v[0]
+                                 + out_planes[p].v[1] * out_planes[p].v[1]
+                                 + out_planes[p].v[2] * out_planes[p].v[2]);
+        for (unsigned c = 0; c < 4; ++c) {
+            out_planes[p].v[c] /= l;
+        }
+    }
+}
+
+inline
+real
+plane_distance(const rvec<4>& p, const rvec<3>& x)
+{
+    return p.v[0] * x.v[0] + p.v[1] * x.v[1] + p.v[2] * x.v[2] + p.v[3];
+}
+
+// slab test, returns false for a miss, t values along the (normalized) ray
+inline
+bool
+ray_box(const rvec<3>& org, const rvec<3>& dir, const rvec<3>& bmin, const rvec<3>& bmax, real& out_tmin, real& out_tmax)
+{
+    real tmin = -HUGE_VALL;
+    real tmax =  HUGE_VALL;
+    for (unsigned i = 0; i < 3; ++i) {
+        const real t0 = (bmin.v[i] - org.v[i]) / dir.v[i];
+        const real t1 = (bmax.v[i] - org.v[i]) / dir.v[i];
+        tmin = std::max(tmin, std::min(t0, t1));
+        tmax = std::min(tmax, std::max(t0, t1));
+    }
+    out_tmin = tmin;
+    out_tmax = tmax;
+    return tmin <= tmax;
+}
+
+// bit permutation of the butterfly networks in bit_magic.h, swaps the second and
+// third quarter of each group of 4 * b bits, quarters outside of the 32 bits
+// leave the bits unchanged
+inline
+unsigned
+butterfly(unsigned x, unsigned b)
+{
+    unsigned r = 0;
+    for (unsigned i = 0; i < 32; ++i) {
+        const unsigned g = i / (4 * b);
+        const unsigned q = (i % (4 * b)) / b;
+        const unsigned o = i % b;
+        unsigned       s = q;
+        if (q == 1) {
+            s = 2;
+        }
+        else if (q == 2) {
+            s = 1;
+        }
+        unsigned       src = g * 4 * b + s * b + o;
+        if (src >= 32) {
+            src = i;
+        }
+        if (x & (1u << src)) {
+            r |= 1u << i;
+        }
+    }
+    return r;
+}
+
+inline
+unsigned
+bit_count(scm::uint64 x)
+{
+    unsigned c = 0;
+    for (; x; x >>= 1) {
+        c += static_cast<unsigned>(x & 1u);
+    }
+    return c;
+}
+
+inline
+int
+floor_log2(scm::uint64 x)
+{
+    int p = -1;
+    for (; x; x >>= 1) {
+        ++p;
+    }
+    return p;
+}
+
+inline
+scm::uint64
+next_power_of_two(scm::uint64 x)
+{
+    scm::uint64 p = 1;
+    while (p < x) {
+        p <<= 1;
+    }
+    return p;
+}
+
+} // namespace ref
+
+#endif // SCM_MATH_BENCH_REFERENCE_H_INCLUDED
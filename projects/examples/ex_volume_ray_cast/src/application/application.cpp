@@ -267,7 +267,8 @@ application_window::display(const gl::render_context_ptr& context)
             os << std::fixed << std::setprecision(3)
                << (_show_raw ? "Raw Volume " : "Color-Mapped Volume ")
                << "LOD: " << _volume_data->selected_lod() 
-               << ", size: " << lod_size << std::endl;
+               << ", size: " << lod_size
+               << ", empty-space skipping: " << (_volume_data->empty_space_skipping() ? "on" : "off") << std::endl;
             _output_text->text_string(os.str());
             _text_renderer->draw_shadowed(context, vec2i(10, 10), _output_text);
         }
@@ -294,6 +295,7 @@ application_window::keyboard_input(int k, bool state, scm::uint32 mod)
             case Qt::Key_S:         _volume_renderer->reload_shaders(_viewer->device());break;
             case Qt::Key_1:         _volume_data->selected_lod(_volume_data->selected_lod() - 0.25f);break;
             case Qt::Key_2:         _volume_data->selected_lod(_volume_data->selected_lod() + 0.25f);break;
+            case Qt::Key_E:         _volume_data->empty_space_skipping(!_volume_data->empty_space_skipping());break;
             default:;
         }
     }
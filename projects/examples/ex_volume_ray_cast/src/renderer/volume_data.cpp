@@ -22,6 +22,7 @@
 #include <scm/core/numeric_types.h>
 #include <scm/core/time/high_res_timer.h>
 
+#include <scm/gl_util/data/analysis/volume_statistics.h>
 #include <scm/gl_util/data/analysis/transfer_function/build_lookup_table.h>
 
 #include <scm/gl_core/math.h>
@@ -38,6 +39,12 @@
 #include <scm/gl_util/data/volume/volume_reader_segy.h>
 #include <scm/gl_util/data/volume/volume_reader_vgeo.h>
 
+namespace {
+
+const unsigned empty_space_brick_size = 16;
+
+} // namespace
+
 namespace scm {
 namespace data {
 
@@ -49,6 +56,7 @@ volume_data::volume_data(const gl::render_device_ptr& device,
   , _color_map(new color_map_type(cmap))
   , _alpha_map(new alpha_map_type(amap))
   , _selected_lod(0.0f)
+  , _empty_space_skipping(true)
 {
     using namespace scm::gl;
     using namespace scm::math;
@@ -126,6 +134,7 @@ volume_data::~volume_data()
 
     _volume_raw.reset();
     _color_alpha_map.reset();
+    _empty_space_map.reset();
 
     _volume_block.reset();
 }
@@ -268,6 +277,24 @@ volume_data::color_alpha_map() const
     return _color_alpha_map;
 }
 
+const gl::empty_space_map_ptr&
+volume_data::empty_space_map() const
+{
+    return _empty_space_map;
+}
+
+bool
+volume_data::empty_space_skipping() const
+{
+    return _empty_space_skipping;
+}
+
+void
+volume_data::empty_space_skipping(bool s)
+{
+    _empty_space_skipping = s;
+}
+
 const volume_data::color_map_ptr&
 volume_data::color_map() const
 {
@@ -364,21 +391,22 @@ volume_data::load_volume(const gl::render_device_ptr& in_device,
           << time::to_seconds(timer.get_time()) << "s, "
           << (static_cast<double>(read_buffer_size) / (1024.0*1024.0)) / time::to_seconds(timer.get_time()) << "MiB/s)" << log::end;
 
+    out() << "determining value range and brick statistics..." << log::end;
+    timer.start();
+
+    gl::volume_statistics vstats;
+    bool                  vstats_valid = vstats.compute(data_dimensions, data_format, read_buffer.get(), 0, vec3ui(empty_space_brick_size));
+
+    timer.stop();
+    out() << "determining value range and brick statistics done"
+          << " (elapsed time: " << std::fixed << std::setprecision(3)
+          << time::to_seconds(timer.get_time()) << "s)" << log::end;
+
     _min_value = 0.0f;
     _max_value = 1.0f;
-    if (is_float_type(data_format)) {
-        out() << "determining floating point value range..." << log::end;
-        timer.start();
-
-        float* fp_data = reinterpret_cast<float*>(read_buffer.get());
-        size_t dcount  = static_cast<scm::size_t>(data_dimensions.x) * data_dimensions.y * data_dimensions.z * channel_count(data_format);
-        _min_value = boost::numeric::bounds<float>::highest();//(std::numeric_limits<float>::max)();
-        _max_value = boost::numeric::bounds<float>::lowest();//(std::numeric_limits<float>::min)();
-
-        for (size_t i = 0; i < dcount; ++i) {
-            _min_value = min(_min_value, fp_data[i]);
-            _max_value = max(_max_value, fp_data[i]);
-        }
+    if (is_float_type(data_format) && vstats_valid) {
+        _min_value = vstats.statistics()._min;
+        _max_value = vstats.statistics()._max;
 
         if (abs(_min_value) > abs(_max_value)) {
             _max_value = abs(_min_value);
@@ -386,15 +414,22 @@ volume_data::load_volume(const gl::render_device_ptr& in_device,
         else {
             _min_value = -abs(_max_value);
         }
-
-        timer.stop();
-        out() << "etermining floating point value range"
-              << " (elapsed time: " << std::fixed << std::setprecision(3)
-              << time::to_seconds(timer.get_time()) << "s)" << log::end;
-
     }
     out() << "min_value: " << _min_value << ", max_value: " << _max_value << log::end;
 
+    _empty_space_map.reset();
+    if (vstats_valid) {
+        try {
+            _empty_space_map = make_shared<gl::empty_space_map>(in_device, vstats, data_format, data_dimensions);
+            out() << "empty space map grid dimensions: " << _empty_space_map->grid_dimensions() << log::end;
+        }
+        catch (const std::exception& e) {
+            err() << log::warning
+                  << "volume_data::load_volume(): unable to create empty space map, "
+                  << "empty-space skipping disabled (" << e.what() << ")." << log::end;
+        }
+    }
+
     std::vector<uint8*> mip_data;
     std::vector<void*>  mip_init_data;
 
@@ -495,6 +530,16 @@ volume_data::update_color_alpha_map(const gl::render_context_ptr& context) const
               << "volume_data::update_color_alpha_map(): error during lookuptable generation" << log::end;
         return false;
     }
+    if (_empty_space_map) {
+        if (!_empty_space_map->classify(context, alpha_lut.get(), in_size, min_value(), max_value())) {
+            err() << log::warning
+                  << "volume_data::update_color_alpha_map(): error classifying empty space map" << log::end;
+        }
+        else {
+            out() << "empty space map: " << _empty_space_map->occupied_bricks() << " occupied bricks" << log::end;
+        }
+    }
+
     scm::scoped_array<float> combined_lut;
 
     combined_lut.reset(new float[in_size * 4]);
@@ -561,6 +606,20 @@ volume_data::update(const gl::render_context_ptr& context,
         _volume_block->_os_camera_position          = mv_matrix_inv.column(3) / mv_matrix_inv.column(3).w;
         _volume_block->_value_range                 = vec4f(min_value(), max_value(), max_value() - min_value(), 1.0f / (max_value() - min_value()));
 
+        if (_empty_space_map && _empty_space_skipping) {
+            _volume_block->_volume_dimensions       = vec4f(vec3f(_data_dimensions), 1.0f);
+            _volume_block->_brick_size              = vec4f(vec3f(_empty_space_map->brick_size()), 0.0f);
+            _volume_block->_os_occupied_min         = vec4f(_empty_space_map->occupied_min() * extends(),
+                                                            _empty_space_map->occupied_bricks() == 0 ? 1.0f : 0.0f);
+            _volume_block->_os_occupied_max         = vec4f(_empty_space_map->occupied_max() * extends(), 0.0f);
+        }
+        else {
+            _volume_block->_volume_dimensions       = vec4f(vec3f(_data_dimensions), 0.0f);
+            _volume_block->_brick_size              = vec4f(vec3f(_data_dimensions), 0.0f);
+            _volume_block->_os_occupied_min         = vec4f(0.0f);
+            _volume_block->_os_occupied_max         = vec4f(extends(), 0.0f);
+        }
+
         _volume_block->_m_matrix                     = transform();
         _volume_block->_m_matrix_inverse             = inverse(transform());
         _volume_block->_m_matrix_inverse_transpose   = transpose(_volume_block->_m_matrix_inverse);
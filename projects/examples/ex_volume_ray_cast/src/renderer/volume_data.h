@@ -17,6 +17,7 @@
 #include <scm/gl_core/constants.h>
 #include <scm/gl_core/primitives/box.h>
 
+#include <scm/gl_util/data/volume/empty_space_map.h>
 #include <scm/gl_util/primitives/primitives_fwd.h>
 #include <scm/gl_util/viewer/viewer_fwd.h>
 
@@ -42,6 +43,10 @@ public:
         math::vec4f _sampling_distance;  // yzw unused
         math::vec4f _os_camera_position;
         math::vec4f _value_range;
+        math::vec4f _volume_dimensions;  // w empty-space skipping enabled
+        math::vec4f _brick_size;         // w unused
+        math::vec4f _os_occupied_min;    // w all bricks empty
+        math::vec4f _os_occupied_max;    // w unused
 
         math::mat4f _m_matrix;
         math::mat4f _m_matrix_inverse;
@@ -95,6 +100,10 @@ public:
 
     const gl::texture_3d_ptr&           volume_raw() const;
     const gl::texture_1d_ptr&           color_alpha_map() const;
+    const gl::empty_space_map_ptr&      empty_space_map() const;
+
+    bool                                empty_space_skipping() const;
+    void                                empty_space_skipping(bool s);
 
     const color_map_ptr&                color_map() const;
     const alpha_map_ptr&                alpha_map() const;
@@ -137,6 +146,8 @@ protected:
     gl::texture_3d_ptr                  _volume_raw;
     gl::texture_1d_ptr                  _color_alpha_map;
     bool                                _color_alpha_map_dirty;
+    gl::empty_space_map_ptr             _empty_space_map;
+    bool                                _empty_space_skipping;
     gl::sampler_state_ptr               _sstate_linear;
 
 }; // volume_data
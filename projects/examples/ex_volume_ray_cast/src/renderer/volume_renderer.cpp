@@ -129,6 +129,9 @@ volume_renderer::draw(const gl::render_context_ptr& context,
 #else
     context->bind_texture(vdata->texture_handles(), _sstate_nearest, 4);
 #endif SCM_TEXT_NV_BINDLESS_TEXTURES != 1
+    if (vdata->empty_space_map()) {
+        context->bind_texture(vdata->empty_space_map()->occupancy_texture(), _sstate_nearest, 3);
+    }
 
     vdata->bbox_geometry()->draw(context, geometry::MODE_SOLID);
 }
@@ -173,6 +176,7 @@ volume_renderer::reload_shaders(const gl::render_device_ptr& device)
 
     _program->uniform_sampler("volume_raw",     0);
     _program->uniform_sampler("color_map",      2);
+    _program->uniform_sampler("empty_space_map", 3);
 
     _program->uniform_buffer("camera_matrices",     0);
     _program->uniform_buffer("volume_uniform_data", 1);
@@ -0,0 +1,273 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "file_read_ahead.h"
+
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <scm/core/math/math.h>
+
+namespace scm {
+namespace io {
+
+struct file_read_ahead::prefetch_state
+{
+    enum block_state {
+        BLOCK_EMPTY     = 0x00,
+        BLOCK_LOADING,
+        BLOCK_READY
+    };
+    struct block {
+        block() : _offset(0), _size(0), _state(BLOCK_EMPTY), _generation(0) {}
+        // hands the block back to the prefetch thread for a new offset, a load
+        // still in flight for the old offset is discarded through the generation
+        void recycle(offset_type offset) {
+            ++_generation;
+            _offset = offset;
+            _size   = 0;
+            _state  = BLOCK_EMPTY;
+        }
+        offset_type         _offset;
+        size_type           _size;
+        block_state         _state;
+        scm::uint32         _generation;
+        std::vector<char>   _data;
+    };
+
+    prefetch_state()
+      : _head(0)
+      , _window_start(0)
+      , _window_active(false)
+      , _sequential_end(0)
+      , _running(true)
+    {}
+
+    void reset_window(offset_type start, size_type block_size) {
+        _head           = 0;
+        _window_start   = start;
+        for (std::size_t b = 0; b < _blocks.size(); ++b) {
+            _blocks[b].recycle(start + static_cast<offset_type>(b) * block_size);
+        }
+    }
+    bool in_window(offset_type pos, size_type block_size) const {
+        return    _window_active
+               && pos >= _window_start
+               && pos <  _window_start + static_cast<offset_type>(_blocks.size()) * block_size;
+    }
+
+    std::vector<block>          _blocks;
+    int                         _head;
+    offset_type                 _window_start;
+    bool                        _window_active;
+    offset_type                 _sequential_end;
+    bool                        _running;
+
+    boost::mutex                _mutex;
+    boost::mutex                _io_mutex;
+    boost::condition_variable   _block_ready;
+    boost::condition_variable   _block_requested;
+
+    scoped_ptr<boost::thread>   _thread;
+}; // struct file_read_ahead::prefetch_state
+
+file_read_ahead::file_read_ahead(const file_ptr&     in_file,
+                                 size_type           block_size,
+                                 int                 block_count)
+  : _file(in_file)
+  , _block_size(math::max<size_type>(1, block_size))
+  , _block_count(math::max<int>(1, block_count))
+  , _state(new prefetch_state)
+{
+    assert(_file);
+
+    _state->_blocks.resize(_block_count);
+    for (int b = 0; b < _block_count; ++b) {
+        _state->_blocks[b]._data.resize(static_cast<std::size_t>(_block_size));
+    }
+
+    _state->_thread.reset(new boost::thread(boost::bind(&file_read_ahead::prefetch_thread_entry, this)));
+}
+
+file_read_ahead::~file_read_ahead()
+{
+    { // stop the prefetch thread
+        boost::mutex::scoped_lock lock(_state->_mutex);
+        _state->_running = false;
+    }
+    _state->_block_requested.notify_all();
+    _state->_thread->join();
+    _state->_thread.reset();
+}
+
+file_read_ahead::size_type
+file_read_ahead::read(void*           output_buffer,
+                      offset_type     start_position,
+                      size_type       num_bytes_to_read)
+{
+    typedef prefetch_state::block block;
+
+    if (num_bytes_to_read <= 0) {
+        return (0);
+    }
+
+    prefetch_state& s   = *_state;
+    char*           out = reinterpret_cast<char*>(output_buffer);
+    offset_type     pos = start_position;
+    size_type       br  = 0;
+
+    boost::mutex::scoped_lock lock(s._mutex);
+
+    if (!s.in_window(pos, _block_size)) {
+        if (pos == s._sequential_end) {
+            // sequential access detected, (re)start the prefetch window here
+            s.reset_window(pos, _block_size);
+            s._window_active = true;
+            s._block_requested.notify_one();
+        }
+        else {
+            // random access: drop all pending prefetches and read synchronously
+            s.reset_window(pos, _block_size);
+            s._window_active = false;
+            lock.unlock();
+
+            size_type r = 0;
+            {
+                boost::mutex::scoped_lock io_lock(s._io_mutex);
+                r = _file->read(out, pos, num_bytes_to_read);
+            }
+            r = math::max<size_type>(0, r);
+
+            lock.lock();
+            s._sequential_end = pos + r;
+            return (r);
+        }
+    }
+
+    const offset_type blk_size = static_cast<offset_type>(_block_size);
+
+    while (br < num_bytes_to_read) {
+        // recycle the blocks already consumed and hand them back to the prefetch thread
+        while (pos >= s._window_start + blk_size) {
+            s._blocks[s._head].recycle(s._window_start + static_cast<offset_type>(_block_count) * blk_size);
+
+            s._head          = (s._head + 1) % _block_count;
+            s._window_start += blk_size;
+            s._block_requested.notify_one();
+        }
+
+        block& b = s._blocks[s._head];
+        while (b._state != prefetch_state::BLOCK_READY) {
+            s._block_ready.wait(lock);
+        }
+
+        const offset_type block_offset = pos - s._window_start;
+        if (block_offset >= b._size) {
+            break; // end of file
+        }
+
+        const size_type c = math::min<size_type>(b._size - block_offset, num_bytes_to_read - br);
+        std::memcpy(out + br, &b._data[static_cast<std::size_t>(block_offset)], static_cast<std::size_t>(c));
+
+        br  += c;
+        pos += c;
+    }
+
+    s._sequential_end = pos;
+
+    return (br);
+}
+
+void
+file_read_ahead::seek(offset_type new_position)
+{
+    boost::mutex::scoped_lock lock(_state->_mutex);
+
+    if (   _state->_window_active
+        && !_state->in_window(new_position, _block_size)) {
+        _state->reset_window(new_position, _block_size);
+        _state->_window_active = false;
+    }
+}
+
+void
+file_read_ahead::cancel()
+{
+    boost::mutex::scoped_lock lock(_state->_mutex);
+
+    _state->reset_window(_state->_sequential_end, _block_size);
+    _state->_window_active = false;
+}
+
+file_read_ahead::size_type
+file_read_ahead::block_size() const
+{
+    return (_block_size);
+}
+
+int
+file_read_ahead::block_count() const
+{
+    return (_block_count);
+}
+
+void
+file_read_ahead::prefetch_thread_entry()
+{
+    typedef prefetch_state::block block;
+
+    prefetch_state&     s         = *_state;
+    const offset_type   file_size = _file->size();
+
+    boost::mutex::scoped_lock lock(s._mutex);
+
+    while (s._running) {
+        // find the next empty block in window order
+        block* next_block = 0;
+        if (s._window_active) {
+            for (int b = 0; b < _block_count && !next_block; ++b) {
+                block& cb = s._blocks[(s._head + b) % _block_count];
+                if (cb._state == prefetch_state::BLOCK_EMPTY) {
+                    next_block = &cb;
+                }
+            }
+        }
+        if (!next_block) {
+            s._block_requested.wait(lock);
+            continue;
+        }
+
+        const scm::uint32   generation  = next_block->_generation;
+        const offset_type   offset      = next_block->_offset;
+        size_type           r           = 0;
+
+        next_block->_state = prefetch_state::BLOCK_LOADING;
+
+        if (offset < file_size) {
+            lock.unlock();
+            {
+                boost::mutex::scoped_lock io_lock(s._io_mutex);
+                r = _file->read(&next_block->_data[0], offset, _block_size);
+            }
+            lock.lock();
+        }
+
+        // the block was recycled (seek, cancel or consumed window) while reading,
+        // the result is stale and the block was already handed back as empty
+        if (generation == next_block->_generation) {
+            next_block->_size  = math::max<size_type>(0, r);
+            next_block->_state = prefetch_state::BLOCK_READY;
+            s._block_ready.notify_all();
+        }
+    }
+}
+
+} // namespace io
+} // namespace scm
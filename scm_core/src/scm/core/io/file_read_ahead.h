@@ -0,0 +1,72 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_CORE_IO_FILE_READ_AHEAD_H_INCLUDED
+#define SCM_CORE_IO_FILE_READ_AHEAD_H_INCLUDED
+
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/core/io/io_fwd.h>
+#include <scm/core/io/file.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace io {
+
+// read-ahead cache for sequential read access to a file
+//  - a background thread keeps a window of block_count blocks of block_size
+//    bytes ahead of the current sequential read position in flight
+//  - reads outside of the current window cancel all pending prefetches,
+//    the window is restarted once a sequential access pattern is detected
+//  - all file accesses (including the synchronous non-sequential reads) are
+//    serialized internally, the file object must not be used concurrently
+//    from outside while the read-ahead is active
+class __scm_export(core) file_read_ahead : boost::noncopyable
+{
+public:
+    typedef file::size_type     size_type;
+    typedef file::offset_type   offset_type;
+
+public:
+    file_read_ahead(const file_ptr&     in_file,
+                    size_type           block_size,
+                    int                 block_count);
+    virtual ~file_read_ahead();
+
+    size_type                   read(void*           output_buffer,
+                                     offset_type     start_position,
+                                     size_type       num_bytes_to_read);
+
+    // cancels pending prefetches if new_position lies outside the current window
+    void                        seek(offset_type     new_position);
+    void                        cancel();
+
+    size_type                   block_size() const;
+    int                         block_count() const;
+
+private:
+    struct prefetch_state;
+
+    void                        prefetch_thread_entry();
+
+private:
+    file_ptr                    _file;
+    size_type                   _block_size;
+    int                         _block_count;
+
+    shared_ptr<prefetch_state>  _state;
+
+}; // class file_read_ahead
+
+} // namespace io
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_CORE_IO_FILE_READ_AHEAD_H_INCLUDED
@@ -14,6 +14,7 @@
 
 #include <scm/core/numeric_types.h>
 #include <scm/core/io/file.h>
+#include <scm/core/io/file_read_ahead.h>
 
 namespace scm {
 namespace io {
@@ -54,9 +55,15 @@ public:
     void                    close();
     std::streamsize         optimal_buffer_size() const;
 
+protected:
+    // read-ahead of read_ahead_blocks blocks of optimal_buffer_size() bytes,
+    // only sensible for read-only devices (0 disables the read-ahead)
+    void                    enable_read_ahead(scm::uint32 read_ahead_blocks);
+
 private:
-    boost::shared_ptr<file>     _impl;
-    file::offset_type           _position;
+    boost::shared_ptr<file>             _impl;
+    file::offset_type                   _position;
+    boost::shared_ptr<file_read_ahead>  _read_ahead;
 
 }; // class large_file
 
@@ -82,13 +89,15 @@ public:
                       std::ios_base::openmode  open_mode                            = std::ios_base::in,
                       bool                     disable_system_cache                 = true,
                       scm::uint32              read_write_buffer_size               = detail::default_io_block_size,
-                      scm::uint32              read_write_asynchronous_requests     = detail::default_asynchronous_requests)
+                      scm::uint32              read_write_asynchronous_requests     = detail::default_asynchronous_requests,
+                      scm::uint32              read_ahead_blocks                    = 0)
         : large_file<char_t>(file_path,
                              open_mode & ~std::ios_base::out,
                              disable_system_cache,
                              read_write_buffer_size,
                              read_write_asynchronous_requests)
     {
+        large_file<char_t>::enable_read_ahead(read_ahead_blocks);
     }
     large_file_source(const large_file_source& rhs)
         : large_file<char_t>(rhs)
@@ -98,13 +107,15 @@ public:
                                  std::ios_base::openmode  open_mode                            = std::ios_base::in,
                                  bool                     disable_system_cache                 = true,
                                  scm::uint32              read_write_buffer_size               = detail::default_io_block_size,
-                                 scm::uint32              read_write_asynchronous_requests     = detail::default_asynchronous_requests)
+                                 scm::uint32              read_write_asynchronous_requests     = detail::default_asynchronous_requests,
+                                 scm::uint32              read_ahead_blocks                    = 0)
     {
         large_file<char_t>::open(file_path,
                                  open_mode & ~std::ios_base::out,
                                  disable_system_cache,
                                  read_write_buffer_size,
                                  read_write_asynchronous_requests);
+        large_file<char_t>::enable_read_ahead(read_ahead_blocks);
     }
 
 }; // class large_file_source
@@ -29,13 +29,23 @@ large_file<char_t>::large_file(const std::string&       file_path,
 
 template <typename char_t>
 large_file<char_t>::large_file(const large_file<char_t>& rhs)
+  : _position(rhs._position)
 {
     _impl.reset(new file(*rhs._impl.get()));
+
+    // the read-ahead is bound to its file, the copy gets its own on the copied file
+    if (rhs._read_ahead && is_open()) {
+        _read_ahead.reset(new file_read_ahead(_impl,
+                                              rhs._read_ahead->block_size(),
+                                              rhs._read_ahead->block_count()));
+        _read_ahead->seek(_position);
+    }
 }
 
 template <typename char_t>
 large_file<char_t>::~large_file()
 {
+    _read_ahead.reset();
     _impl.reset();
 }
 
@@ -44,7 +54,18 @@ std::streamsize
 large_file<char_t>::read(char_type* s, std::streamsize n)
 {
     file::char_type* char_buf = reinterpret_cast<file::char_type*>(s);
-    file::size_type r = _impl->read(char_buf, _position, n);
+    file::size_type r = 0;
+
+    if (_read_ahead) {
+        r = _read_ahead->read(char_buf, _position, n);
+    }
+    else {
+        r = _impl->read(char_buf, _position, n);
+    }
+
+    if (r <= 0) {
+        return -1; // eof
+    }
     _position += r;
 
     return r;
@@ -66,7 +87,19 @@ std::streampos
 large_file<char_t>::seek(boost::iostreams::stream_offset    off,
                          std::ios_base::seek_dir            way)
 {
-    _position = _impl->seek(off, way);
+    if (_read_ahead) {
+        // the prefetch thread moves the file position, so track it here
+        switch (way) {
+            case std::ios_base::beg: _position = off;                break;
+            case std::ios_base::cur: _position = _position + off;    break;
+            case std::ios_base::end: _position = _impl->size() + off; break;
+            default: break;
+        }
+        _read_ahead->seek(_position);
+    }
+    else {
+        _position = _impl->seek(off, way);
+    }
     return _position;
 }
 
@@ -78,6 +111,8 @@ large_file<char_t>::open(const std::string&         file_path,
                          scm::uint32                read_write_buffer_size,
                          scm::uint32                read_write_asynchronous_requests)
 {
+    _read_ahead.reset();
+
     if (!_impl->open(file_path, open_mode, disable_system_cache, read_write_buffer_size, read_write_asynchronous_requests)) {
         throw std::ios_base::failure("large_file<char_type>::open(): error opening file");
     }
@@ -95,6 +130,7 @@ template <typename char_t>
 void
 large_file<char_t>::close()
 {
+    _read_ahead.reset();
     _impl->close();
 }
 
@@ -105,5 +141,18 @@ large_file<char_t>::optimal_buffer_size() const
     return (_impl->optimal_buffer_size());
 }
 
+template <typename char_t>
+void
+large_file<char_t>::enable_read_ahead(scm::uint32 read_ahead_blocks)
+{
+    _read_ahead.reset();
+
+    if (read_ahead_blocks > 0 && is_open()) {
+        _read_ahead.reset(new file_read_ahead(_impl,
+                                              _impl->optimal_buffer_size(),
+                                              static_cast<int>(read_ahead_blocks)));
+    }
+}
+
 } // namespace io
 } // namespace scm
@@ -98,8 +98,8 @@ inline scal_type shoothstep(const scal_type min,
                             const scal_type max,
                             const scal_type x)
 {
-    scal_type s = clamp((x - min) / (max-min), 0.0f, 1.0f);
-    s = (s*s*(3.0f-2.0f*s));
+    scal_type s = clamp((x - min) / (max-min), scal_type(0), scal_type(1));
+    s = (s*s*(scal_type(3)-scal_type(2)*s));
 
     return (s);
 }
@@ -132,8 +132,8 @@ inline unsigned bit_count(int_type x)
     assert(    std::numeric_limits<int_type>::is_integer
            &&  sizeof(int_type) == 4);
 
-    int& i = *static_cast<int*>(&x);
-    unsigned count;
+    scm::uint32 i = static_cast<scm::uint32>(x);
+    unsigned    count;
 
     count =     i
             - ((i >> 1) & 033333333333)
@@ -148,11 +148,9 @@ inline unsigned first_zero_bit(int_type x)
     assert(    std::numeric_limits<int_type>::is_integer
            &&  sizeof(int_type) == 4);
 
-    int& i = *static_cast<int*>(&x);
+    scm::uint32 i = ~static_cast<scm::uint32>(x);
 
-    i = ~i;
-
-    return bit_count((i & (-i)) - 1);
+    return bit_count((i & (0u - i)) - 1u);
 }
 
 inline
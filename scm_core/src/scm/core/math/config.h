@@ -12,4 +12,12 @@
 
 #define SCM_CORE_MATH_FP_PRECISION  SCM_CORE_MATH_FP_PRECISION_SINGLE
 
+// sse code paths for the single precision 4x4 matrix, vector and quaternion types
+//  - enabled if the compiler targets sse2, define SCM_CORE_MATH_NO_SIMD to disable
+#if !defined(SCM_CORE_MATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#   define SCM_CORE_MATH_SIMD_SSE   1
+#else
+#   define SCM_CORE_MATH_SIMD_SSE   0
+#endif
+
 #endif // SCM_CORE_MATH_CONFIG_H_INCLUDED
@@ -90,6 +90,9 @@ public:
 
 }; // class mat<scal_type, 4, 4>
 
+// closed form versions of the generic cofactor expansions
+template<typename scal_type> scal_type                      determinant(const mat<scal_type, 4, 4>& lhs);
+template<typename scal_type> const mat<scal_type, 4, 4>     inverse(const mat<scal_type, 4, 4>& lhs);
 
 } // namespace math
 } // namespace scm
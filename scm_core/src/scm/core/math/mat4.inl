@@ -155,5 +155,85 @@ inline vec<scal_type, 4> mat<scal_type, 4, 4>::row(const int i) const
                               data_array[i + 12]));
 }
 
+template<typename scal_type>
+inline
+scal_type
+determinant(const mat<scal_type, 4, 4>& lhs)
+{
+    const scal_type* m = lhs.data_array;
+
+    // 2x2 sub-determinants of the upper and lower two rows
+    const scal_type s0 = m[0] * m[5]  - m[4] * m[1];
+    const scal_type s1 = m[0] * m[6]  - m[4] * m[2];
+    const scal_type s2 = m[0] * m[7]  - m[4] * m[3];
+    const scal_type s3 = m[1] * m[6]  - m[5] * m[2];
+    const scal_type s4 = m[1] * m[7]  - m[5] * m[3];
+    const scal_type s5 = m[2] * m[7]  - m[6] * m[3];
+
+    const scal_type c5 = m[10] * m[15] - m[14] * m[11];
+    const scal_type c4 = m[9]  * m[15] - m[13] * m[11];
+    const scal_type c3 = m[9]  * m[14] - m[13] * m[10];
+    const scal_type c2 = m[8]  * m[15] - m[12] * m[11];
+    const scal_type c1 = m[8]  * m[14] - m[12] * m[10];
+    const scal_type c0 = m[8]  * m[13] - m[12] * m[9];
+
+    return (s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0);
+}
+
+template<typename scal_type>
+inline
+const mat<scal_type, 4, 4>
+inverse(const mat<scal_type, 4, 4>& lhs)
+{
+    const scal_type* m = lhs.data_array;
+
+    const scal_type s0 = m[0] * m[5]  - m[4] * m[1];
+    const scal_type s1 = m[0] * m[6]  - m[4] * m[2];
+    const scal_type s2 = m[0] * m[7]  - m[4] * m[3];
+    const scal_type s3 = m[1] * m[6]  - m[5] * m[2];
+    const scal_type s4 = m[1] * m[7]  - m[5] * m[3];
+    const scal_type s5 = m[2] * m[7]  - m[6] * m[3];
+
+    const scal_type c5 = m[10] * m[15] - m[14] * m[11];
+    const scal_type c4 = m[9]  * m[15] - m[13] * m[11];
+    const scal_type c3 = m[9]  * m[14] - m[13] * m[10];
+    const scal_type c2 = m[8]  * m[15] - m[12] * m[11];
+    const scal_type c1 = m[8]  * m[14] - m[12] * m[10];
+    const scal_type c0 = m[8]  * m[13] - m[12] * m[9];
+
+    const scal_type det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+
+    // ATTENTION!!!! float equal test (same as the generic version)
+    if (det == scal_type(0)) {
+        return (mat<scal_type, 4, 4>::zero());
+    }
+
+    const scal_type inv_det = scal_type(1) / det;
+
+    mat<scal_type, 4, 4> r;
+
+    r.data_array[0]  = ( m[5]  * c5 - m[6]  * c4 + m[7]  * c3) * inv_det;
+    r.data_array[4]  = (-m[4]  * c5 + m[6]  * c2 - m[7]  * c1) * inv_det;
+    r.data_array[8]  = ( m[4]  * c4 - m[5]  * c2 + m[7]  * c0) * inv_det;
+    r.data_array[12] = (-m[4]  * c3 + m[5]  * c1 - m[6]  * c0) * inv_det;
+
+    r.data_array[1]  = (-m[1]  * c5 + m[2]  * c4 - m[3]  * c3) * inv_det;
+    r.data_array[5]  = ( m[0]  * c5 - m[2]  * c2 + m[3]  * c1) * inv_det;
+    r.data_array[9]  = (-m[0]  * c4 + m[1]  * c2 - m[3]  * c0) * inv_det;
+    r.data_array[13] = ( m[0]  * c3 - m[1]  * c1 + m[2]  * c0) * inv_det;
+
+    r.data_array[2]  = ( m[13] * s5 - m[14] * s4 + m[15] * s3) * inv_det;
+    r.data_array[6]  = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * inv_det;
+    r.data_array[10] = ( m[12] * s4 - m[13] * s2 + m[15] * s0) * inv_det;
+    r.data_array[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * inv_det;
+
+    r.data_array[3]  = (-m[9]  * s5 + m[10] * s4 - m[11] * s3) * inv_det;
+    r.data_array[7]  = ( m[8]  * s5 - m[10] * s2 + m[11] * s1) * inv_det;
+    r.data_array[11] = (-m[8]  * s4 + m[9]  * s2 - m[11] * s0) * inv_det;
+    r.data_array[15] = ( m[8]  * s3 - m[9]  * s1 + m[10] * s0) * inv_det;
+
+    return (r);
+}
+
 } // namespace math
 } // namespace scm
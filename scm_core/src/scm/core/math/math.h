@@ -23,6 +23,8 @@
 
 #include <scm/core/math/quat.h>
 
+#include <scm/core/math/simd.h>
+
 #include <scm/core/math/vec_stream_io.h>
 #include <scm/core/math/mat_stream_io.h>
 #include <scm/core/math/quat_stream_io.h>
@@ -0,0 +1,140 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_CORE_MATH_SIMD_H_INCLUDED
+#define SCM_CORE_MATH_SIMD_H_INCLUDED
+
+#include <cstddef>
+
+#include <scm/core/platform/platform.h>
+
+#include <scm/core/math/config.h>
+#include <scm/core/math/vec3.h>
+#include <scm/core/math/vec4.h>
+#include <scm/core/math/mat4.h>
+#include <scm/core/math/quat.h>
+
+#if SCM_CORE_MATH_SIMD_SSE
+#   include <xmmintrin.h>
+#   include <emmintrin.h>
+#endif
+
+namespace scm {
+namespace math {
+
+// 16 byte aligned single precision types for the sse code paths
+//  - convert from and to the generic vec4f, mat4f (column major) and quatf
+//    types with a single (unaligned) load or store per column
+//  - without SCM_CORE_MATH_SIMD_SSE all operations fall back to the generic
+//    scalar implementations
+class vec4f_simd
+{
+public:
+    vec4f_simd();
+    explicit vec4f_simd(const float s);
+    vec4f_simd(const float x, const float y, const float z, const float w);
+    explicit vec4f_simd(const vec<float, 4>& v);
+#if SCM_CORE_MATH_SIMD_SSE
+    explicit vec4f_simd(const __m128 v);
+#endif
+
+    const vec<float, 4>             to_vec4f() const;
+
+    float                           operator[](const int i) const;
+
+    union {
+#if SCM_CORE_MATH_SIMD_SSE
+        __m128                      simd_data;
+#endif
+        scm_align(16) float         data_array[4];
+    };
+}; // class vec4f_simd
+
+class mat4f_simd
+{
+public:
+    mat4f_simd();
+    explicit mat4f_simd(const mat<float, 4, 4>& m);
+
+    static const mat4f_simd         identity();
+
+    const mat<float, 4, 4>          to_mat4f() const;
+    void                            store(mat<float, 4, 4>& m) const;
+
+    // columns
+    union {
+#if SCM_CORE_MATH_SIMD_SSE
+        __m128                      simd_data[4];
+#endif
+        scm_align(16) float         data_array[16];
+    };
+}; // class mat4f_simd
+
+class quatf_simd
+{
+public:
+    quatf_simd();
+    explicit quatf_simd(const quat<float>& q);
+#if SCM_CORE_MATH_SIMD_SSE
+    explicit quatf_simd(const __m128 v);
+#endif
+
+    const quat<float>               to_quatf() const;
+    const mat4f_simd                to_matrix() const;
+
+    // x, y, z, w (imaginary parts first, unlike quat)
+    union {
+#if SCM_CORE_MATH_SIMD_SSE
+        __m128                      simd_data;
+#endif
+        scm_align(16) float         data_array[4];
+    };
+}; // class quatf_simd
+
+// vec4f_simd
+const vec4f_simd    operator+(const vec4f_simd& lhs, const vec4f_simd& rhs);
+const vec4f_simd    operator-(const vec4f_simd& lhs, const vec4f_simd& rhs);
+const vec4f_simd    operator*(const vec4f_simd& lhs, const vec4f_simd& rhs);
+const vec4f_simd    operator*(const vec4f_simd& lhs, const float rhs);
+float               dot(const vec4f_simd& lhs, const vec4f_simd& rhs);
+float               length(const vec4f_simd& lhs);
+const vec4f_simd    normalize(const vec4f_simd& lhs);
+
+// mat4f_simd, results identical to the generic mat4f operators
+const mat4f_simd    operator*(const mat4f_simd& lhs, const mat4f_simd& rhs);
+const vec4f_simd    operator*(const mat4f_simd& lhs, const vec4f_simd& rhs);
+const mat4f_simd    transpose(const mat4f_simd& lhs);
+// block wise 2x2 adjugate inverse, zero matrix for singular input
+const mat4f_simd    inverse(const mat4f_simd& lhs);
+
+// quatf_simd
+const quatf_simd    operator*(const quatf_simd& lhs, const quatf_simd& rhs);
+const quatf_simd    normalize(const quatf_simd& lhs);
+const quatf_simd    slerp(const quatf_simd& a, const quatf_simd& b, const float u);
+
+// batched transformations for arrays of points and matrices
+//  - points are transformed with w = 1 without perspective division like mat4f * vec3f
+//  - in and out may point to the same array
+void                transform_points(const mat<float, 4, 4>& m, const vec<float, 3>* in_points, vec<float, 3>* out_points, const std::size_t count);
+void                transform_points(const mat<float, 4, 4>& m, const vec<float, 4>* in_points, vec<float, 4>* out_points, const std::size_t count);
+// out_matrices[i] = m * in_matrices[i], e.g. parent to child world transforms
+void                transform_matrices(const mat<float, 4, 4>& m, const mat<float, 4, 4>* in_matrices, mat<float, 4, 4>* out_matrices, const std::size_t count);
+
+#if SCM_CORE_MATH_SIMD_SSE
+// sse overloads of the generic mat4f operators, these are picked over the
+// generic templates for single precision 4x4 matrices
+const mat<float, 4, 4>          operator*(const mat<float, 4, 4>& lhs, const mat<float, 4, 4>& rhs);
+mat<float, 4, 4>&               operator*=(mat<float, 4, 4>& lhs, const mat<float, 4, 4>& rhs);
+const vec<float, 4>             operator*(const mat<float, 4, 4>& lhs, const vec<float, 4>& rhs);
+const vec<float, 4>             operator*(const mat<float, 4, 4>& lhs, const vec<float, 3>& rhs); // w = 0 like the generic version
+const mat<float, 4, 4>          transpose(const mat<float, 4, 4>& lhs);
+const mat<float, 4, 4>          inverse(const mat<float, 4, 4>& lhs);
+#endif // SCM_CORE_MATH_SIMD_SSE
+
+} // namespace math
+} // namespace scm
+
+#include "simd.inl"
+
+#endif // SCM_CORE_MATH_SIMD_H_INCLUDED
@@ -0,0 +1,682 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include <scm/core/math/common.h>
+
+#if SCM_CORE_MATH_SIMD_SSE
+
+#define SCM_MATH_SSE_SHUFFLE_MASK(x, y, z, w)   ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+#define SCM_MATH_SSE_SWIZZLE(v, x, y, z, w)     _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), SCM_MATH_SSE_SHUFFLE_MASK(x, y, z, w)))
+#define SCM_MATH_SSE_SHUFFLE(a, b, x, y, z, w)  _mm_shuffle_ps(a, b, SCM_MATH_SSE_SHUFFLE_MASK(x, y, z, w))
+
+namespace scm {
+namespace math {
+namespace detail {
+
+inline
+__m128
+sse_dot4(const __m128 a, const __m128 b)
+{
+    __m128 m = _mm_mul_ps(a, b);
+    m = _mm_add_ps(m, SCM_MATH_SSE_SWIZZLE(m, 1, 0, 3, 2));
+    m = _mm_add_ps(m, SCM_MATH_SSE_SWIZZLE(m, 2, 3, 0, 1));
+    return m; // dot product in all lanes
+}
+
+// m * v for column major m, same evaluation order as the generic operator
+inline
+__m128
+sse_mat_vec(const __m128 m[4], const __m128 v)
+{
+    __m128 r = _mm_mul_ps(m[0], SCM_MATH_SSE_SWIZZLE(v, 0, 0, 0, 0));
+    r = _mm_add_ps(r, _mm_mul_ps(m[1], SCM_MATH_SSE_SWIZZLE(v, 1, 1, 1, 1)));
+    r = _mm_add_ps(r, _mm_mul_ps(m[2], SCM_MATH_SSE_SWIZZLE(v, 2, 2, 2, 2)));
+    r = _mm_add_ps(r, _mm_mul_ps(m[3], SCM_MATH_SSE_SWIZZLE(v, 3, 3, 3, 3)));
+    return r;
+}
+
+// m * (x, y, z, 1)
+inline
+__m128
+sse_mat_point(const __m128 m[4], const float x, const float y, const float z)
+{
+    __m128 r = _mm_mul_ps(m[0], _mm_set1_ps(x));
+    r = _mm_add_ps(r, _mm_mul_ps(m[1], _mm_set1_ps(y)));
+    r = _mm_add_ps(r, _mm_mul_ps(m[2], _mm_set1_ps(z)));
+    r = _mm_add_ps(r, m[3]);
+    return r;
+}
+
+inline
+void
+sse_mat_mul(const __m128 lhs[4], const __m128 rhs[4], __m128 out[4])
+{
+    const __m128 c0 = sse_mat_vec(lhs, rhs[0]);
+    const __m128 c1 = sse_mat_vec(lhs, rhs[1]);
+    const __m128 c2 = sse_mat_vec(lhs, rhs[2]);
+    const __m128 c3 = sse_mat_vec(lhs, rhs[3]);
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+inline
+void
+sse_load(const mat<float, 4, 4>& m, __m128 out[4])
+{
+    out[0] = _mm_loadu_ps(m.data_array);
+    out[1] = _mm_loadu_ps(m.data_array + 4);
+    out[2] = _mm_loadu_ps(m.data_array + 8);
+    out[3] = _mm_loadu_ps(m.data_array + 12);
+}
+
+inline
+void
+sse_store(const __m128 m[4], mat<float, 4, 4>& out)
+{
+    _mm_storeu_ps(out.data_array,      m[0]);
+    _mm_storeu_ps(out.data_array + 4,  m[1]);
+    _mm_storeu_ps(out.data_array + 8,  m[2]);
+    _mm_storeu_ps(out.data_array + 12, m[3]);
+}
+
+// 2x2 block matrix helpers for the inverse, a 2x2 block (a, b, c, d) is held
+// in one register as (a00, a01, a10, a11)
+inline
+__m128
+sse_mat2_mul(const __m128 a, const __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, SCM_MATH_SSE_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(SCM_MATH_SSE_SWIZZLE(a, 1, 0, 3, 2), SCM_MATH_SSE_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adj(a) * b
+inline
+__m128
+sse_mat2_adj_mul(const __m128 a, const __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(SCM_MATH_SSE_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(SCM_MATH_SSE_SWIZZLE(a, 1, 1, 2, 2), SCM_MATH_SSE_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// a * adj(b)
+inline
+__m128
+sse_mat2_mul_adj(const __m128 a, const __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, SCM_MATH_SSE_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(SCM_MATH_SSE_SWIZZLE(a, 1, 0, 3, 2), SCM_MATH_SSE_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// inverse through the 2x2 block adjugates, works on rows or columns alike
+// since inverse(transpose(m)) == transpose(inverse(m)), returns false for singular matrices
+inline
+bool
+sse_inverse(const __m128 m[4], __m128 out[4])
+{
+    const __m128 a = _mm_movelh_ps(m[0], m[1]);
+    const __m128 b = _mm_movehl_ps(m[1], m[0]);
+    const __m128 c = _mm_movelh_ps(m[2], m[3]);
+    const __m128 d = _mm_movehl_ps(m[3], m[2]);
+
+    // (|a|, |b|, |c|, |d|)
+    const __m128 det_sub = _mm_sub_ps(_mm_mul_ps(SCM_MATH_SSE_SHUFFLE(m[0], m[2], 0, 2, 0, 2), SCM_MATH_SSE_SHUFFLE(m[1], m[3], 1, 3, 1, 3)),
+                                      _mm_mul_ps(SCM_MATH_SSE_SHUFFLE(m[0], m[2], 1, 3, 1, 3), SCM_MATH_SSE_SHUFFLE(m[1], m[3], 0, 2, 0, 2)));
+    const __m128 det_a = SCM_MATH_SSE_SWIZZLE(det_sub, 0, 0, 0, 0);
+    const __m128 det_b = SCM_MATH_SSE_SWIZZLE(det_sub, 1, 1, 1, 1);
+    const __m128 det_c = SCM_MATH_SSE_SWIZZLE(det_sub, 2, 2, 2, 2);
+    const __m128 det_d = SCM_MATH_SSE_SWIZZLE(det_sub, 3, 3, 3, 3);
+
+    const __m128 d_c = sse_mat2_adj_mul(d, c);
+    const __m128 a_b = sse_mat2_adj_mul(a, b);
+
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), sse_mat2_mul(b, d_c));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), sse_mat2_mul(c, a_b));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), sse_mat2_mul_adj(d, a_b));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), sse_mat2_mul_adj(a, d_c));
+
+    // |m| = |a||d| + |b||c| - tr(adj(a)b adj(d)c)
+    __m128 tr = _mm_mul_ps(a_b, SCM_MATH_SSE_SWIZZLE(d_c, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, SCM_MATH_SSE_SWIZZLE(tr, 1, 0, 3, 2));
+    tr = _mm_add_ps(tr, SCM_MATH_SSE_SWIZZLE(tr, 2, 3, 0, 1));
+
+    const __m128 det_m = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), tr);
+
+    if (_mm_cvtss_f32(det_m) == 0.0f) {
+        return false;
+    }
+
+    const __m128 rcp_det = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+
+    x = _mm_mul_ps(x, rcp_det);
+    y = _mm_mul_ps(y, rcp_det);
+    z = _mm_mul_ps(z, rcp_det);
+    w = _mm_mul_ps(w, rcp_det);
+
+    // adjugate shuffle combined with the block reassembly
+    out[0] = SCM_MATH_SSE_SHUFFLE(x, y, 3, 1, 3, 1);
+    out[1] = SCM_MATH_SSE_SHUFFLE(x, y, 2, 0, 2, 0);
+    out[2] = SCM_MATH_SSE_SHUFFLE(z, w, 3, 1, 3, 1);
+    out[3] = SCM_MATH_SSE_SHUFFLE(z, w, 2, 0, 2, 0);
+
+    return true;
+}
+
+inline
+__m128
+sse_quat_mul(const __m128 l, const __m128 r)
+{
+    // x = lw rx + lx rw + ly rz - lz ry
+    // y = lw ry + ly rw + lz rx - lx rz
+    // z = lw rz + lz rw + lx ry - ly rx
+    // w = lw rw - lx rx - ly ry - lz rz
+    const __m128 sign_w = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, static_cast<int>(0x80000000u)));
+
+    const __m128 t0 = _mm_mul_ps(SCM_MATH_SSE_SWIZZLE(l, 3, 3, 3, 3), r);
+    const __m128 t1 = _mm_mul_ps(SCM_MATH_SSE_SWIZZLE(l, 0, 1, 2, 0), SCM_MATH_SSE_SWIZZLE(r, 3, 3, 3, 0));
+    const __m128 t2 = _mm_mul_ps(SCM_MATH_SSE_SWIZZLE(l, 1, 2, 0, 1), SCM_MATH_SSE_SWIZZLE(r, 2, 0, 1, 1));
+    const __m128 t3 = _mm_mul_ps(SCM_MATH_SSE_SWIZZLE(l, 2, 0, 1, 2), SCM_MATH_SSE_SWIZZLE(r, 1, 2, 0, 2));
+
+    return _mm_sub_ps(_mm_add_ps(_mm_add_ps(t0, _mm_xor_ps(t1, sign_w)), _mm_xor_ps(t2, sign_w)), t3);
+}
+
+} // namespace detail
+} // namespace math
+} // namespace scm
+
+#endif // SCM_CORE_MATH_SIMD_SSE
+
+namespace scm {
+namespace math {
+
+// vec4f_simd /////////////////////////////////////////////////////////////////////////////////////
+inline
+vec4f_simd::vec4f_simd()
+{
+}
+
+inline
+vec4f_simd::vec4f_simd(const float s)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    simd_data = _mm_set1_ps(s);
+#else
+    data_array[0] = data_array[1] = data_array[2] = data_array[3] = s;
+#endif
+}
+
+inline
+vec4f_simd::vec4f_simd(const float x, const float y, const float z, const float w)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    simd_data = _mm_setr_ps(x, y, z, w);
+#else
+    data_array[0] = x;
+    data_array[1] = y;
+    data_array[2] = z;
+    data_array[3] = w;
+#endif
+}
+
+inline
+vec4f_simd::vec4f_simd(const vec<float, 4>& v)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    simd_data = _mm_loadu_ps(v.data_array);
+#else
+    for (unsigned i = 0; i < 4; ++i) {
+        data_array[i] = v.data_array[i];
+    }
+#endif
+}
+
+#if SCM_CORE_MATH_SIMD_SSE
+inline
+vec4f_simd::vec4f_simd(const __m128 v)
+  : simd_data(v)
+{
+}
+#endif
+
+inline
+const vec<float, 4>
+vec4f_simd::to_vec4f() const
+{
+    return vec<float, 4>(data_array[0], data_array[1], data_array[2], data_array[3]);
+}
+
+inline
+float
+vec4f_simd::operator[](const int i) const
+{
+    return data_array[i];
+}
+
+inline
+const vec4f_simd
+operator+(const vec4f_simd& lhs, const vec4f_simd& rhs)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    return vec4f_simd(_mm_add_ps(lhs.simd_data, rhs.simd_data));
+#else
+    return vec4f_simd(lhs[0] + rhs[0], lhs[1] + rhs[1], lhs[2] + rhs[2], lhs[3] + rhs[3]);
+#endif
+}
+
+inline
+const vec4f_simd
+operator-(const vec4f_simd& lhs, const vec4f_simd& rhs)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    return vec4f_simd(_mm_sub_ps(lhs.simd_data, rhs.simd_data));
+#else
+    return vec4f_simd(lhs[0] - rhs[0], lhs[1] - rhs[1], lhs[2] - rhs[2], lhs[3] - rhs[3]);
+#endif
+}
+
+inline
+const vec4f_simd
+operator*(const vec4f_simd& lhs, const vec4f_simd& rhs)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    return vec4f_simd(_mm_mul_ps(lhs.simd_data, rhs.simd_data));
+#else
+    return vec4f_simd(lhs[0] * rhs[0], lhs[1] * rhs[1], lhs[2] * rhs[2], lhs[3] * rhs[3]);
+#endif
+}
+
+inline
+const vec4f_simd
+operator*(const vec4f_simd& lhs, const float rhs)
+{
+    return lhs * vec4f_simd(rhs);
+}
+
+inline
+float
+dot(const vec4f_simd& lhs, const vec4f_simd& rhs)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    return _mm_cvtss_f32(detail::sse_dot4(lhs.simd_data, rhs.simd_data));
+#else
+    return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2] + lhs[3] * rhs[3];
+#endif
+}
+
+inline
+float
+length(const vec4f_simd& lhs)
+{
+    return sqrt(dot(lhs, lhs));
+}
+
+inline
+const vec4f_simd
+normalize(const vec4f_simd& lhs)
+{
+    const float l = length(lhs);
+    return l > 0.0f ? lhs * (1.0f / l) : lhs;
+}
+
+// mat4f_simd /////////////////////////////////////////////////////////////////////////////////////
+inline
+mat4f_simd::mat4f_simd()
+{
+}
+
+inline
+mat4f_simd::mat4f_simd(const mat<float, 4, 4>& m)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    detail::sse_load(m, simd_data);
+#else
+    for (unsigned i = 0; i < 16; ++i) {
+        data_array[i] = m.data_array[i];
+    }
+#endif
+}
+
+inline
+const mat4f_simd
+mat4f_simd::identity()
+{
+    return mat4f_simd(mat<float, 4, 4>::identity());
+}
+
+inline
+const mat<float, 4, 4>
+mat4f_simd::to_mat4f() const
+{
+    mat<float, 4, 4> ret;
+    store(ret);
+    return ret;
+}
+
+inline
+void
+mat4f_simd::store(mat<float, 4, 4>& m) const
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    detail::sse_store(simd_data, m);
+#else
+    for (unsigned i = 0; i < 16; ++i) {
+        m.data_array[i] = data_array[i];
+    }
+#endif
+}
+
+inline
+const mat4f_simd
+operator*(const mat4f_simd& lhs, const mat4f_simd& rhs)
+{
+    mat4f_simd ret;
+#if SCM_CORE_MATH_SIMD_SSE
+    detail::sse_mat_mul(lhs.simd_data, rhs.simd_data, ret.simd_data);
+#else
+    ret = mat4f_simd(lhs.to_mat4f() * rhs.to_mat4f());
+#endif
+    return ret;
+}
+
+inline
+const vec4f_simd
+operator*(const mat4f_simd& lhs, const vec4f_simd& rhs)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    return vec4f_simd(detail::sse_mat_vec(lhs.simd_data, rhs.simd_data));
+#else
+    return vec4f_simd(lhs.to_mat4f() * rhs.to_vec4f());
+#endif
+}
+
+inline
+const mat4f_simd
+transpose(const mat4f_simd& lhs)
+{
+    mat4f_simd ret(lhs);
+#if SCM_CORE_MATH_SIMD_SSE
+    _MM_TRANSPOSE4_PS(ret.simd_data[0], ret.simd_data[1], ret.simd_data[2], ret.simd_data[3]);
+#else
+    ret = mat4f_simd(transpose(lhs.to_mat4f()));
+#endif
+    return ret;
+}
+
+inline
+const mat4f_simd
+inverse(const mat4f_simd& lhs)
+{
+    mat4f_simd ret;
+#if SCM_CORE_MATH_SIMD_SSE
+    if (!detail::sse_inverse(lhs.simd_data, ret.simd_data)) {
+        ret = mat4f_simd(mat<float, 4, 4>::zero());
+    }
+#else
+    ret = mat4f_simd(inverse(lhs.to_mat4f()));
+#endif
+    return ret;
+}
+
+// quatf_simd /////////////////////////////////////////////////////////////////////////////////////
+inline
+quatf_simd::quatf_simd()
+{
+}
+
+inline
+quatf_simd::quatf_simd(const quat<float>& q)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    simd_data = _mm_setr_ps(q.x, q.y, q.z, q.w);
+#else
+    data_array[0] = q.x;
+    data_array[1] = q.y;
+    data_array[2] = q.z;
+    data_array[3] = q.w;
+#endif
+}
+
+#if SCM_CORE_MATH_SIMD_SSE
+inline
+quatf_simd::quatf_simd(const __m128 v)
+  : simd_data(v)
+{
+}
+#endif
+
+inline
+const quat<float>
+quatf_simd::to_quatf() const
+{
+    return quat<float>(data_array[3], data_array[0], data_array[1], data_array[2]);
+}
+
+inline
+const mat4f_simd
+quatf_simd::to_matrix() const
+{
+    return mat4f_simd(to_quatf().to_matrix());
+}
+
+inline
+const quatf_simd
+operator*(const quatf_simd& lhs, const quatf_simd& rhs)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    return quatf_simd(detail::sse_quat_mul(lhs.simd_data, rhs.simd_data));
+#else
+    return quatf_simd(lhs.to_quatf() * rhs.to_quatf());
+#endif
+}
+
+inline
+const quatf_simd
+normalize(const quatf_simd& lhs)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    const float t = _mm_cvtss_f32(detail::sse_dot4(lhs.simd_data, lhs.simd_data));
+    if (t > 0.0f) {
+        return quatf_simd(_mm_mul_ps(lhs.simd_data, _mm_set1_ps(1.0f / sqrt(t))));
+    }
+    return lhs;
+#else
+    return quatf_simd(normalize(lhs.to_quatf()));
+#endif
+}
+
+// same interpolation as slerp(quat, quat, u)
+inline
+const quatf_simd
+slerp(const quatf_simd& a, const quatf_simd& b, const float u)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    float       cos_theta = _mm_cvtss_f32(detail::sse_dot4(a.simd_data, b.simd_data));
+    const float sgn_theta = cos_theta < 0.0f ? -1.0f : 1.0f;
+
+    cos_theta *= sgn_theta;
+
+    float alpha = u;
+    float beta  = 1.0f - u;
+
+    if (1.0f - cos_theta > 0.0f) {
+        const float theta     = acos(cos_theta);
+        const float sin_theta = sin(theta);
+
+        beta  = sin(theta - u * theta) / sin_theta;
+        alpha = sgn_theta * sin(u * theta) / sin_theta;
+    }
+
+    return normalize(quatf_simd(_mm_add_ps(_mm_mul_ps(a.simd_data, _mm_set1_ps(beta)),
+                                           _mm_mul_ps(b.simd_data, _mm_set1_ps(alpha)))));
+#else
+    return quatf_simd(slerp(a.to_quatf(), b.to_quatf(), u));
+#endif
+}
+
+// batched transformations ////////////////////////////////////////////////////////////////////////
+inline
+void
+transform_points(const mat<float, 4, 4>& m,
+                 const vec<float, 3>*    in_points,
+                       vec<float, 3>*    out_points,
+                 const std::size_t       count)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    __m128 mc[4];
+    detail::sse_load(m, mc);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        const vec<float, 3>& p = in_points[i];
+        const __m128         r = detail::sse_mat_point(mc, p.x, p.y, p.z);
+
+        _mm_storel_pi(reinterpret_cast<__m64*>(out_points[i].data_array), r);
+        _mm_store_ss(out_points[i].data_array + 2, _mm_movehl_ps(r, r));
+    }
+#else
+    for (std::size_t i = 0; i < count; ++i) {
+        const vec<float, 4> r = m * in_points[i];
+        out_points[i] = vec<float, 3>(r.x, r.y, r.z);
+    }
+#endif
+}
+
+inline
+void
+transform_points(const mat<float, 4, 4>& m,
+                 const vec<float, 4>*    in_points,
+                       vec<float, 4>*    out_points,
+                 const std::size_t       count)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    __m128 mc[4];
+    detail::sse_load(m, mc);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        _mm_storeu_ps(out_points[i].data_array, detail::sse_mat_vec(mc, _mm_loadu_ps(in_points[i].data_array)));
+    }
+#else
+    for (std::size_t i = 0; i < count; ++i) {
+        out_points[i] = m * in_points[i];
+    }
+#endif
+}
+
+inline
+void
+transform_matrices(const mat<float, 4, 4>& m,
+                   const mat<float, 4, 4>* in_matrices,
+                         mat<float, 4, 4>* out_matrices,
+                   const std::size_t       count)
+{
+#if SCM_CORE_MATH_SIMD_SSE
+    __m128 mc[4];
+    detail::sse_load(m, mc);
+
+    for (std::size_t i = 0; i < count; ++i) {
+        __m128 r[4];
+        detail::sse_load(in_matrices[i], r);
+        detail::sse_mat_mul(mc, r, r);
+        detail::sse_store(r, out_matrices[i]);
+    }
+#else
+    for (std::size_t i = 0; i < count; ++i) {
+        out_matrices[i] = m * in_matrices[i];
+    }
+#endif
+}
+
+#if SCM_CORE_MATH_SIMD_SSE
+// mat4f overloads ////////////////////////////////////////////////////////////////////////////////
+inline
+const mat<float, 4, 4>
+operator*(const mat<float, 4, 4>& lhs, const mat<float, 4, 4>& rhs)
+{
+    __m128 l[4];
+    __m128 r[4];
+    detail::sse_load(lhs, l);
+    detail::sse_load(rhs, r);
+    detail::sse_mat_mul(l, r, r);
+
+    mat<float, 4, 4> ret;
+    detail::sse_store(r, ret);
+    return ret;
+}
+
+inline
+mat<float, 4, 4>&
+operator*=(mat<float, 4, 4>& lhs, const mat<float, 4, 4>& rhs)
+{
+    __m128 l[4];
+    __m128 r[4];
+    detail::sse_load(lhs, l);
+    detail::sse_load(rhs, r);
+    detail::sse_mat_mul(l, r, r);
+    detail::sse_store(r, lhs);
+
+    return lhs;
+}
+
+inline
+const vec<float, 4>
+operator*(const mat<float, 4, 4>& lhs, const vec<float, 4>& rhs)
+{
+    __m128 l[4];
+    detail::sse_load(lhs, l);
+
+    vec<float, 4> ret;
+    _mm_storeu_ps(ret.data_array, detail::sse_mat_vec(l, _mm_loadu_ps(rhs.data_array)));
+    return ret;
+}
+
+inline
+const vec<float, 4>
+operator*(const mat<float, 4, 4>& lhs, const vec<float, 3>& rhs)
+{
+    __m128 l[4];
+    detail::sse_load(lhs, l);
+
+    vec<float, 4> ret;
+    _mm_storeu_ps(ret.data_array, detail::sse_mat_point(l, rhs.x, rhs.y, rhs.z));
+    ret.w = 0.0f;
+    return ret;
+}
+
+inline
+const mat<float, 4, 4>
+transpose(const mat<float, 4, 4>& lhs)
+{
+    __m128 l[4];
+    detail::sse_load(lhs, l);
+    _MM_TRANSPOSE4_PS(l[0], l[1], l[2], l[3]);
+
+    mat<float, 4, 4> ret;
+    detail::sse_store(l, ret);
+    return ret;
+}
+
+inline
+const mat<float, 4, 4>
+inverse(const mat<float, 4, 4>& lhs)
+{
+    __m128 l[4];
+    detail::sse_load(lhs, l);
+    if (!detail::sse_inverse(l, l)) {
+        return mat<float, 4, 4>::zero();
+    }
+
+    mat<float, 4, 4> ret;
+    detail::sse_store(l, ret);
+    return ret;
+}
+#endif // SCM_CORE_MATH_SIMD_SSE
+
+} // namespace math
+} // namespace scm
+
+#if SCM_CORE_MATH_SIMD_SSE
+#undef SCM_MATH_SSE_SHUFFLE_MASK
+#undef SCM_MATH_SSE_SWIZZLE
+#undef SCM_MATH_SSE_SHUFFLE
+#endif // SCM_CORE_MATH_SIMD_SSE
@@ -0,0 +1,72 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_CORE_UTILITIES_PARALLEL_FOR_H_INCLUDED
+#define SCM_CORE_UTILITIES_PARALLEL_FOR_H_INCLUDED
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <scm/core/numeric_types.h>
+#include <scm/core/math/common.h>
+
+namespace scm {
+
+// number of contiguous ranges [0, count) is split into by parallel_for,
+// one per hardware thread but never smaller than min_range_size items
+inline
+unsigned
+parallel_range_count(scm::size_t count,
+                     scm::size_t min_range_size)
+{
+    const scm::size_t hw_threads = math::max<scm::size_t>(1, boost::thread::hardware_concurrency());
+    const scm::size_t range_size = math::max<scm::size_t>(1, min_range_size);
+
+    return static_cast<unsigned>(math::max<scm::size_t>(1, math::min(hw_threads, count / range_size)));
+}
+
+inline
+scm::size_t
+parallel_range_begin(scm::size_t count,
+                     unsigned    range_count,
+                     unsigned    range_index)
+{
+    return (count / range_count) * range_index + math::min<scm::size_t>(range_index, count % range_count);
+}
+
+// calls f(range_begin, range_end, range_index) concurrently for the
+// parallel_range_count(count, min_range_size) ranges covering [0, count)
+//  - the last range is processed on the calling thread
+//  - the call returns after all ranges are processed
+//  - f is shared between all threads and must be safe to call concurrently,
+//    per range results are best written to slots indexed by range_index
+template<typename functor>
+void
+parallel_for(scm::size_t        count,
+             scm::size_t        min_range_size,
+             const functor&     f)
+{
+    const unsigned range_count = parallel_range_count(count, min_range_size);
+
+    if (range_count < 2) {
+        f(scm::size_t(0), count, 0u);
+        return;
+    }
+
+    boost::thread_group workers;
+    for (unsigned r = 0; r < range_count - 1; ++r) {
+        workers.create_thread(boost::bind<void>(boost::cref(f),
+                                                parallel_range_begin(count, range_count, r),
+                                                parallel_range_begin(count, range_count, r + 1),
+                                                r));
+    }
+    f(parallel_range_begin(count, range_count, range_count - 1), count, range_count - 1);
+
+    workers.join_all();
+}
+
+} // namespace scm
+
+#endif // SCM_CORE_UTILITIES_PARALLEL_FOR_H_INCLUDED
@@ -28,6 +28,7 @@ enum buffer_binding
     BIND_TRANSFORM_FEEDBACK_BUFFER   = 0x0040,
     BIND_ATOMIC_COUNTER_BUFFER       = 0x0080,
     BIND_STORAGE_BUFFER              = 0x0100,
+    BIND_DRAW_INDIRECT_BUFFER        = 0x0200,
 
     BUFFER_BINDING_COUNT
 }; // enum buffer_binding
@@ -376,6 +377,24 @@ enum occlusion_query_mode {
     OCCLUSION_QUERY_MODE_COUNT
 }; // occlusion_query_mode
 
+enum memory_barrier_type {
+    BARRIER_VERTEX_ATTRIB_ARRAY     = 0x0001,
+    BARRIER_ELEMENT_ARRAY           = 0x0002,
+    BARRIER_UNIFORM                 = 0x0004,
+    BARRIER_TEXTURE_FETCH           = 0x0008,
+    BARRIER_SHADER_IMAGE_ACCESS     = 0x0010,
+    BARRIER_COMMAND                 = 0x0020,
+    BARRIER_PIXEL_BUFFER            = 0x0040,
+    BARRIER_TEXTURE_UPDATE          = 0x0080,
+    BARRIER_BUFFER_UPDATE           = 0x0100,
+    BARRIER_FRAMEBUFFER             = 0x0200,
+    BARRIER_TRANSFORM_FEEDBACK      = 0x0400,
+    BARRIER_ATOMIC_COUNTER          = 0x0800,
+    BARRIER_SHADER_STORAGE          = 0x1000,
+
+    BARRIER_ALL                     = 0x1fff
+}; // enum memory_barrier_type
+
 const scm::uint64 sync_timeout_ignored = 0xffffffffffffffffull;
 
 } // namespace gl
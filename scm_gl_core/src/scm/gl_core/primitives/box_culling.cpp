@@ -0,0 +1,340 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "box_culling.h"
+
+#include <cassert>
+
+#include <scm/core/math.h>
+
+#include <scm/gl_core/primitives/box.h>
+#include <scm/gl_core/primitives/frustum.h>
+#include <scm/gl_core/primitives/plane.h>
+
+#if defined(__AVX__)
+#   define SCM_GL_CORE_BOX_CULLING_AVX 1
+#   include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#   define SCM_GL_CORE_BOX_CULLING_SSE 1
+#   include <xmmintrin.h>
+#endif
+
+namespace {
+
+using scm::gl::frustumf;
+
+// per plane stream selection, the p-corner is the box corner furthest along the
+// plane normal, the n-corner the nearest one (see plane_impl::update_corner_indices)
+struct cull_plane
+{
+    float           _n[3];
+    float           _w;
+    const float*    _p_corner[3];
+    const float*    _n_corner[3];
+}; // struct cull_plane
+
+void
+setup_planes(const frustumf&                in_frustum,
+             const scm::gl::box_soa_array&  in_boxes,
+             cull_plane                     out_planes[6])
+{
+    for (unsigned p = 0; p < 6; ++p) {
+        const scm::math::vec4f& pv = in_frustum.get_plane(p).vector();
+        for (unsigned c = 0; c < 3; ++c) {
+            out_planes[p]._n[c]        = pv[c];
+            out_planes[p]._p_corner[c] = pv[c] > 0.0f ? in_boxes.max_stream(c) : in_boxes.min_stream(c);
+            out_planes[p]._n_corner[c] = pv[c] > 0.0f ? in_boxes.min_stream(c) : in_boxes.max_stream(c);
+        }
+        out_planes[p]._w = pv.w;
+    }
+}
+
+// same evaluation order as plane_impl::distance and plane_impl::classify
+inline
+scm::uint8
+classify_box(const cull_plane planes[6], scm::size_t i, float e)
+{
+    bool intersect = false;
+    for (unsigned p = 0; p < 6; ++p) {
+        const cull_plane& cp = planes[p];
+        const float dn =   cp._n[0] * cp._n_corner[0][i] + cp._n[1] * cp._n_corner[1][i]
+                         + cp._n[2] * cp._n_corner[2][i] + cp._w;
+        if (dn > e) {
+            continue;
+        }
+        const float dp =   cp._n[0] * cp._p_corner[0][i] + cp._n[1] * cp._p_corner[1][i]
+                         + cp._n[2] * cp._p_corner[2][i] + cp._w;
+        if (dp > e) {
+            intersect = true;
+        }
+        else {
+            return static_cast<scm::uint8>(frustumf::outside);
+        }
+    }
+    return static_cast<scm::uint8>(intersect ? frustumf::intersecting : frustumf::inside);
+}
+
+#if SCM_GL_CORE_BOX_CULLING_AVX
+struct simd_ops
+{
+    typedef __m256  reg;
+    static const unsigned width = 8;
+
+    static reg      set1(float f)               { return _mm256_set1_ps(f); }
+    static reg      zero()                      { return _mm256_setzero_ps(); }
+    static reg      load(const float* p)        { return _mm256_loadu_ps(p); }
+    static reg      add(reg a, reg b)           { return _mm256_add_ps(a, b); }
+    static reg      mul(reg a, reg b)           { return _mm256_mul_ps(a, b); }
+    static reg      or_(reg a, reg b)           { return _mm256_or_ps(a, b); }
+    static reg      cmple(reg a, reg b)         { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static unsigned movemask(reg a)             { return static_cast<unsigned>(_mm256_movemask_ps(a)); }
+    static const char* name()                   { return "avx"; }
+}; // struct simd_ops
+#elif SCM_GL_CORE_BOX_CULLING_SSE
+struct simd_ops
+{
+    typedef __m128  reg;
+    static const unsigned width = 4;
+
+    static reg      set1(float f)               { return _mm_set1_ps(f); }
+    static reg      zero()                      { return _mm_setzero_ps(); }
+    static reg      load(const float* p)        { return _mm_loadu_ps(p); }
+    static reg      add(reg a, reg b)           { return _mm_add_ps(a, b); }
+    static reg      mul(reg a, reg b)           { return _mm_mul_ps(a, b); }
+    static reg      or_(reg a, reg b)           { return _mm_or_ps(a, b); }
+    static reg      cmple(reg a, reg b)         { return _mm_cmple_ps(a, b); }
+    static unsigned movemask(reg a)             { return static_cast<unsigned>(_mm_movemask_ps(a)); }
+    static const char* name()                   { return "sse"; }
+}; // struct simd_ops
+#endif
+
+#if SCM_GL_CORE_BOX_CULLING_AVX || SCM_GL_CORE_BOX_CULLING_SSE
+// classifies simd_ops::width boxes starting at i, returns the lane masks of
+// boxes outside any plane and of boxes not completely in front of all planes
+inline
+void
+classify_box_group(const cull_plane planes[6], scm::size_t i, const simd_ops::reg& e,
+                   unsigned& out_outside_mask, unsigned& out_intersect_mask)
+{
+    typedef simd_ops op;
+
+    op::reg outside   = op::zero();
+    op::reg intersect = op::zero();
+
+    for (unsigned p = 0; p < 6; ++p) {
+        const cull_plane& cp = planes[p];
+        const op::reg nx = op::set1(cp._n[0]);
+        const op::reg ny = op::set1(cp._n[1]);
+        const op::reg nz = op::set1(cp._n[2]);
+        const op::reg w  = op::set1(cp._w);
+
+        const op::reg dp = op::add(op::add(op::add(op::mul(nx, op::load(cp._p_corner[0] + i)),
+                                                   op::mul(ny, op::load(cp._p_corner[1] + i))),
+                                                   op::mul(nz, op::load(cp._p_corner[2] + i))),
+                                   w);
+        const op::reg dn = op::add(op::add(op::add(op::mul(nx, op::load(cp._n_corner[0] + i)),
+                                                   op::mul(ny, op::load(cp._n_corner[1] + i))),
+                                                   op::mul(nz, op::load(cp._n_corner[2] + i))),
+                                   w);
+
+        outside   = op::or_(outside,   op::cmple(dp, e));
+        intersect = op::or_(intersect, op::cmple(dn, e));
+    }
+
+    out_outside_mask   = op::movemask(outside);
+    out_intersect_mask = op::movemask(intersect);
+}
+#endif
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+box_soa_array::box_soa_array()
+{
+}
+
+void
+box_soa_array::clear()
+{
+    for (unsigned c = 0; c < 3; ++c) {
+        _min[c].clear();
+        _max[c].clear();
+    }
+}
+
+void
+box_soa_array::reserve(scm::size_t n)
+{
+    for (unsigned c = 0; c < 3; ++c) {
+        _min[c].reserve(n);
+        _max[c].reserve(n);
+    }
+}
+
+void
+box_soa_array::resize(scm::size_t n)
+{
+    for (unsigned c = 0; c < 3; ++c) {
+        _min[c].resize(n, 0.0f);
+        _max[c].resize(n, 0.0f);
+    }
+}
+
+scm::size_t
+box_soa_array::size() const
+{
+    return _min[0].size();
+}
+
+void
+box_soa_array::push_back(const boxf& b)
+{
+    for (unsigned c = 0; c < 3; ++c) {
+        _min[c].push_back(b.min_vertex()[c]);
+        _max[c].push_back(b.max_vertex()[c]);
+    }
+}
+
+void
+box_soa_array::set(scm::size_t i, const boxf& b)
+{
+    assert(i < size());
+    for (unsigned c = 0; c < 3; ++c) {
+        _min[c][i] = b.min_vertex()[c];
+        _max[c][i] = b.max_vertex()[c];
+    }
+}
+
+const boxf
+box_soa_array::get(scm::size_t i) const
+{
+    assert(i < size());
+    return boxf(math::vec3f(_min[0][i], _min[1][i], _min[2][i]),
+                math::vec3f(_max[0][i], _max[1][i], _max[2][i]));
+}
+
+const float*
+box_soa_array::min_stream(unsigned c) const
+{
+    assert(c < 3);
+    return _min[c].empty() ? 0 : &_min[c].front();
+}
+
+const float*
+box_soa_array::max_stream(unsigned c) const
+{
+    assert(c < 3);
+    return _max[c].empty() ? 0 : &_max[c].front();
+}
+
+float*
+box_soa_array::min_stream(unsigned c)
+{
+    assert(c < 3);
+    return _min[c].empty() ? 0 : &_min[c].front();
+}
+
+float*
+box_soa_array::max_stream(unsigned c)
+{
+    assert(c < 3);
+    return _max[c].empty() ? 0 : &_max[c].front();
+}
+
+void
+classify_boxes(const frustumf&      in_frustum,
+               const box_soa_array& in_boxes,
+               scm::uint8*          out_results)
+{
+    const scm::size_t count = in_boxes.size();
+    const float       e     = epsilon<float>::value();
+
+    if (count < 1) {
+        return;
+    }
+
+    cull_plane planes[6];
+    setup_planes(in_frustum, in_boxes, planes);
+
+    scm::size_t i = 0;
+
+#if SCM_GL_CORE_BOX_CULLING_AVX || SCM_GL_CORE_BOX_CULLING_SSE
+    const simd_ops::reg ev = simd_ops::set1(e);
+    for (; i + simd_ops::width <= count; i += simd_ops::width) {
+        unsigned om;
+        unsigned im;
+        classify_box_group(planes, i, ev, om, im);
+        for (unsigned l = 0; l < simd_ops::width; ++l) {
+            out_results[i + l] = static_cast<scm::uint8>(  (om & (1u << l)) ? frustumf::outside
+                                                         : (im & (1u << l)) ? frustumf::intersecting
+                                                                            : frustumf::inside);
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        out_results[i] = classify_box(planes, i, e);
+    }
+}
+
+scm::size_t
+cull_boxes(const frustumf&      in_frustum,
+           const box_soa_array& in_boxes,
+           scm::uint32*         out_indices)
+{
+    const scm::size_t count = in_boxes.size();
+    const float       e     = epsilon<float>::value();
+
+    if (count < 1) {
+        return 0;
+    }
+
+    cull_plane planes[6];
+    setup_planes(in_frustum, in_boxes, planes);
+
+    scm::size_t i       = 0;
+    scm::size_t visible = 0;
+
+#if SCM_GL_CORE_BOX_CULLING_AVX || SCM_GL_CORE_BOX_CULLING_SSE
+    const simd_ops::reg ev        = simd_ops::set1(e);
+    const unsigned      all_lanes = (1u << simd_ops::width) - 1u;
+    for (; i + simd_ops::width <= count; i += simd_ops::width) {
+        unsigned om;
+        unsigned im;
+        classify_box_group(planes, i, ev, om, im);
+        unsigned vm = ~om & all_lanes;
+        while (0 != vm) {
+            unsigned l = 0;
+            while (0 == (vm & (1u << l))) {
+                ++l;
+            }
+            out_indices[visible++] = static_cast<scm::uint32>(i + l);
+            vm &= vm - 1u;
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        if (classify_box(planes, i, e) != frustumf::outside) {
+            out_indices[visible++] = static_cast<scm::uint32>(i);
+        }
+    }
+
+    return visible;
+}
+
+const char*
+box_culling_instruction_set()
+{
+#if SCM_GL_CORE_BOX_CULLING_AVX || SCM_GL_CORE_BOX_CULLING_SSE
+    return simd_ops::name();
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace gl
+} // namespace scm
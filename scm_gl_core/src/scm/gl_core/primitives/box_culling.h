@@ -0,0 +1,75 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_CORE_PRIMITIVES_BOX_CULLING_H_INCLUDED
+#define SCM_GL_CORE_PRIMITIVES_BOX_CULLING_H_INCLUDED
+
+#include <vector>
+
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/primitives/primitives_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// structure of arrays storage of axis aligned boxes for batched culling
+//  - one stream per min/max component, processed 4 (SSE) or 8 (AVX) boxes at a time
+class __scm_export(gl_core) box_soa_array
+{
+public:
+    box_soa_array();
+
+    void                        clear();
+    void                        reserve(scm::size_t n);
+    void                        resize(scm::size_t n);
+    scm::size_t                 size() const;
+
+    void                        push_back(const boxf& b);
+    void                        set(scm::size_t i, const boxf& b);
+    const boxf                  get(scm::size_t i) const;
+
+    // component streams (0 = x, 1 = y, 2 = z)
+    const float*                min_stream(unsigned c) const;
+    const float*                max_stream(unsigned c) const;
+    float*                      min_stream(unsigned c);
+    float*                      max_stream(unsigned c);
+
+protected:
+    std::vector<float>          _min[3];
+    std::vector<float>          _max[3];
+
+}; // class box_soa_array
+
+// classifies all boxes against the frustum, writes one frustumf::classification_result
+// (inside, outside, intersecting) per box to out_results, the results are identical to
+// calling frustumf::classify for each box
+__scm_export(gl_core)
+void
+classify_boxes(const frustumf&      in_frustum,
+               const box_soa_array& in_boxes,
+               scm::uint8*          out_results);
+
+// writes the indices of all boxes not outside the frustum to out_indices (sized for
+// in_boxes.size() entries), returns the number of written indices
+__scm_export(gl_core)
+scm::size_t
+cull_boxes(const frustumf&      in_frustum,
+           const box_soa_array& in_boxes,
+           scm::uint32*         out_indices);
+
+// name of the instruction set used for the batched culling (sse, avx or scalar)
+__scm_export(gl_core)
+const char*
+box_culling_instruction_set();
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_CORE_PRIMITIVES_BOX_CULLING_H_INCLUDED
@@ -45,7 +45,7 @@ frustum_impl<s>::update(const typename frustum_impl<s>::mat4_type& mvp_matrix)
 {
     using namespace scm::math;
 
-    vec4f tmp_plane;
+    typename plane_type::vec4_type tmp_plane;
 
     // left plane
     tmp_plane.x = mvp_matrix.m03 + mvp_matrix.m00;
@@ -53,7 +53,7 @@ frustum_impl<s>::update(const typename frustum_impl<s>::mat4_type& mvp_matrix)
     tmp_plane.z = mvp_matrix.m11 + mvp_matrix.m08;
     tmp_plane.w = mvp_matrix.m15 + mvp_matrix.m12;
 
-    _planes[left_plane]     = plane(tmp_plane);
+    _planes[left_plane]     = plane_type(tmp_plane);
 
     // right plane
     tmp_plane.x = mvp_matrix.m03 - mvp_matrix.m00;
@@ -61,7 +61,7 @@ frustum_impl<s>::update(const typename frustum_impl<s>::mat4_type& mvp_matrix)
     tmp_plane.z = mvp_matrix.m11 - mvp_matrix.m08;
     tmp_plane.w = mvp_matrix.m15 - mvp_matrix.m12;
 
-    _planes[right_plane]    = plane(tmp_plane);
+    _planes[right_plane]    = plane_type(tmp_plane);
 
     // bottom plane
     tmp_plane.x = mvp_matrix.m03 + mvp_matrix.m01;
@@ -69,7 +69,7 @@ frustum_impl<s>::update(const typename frustum_impl<s>::mat4_type& mvp_matrix)
     tmp_plane.z = mvp_matrix.m11 + mvp_matrix.m09;
     tmp_plane.w = mvp_matrix.m15 + mvp_matrix.m13;
 
-    _planes[bottom_plane]   = plane(tmp_plane);
+    _planes[bottom_plane]   = plane_type(tmp_plane);
 
     // top plane
     tmp_plane.x = mvp_matrix.m03 - mvp_matrix.m01;
@@ -77,7 +77,7 @@ frustum_impl<s>::update(const typename frustum_impl<s>::mat4_type& mvp_matrix)
     tmp_plane.z = mvp_matrix.m11 - mvp_matrix.m09;
     tmp_plane.w = mvp_matrix.m15 - mvp_matrix.m13;
 
-    _planes[top_plane]      = plane(tmp_plane);
+    _planes[top_plane]      = plane_type(tmp_plane);
 
     // near plane
     tmp_plane.x = mvp_matrix.m03 + mvp_matrix.m02;
@@ -85,7 +85,7 @@ frustum_impl<s>::update(const typename frustum_impl<s>::mat4_type& mvp_matrix)
     tmp_plane.z = mvp_matrix.m11 + mvp_matrix.m10;
     tmp_plane.w = mvp_matrix.m15 + mvp_matrix.m14;
 
-    _planes[near_plane]     = plane(tmp_plane);
+    _planes[near_plane]     = plane_type(tmp_plane);
 
     // far plane
     tmp_plane.x = mvp_matrix.m03 - mvp_matrix.m02;
@@ -93,7 +93,7 @@ frustum_impl<s>::update(const typename frustum_impl<s>::mat4_type& mvp_matrix)
     tmp_plane.z = mvp_matrix.m11 - mvp_matrix.m10;
     tmp_plane.w = mvp_matrix.m15 - mvp_matrix.m14;
 
-    _planes[far_plane]      = plane(tmp_plane);
+    _planes[far_plane]      = plane_type(tmp_plane);
 }
 
 template<typename s>
@@ -130,12 +130,12 @@ frustum_impl<s>::classify(const box_type& b) const
 
     // normals of frustum_impl planes point inside the frustum_impl
     for (unsigned i = 0; i < 6; ++i) {
-        plane::classification_result cur_plane_res = _planes[i].classify(b);
+        typename plane_type::classification_result cur_plane_res = _planes[i].classify(b);
 
-        if (cur_plane_res == plane::back) {
+        if (cur_plane_res == plane_type::back) {
             return (outside);
         }
-        else if (cur_plane_res == plane::intersecting) {
+        else if (cur_plane_res == plane_type::intersecting) {
             plane_intersect = true;
         }
     }
@@ -151,12 +151,12 @@ frustum_impl<s>::classify(const rect_type& b) const
 
     // normals of frustum_impl planes point inside the frustum_impl
     for (unsigned i = 0; i < 6; ++i) {
-        plane::classification_result cur_plane_res = _planes[i].classify(b);
+        typename plane_type::classification_result cur_plane_res = _planes[i].classify(b);
 
-        if (cur_plane_res == plane::back) {
+        if (cur_plane_res == plane_type::back) {
             return (outside);
         }
-        else if (cur_plane_res == plane::intersecting) {
+        else if (cur_plane_res == plane_type::intersecting) {
             plane_intersect = true;
         }
     }
@@ -116,6 +116,7 @@ render_context::binding_state_type::binding_state_type()
 render_context::render_context(render_device& in_device)
   : render_device_child(in_device)
   , _opengl_api_core(in_device.opengl_api())
+  , _state_objects_delta(PIPELINE_DELTA_NONE)
 {
     const opengl::gl_core& glapi = opengl_api();
 
@@ -136,7 +137,8 @@ render_context::render_context(render_device& in_device)
 
     _current_state._texture_units.resize(in_device.capabilities()._max_texture_image_units);
     _applied_state._texture_units.resize(in_device.capabilities()._max_texture_image_units);
-    if (   glapi.extension_EXT_shader_image_load_store
+    if (   (   SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_420
+            || glapi.extension_EXT_shader_image_load_store)
         && in_device.capabilities()._max_image_units > 0) {
         _current_state._image_units.resize(in_device.capabilities()._max_image_units);
         _applied_state._image_units.resize(in_device.capabilities()._max_image_units);
@@ -344,6 +346,27 @@ render_context::dispatch_compute(const math::vec3ui& num_groups,
     gl_assert(glapi, leaving render_context::dispatch_compute(variable));
 }
 
+void
+render_context::memory_barrier(unsigned in_barriers)
+{
+    const opengl::gl_core& glapi = opengl_api();
+
+    if (SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_420) {
+        glapi.glMemoryBarrier(util::gl_memory_barrier_bits(in_barriers));
+    }
+    else if (glapi.extension_EXT_shader_image_load_store) {
+        glapi.glMemoryBarrierEXT(GL_ALL_BARRIER_BITS_EXT);
+    }
+    else {
+        glerr() << log::error
+                << "render_context::memory_barrier(): "
+                << "memory barriers are only available using scm_gl_core with OpenGL4.2 capabilities enabled on a OpenGL4.2+ context."
+                << log::end;
+    }
+
+    gl_assert(glapi, leaving render_context::memory_barrier());
+}
+
 // debug api //////////////////////////////////////////////////////////////////////////////////
 void
 render_context::register_debug_callback(const debug_output_ptr& f)
@@ -782,6 +805,26 @@ render_context::current_unpack_buffer() const
     return _unpack_buffer;
 }
 
+void
+render_context::bind_pack_buffer(const buffer_ptr& in_buffer)
+{
+    if (_pack_buffer != in_buffer) {
+        if (in_buffer) {
+            in_buffer->bind(*this, BIND_PIXEL_PACK_BUFFER);
+        }
+        else {
+            _pack_buffer->unbind(*this, BIND_PIXEL_PACK_BUFFER);
+        }
+        _pack_buffer = in_buffer;
+    }
+}
+
+const buffer_ptr&
+render_context::current_pack_buffer() const
+{
+    return _pack_buffer;
+}
+
 void
 render_context::bind_vertex_array(const vertex_array_ptr& in_vertex_array)
 {
@@ -824,11 +867,24 @@ render_context::current_index_buffer_binding() const
     return _current_state._index_buffer_binding;
 }
 
+void
+render_context::bind_draw_indirect_buffer(const buffer_ptr& in_buffer)
+{
+    _current_state._draw_indirect_buffer = in_buffer;
+}
+
+const buffer_ptr&
+render_context::current_draw_indirect_buffer() const
+{
+    return _current_state._draw_indirect_buffer;
+}
+
 void
 render_context::reset_vertex_input()
 {
     _current_state._vertex_array         = vertex_array_ptr();
     _current_state._index_buffer_binding = index_buffer_binding();
+    _current_state._draw_indirect_buffer = buffer_ptr();
 }
 
 void
@@ -1003,6 +1059,231 @@ render_context::multi_draw_arrays(const primitive_topology in_topology, const in
     gl_assert(glapi, leaving render_context::draw_elements());
 }
 
+void
+render_context::draw_arrays_instanced(const primitive_topology in_topology, const int in_first_index, const int in_count,
+                                      const int in_instance_count, const unsigned in_base_instance)
+{
+    const opengl::gl_core& glapi = opengl_api();
+
+    if (   (0 > in_first_index)
+        || (0 > in_count)
+        || (0 > in_instance_count)) {
+        state().set(object_state::OS_ERROR_INVALID_VALUE);
+        SCM_GL_DGB("render_context::draw_arrays_instanced(): error invalid count, start index or instance count (< 0) " << "('" << state().state_string() << "')");
+        return;
+    }
+
+    if (0 != in_base_instance) {
+        if (SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_420) {
+            pre_draw_setup();
+            glapi.glDrawArraysInstancedBaseInstance(util::gl_primitive_topology(in_topology), in_first_index, in_count,
+                                                    in_instance_count, in_base_instance);
+            post_draw_setup();
+        }
+        else {
+            glerr() << log::error
+                    << "render_context::draw_arrays_instanced(): "
+                    << "base instances are only available using scm_gl_core with OpenGL4.2 capabilities enabled on a OpenGL4.2+ context."
+                    << log::end;
+        }
+    }
+    else {
+        pre_draw_setup();
+        glapi.glDrawArraysInstanced(util::gl_primitive_topology(in_topology), in_first_index, in_count, in_instance_count);
+        post_draw_setup();
+    }
+
+    gl_assert(glapi, leaving render_context::draw_arrays_instanced());
+}
+
+void
+render_context::draw_elements_instanced(const int in_count, const int in_start_index, const int in_instance_count,
+                                        const int in_base_vertex, const unsigned in_base_instance)
+{
+    const opengl::gl_core& glapi = opengl_api();
+
+    if (!util::is_vaild_index_type(_applied_state._index_buffer_binding._index_data_type)) {
+        state().set(object_state::OS_ERROR_INVALID_ENUM);
+        return;
+    }
+    if (   (0 > in_count)
+        || (0 > in_start_index)
+        || (0 > in_instance_count)) {
+        state().set(object_state::OS_ERROR_INVALID_VALUE);
+        SCM_GL_DGB("render_context::draw_elements_instanced(): error invalid count, start index or instance count (< 0) " << "('" << state().state_string() << "')");
+        return;
+    }
+
+    const index_buffer_binding& ib = _applied_state._index_buffer_binding;
+    const unsigned              gl_topology   = util::gl_primitive_topology(ib._primitive_topology);
+    const unsigned              gl_index_type = util::gl_base_type(ib._index_data_type);
+    const char*                 gl_indices    = (char*)0 + ib._index_data_offset + size_of_type(ib._index_data_type) * in_start_index;
+
+    if (0 != in_base_instance) {
+        if (SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_420) {
+            pre_draw_setup();
+            glapi.glDrawElementsInstancedBaseVertexBaseInstance(gl_topology, in_count, gl_index_type, gl_indices,
+                                                                in_instance_count, in_base_vertex, in_base_instance);
+            post_draw_setup();
+        }
+        else {
+            glerr() << log::error
+                    << "render_context::draw_elements_instanced(): "
+                    << "base instances are only available using scm_gl_core with OpenGL4.2 capabilities enabled on a OpenGL4.2+ context."
+                    << log::end;
+        }
+    }
+    else {
+        pre_draw_setup();
+        glapi.glDrawElementsInstancedBaseVertex(gl_topology, in_count, gl_index_type, gl_indices,
+                                                in_instance_count, in_base_vertex);
+        post_draw_setup();
+    }
+
+    gl_assert(glapi, leaving render_context::draw_elements_instanced());
+}
+
+void
+render_context::draw_arrays_indirect(const primitive_topology in_topology, const scm::size_t in_offset)
+{
+    if (SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_400) {
+        const opengl::gl_core& glapi = opengl_api();
+
+        if (!_applied_state._draw_indirect_buffer) {
+            state().set(object_state::OS_ERROR_INVALID_OPERATION);
+            SCM_GL_DGB("render_context::draw_arrays_indirect(): error no draw indirect buffer bound " << "('" << state().state_string() << "')");
+            return;
+        }
+
+        pre_draw_setup();
+
+        glapi.glDrawArraysIndirect(util::gl_primitive_topology(in_topology), (char*)0 + in_offset);
+
+        post_draw_setup();
+
+        gl_assert(glapi, leaving render_context::draw_arrays_indirect());
+    }
+    else {
+        glerr() << log::error
+                << "render_context::draw_arrays_indirect(): "
+                << "the indirect draw functionality is only available using scm_gl_core with OpenGL4.x capabilities enabled on a OpenGL4.x context."
+                << log::end;
+    }
+}
+
+void
+render_context::draw_elements_indirect(const scm::size_t in_offset)
+{
+    if (SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_400) {
+        const opengl::gl_core& glapi = opengl_api();
+
+        if (!util::is_vaild_index_type(_applied_state._index_buffer_binding._index_data_type)) {
+            state().set(object_state::OS_ERROR_INVALID_ENUM);
+            return;
+        }
+        if (!_applied_state._draw_indirect_buffer) {
+            state().set(object_state::OS_ERROR_INVALID_OPERATION);
+            SCM_GL_DGB("render_context::draw_elements_indirect(): error no draw indirect buffer bound " << "('" << state().state_string() << "')");
+            return;
+        }
+
+        pre_draw_setup();
+
+        // the index data offset of the index buffer binding is not applied, the
+        // first index of the draw command is relative to the start of the index buffer
+        glapi.glDrawElementsIndirect(
+            util::gl_primitive_topology(_applied_state._index_buffer_binding._primitive_topology),
+            util::gl_base_type(_applied_state._index_buffer_binding._index_data_type),
+            (char*)0 + in_offset);
+
+        post_draw_setup();
+
+        gl_assert(glapi, leaving render_context::draw_elements_indirect());
+    }
+    else {
+        glerr() << log::error
+                << "render_context::draw_elements_indirect(): "
+                << "the indirect draw functionality is only available using scm_gl_core with OpenGL4.x capabilities enabled on a OpenGL4.x context."
+                << log::end;
+    }
+}
+
+void
+render_context::multi_draw_arrays_indirect(const primitive_topology in_topology, const scm::size_t in_offset,
+                                           const int in_draw_count, const int in_stride)
+{
+    if (SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_430) {
+        const opengl::gl_core& glapi = opengl_api();
+
+        if (   (0 > in_draw_count)
+            || (0 > in_stride)) {
+            state().set(object_state::OS_ERROR_INVALID_VALUE);
+            SCM_GL_DGB("render_context::multi_draw_arrays_indirect(): error invalid draw count or stride (< 0) " << "('" << state().state_string() << "')");
+            return;
+        }
+        if (!_applied_state._draw_indirect_buffer) {
+            state().set(object_state::OS_ERROR_INVALID_OPERATION);
+            SCM_GL_DGB("render_context::multi_draw_arrays_indirect(): error no draw indirect buffer bound " << "('" << state().state_string() << "')");
+            return;
+        }
+
+        pre_draw_setup();
+
+        glapi.glMultiDrawArraysIndirect(util::gl_primitive_topology(in_topology), (char*)0 + in_offset, in_draw_count, in_stride);
+
+        post_draw_setup();
+
+        gl_assert(glapi, leaving render_context::multi_draw_arrays_indirect());
+    }
+    else {
+        glerr() << log::error
+                << "render_context::multi_draw_arrays_indirect(): "
+                << "the multi draw indirect functionality is only available using scm_gl_core with OpenGL4.3 capabilities enabled on a OpenGL4.3+ context."
+                << log::end;
+    }
+}
+
+void
+render_context::multi_draw_elements_indirect(const scm::size_t in_offset, const int in_draw_count, const int in_stride)
+{
+    if (SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_430) {
+        const opengl::gl_core& glapi = opengl_api();
+
+        if (!util::is_vaild_index_type(_applied_state._index_buffer_binding._index_data_type)) {
+            state().set(object_state::OS_ERROR_INVALID_ENUM);
+            return;
+        }
+        if (   (0 > in_draw_count)
+            || (0 > in_stride)) {
+            state().set(object_state::OS_ERROR_INVALID_VALUE);
+            SCM_GL_DGB("render_context::multi_draw_elements_indirect(): error invalid draw count or stride (< 0) " << "('" << state().state_string() << "')");
+            return;
+        }
+        if (!_applied_state._draw_indirect_buffer) {
+            state().set(object_state::OS_ERROR_INVALID_OPERATION);
+            SCM_GL_DGB("render_context::multi_draw_elements_indirect(): error no draw indirect buffer bound " << "('" << state().state_string() << "')");
+            return;
+        }
+
+        pre_draw_setup();
+
+        glapi.glMultiDrawElementsIndirect(
+            util::gl_primitive_topology(_applied_state._index_buffer_binding._primitive_topology),
+            util::gl_base_type(_applied_state._index_buffer_binding._index_data_type),
+            (char*)0 + in_offset, in_draw_count, in_stride);
+
+        post_draw_setup();
+
+        gl_assert(glapi, leaving render_context::multi_draw_elements_indirect());
+    }
+    else {
+        glerr() << log::error
+                << "render_context::multi_draw_elements_indirect(): "
+                << "the multi draw indirect functionality is only available using scm_gl_core with OpenGL4.3 capabilities enabled on a OpenGL4.3+ context."
+                << log::end;
+    }
+}
+
 bool
 render_context::make_resident(const buffer_ptr& in_buffer,
                               const access_mode in_access)
@@ -1100,6 +1381,16 @@ render_context::apply_vertex_input()
         }
         _applied_state._index_buffer_binding = _current_state._index_buffer_binding;
     }
+
+    if (_current_state._draw_indirect_buffer != _applied_state._draw_indirect_buffer) {
+        if (_current_state._draw_indirect_buffer) {
+            _current_state._draw_indirect_buffer->bind(*this, BIND_DRAW_INDIRECT_BUFFER);
+        }
+        else {
+            _applied_state._draw_indirect_buffer->unbind(*this, BIND_DRAW_INDIRECT_BUFFER);
+        }
+        _applied_state._draw_indirect_buffer = _current_state._draw_indirect_buffer;
+    }
     gl_assert(opengl_api(), leaving render_context::apply_vertex_input());
 }
 
@@ -1167,7 +1458,8 @@ render_context::apply_storage_buffer_bindings()
 void
 render_context::bind_program(const program_ptr& in_program)
 {
-    _current_state._program = in_program;
+    _current_state._program        = in_program;
+    _current_state._pipeline_state = pipeline_state_ptr();
 }
 
 const program_ptr&
@@ -1179,7 +1471,8 @@ render_context::current_program() const
 void
 render_context::reset_program()
 {
-    _current_state._program = program_ptr();
+    _current_state._program        = program_ptr();
+    _current_state._pipeline_state = pipeline_state_ptr();
 }
 
 void
@@ -1329,12 +1622,28 @@ render_context::update_sub_texture(const texture_image_ptr& in_texture,
     return true;
 }
 
+bool
+render_context::retrieve_texture_data(const texture_image_ptr& in_texture,
+                                      const unsigned           in_level,
+                                      const size_t             in_offset)
+{
+    assert(_pack_buffer);
+    if (!in_texture->retrieve_image_data(*this, in_level, BUFFER_OFFSET(in_offset))) {
+        glerr() << log::error
+                << "render_context::retrieve_texture_data(): "
+                << "error during texture data retrival (check valid level or if multisampled texture)."
+                << log::end;
+        return false;
+    }
+    return true;
+}
+
 bool
 render_context::retrieve_texture_data(const texture_image_ptr& in_texture,
                                       const unsigned           in_level,
                                             void*              in_data)
 {
-    //assert(!_pack_buffer);
+    assert(!_pack_buffer);
     if (!in_texture->retrieve_image_data(*this, in_level, in_data)) {
         glerr() << log::error
                 << "render_context::retrieve_texture_data(): "
@@ -2170,6 +2479,8 @@ render_context::set_depth_stencil_state(const depth_stencil_state_ptr& in_ds_sta
 {
     _current_state._depth_stencil_state = in_ds_state;
     _current_state._stencil_ref_value   = in_stencil_ref;
+    _current_state._pipeline_state      = pipeline_state_ptr();
+    _state_objects_delta               |= PIPELINE_DELTA_DEPTH_STENCIL;
 }
 
 const depth_stencil_state_ptr&
@@ -2190,6 +2501,8 @@ render_context::set_rasterizer_state(const rasterizer_state_ptr& in_rs_state, fl
     _current_state._rasterizer_state = in_rs_state;
     _current_state._line_width       = in_line_width;
     _current_state._point_size       = in_point_size;
+    _current_state._pipeline_state   = pipeline_state_ptr();
+    _state_objects_delta            |= PIPELINE_DELTA_RASTERIZER;
 }
 
 const rasterizer_state_ptr&
@@ -2213,8 +2526,10 @@ render_context::current_point_size() const
 void
 render_context::set_blend_state(const blend_state_ptr& in_bl_state, const math::vec4f& in_blend_color)
 {
-    _current_state._blend_state = in_bl_state;
-    _current_state._blend_color = in_blend_color;
+    _current_state._blend_state    = in_bl_state;
+    _current_state._blend_color    = in_blend_color;
+    _current_state._pipeline_state = pipeline_state_ptr();
+    _state_objects_delta          |= PIPELINE_DELTA_BLEND;
 }
 
 const blend_state_ptr&
@@ -2235,21 +2550,31 @@ render_context::reset_state_objects()
     _current_state._depth_stencil_state = _default_depth_stencil_state;
     _current_state._rasterizer_state    = _default_rasterizer_state;
     _current_state._blend_state         = _default_blend_state;
+    _current_state._pipeline_state      = pipeline_state_ptr();
+    _state_objects_delta               |= PIPELINE_DELTA_STATE_OBJECTS;
 }
 
 void
 render_context::apply_state_objects()
 {
-    if (   (_current_state._depth_stencil_state != _applied_state._depth_stencil_state)
-        || (_current_state._stencil_ref_value != _applied_state._stencil_ref_value)) {
+    // only the state objects set since the last apply are compared, pipeline
+    // switches only mark the state objects of their delta
+    if (_state_objects_delta == PIPELINE_DELTA_NONE) {
+        return;
+    }
+
+    if (   (_state_objects_delta & PIPELINE_DELTA_DEPTH_STENCIL)
+        && (   (_current_state._depth_stencil_state != _applied_state._depth_stencil_state)
+            || (_current_state._stencil_ref_value != _applied_state._stencil_ref_value))) {
         _current_state._depth_stencil_state->apply(*this, _current_state._stencil_ref_value,
                                                    *(_applied_state._depth_stencil_state), _applied_state._stencil_ref_value);
         _applied_state._depth_stencil_state = _current_state._depth_stencil_state;
         _applied_state._stencil_ref_value   = _current_state._stencil_ref_value;
     }
 
-    if (   (_current_state._rasterizer_state != _applied_state._rasterizer_state)
-        || (_current_state._line_width       != _applied_state._line_width)) {
+    if (   (_state_objects_delta & PIPELINE_DELTA_RASTERIZER)
+        && (   (_current_state._rasterizer_state != _applied_state._rasterizer_state)
+            || (_current_state._line_width       != _applied_state._line_width))) {
         _current_state._rasterizer_state->apply(*this, _current_state._line_width, _current_state._point_size,
                                                 *(_applied_state._rasterizer_state), _applied_state._line_width, _applied_state._point_size);
         _applied_state._rasterizer_state = _current_state._rasterizer_state;
@@ -2257,16 +2582,61 @@ render_context::apply_state_objects()
         _applied_state._point_size       = _current_state._point_size;
     }
 
-    if (   (_current_state._blend_state != _applied_state._blend_state)
-        || (_current_state._blend_color != _applied_state._blend_color)) {
+    if (   (_state_objects_delta & PIPELINE_DELTA_BLEND)
+        && (   (_current_state._blend_state != _applied_state._blend_state)
+            || (_current_state._blend_color != _applied_state._blend_color))) {
         _current_state._blend_state->apply(*this, _current_state._blend_color,
                                            *(_applied_state._blend_state), _applied_state._blend_color);
         _applied_state._blend_state = _current_state._blend_state;
         _applied_state._blend_color = _current_state._blend_color;
     }
+    _state_objects_delta = PIPELINE_DELTA_NONE;
+
     gl_assert(opengl_api(), leaving render_context::apply_state_objects());
 }
 
+void
+render_context::bind_pipeline_state(const pipeline_state_ptr& in_pipeline)
+{
+    if (_current_state._pipeline_state == in_pipeline) {
+        return;
+    }
+    if (!in_pipeline) {
+        _current_state._pipeline_state = pipeline_state_ptr();
+        return;
+    }
+
+    const pipeline_state_desc& pd    = in_pipeline->descriptor();
+    const unsigned             delta =   _current_state._pipeline_state
+                                       ? in_pipeline->delta(*_current_state._pipeline_state)
+                                       : PIPELINE_DELTA_ALL;
+
+    if (delta & PIPELINE_DELTA_PROGRAM) {
+        _current_state._program             = pd._program;
+    }
+    if (delta & PIPELINE_DELTA_DEPTH_STENCIL) {
+        _current_state._depth_stencil_state = pd._depth_stencil_state;
+        _current_state._stencil_ref_value   = pd._stencil_ref;
+    }
+    if (delta & PIPELINE_DELTA_RASTERIZER) {
+        _current_state._rasterizer_state    = pd._rasterizer_state;
+        _current_state._line_width          = pd._line_width;
+        _current_state._point_size          = pd._point_size;
+    }
+    if (delta & PIPELINE_DELTA_BLEND) {
+        _current_state._blend_state         = pd._blend_state;
+        _current_state._blend_color         = pd._blend_color;
+    }
+    _current_state._pipeline_state = in_pipeline;
+    _state_objects_delta          |= delta & PIPELINE_DELTA_STATE_OBJECTS;
+}
+
+const pipeline_state_ptr&
+render_context::current_pipeline_state() const
+{
+    return _current_state._pipeline_state;
+}
+
 // active queries /////////////////////////////////////////////////////////////////////////////////
 void
 render_context::begin_query(const query_ptr& in_query)
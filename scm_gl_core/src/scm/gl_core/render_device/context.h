@@ -91,6 +91,20 @@ public:
         scm::size_t         _offset;
         scm::size_t         _size;
     }; // struct uniform_buffer_binding
+    // draw indirect buffer layouts as defined by the OpenGL specification
+    struct draw_arrays_indirect_command {
+        unsigned            _count;
+        unsigned            _instance_count;
+        unsigned            _first;
+        unsigned            _base_instance;
+    }; // struct draw_arrays_indirect_command
+    struct draw_elements_indirect_command {
+        unsigned            _count;
+        unsigned            _instance_count;
+        unsigned            _first_index;
+        int                 _base_vertex;
+        unsigned            _base_instance;
+    }; // struct draw_elements_indirect_command
     typedef std::vector<texture_unit_binding>   texture_unit_array;
     typedef std::vector<image_unit_binding>     image_unit_array;
     typedef std::vector<buffer_binding>         buffer_binding_array;
@@ -103,6 +117,7 @@ private:
         // vertex specification ///////////////////////////////////////////////////////////////////
         vertex_array_ptr                    _vertex_array;
         index_buffer_binding                _index_buffer_binding;
+        buffer_ptr                          _draw_indirect_buffer;
         buffer_binding_array                _active_uniform_buffers;
         buffer_binding_array                _active_atomic_counter_buffers;
         buffer_binding_array                _active_storage_buffers;
@@ -117,6 +132,9 @@ private:
         // blend state
         blend_state_ptr                     _blend_state;
         math::vec4f                         _blend_color;
+        // pipeline the program and state objects were set from, reset when one
+        // of them is set individually
+        pipeline_state_ptr                  _pipeline_state;
         // texture units //////////////////////////////////////////////////////////////////////////
         texture_unit_array                  _texture_units;
         image_unit_array                    _image_units;
@@ -143,6 +161,9 @@ public:
     void                        dispatch_compute(const math::vec3ui& num_groups);
     void                        dispatch_compute(const math::vec3ui& num_groups,
                                                  const math::vec3ui& group_sizes);
+    // order incoherent shader writes (image, storage buffer, atomic counter) before
+    // the accesses given by in_barriers (combination of memory_barrier_type bits)
+    void                        memory_barrier(unsigned in_barriers = BARRIER_ALL);
 
     // debug api //////////////////////////////////////////////////////////////////////////////////
 public:
@@ -217,6 +238,9 @@ public:
     void                        bind_unpack_buffer(const buffer_ptr& in_buffer);
     const buffer_ptr&           current_unpack_buffer() const;
 
+    void                        bind_pack_buffer(const buffer_ptr& in_buffer);
+    const buffer_ptr&           current_pack_buffer() const;
+
     void                        reset_uniform_buffers();
     void                        reset_atomic_counter_buffers();
     void                        reset_storage_buffers();
@@ -229,6 +253,10 @@ public:
     void                        set_index_buffer_binding(const index_buffer_binding& in_index_buffer_binding);
     const index_buffer_binding& current_index_buffer_binding() const;
 
+    // source of the draw commands of the *_indirect draw calls
+    void                        bind_draw_indirect_buffer(const buffer_ptr& in_buffer);
+    const buffer_ptr&           current_draw_indirect_buffer() const;
+
     void                        reset_vertex_input();
 
     void                        begin_transform_feedback(const transform_feedback_ptr& in_transform_feedback, primitive_type in_topology_mode);
@@ -242,6 +270,21 @@ public:
 
     void                        multi_draw_arrays(const primitive_topology in_topology, const int* in_first_indices, const int* in_counts, const int draw_count);
 
+    // instanced draw calls, base instances require OpenGL4.2 capabilities
+    void                        draw_arrays_instanced(const primitive_topology in_topology, const int in_first_index, const int in_count,
+                                                      const int in_instance_count, const unsigned in_base_instance = 0);
+    void                        draw_elements_instanced(const int in_count, const int in_start_index, const int in_instance_count,
+                                                        const int in_base_vertex = 0, const unsigned in_base_instance = 0);
+
+    // indirect draw calls, the draw commands are sourced from the bound draw indirect buffer at
+    // in_offset, laid out as draw_arrays_indirect_command or draw_elements_indirect_command
+    //  - the multi draw versions require OpenGL4.3 capabilities, in_stride = 0 means tightly packed
+    void                        draw_arrays_indirect(const primitive_topology in_topology, const scm::size_t in_offset = 0);
+    void                        draw_elements_indirect(const scm::size_t in_offset = 0);
+    void                        multi_draw_arrays_indirect(const primitive_topology in_topology, const scm::size_t in_offset,
+                                                           const int in_draw_count, const int in_stride = 0);
+    void                        multi_draw_elements_indirect(const scm::size_t in_offset, const int in_draw_count, const int in_stride = 0);
+
     bool                        make_resident(const buffer_ptr&     in_buffer,
                                               const access_mode     in_access);
     bool                        make_non_resident(const buffer_ptr& in_buffer);
@@ -296,6 +339,9 @@ public:
                                                    const unsigned           in_level,
                                                    const data_format        in_data_format,
                                                    const void*const         in_data);
+    bool                        retrieve_texture_data(const texture_image_ptr& in_texture,
+                                                      const unsigned           in_level,
+                                                      const size_t             in_offset);
     bool                        retrieve_texture_data(const texture_image_ptr& in_texture,
                                                       const unsigned           in_level,
                                                             void*              in_data);
@@ -393,6 +439,11 @@ public:
 
     void                            reset_state_objects();
     void                            apply_state_objects();
+
+    // pipeline state, sets the program and state objects of in_pipeline, only the
+    // parts differing from the currently bound pipeline are replayed
+    void                            bind_pipeline_state(const pipeline_state_ptr& in_pipeline);
+    const pipeline_state_ptr&       current_pipeline_state() const;
      
     // active queries /////////////////////////////////////////////////////////////////////////////
 public:
@@ -431,8 +482,11 @@ private:
 
     binding_state_type          _current_state;
     binding_state_type          _applied_state;
+    // pipeline_state_delta bits of the state objects set since the last apply_state_objects()
+    unsigned                    _state_objects_delta;
 
     buffer_ptr                  _unpack_buffer;
+    buffer_ptr                  _pack_buffer;
 
     boost::unordered_set<debug_output_ptr>      _debug_outputs;
     bool                                        _debug_synchronous_reporting;
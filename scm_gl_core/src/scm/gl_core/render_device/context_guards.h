@@ -42,6 +42,7 @@ public:
         : _guarded_context(in_context)
         ,  _save_vertex_array(in_context->current_vertex_array())
         ,  _save_index_buffer_binding(in_context->current_index_buffer_binding())
+        ,  _save_draw_indirect_buffer(in_context->current_draw_indirect_buffer())
     {
     }
     ~context_vertex_input_guard()
@@ -52,11 +53,13 @@ public:
     {
         _guarded_context->bind_vertex_array(_save_vertex_array);
         _guarded_context->set_index_buffer_binding(_save_index_buffer_binding);
+        _guarded_context->bind_draw_indirect_buffer(_save_draw_indirect_buffer);
     }
 private:
     const render_context_ptr&   _guarded_context;
     const vertex_array_ptr      _save_vertex_array;
     const render_context::index_buffer_binding _save_index_buffer_binding;
+    const buffer_ptr            _save_draw_indirect_buffer;
 }; // class context_vertex_input_guard
 
 
@@ -144,6 +147,27 @@ private:
     const buffer_ptr            _save_unpack_buffer;
 }; // class context_unpack_buffer_guard
 
+class context_pack_buffer_guard : boost::noncopyable
+{
+public:
+    context_pack_buffer_guard(const render_context_ptr& in_context)
+        : _guarded_context(in_context)
+        , _save_pack_buffer(in_context->current_pack_buffer())
+    {
+    }
+    ~context_pack_buffer_guard()
+    {
+        restore();
+    }
+    void restore()
+    {
+        _guarded_context->bind_pack_buffer(_save_pack_buffer);
+    }
+private:
+    const render_context_ptr&   _guarded_context;
+    const buffer_ptr            _save_pack_buffer;
+}; // class context_pack_buffer_guard
+
 class context_state_objects_guard : boost::noncopyable
 {
 public:
@@ -265,6 +289,7 @@ public:
       , _ac_guard(in_context)
       , _ss_guard(in_context)
       , _up_guard(in_context)
+      , _pp_guard(in_context)
       , _s_guard(in_context)
       , _t_guard(in_context)
       , _i_guard(in_context)
@@ -281,6 +306,7 @@ private:
     context_atomic_counter_buffer_guard _ac_guard;
     context_storage_buffer_guard        _ss_guard;
     context_unpack_buffer_guard         _up_guard;
+    context_pack_buffer_guard           _pp_guard;
     context_state_objects_guard         _s_guard;
     context_texture_units_guard         _t_guard;
     context_image_units_guard           _i_guard;
@@ -50,8 +50,131 @@ struct render_device::mutex_impl
     boost::mutex    _mutex;
 };
 
+namespace {
+
+// descriptor keyed cache of weakly referenced state objects
+template<class desc_type, class state_type>
+class state_cache
+{
+    typedef shared_ptr<state_type>                              state_ptr;
+    typedef boost::unordered_map<desc_type, weak_ptr<state_type>,
+                                 boost::hash<desc_type> >       state_map;
+
+public:
+    state_cache() : _sweep_size(64) {}
+
+    state_ptr find(const desc_type& in_desc) const {
+        typename state_map::const_iterator s = _states.find(in_desc);
+        if (s != _states.end()) {
+            return s->second.lock();
+        }
+        return state_ptr();
+    }
+    // returns the cached state if an equal one was inserted in the meantime
+    state_ptr insert(const desc_type& in_desc, const state_ptr& in_state) {
+        weak_ptr<state_type>& ws = _states[in_desc];
+        state_ptr             cs = ws.lock();
+        if (cs) {
+            return cs;
+        }
+        ws = in_state;
+        if (_states.size() > _sweep_size) {
+            sweep();
+        }
+        return in_state;
+    }
+    std::size_t size() const {
+        return _states.size();
+    }
+
+private:
+    void sweep() {
+        typename state_map::iterator s = _states.begin();
+        while (s != _states.end()) {
+            if (s->second.expired()) {
+                s = _states.erase(s);
+            }
+            else {
+                ++s;
+            }
+        }
+        _sweep_size = (std::max)(std::size_t(64), 2 * _states.size());
+    }
+
+private:
+    state_map       _states;
+    std::size_t     _sweep_size;
+}; // class state_cache
+
+} // namespace
+
+struct render_device::resource_registry
+{
+    struct resource_entry {
+        resource_type   _type;
+        scm::size_t     _bytes;
+    }; // struct resource_entry
+    typedef boost::unordered_map<render_device_resource*, resource_entry> resource_map;
+
+    struct shard {
+        shard() {
+            std::fill(_counts, _counts + RESOURCE_TYPE_COUNT, scm::size_t(0));
+            std::fill(_bytes,  _bytes  + RESOURCE_TYPE_COUNT, scm::size_t(0));
+        }
+        boost::mutex    _mutex;
+        resource_map    _resources;
+        scm::size_t     _counts[RESOURCE_TYPE_COUNT];
+        scm::size_t     _bytes[RESOURCE_TYPE_COUNT];
+    }; // struct shard
+
+    static const unsigned shard_count = 16;
+
+    shard& resource_shard(const render_device_resource* in_resource) {
+        // heap allocations are at least 16 byte aligned
+        const std::size_t p = reinterpret_cast<std::size_t>(in_resource) >> 4;
+        return _shards[(p ^ (p >> 7)) % shard_count];
+    }
+
+    shard           _shards[shard_count];
+}; // struct render_device::resource_registry
+
+namespace {
+
+scm::size_t
+image_bytes(data_format in_format, const math::vec3ui& in_size,
+            unsigned in_mip_levels, unsigned in_layers, unsigned in_samples)
+{
+    const unsigned levels = (in_mip_levels == 0) ? util::max_mip_levels(in_size) : in_mip_levels;
+    const bool     cmpr   = is_compressed_format(in_format);
+    scm::size_t    bytes  = 0;
+
+    for (unsigned l = 0; l < levels; ++l) {
+        math::vec3ui ls = util::mip_level_dimensions(in_size, l);
+        if (cmpr) {
+            ls.x = (ls.x + 3) & ~3u;
+            ls.y = (ls.y + 3) & ~3u;
+        }
+        bytes += (static_cast<scm::size_t>(ls.x) * ls.y * ls.z * bit_per_pixel(in_format)) / 8;
+    }
+
+    return bytes * (std::max)(1u, in_layers) * (std::max)(1u, in_samples);
+}
+
+} // namespace
+
+struct render_device::state_object_cache
+{
+    state_cache<sampler_state_desc,       sampler_state>        _sampler_states;
+    state_cache<depth_stencil_state_desc, depth_stencil_state>  _depth_stencil_states;
+    state_cache<rasterizer_state_desc,    rasterizer_state>     _rasterizer_states;
+    state_cache<blend_state_desc,         blend_state>          _blend_states;
+};
+
 render_device::render_device()
   : _mutex_impl(new mutex_impl)
+  , _state_object_cache(new state_object_cache)
+  , _resource_registry(new resource_registry)
+  , _pipeline_state_serial(0)
 {
     _opengl_api_core.reset(new opengl::gl_core());
 
@@ -116,7 +239,11 @@ render_device::~render_device()
 {
     _main_context.reset();
 
-    assert(0 == _registered_resources.size());
+#ifndef NDEBUG
+    for (int t = 0; t < RESOURCE_TYPE_COUNT; ++t) {
+        assert(0 == registered_resources(static_cast<resource_type>(t))._count);
+    }
+#endif // NDEBUG
 }
 
 const opengl::gl_core&
@@ -393,7 +520,7 @@ render_device::create_buffer(const buffer_desc& in_buffer_desc,
         return buffer_ptr();
     }
     else {
-        register_resource(new_buffer.get());
+        register_resource(new_buffer.get(), RESOURCE_BUFFER, in_buffer_desc._size);
         return new_buffer;
     }
 }
@@ -418,6 +545,7 @@ render_device::resize_buffer(const buffer_ptr& in_buffer, scm::size_t in_size)
         return false;
     }
     else {
+        update_resource(in_buffer.get(), in_size);
         return true;
     }
 }
@@ -856,7 +984,8 @@ render_device::create_program(const shader_list&          in_shaders,
 texture_1d_ptr
 render_device::create_texture_1d(const texture_1d_desc&   in_desc)
 {
-    texture_1d_ptr  new_tex(new texture_1d(*this, in_desc));
+    texture_1d_ptr  new_tex(new texture_1d(*this, in_desc),
+                            boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         if (new_tex->bad()) {
             glerr() << log::error << "render_device::create_texture_1d(): unable to create texture object ("
@@ -869,6 +998,9 @@ render_device::create_texture_1d(const texture_1d_desc&   in_desc)
         return texture_1d_ptr();
     }
     else {
+        const texture_1d_desc& d = new_tex->descriptor();
+        register_resource(new_tex.get(), RESOURCE_TEXTURE,
+                          image_bytes(d._format, math::vec3ui(d._size, 1, 1), d._mip_levels, d._array_layers, 1));
         return new_tex;
     }
 }
@@ -878,7 +1010,8 @@ render_device::create_texture_1d(const texture_1d_desc&    in_desc,
                                  const data_format         in_initial_data_format,
                                  const std::vector<void*>& in_initial_mip_level_data)
 {
-    texture_1d_ptr  new_tex(new texture_1d(*this, in_desc, in_initial_data_format, in_initial_mip_level_data));
+    texture_1d_ptr  new_tex(new texture_1d(*this, in_desc, in_initial_data_format, in_initial_mip_level_data),
+                            boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         if (new_tex->bad()) {
             glerr() << log::error << "render_device::create_texture_1d(): unable to create texture object ("
@@ -891,6 +1024,9 @@ render_device::create_texture_1d(const texture_1d_desc&    in_desc,
         return texture_1d_ptr();
     }
     else {
+        const texture_1d_desc& d = new_tex->descriptor();
+        register_resource(new_tex.get(), RESOURCE_TEXTURE,
+                          image_bytes(d._format, math::vec3ui(d._size, 1, 1), d._mip_levels, d._array_layers, 1));
         return new_tex;
     }
 }
@@ -923,13 +1059,15 @@ render_device::create_texture_1d(const texture_1d_ptr&     in_orig_texture,
                                  const math::vec2ui&       in_mip_range,
                                  const math::vec2ui&       in_layer_range)
 {
-    texture_1d_ptr  new_tex(new texture_1d(*this, *in_orig_texture, in_format, in_mip_range, in_layer_range));
+    texture_1d_ptr  new_tex(new texture_1d(*this, *in_orig_texture, in_format, in_mip_range, in_layer_range),
+                            boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         glerr() << log::error << "render_device::create_texture_1d(): unable to create texture view object ("
                 << new_tex->state().state_string() << ")." << log::end;
         return texture_1d_ptr();
     }
     else {
+        register_resource(new_tex.get(), RESOURCE_TEXTURE, 0);
         return new_tex;
     }
 }
@@ -937,7 +1075,8 @@ render_device::create_texture_1d(const texture_1d_ptr&     in_orig_texture,
 texture_2d_ptr
 render_device::create_texture_2d(const texture_2d_desc&   in_desc)
 {
-    texture_2d_ptr  new_tex(new texture_2d(*this, in_desc));
+    texture_2d_ptr  new_tex(new texture_2d(*this, in_desc),
+                            boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         if (new_tex->bad()) {
             glerr() << log::error << "render_device::create_texture_2d(): unable to create texture object ("
@@ -950,6 +1089,9 @@ render_device::create_texture_2d(const texture_2d_desc&   in_desc)
         return texture_2d_ptr();
     }
     else {
+        const texture_2d_desc& d = new_tex->descriptor();
+        register_resource(new_tex.get(), RESOURCE_TEXTURE,
+                          image_bytes(d._format, math::vec3ui(d._size, 1), d._mip_levels, d._array_layers, d._samples));
         return new_tex;
     }
 }
@@ -959,7 +1101,8 @@ render_device::create_texture_2d(const texture_2d_desc&    in_desc,
                                  const data_format         in_initial_data_format,
                                  const std::vector<void*>& in_initial_mip_level_data)
 {
-    texture_2d_ptr  new_tex(new texture_2d(*this, in_desc, in_initial_data_format, in_initial_mip_level_data));
+    texture_2d_ptr  new_tex(new texture_2d(*this, in_desc, in_initial_data_format, in_initial_mip_level_data),
+                            boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         if (new_tex->bad()) {
             glerr() << log::error << "render_device::create_texture_2d(): unable to create texture object ("
@@ -972,6 +1115,9 @@ render_device::create_texture_2d(const texture_2d_desc&    in_desc,
         return texture_2d_ptr();
     }
     else {
+        const texture_2d_desc& d = new_tex->descriptor();
+        register_resource(new_tex.get(), RESOURCE_TEXTURE,
+                          image_bytes(d._format, math::vec3ui(d._size, 1), d._mip_levels, d._array_layers, d._samples));
         return new_tex;
     }
 }
@@ -1006,13 +1152,15 @@ render_device::create_texture_2d(const texture_2d_ptr&     in_orig_texture,
                                  const math::vec2ui&       in_mip_range,
                                  const math::vec2ui&       in_layer_range)
 {
-    texture_2d_ptr  new_tex(new texture_2d(*this, *in_orig_texture, in_format, in_mip_range, in_layer_range));
+    texture_2d_ptr  new_tex(new texture_2d(*this, *in_orig_texture, in_format, in_mip_range, in_layer_range),
+                            boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         glerr() << log::error << "render_device::create_texture_2d(): unable to create texture view object ("
                 << new_tex->state().state_string() << ")." << log::end;
         return texture_2d_ptr();
     }
     else {
+        register_resource(new_tex.get(), RESOURCE_TEXTURE, 0);
         return new_tex;
     }
 }
@@ -1020,7 +1168,8 @@ render_device::create_texture_2d(const texture_2d_ptr&     in_orig_texture,
 texture_3d_ptr
 render_device::create_texture_3d(const texture_3d_desc&   in_desc)
 {
-    texture_3d_ptr  new_tex(new texture_3d(*this, in_desc));
+    texture_3d_ptr  new_tex(new texture_3d(*this, in_desc),
+                            boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         if (new_tex->bad()) {
             glerr() << log::error << "render_device::create_texture_3d(): unable to create texture object ("
@@ -1033,6 +1182,9 @@ render_device::create_texture_3d(const texture_3d_desc&   in_desc)
         return texture_3d_ptr();
     }
     else {
+        const texture_3d_desc& d = new_tex->descriptor();
+        register_resource(new_tex.get(), RESOURCE_TEXTURE,
+                          image_bytes(d._format, d._size, d._mip_levels, 1, 1));
         return new_tex;
     }
 }
@@ -1042,7 +1194,8 @@ render_device::create_texture_3d(const texture_3d_desc&    in_desc,
                                  const data_format         in_initial_data_format,
                                  const std::vector<void*>& in_initial_mip_level_data)
 {
-    texture_3d_ptr  new_tex(new texture_3d(*this, in_desc, in_initial_data_format, in_initial_mip_level_data));
+    texture_3d_ptr  new_tex(new texture_3d(*this, in_desc, in_initial_data_format, in_initial_mip_level_data),
+                            boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         if (new_tex->bad()) {
             glerr() << log::error << "render_device::create_texture_3d(): unable to create texture object ("
@@ -1055,6 +1208,9 @@ render_device::create_texture_3d(const texture_3d_desc&    in_desc,
         return texture_3d_ptr();
     }
     else {
+        const texture_3d_desc& d = new_tex->descriptor();
+        register_resource(new_tex.get(), RESOURCE_TEXTURE,
+                          image_bytes(d._format, d._size, d._mip_levels, 1, 1));
         return new_tex;
     }
 }
@@ -1084,13 +1240,15 @@ render_device::create_texture_3d(const texture_3d_ptr&     in_orig_texture,
                                  const data_format         in_format,
                                  const math::vec2ui&       in_mip_range)
 {
-    texture_3d_ptr  new_tex(new texture_3d(*this, *in_orig_texture, in_format, in_mip_range));
+    texture_3d_ptr  new_tex(new texture_3d(*this, *in_orig_texture, in_format, in_mip_range),
+                            boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         glerr() << log::error << "render_device::create_texture_3d(): unable to create texture view object ("
                 << new_tex->state().state_string() << ")." << log::end;
         return texture_3d_ptr();
     }
     else {
+        register_resource(new_tex.get(), RESOURCE_TEXTURE, 0);
         return new_tex;
     }
 }
@@ -1098,7 +1256,8 @@ render_device::create_texture_3d(const texture_3d_ptr&     in_orig_texture,
 texture_cube_ptr
 render_device::create_texture_cube(const texture_cube_desc&   in_desc)
 {
-    texture_cube_ptr  new_tex(new texture_cube(*this, in_desc));
+    texture_cube_ptr  new_tex(new texture_cube(*this, in_desc),
+                              boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         if (new_tex->bad()) {
             glerr() << log::error << "render_device::create_texture_cube(): unable to create texture object ("
@@ -1111,6 +1270,9 @@ render_device::create_texture_cube(const texture_cube_desc&   in_desc)
         return texture_cube_ptr();
     }
     else {
+        const texture_cube_desc& d = new_tex->descriptor();
+        register_resource(new_tex.get(), RESOURCE_TEXTURE,
+                          image_bytes(d._format, math::vec3ui(d._size, 1), d._mip_levels, 6, 1));
         return new_tex;
     }
 }
@@ -1131,7 +1293,8 @@ render_device::create_texture_cube(const texture_cube_desc&    in_desc,
                                                  in_initial_mip_level_data_py,
                                                  in_initial_mip_level_data_ny,
                                                  in_initial_mip_level_data_pz,
-                                                 in_initial_mip_level_data_nz));
+                                                 in_initial_mip_level_data_nz),
+                              boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         if (new_tex->bad()) {
             glerr() << log::error << "render_device::create_texture_cube(): unable to create texture object ("
@@ -1144,6 +1307,9 @@ render_device::create_texture_cube(const texture_cube_desc&    in_desc,
         return texture_cube_ptr();
     }
     else {
+        const texture_cube_desc& d = new_tex->descriptor();
+        register_resource(new_tex.get(), RESOURCE_TEXTURE,
+                          image_bytes(d._format, math::vec3ui(d._size, 1), d._mip_levels, 6, 1));
         return new_tex;
     }
 } 
@@ -1181,7 +1347,8 @@ render_device::create_texture_cube(const math::vec2ui&       in_size,
 texture_buffer_ptr
 render_device::create_texture_buffer(const texture_buffer_desc& in_desc)
 {
-    texture_buffer_ptr  new_tex(new texture_buffer(*this, in_desc));
+    texture_buffer_ptr  new_tex(new texture_buffer(*this, in_desc),
+                                boost::bind(&render_device::release_resource, this, _1));
     if (new_tex->fail()) {
         if (new_tex->bad()) {
             glerr() << log::error << "render_device::create_texture_buffer(): unable to create texture buffer object ("
@@ -1194,6 +1361,7 @@ render_device::create_texture_buffer(const texture_buffer_desc& in_desc)
         return texture_buffer_ptr();
     }
     else {
+        register_resource(new_tex.get(), RESOURCE_TEXTURE, 0);
         return new_tex;
     }
 }
@@ -1226,13 +1394,15 @@ render_device::create_resident_handle(const texture_ptr&       in_texture,
     assert(in_texture);
     assert(in_sampler);
 
-    texture_handle_ptr new_tex_handle(new texture_handle(*this, *in_texture, *in_sampler));
+    texture_handle_ptr new_tex_handle(new texture_handle(*this, *in_texture, *in_sampler),
+                                      boost::bind(&render_device::release_resource, this, _1));
     if (new_tex_handle->fail()) {
         glerr() << log::error << "render_device::create_resident_handle(): unable to create texture handle ("
                 << new_tex_handle->state().state_string() << ")." << log::end;
         return texture_handle_ptr();
     }
     else {
+        register_resource(new_tex_handle.get(), RESOURCE_TEXTURE_HANDLE, 0);
         return new_tex_handle;
     }
 }
@@ -1240,6 +1410,13 @@ render_device::create_resident_handle(const texture_ptr&       in_texture,
 sampler_state_ptr
 render_device::create_sampler_state(const sampler_state_desc& in_desc)
 {
+    {
+        boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+        if (sampler_state_ptr cached_sstate = _state_object_cache->_sampler_states.find(in_desc)) {
+            return cached_sstate;
+        }
+    }
+
     sampler_state_ptr  new_sstate(new sampler_state(*this, in_desc));
     if (new_sstate->fail()) {
         if (new_sstate->bad()) {
@@ -1249,7 +1426,8 @@ render_device::create_sampler_state(const sampler_state_desc& in_desc)
         return sampler_state_ptr();
     }
     else {
-        return new_sstate;
+        boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+        return _state_object_cache->_sampler_states.insert(in_desc, new_sstate);
     }
 }
 
@@ -1287,7 +1465,8 @@ render_device::create_sampler_state(texture_filter_mode  in_filter,
 render_buffer_ptr
 render_device::create_render_buffer(const render_buffer_desc& in_desc)
 {
-    render_buffer_ptr  new_rb(new render_buffer(*this, in_desc));
+    render_buffer_ptr  new_rb(new render_buffer(*this, in_desc),
+                              boost::bind(&render_device::release_resource, this, _1));
     if (new_rb->fail()) {
         if (new_rb->bad()) {
             glerr() << log::error << "render_device::create_render_buffer(): unable to create render buffer object ("
@@ -1296,6 +1475,9 @@ render_device::create_render_buffer(const render_buffer_desc& in_desc)
         return render_buffer_ptr();
     }
     else {
+        const render_buffer_desc& d = new_rb->descriptor();
+        register_resource(new_rb.get(), RESOURCE_RENDER_BUFFER,
+                          image_bytes(d._format, math::vec3ui(d._size, 1), 1, 1, d._samples));
         return new_rb;
     }
 }
@@ -1327,8 +1509,13 @@ render_device::create_frame_buffer()
 depth_stencil_state_ptr
 render_device::create_depth_stencil_state(const depth_stencil_state_desc& in_desc)
 {
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+    if (depth_stencil_state_ptr cached_ds_state = _state_object_cache->_depth_stencil_states.find(in_desc)) {
+        return cached_ds_state;
+    }
+
     depth_stencil_state_ptr new_ds_state(new depth_stencil_state(*this, in_desc));
-    return new_ds_state;
+    return _state_object_cache->_depth_stencil_states.insert(in_desc, new_ds_state);
 }
 
 depth_stencil_state_ptr
@@ -1354,8 +1541,13 @@ render_device::create_depth_stencil_state(bool in_depth_test, bool in_depth_mask
 rasterizer_state_ptr
 render_device::create_rasterizer_state(const rasterizer_state_desc& in_desc)
 {
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+    if (rasterizer_state_ptr cached_r_state = _state_object_cache->_rasterizer_states.find(in_desc)) {
+        return cached_r_state;
+    }
+
     rasterizer_state_ptr new_r_state(new rasterizer_state(*this, in_desc));
-    return new_r_state;
+    return _state_object_cache->_rasterizer_states.insert(in_desc, new_r_state);
 }
 
 rasterizer_state_ptr
@@ -1371,8 +1563,13 @@ render_device::create_rasterizer_state(fill_mode in_fmode, cull_mode in_cmode, p
 blend_state_ptr
 render_device::create_blend_state(const blend_state_desc& in_desc)
 {
+    boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+    if (blend_state_ptr cached_bl_state = _state_object_cache->_blend_states.find(in_desc)) {
+        return cached_bl_state;
+    }
+
     blend_state_ptr new_bl_state(new blend_state(*this, in_desc));
-    return new_bl_state;
+    return _state_object_cache->_blend_states.insert(in_desc, new_bl_state);
 }
 
 blend_state_ptr
@@ -1395,6 +1592,36 @@ render_device::create_blend_state(const blend_ops_array& in_blend_ops, bool in_a
     return create_blend_state(blend_state_desc(in_blend_ops, in_alpha_to_coverage));
 }
 
+pipeline_state_ptr
+render_device::create_pipeline_state(const pipeline_state_desc& in_desc)
+{
+    if (!in_desc._program) {
+        glerr() << log::error << "render_device::create_pipeline_state(): invalid program." << log::end;
+        return pipeline_state_ptr();
+    }
+
+    pipeline_state_desc desc(in_desc);
+
+    if (!desc._depth_stencil_state) {
+        desc._depth_stencil_state = create_depth_stencil_state(depth_stencil_state_desc());
+    }
+    if (!desc._rasterizer_state) {
+        desc._rasterizer_state = create_rasterizer_state(rasterizer_state_desc());
+    }
+    if (!desc._blend_state) {
+        desc._blend_state = create_blend_state(blend_state_desc());
+    }
+
+    scm::uint64 serial = 0;
+    {
+        boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+        serial = ++_pipeline_state_serial;
+    }
+
+    pipeline_state_ptr new_pl_state(new pipeline_state(*this, desc, serial));
+    return new_pl_state;
+}
+
 // query api //////////////////////////////////////////////////////////////////////////////////////
 timer_query_ptr
 render_device::create_timer_query()
@@ -1451,6 +1678,27 @@ render_device::dump_memory_info(std::ostream& os) const
     const opengl::gl_core& glcore = opengl_api();
     util::gl_error         glerror(glcore);
 
+    { // registered resources, locks only one registry shard at a time
+        static const char* type_names[RESOURCE_TYPE_COUNT] = {
+            "buffers        ",
+            "textures       ",
+            "render buffers ",
+            "texture handles"
+        };
+        resource_usage total;
+
+        os << std::fixed << std::setprecision(3);
+        for (int t = 0; t < RESOURCE_TYPE_COUNT; ++t) {
+            resource_usage ru = registered_resources(static_cast<resource_type>(t));
+            total._count += ru._count;
+            total._bytes += ru._bytes;
+            os << type_names[t] << "         : " << ru._count << " ("
+               << static_cast<double>(ru._bytes) / (1024.0 * 1024.0) << "MiB)" << std::endl;
+        }
+        os << "total registered        : " << total._count << " ("
+           << static_cast<double>(total._bytes) / (1024.0 * 1024.0) << "MiB)" << std::endl;
+    }
+
     if (!glcore.extension_NVX_gpu_memory_info) {
         glout() << log::warning << "render_device::dump_memory_info(): "
                 << "shader includes not supported (GL_NVX_gpu_memory_info unsupported), ignoring call." << log::end;
@@ -1601,28 +1849,74 @@ render_device::cuda_interop_device() const
 #endif
 
 void
-render_device::register_resource(render_device_resource* res_ptr)
+render_device::register_resource(render_device_resource* res_ptr,
+                                 resource_type           in_type,
+                                 scm::size_t             in_bytes)
 {
-    { // protect this function from multiple thread access
-        boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+    resource_registry::shard& s = _resource_registry->resource_shard(res_ptr);
+
+    { // protect this shard from multiple thread access
+        boost::mutex::scoped_lock lock(s._mutex);
+
+        resource_registry::resource_entry e = { in_type, in_bytes };
+        if (s._resources.insert(resource_registry::resource_map::value_type(res_ptr, e)).second) {
+            s._counts[in_type] += 1;
+            s._bytes[in_type]  += in_bytes;
+        }
+    }
+}
 
-        _registered_resources.insert(res_ptr);
+void
+render_device::update_resource(render_device_resource* res_ptr,
+                               scm::size_t             in_bytes)
+{
+    resource_registry::shard& s = _resource_registry->resource_shard(res_ptr);
+
+    { // protect this shard from multiple thread access
+        boost::mutex::scoped_lock lock(s._mutex);
+
+        resource_registry::resource_map::iterator r = s._resources.find(res_ptr);
+        if (r != s._resources.end()) {
+            s._bytes[r->second._type] -= r->second._bytes;
+            s._bytes[r->second._type] += in_bytes;
+            r->second._bytes           = in_bytes;
+        }
     }
 }
 
 void
 render_device::release_resource(render_device_resource* res_ptr)
 {
-    { // protect this function from multiple thread access
-        boost::mutex::scoped_lock lock(_mutex_impl->_mutex);
+    resource_registry::shard& s = _resource_registry->resource_shard(res_ptr);
+
+    { // protect this shard from multiple thread access
+        boost::mutex::scoped_lock lock(s._mutex);
 
-        resource_ptr_set::iterator res_iter = _registered_resources.find(res_ptr);
-        if (res_iter != _registered_resources.end()) {
-            _registered_resources.erase(res_iter);
+        resource_registry::resource_map::iterator r = s._resources.find(res_ptr);
+        if (r != s._resources.end()) {
+            s._counts[r->second._type] -= 1;
+            s._bytes[r->second._type]  -= r->second._bytes;
+            s._resources.erase(r);
         }
+    }
+
+    delete res_ptr;
+}
+
+render_device::resource_usage
+render_device::registered_resources(resource_type in_type) const
+{
+    resource_usage ru;
 
-        delete res_ptr;
+    for (unsigned i = 0; i < resource_registry::shard_count; ++i) {
+        resource_registry::shard& s = _resource_registry->_shards[i];
+        boost::mutex::scoped_lock lock(s._mutex);
+
+        ru._count += s._counts[in_type];
+        ru._bytes += s._bytes[in_type];
     }
+
+    return ru;
 }
 
 std::ostream& operator<<(std::ostream& os, const render_device& ren_dev)
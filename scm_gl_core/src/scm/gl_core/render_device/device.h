@@ -27,6 +27,7 @@
 #include <scm/gl_core/shader_objects/shader_macro.h>
 #include <scm/gl_core/state_objects/blend_state.h>
 #include <scm/gl_core/state_objects/depth_stencil_state.h>
+#include <scm/gl_core/state_objects/pipeline_state.h>
 #include <scm/gl_core/state_objects/rasterizer_state.h>
 
 #include <scm/core/platform/platform.h>
@@ -113,9 +114,22 @@ public:
         int64           _shader_storage_buffer_offset_alignment;
     }; // struct device_capabilities
 
-protected:
-    typedef boost::unordered_set<render_device_resource*>   resource_ptr_set;
+    enum resource_type {
+        RESOURCE_BUFFER         = 0x00,
+        RESOURCE_TEXTURE,
+        RESOURCE_RENDER_BUFFER,
+        RESOURCE_TEXTURE_HANDLE,
+
+        RESOURCE_TYPE_COUNT
+    }; // enum resource_type
 
+    struct resource_usage {
+        resource_usage() : _count(0), _bytes(0) {}
+        scm::size_t     _count;
+        scm::size_t     _bytes;     // allocated storage, texture views share their storage
+    }; // struct resource_usage
+
+protected:
     typedef boost::unordered_map<std::string, shader_macro> shader_macro_map;
     typedef std::set<std::string>                           string_set;
 
@@ -143,8 +157,14 @@ public:
 protected:
     void                            init_capabilities();
 
-    void                            register_resource(render_device_resource* res_ptr);
-    void                            release_resource(render_device_resource* res_ptr);
+    // the resource registry is split into independently locked shards, the per type
+    // counts and sizes are kept per shard and summed up on request
+    void                            register_resource(render_device_resource* res_ptr,
+                                                      resource_type           in_type,
+                                                      scm::size_t             in_bytes);
+    void                            update_resource(render_device_resource*   res_ptr,
+                                                    scm::size_t               in_bytes);
+    void                            release_resource(render_device_resource*  res_ptr);
 
     // buffer api /////////////////////////////////////////////////////////////////////////////////
 public:
@@ -338,6 +358,8 @@ public:
 
 
     // state api //////////////////////////////////////////////////////////////////////////////////
+    //  - state objects are cached by descriptor, equal descriptors return the same
+    //    state object as long as it is referenced somewhere outside the device
 public:
     depth_stencil_state_ptr         create_depth_stencil_state(const depth_stencil_state_desc& in_desc);
     depth_stencil_state_ptr         create_depth_stencil_state(bool in_depth_test, bool in_depth_mask = true, compare_func in_depth_func = COMPARISON_LESS,
@@ -361,6 +383,9 @@ public:
                                                        unsigned in_write_mask = COLOR_ALL, bool in_alpha_to_coverage = false);
     blend_state_ptr                 create_blend_state(const blend_ops_array& in_blend_ops, bool in_alpha_to_coverage = false);
 
+    // missing state objects in in_desc are replaced by default state objects
+    pipeline_state_ptr              create_pipeline_state(const pipeline_state_desc& in_desc);
+
     // query api //////////////////////////////////////////////////////////////////////////////////
 public:
     timer_query_ptr                 create_timer_query();
@@ -370,6 +395,7 @@ public:
     // debug //////////////////////////////////////////////////////////////////////////////////////
 public:
     void                            dump_memory_info(std::ostream& os) const;
+    resource_usage                  registered_resources(resource_type in_type) const;
 
 #if SCM_ENABLE_CUDA_CL_SUPPORT
     // compute interop ////////////////////////////////////////////////////////////////////////////
@@ -386,6 +412,10 @@ protected:
     // device /////////////////////////////////////////////////////////////////////////////////////
     struct mutex_impl;
     shared_ptr<mutex_impl>          _mutex_impl;
+    struct state_object_cache;
+    shared_ptr<state_object_cache>  _state_object_cache;
+    struct resource_registry;
+    shared_ptr<resource_registry>   _resource_registry;
 
     // device /////////////////////////////////////////////////////////////////////////////////////
     shared_ptr<opengl::gl_core>     _opengl_api_core;
@@ -396,7 +426,9 @@ protected:
     string_set                      _default_include_paths;
 
     device_capabilities             _capabilities;
-    resource_ptr_set                _registered_resources;
+
+    // state api //////////////////////////////////////////////////////////////////////////////////
+    scm::uint64                     _pipeline_state_serial;
 
 #if SCM_ENABLE_CUDA_CL_SUPPORT
     // compute interop ////////////////////////////////////////////////////////////////////////////
@@ -35,6 +35,7 @@ unsigned gl_texture_compare_mode(const texture_compare_mode s);
 unsigned gl_framebuffer_binding(const frame_buffer_binding s);
 unsigned gl_framebuffer_binding_point(const frame_buffer_binding s);
 unsigned gl_frame_buffer_target(const frame_buffer_target s);
+unsigned gl_memory_barrier_bits(unsigned in_barriers);
 
 debug_source    gl_to_debug_source(unsigned s);
 debug_type      gl_to_debug_type(unsigned t);
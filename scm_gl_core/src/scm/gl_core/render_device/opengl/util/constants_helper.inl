@@ -27,6 +27,7 @@ gl_buffer_targets(const buffer_binding b)
         case BIND_TRANSFORM_FEEDBACK_BUFFER:    return GL_TRANSFORM_FEEDBACK_BUFFER;
         case BIND_ATOMIC_COUNTER_BUFFER:        return GL_ATOMIC_COUNTER_BUFFER;
         case BIND_STORAGE_BUFFER:               return GL_SHADER_STORAGE_BUFFER;
+        case BIND_DRAW_INDIRECT_BUFFER:         return GL_DRAW_INDIRECT_BUFFER;
         default:                                return 0;
     }
 }
@@ -46,6 +47,7 @@ gl_buffer_bindings(const buffer_binding b)
         case BIND_TRANSFORM_FEEDBACK_BUFFER:    return GL_TRANSFORM_FEEDBACK_BUFFER_BINDING;
         case BIND_ATOMIC_COUNTER_BUFFER:        return GL_ATOMIC_COUNTER_BUFFER_BINDING;
         case BIND_STORAGE_BUFFER:               return GL_SHADER_STORAGE_BUFFER_BINDING;
+        case BIND_DRAW_INDIRECT_BUFFER:         return GL_DRAW_INDIRECT_BUFFER_BINDING;
         default:                                return 0;
     }
 }
@@ -529,6 +531,40 @@ gl_frame_buffer_target(const frame_buffer_target s)
     return framebuffer_targets[s];
 }
 
+inline
+unsigned
+gl_memory_barrier_bits(unsigned in_barriers)
+{
+    static unsigned barrier_bits[] = {
+        GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT,     // BARRIER_VERTEX_ATTRIB_ARRAY   = 0x0001,
+        GL_ELEMENT_ARRAY_BARRIER_BIT,           // BARRIER_ELEMENT_ARRAY         = 0x0002,
+        GL_UNIFORM_BARRIER_BIT,                 // BARRIER_UNIFORM               = 0x0004,
+        GL_TEXTURE_FETCH_BARRIER_BIT,           // BARRIER_TEXTURE_FETCH         = 0x0008,
+        GL_SHADER_IMAGE_ACCESS_BARRIER_BIT,     // BARRIER_SHADER_IMAGE_ACCESS   = 0x0010,
+        GL_COMMAND_BARRIER_BIT,                 // BARRIER_COMMAND               = 0x0020,
+        GL_PIXEL_BUFFER_BARRIER_BIT,            // BARRIER_PIXEL_BUFFER          = 0x0040,
+        GL_TEXTURE_UPDATE_BARRIER_BIT,          // BARRIER_TEXTURE_UPDATE        = 0x0080,
+        GL_BUFFER_UPDATE_BARRIER_BIT,           // BARRIER_BUFFER_UPDATE         = 0x0100,
+        GL_FRAMEBUFFER_BARRIER_BIT,             // BARRIER_FRAMEBUFFER           = 0x0200,
+        GL_TRANSFORM_FEEDBACK_BARRIER_BIT,      // BARRIER_TRANSFORM_FEEDBACK    = 0x0400,
+        GL_ATOMIC_COUNTER_BARRIER_BIT,          // BARRIER_ATOMIC_COUNTER        = 0x0800,
+        GL_SHADER_STORAGE_BARRIER_BIT           // BARRIER_SHADER_STORAGE        = 0x1000,
+    };
+
+    if (BARRIER_ALL == (in_barriers & BARRIER_ALL)) {
+        return GL_ALL_BARRIER_BITS;
+    }
+
+    unsigned gl_bits = 0u;
+    for (unsigned b = 0; b < (sizeof(barrier_bits) / sizeof(unsigned)); ++b) {
+        if (0 != (in_barriers & (1u << b))) {
+            gl_bits |= barrier_bits[b];
+        }
+    }
+
+    return gl_bits;
+}
+
 inline
 debug_source
 gl_to_debug_source(unsigned s)
@@ -8,6 +8,7 @@
 #include <scm/gl_core/state_objects/state_objects_fwd.h>
 #include <scm/gl_core/state_objects/blend_state.h>
 #include <scm/gl_core/state_objects/depth_stencil_state.h>
+#include <scm/gl_core/state_objects/pipeline_state.h>
 #include <scm/gl_core/state_objects/rasterizer_state.h>
 #include <scm/gl_core/state_objects/sampler_state.h>
 
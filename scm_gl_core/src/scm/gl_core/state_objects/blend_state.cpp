@@ -6,6 +6,8 @@
 
 #include <cassert>
 
+#include <boost/functional/hash.hpp>
+
 #include <scm/core/math.h>
 
 #include <scm/gl_core/config.h>
@@ -183,6 +185,38 @@ blend_state_desc::blend_state_desc(const blend_ops_array& in_blend_ops,
     assert(0 < _blend_ops.size());
 }
 
+bool
+blend_state_desc::operator==(const blend_state_desc& rhs) const
+{
+    return (   (_blend_ops         == rhs._blend_ops)
+            && (_alpha_to_coverage == rhs._alpha_to_coverage));
+}
+
+bool
+blend_state_desc::operator!=(const blend_state_desc& rhs) const
+{
+    return !(*this == rhs);
+}
+
+std::size_t
+hash_value(const blend_state_desc& in_desc)
+{
+    std::size_t h = 0;
+    boost::hash_combine(h, in_desc._alpha_to_coverage);
+    for (std::size_t i = 0; i < in_desc._blend_ops.size(); ++i) {
+        const blend_ops& o = in_desc._blend_ops[static_cast<int>(i)];
+        boost::hash_combine(h, o._enabled);
+        boost::hash_combine(h, static_cast<int>(o._src_rgb_func));
+        boost::hash_combine(h, static_cast<int>(o._dst_rgb_func));
+        boost::hash_combine(h, static_cast<int>(o._rgb_equation));
+        boost::hash_combine(h, static_cast<int>(o._src_alpha_func));
+        boost::hash_combine(h, static_cast<int>(o._dst_alpha_func));
+        boost::hash_combine(h, static_cast<int>(o._alpha_equation));
+        boost::hash_combine(h, o._write_mask);
+    }
+    return h;
+}
+
 blend_state::blend_state(      render_device&    in_device,
                          const blend_state_desc& in_desc)
   : render_device_child(in_device),
@@ -6,6 +6,8 @@
 
 #include <cassert>
 
+#include <boost/functional/hash.hpp>
+
 #include <scm/gl_core/config.h>
 #include <scm/gl_core/render_device/context.h>
 #include <scm/gl_core/render_device/device.h>
@@ -76,6 +78,46 @@ depth_stencil_state_desc::depth_stencil_state_desc(bool in_depth_test, bool in_d
 {
 }
 
+bool
+depth_stencil_state_desc::operator==(const depth_stencil_state_desc& rhs) const
+{
+    return (   (_depth_test        == rhs._depth_test)
+            && (_depth_mask        == rhs._depth_mask)
+            && (_depth_func        == rhs._depth_func)
+            && (_stencil_test      == rhs._stencil_test)
+            && (_stencil_rmask     == rhs._stencil_rmask)
+            && (_stencil_wmask     == rhs._stencil_wmask)
+            && (_stencil_front_ops == rhs._stencil_front_ops)
+            && (_stencil_back_ops  == rhs._stencil_back_ops));
+}
+
+bool
+depth_stencil_state_desc::operator!=(const depth_stencil_state_desc& rhs) const
+{
+    return !(*this == rhs);
+}
+
+std::size_t
+hash_value(const depth_stencil_state_desc& in_desc)
+{
+    std::size_t h = 0;
+    boost::hash_combine(h, in_desc._depth_test);
+    boost::hash_combine(h, in_desc._depth_mask);
+    boost::hash_combine(h, static_cast<int>(in_desc._depth_func));
+    boost::hash_combine(h, in_desc._stencil_test);
+    boost::hash_combine(h, in_desc._stencil_rmask);
+    boost::hash_combine(h, in_desc._stencil_wmask);
+
+    const stencil_ops* ops[2] = { &in_desc._stencil_front_ops, &in_desc._stencil_back_ops };
+    for (int i = 0; i < 2; ++i) {
+        boost::hash_combine(h, static_cast<int>(ops[i]->_stencil_func));
+        boost::hash_combine(h, static_cast<int>(ops[i]->_stencil_sfail));
+        boost::hash_combine(h, static_cast<int>(ops[i]->_stencil_dfail));
+        boost::hash_combine(h, static_cast<int>(ops[i]->_stencil_dpass));
+    }
+    return h;
+}
+
 depth_stencil_state::depth_stencil_state(render_device&                  in_device,
                                          const depth_stencil_state_desc& in_desc)
   : render_device_child(in_device),
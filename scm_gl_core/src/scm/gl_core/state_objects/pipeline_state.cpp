@@ -0,0 +1,141 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "pipeline_state.h"
+
+#include <cassert>
+
+#include <boost/functional/hash.hpp>
+
+#include <scm/gl_core/render_device/device.h>
+
+namespace {
+
+template<typename T>
+inline std::size_t
+ptr_value(const scm::shared_ptr<T>& p)
+{
+    return reinterpret_cast<std::size_t>(p.get());
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+// pipeline_state /////////////////////////////////////////////////////////////////////////////////
+
+pipeline_state_desc::pipeline_state_desc(const program_ptr&             in_program,
+                                         const depth_stencil_state_ptr& in_depth_stencil_state,
+                                         const rasterizer_state_ptr&    in_rasterizer_state,
+                                         const blend_state_ptr&         in_blend_state)
+  : _program(in_program)
+  , _depth_stencil_state(in_depth_stencil_state)
+  , _stencil_ref(0)
+  , _rasterizer_state(in_rasterizer_state)
+  , _line_width(1.0f)
+  , _point_size(1.0f)
+  , _blend_state(in_blend_state)
+  , _blend_color(1.0f, 1.0f, 1.0f, 1.0f)
+{
+}
+
+pipeline_state::pipeline_state(render_device&             in_device,
+                               const pipeline_state_desc& in_desc,
+                               scm::uint64                in_serial)
+  : render_device_child(in_device)
+  , _descriptor(in_desc)
+  , _hash(0)
+  , _serial(in_serial)
+  , _delta_cache_next(0)
+{
+    boost::hash_combine(_hash, ptr_value(_descriptor._program));
+    boost::hash_combine(_hash, ptr_value(_descriptor._depth_stencil_state));
+    boost::hash_combine(_hash, _descriptor._stencil_ref);
+    boost::hash_combine(_hash, ptr_value(_descriptor._rasterizer_state));
+    boost::hash_combine(_hash, _descriptor._line_width);
+    boost::hash_combine(_hash, _descriptor._point_size);
+    boost::hash_combine(_hash, ptr_value(_descriptor._blend_state));
+    for (unsigned c = 0; c < 4; ++c) {
+        boost::hash_combine(_hash, _descriptor._blend_color[c]);
+    }
+
+    for (unsigned i = 0; i < delta_cache_size; ++i) {
+        _delta_cache[i]._from_serial = 0;
+        _delta_cache[i]._delta       = PIPELINE_DELTA_ALL;
+    }
+}
+
+pipeline_state::~pipeline_state()
+{
+}
+
+const pipeline_state_desc&
+pipeline_state::descriptor() const
+{
+    return _descriptor;
+}
+
+std::size_t
+pipeline_state::hash() const
+{
+    return _hash;
+}
+
+scm::uint64
+pipeline_state::serial() const
+{
+    return _serial;
+}
+
+unsigned
+pipeline_state::delta(const pipeline_state& in_from) const
+{
+    if (&in_from == this) {
+        return PIPELINE_DELTA_NONE;
+    }
+    // serials start at 1, unused entries never match
+    for (unsigned i = 0; i < delta_cache_size; ++i) {
+        if (_delta_cache[i]._from_serial == in_from._serial) {
+            return _delta_cache[i]._delta;
+        }
+    }
+
+    unsigned d = compute_delta(in_from);
+
+    _delta_cache[_delta_cache_next]._from_serial = in_from._serial;
+    _delta_cache[_delta_cache_next]._delta       = d;
+    _delta_cache_next = (_delta_cache_next + 1) % delta_cache_size;
+
+    return d;
+}
+
+unsigned
+pipeline_state::compute_delta(const pipeline_state& in_from) const
+{
+    const pipeline_state_desc& f = in_from._descriptor;
+    unsigned                   d = PIPELINE_DELTA_NONE;
+
+    if (_descriptor._program != f._program) {
+        d |= PIPELINE_DELTA_PROGRAM;
+    }
+    if (   _descriptor._depth_stencil_state != f._depth_stencil_state
+        || _descriptor._stencil_ref         != f._stencil_ref) {
+        d |= PIPELINE_DELTA_DEPTH_STENCIL;
+    }
+    if (   _descriptor._rasterizer_state != f._rasterizer_state
+        || _descriptor._line_width       != f._line_width
+        || _descriptor._point_size       != f._point_size) {
+        d |= PIPELINE_DELTA_RASTERIZER;
+    }
+    if (   _descriptor._blend_state != f._blend_state
+        || _descriptor._blend_color != f._blend_color) {
+        d |= PIPELINE_DELTA_BLEND;
+    }
+
+    return d;
+}
+
+} // namespace gl
+} // namespace scm
@@ -0,0 +1,105 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_CORE_PIPELINE_STATE_H_INCLUDED
+#define SCM_GL_CORE_PIPELINE_STATE_H_INCLUDED
+
+#include <cstddef>
+
+#include <scm/core/math.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/constants.h>
+#include <scm/gl_core/gl_core_fwd.h>
+#include <scm/gl_core/render_device/device_child.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+enum pipeline_state_delta {
+    PIPELINE_DELTA_NONE             = 0x00,
+    PIPELINE_DELTA_PROGRAM          = 0x01,
+    PIPELINE_DELTA_DEPTH_STENCIL    = 0x02,     // state object or stencil reference
+    PIPELINE_DELTA_RASTERIZER       = 0x04,     // state object, line width or point size
+    PIPELINE_DELTA_BLEND            = 0x08,     // state object or blend color
+
+    PIPELINE_DELTA_STATE_OBJECTS    = 0x0e,
+    PIPELINE_DELTA_ALL              = 0x0f
+}; // enum pipeline_state_delta
+
+struct __scm_export(gl_core) pipeline_state_desc {
+    pipeline_state_desc(const program_ptr&             in_program             = program_ptr(),
+                        const depth_stencil_state_ptr& in_depth_stencil_state = depth_stencil_state_ptr(),
+                        const rasterizer_state_ptr&    in_rasterizer_state    = rasterizer_state_ptr(),
+                        const blend_state_ptr&         in_blend_state         = blend_state_ptr());
+
+    program_ptr                 _program;
+    depth_stencil_state_ptr     _depth_stencil_state;
+    unsigned                    _stencil_ref;
+    rasterizer_state_ptr        _rasterizer_state;
+    float                       _line_width;
+    float                       _point_size;
+    blend_state_ptr             _blend_state;
+    math::vec4f                 _blend_color;
+}; // struct pipeline_state_desc
+
+// immutable combination of program and state objects
+//  - created through render_device::create_pipeline_state, missing state
+//    objects are replaced by the default state objects of the device
+//  - render_context::bind_pipeline_state switches between pipelines by
+//    replaying the delta against the previously bound pipeline, the deltas
+//    to the last few pipelines switched from are cached per pipeline. only
+//    the state objects of the delta are compared again when the context
+//    applies its state
+//  - vertex arrays are not part of the pipeline, they are bound per mesh
+//    with render_context::bind_vertex_array without affecting the pipeline
+//  - the delta cache is not synchronized, a pipeline is expected to be
+//    switched to from a single context at a time
+class __scm_export(gl_core) pipeline_state : public render_device_child
+{
+protected:
+    struct delta_entry {
+        scm::uint64             _from_serial;
+        unsigned                _delta;
+    }; // struct delta_entry
+    static const unsigned       delta_cache_size = 8;
+
+public:
+    virtual ~pipeline_state();
+
+    const pipeline_state_desc&  descriptor() const;
+    std::size_t                 hash() const;
+    scm::uint64                 serial() const;
+
+    // combination of pipeline_state_delta bits for switching from in_from to this pipeline
+    unsigned                    delta(const pipeline_state& in_from) const;
+    unsigned                    compute_delta(const pipeline_state& in_from) const;
+
+protected:
+    pipeline_state(render_device&             in_device,
+                   const pipeline_state_desc& in_desc,
+                   scm::uint64                in_serial);
+
+protected:
+    pipeline_state_desc         _descriptor;
+    std::size_t                 _hash;
+    scm::uint64                 _serial;
+
+    mutable delta_entry         _delta_cache[delta_cache_size];
+    mutable unsigned            _delta_cache_next;
+
+private:
+    friend class scm::gl::render_device;
+    friend class scm::gl::render_context;
+}; // class pipeline_state
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_CORE_PIPELINE_STATE_H_INCLUDED
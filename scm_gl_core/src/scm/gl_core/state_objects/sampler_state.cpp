@@ -6,6 +6,8 @@
 
 #include <cassert>
 
+#include <boost/functional/hash.hpp>
+
 #include <scm/gl_core/config.h>
 #include <scm/gl_core/render_device/context.h>
 #include <scm/gl_core/render_device/device.h>
@@ -42,6 +44,44 @@ sampler_state_desc::sampler_state_desc(
 }
 
 // sampler_state //////////////////////////////////////////////////////////////////////////////////
+bool
+sampler_state_desc::operator==(const sampler_state_desc& rhs) const
+{
+    return (   (_filter         == rhs._filter)
+            && (_max_anisotropy == rhs._max_anisotropy)
+            && (_wrap_s         == rhs._wrap_s)
+            && (_wrap_t         == rhs._wrap_t)
+            && (_wrap_r         == rhs._wrap_r)
+            && (_min_lod        == rhs._min_lod)
+            && (_max_lod        == rhs._max_lod)
+            && (_lod_bias       == rhs._lod_bias)
+            && (_compare_func   == rhs._compare_func)
+            && (_compare_mode   == rhs._compare_mode));
+}
+
+bool
+sampler_state_desc::operator!=(const sampler_state_desc& rhs) const
+{
+    return !(*this == rhs);
+}
+
+std::size_t
+hash_value(const sampler_state_desc& in_desc)
+{
+    std::size_t h = 0;
+    boost::hash_combine(h, static_cast<int>(in_desc._filter));
+    boost::hash_combine(h, in_desc._max_anisotropy);
+    boost::hash_combine(h, static_cast<int>(in_desc._wrap_s));
+    boost::hash_combine(h, static_cast<int>(in_desc._wrap_t));
+    boost::hash_combine(h, static_cast<int>(in_desc._wrap_r));
+    boost::hash_combine(h, in_desc._min_lod);
+    boost::hash_combine(h, in_desc._max_lod);
+    boost::hash_combine(h, in_desc._lod_bias);
+    boost::hash_combine(h, static_cast<int>(in_desc._compare_func));
+    boost::hash_combine(h, static_cast<int>(in_desc._compare_mode));
+    return h;
+}
+
 sampler_state::sampler_state(render_device&            in_device,
                              const sampler_state_desc& in_desc)
   : render_device_child(in_device)
@@ -22,6 +22,9 @@ class  rasterizer_state;
 struct sampler_state_desc;
 class sampler_state;
 
+struct pipeline_state_desc;
+class  pipeline_state;
+
 typedef shared_ptr<depth_stencil_state>         depth_stencil_state_ptr;
 typedef shared_ptr<const depth_stencil_state>   depth_stencil_state_cptr;
 typedef shared_ptr<blend_state>                 blend_state_ptr;
@@ -30,6 +33,8 @@ typedef shared_ptr<rasterizer_state>            rasterizer_state_ptr;
 typedef shared_ptr<const rasterizer_state>      rasterizer_state_cptr;
 typedef shared_ptr<sampler_state>               sampler_state_ptr;
 typedef shared_ptr<const sampler_state>         sampler_state_cptr;
+typedef shared_ptr<pipeline_state>              pipeline_state_ptr;
+typedef shared_ptr<const pipeline_state>        pipeline_state_cptr;
 
 } // namespace gl
 } // namespace scm
@@ -0,0 +1,457 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "volume_statistics.h"
+
+#include <limits>
+
+#include <boost/numeric/conversion/bounds.hpp>
+
+#include <scm/gl_core/log.h>
+#include <scm/core/utilities/parallel_for.h>
+
+namespace {
+
+// independent accumulators per inner loop iteration, breaks the dependency
+// chains of the min/max/sum reductions so the loops can be vectorized
+const unsigned      statistics_lanes        = 8;
+// values accumulated in plain sums before folding them into the
+// running mean and m2 of a range (keeps the variance numerically stable)
+const scm::size_t   statistics_block_size   = 64 * 1024;
+// minimal number of values processed per thread
+const scm::size_t   statistics_range_size   = 1024 * 1024;
+
+struct partial_moments
+{
+    partial_moments()
+      : _min(boost::numeric::bounds<double>::highest())
+      , _max(boost::numeric::bounds<double>::lowest())
+      , _mean(0.0)
+      , _m2(0.0)
+      , _count(0)
+    {}
+
+    void merge(const partial_moments& rhs) {
+        if (rhs._count < 1) {
+            return;
+        }
+        const double n_a   = static_cast<double>(_count);
+        const double n_b   = static_cast<double>(rhs._count);
+        const double n     = n_a + n_b;
+        const double delta = rhs._mean - _mean;
+
+        _min    = scm::math::min(_min, rhs._min);
+        _max    = scm::math::max(_max, rhs._max);
+        _mean  += delta * n_b / n;
+        _m2    += rhs._m2 + delta * delta * n_a * n_b / n;
+        _count += rhs._count;
+    }
+
+    void to_statistics(scm::gl::value_statistics& s) const {
+        if (_count > 0) {
+            s._min      = static_cast<float>(_min);
+            s._max      = static_cast<float>(_max);
+            s._mean     = _mean;
+            s._variance = _m2 / static_cast<double>(_count);
+            s._count    = _count;
+        }
+        else {
+            s = scm::gl::value_statistics();
+        }
+    }
+
+    // double holds all 32bit integer values exactly
+    double          _min;
+    double          _max;
+    double          _mean;
+    double          _m2;
+    scm::uint64     _count;
+}; // struct partial_moments
+
+template<typename value_type>
+void
+accumulate_block(const value_type*  in_data,
+                 scm::size_t        in_count,
+                 partial_moments&   out_moments)
+{
+    // min/max are tracked in the source type, a float can not represent
+    // all 32bit integer values
+    value_type  l_min[statistics_lanes];
+    value_type  l_max[statistics_lanes];
+    double      l_sum[statistics_lanes];
+    double      l_sqr[statistics_lanes];
+
+    // the sums are taken relative to the first value of the block, this avoids
+    // the cancellation in sqr - sum * mean for large values with small spread
+    const double shift = in_count > 0 ? static_cast<double>(in_data[0]) : 0.0;
+
+    for (unsigned l = 0; l < statistics_lanes; ++l) {
+        l_min[l] = boost::numeric::bounds<value_type>::highest();
+        l_max[l] = boost::numeric::bounds<value_type>::lowest();
+        l_sum[l] = 0.0;
+        l_sqr[l] = 0.0;
+    }
+
+    scm::size_t i = 0;
+    for (; i + statistics_lanes <= in_count; i += statistics_lanes) {
+        for (unsigned l = 0; l < statistics_lanes; ++l) {
+            const value_type v = in_data[i + l];
+            const double     d = static_cast<double>(v) - shift;
+            l_min[l] = v < l_min[l] ? v : l_min[l];
+            l_max[l] = v > l_max[l] ? v : l_max[l];
+            l_sum[l] += d;
+            l_sqr[l] += d * d;
+        }
+    }
+    for (unsigned l = 0; i < in_count; ++i, ++l) {
+        const value_type v = in_data[i];
+        const double     d = static_cast<double>(v) - shift;
+        l_min[l] = v < l_min[l] ? v : l_min[l];
+        l_max[l] = v > l_max[l] ? v : l_max[l];
+        l_sum[l] += d;
+        l_sqr[l] += d * d;
+    }
+
+    partial_moments block;
+    double          sum = 0.0;
+    double          sqr = 0.0;
+    for (unsigned l = 0; l < statistics_lanes; ++l) {
+        block._min = scm::math::min(block._min, static_cast<double>(l_min[l]));
+        block._max = scm::math::max(block._max, static_cast<double>(l_max[l]));
+        sum       += l_sum[l];
+        sqr       += l_sqr[l];
+    }
+    block._count = in_count;
+    block._mean  = sum / static_cast<double>(in_count);
+    block._m2    = scm::math::max(0.0, sqr - sum * block._mean);
+    block._mean += shift;
+
+    out_moments.merge(block);
+}
+
+template<typename value_type>
+void
+accumulate_moments(const value_type*  in_data,
+                   scm::size_t        in_count,
+                   partial_moments&   out_moments)
+{
+    for (scm::size_t b = 0; b < in_count; b += statistics_block_size) {
+        accumulate_block(in_data + b, scm::math::min(statistics_block_size, in_count - b), out_moments);
+    }
+}
+
+template<typename value_type>
+void
+accumulate_histogram(const value_type*  in_data,
+                     scm::size_t        in_count,
+                     float              in_min_value,
+                     float              in_bin_scale,
+                     unsigned           in_bins,
+                     scm::uint64*       out_histogram)
+{
+    const float max_bin = static_cast<float>(in_bins - 1);
+
+    for (scm::size_t i = 0; i < in_count; ++i) {
+        const float f = (static_cast<float>(in_data[i]) - in_min_value) * in_bin_scale;
+        // NaNs end up in the first bin
+        const unsigned b = f > 0.0f ? (f < max_bin ? static_cast<unsigned>(f) : in_bins - 1) : 0u;
+        ++out_histogram[b];
+    }
+}
+
+template<typename value_type>
+void
+typed_compute(const scm::math::vec3ui&              in_dimensions,
+              unsigned                              in_channels,
+              const value_type*                     in_data,
+              bool                                  in_range_given,
+              float                                 in_min_value,
+              float                                 in_max_value,
+              unsigned                              in_histogram_bins,
+              const scm::math::vec3ui&              in_brick_size,
+              const scm::math::vec3ui&              in_brick_grid,
+              scm::gl::value_statistics&            out_statistics,
+              std::vector<scm::uint64>&             out_histogram,
+              std::vector<scm::gl::value_statistics>& out_bricks,
+              float&                                out_histogram_min,
+              float&                                out_histogram_max)
+{
+    using namespace scm;
+    using namespace scm::math;
+
+    const scm::size_t value_count =   static_cast<scm::size_t>(in_dimensions.x) * in_dimensions.y
+                                    * in_dimensions.z * in_channels;
+    const unsigned    range_count = parallel_range_count(value_count, statistics_range_size);
+
+    std::vector<partial_moments> range_moments(range_count);
+    std::vector<scm::uint64>     range_histograms(static_cast<scm::size_t>(range_count) * in_histogram_bins, 0);
+
+    const bool  build_histogram = in_histogram_bins > 0 && value_count > 0;
+    float       bin_scale       = 0.0f;
+
+    if (in_range_given) {
+        // histogram range known up front, everything is done in a single pass
+        out_histogram_min = in_min_value;
+        out_histogram_max = in_max_value;
+        if (out_histogram_max > out_histogram_min) {
+            bin_scale = static_cast<float>(in_histogram_bins) / (out_histogram_max - out_histogram_min);
+        }
+        parallel_for(value_count, statistics_range_size,
+            [&](scm::size_t b, scm::size_t e, unsigned r) {
+                accumulate_moments(in_data + b, e - b, range_moments[r]);
+                if (build_histogram) {
+                    accumulate_histogram(in_data + b, e - b, out_histogram_min, bin_scale, in_histogram_bins,
+                                         &range_histograms[static_cast<scm::size_t>(r) * in_histogram_bins]);
+                }
+            });
+    }
+    else {
+        parallel_for(value_count, statistics_range_size,
+            [&](scm::size_t b, scm::size_t e, unsigned r) {
+                accumulate_moments(in_data + b, e - b, range_moments[r]);
+            });
+    }
+
+    partial_moments total;
+    for (unsigned r = 0; r < range_count; ++r) {
+        total.merge(range_moments[r]);
+    }
+    total.to_statistics(out_statistics);
+
+    if (!in_range_given) {
+        // second pass over the data with the now known value range
+        out_histogram_min = out_statistics._min;
+        out_histogram_max = out_statistics._max;
+        if (out_histogram_max > out_histogram_min) {
+            bin_scale = static_cast<float>(in_histogram_bins) / (out_histogram_max - out_histogram_min);
+        }
+        if (build_histogram) {
+            parallel_for(value_count, statistics_range_size,
+                [&](scm::size_t b, scm::size_t e, unsigned r) {
+                    accumulate_histogram(in_data + b, e - b, out_histogram_min, bin_scale, in_histogram_bins,
+                                         &range_histograms[static_cast<scm::size_t>(r) * in_histogram_bins]);
+                });
+        }
+    }
+
+    out_histogram.assign(in_histogram_bins, 0);
+    for (unsigned r = 0; r < range_count && build_histogram; ++r) {
+        const scm::uint64* rh = &range_histograms[static_cast<scm::size_t>(r) * in_histogram_bins];
+        for (unsigned h = 0; h < in_histogram_bins; ++h) {
+            out_histogram[h] += rh[h];
+        }
+    }
+
+    // brick statistics
+    const scm::size_t brick_count = static_cast<scm::size_t>(in_brick_grid.x) * in_brick_grid.y * in_brick_grid.z;
+    out_bricks.resize(brick_count);
+
+    if (brick_count > 0) {
+        parallel_for(brick_count, 1,
+            [&](scm::size_t b, scm::size_t e, unsigned) {
+                for (scm::size_t i = b; i < e; ++i) {
+                    const vec3ui bi  = vec3ui(static_cast<unsigned>(i % in_brick_grid.x),
+                                              static_cast<unsigned>((i / in_brick_grid.x) % in_brick_grid.y),
+                                              static_cast<unsigned>(i / (static_cast<scm::size_t>(in_brick_grid.x) * in_brick_grid.y)));
+                    const vec3ui bo  = bi * in_brick_size;
+                    const vec3ui be  = min(bo + in_brick_size + vec3ui(1u), in_dimensions);
+                    const scm::size_t row_values = static_cast<scm::size_t>(be.x - bo.x) * in_channels;
+
+                    partial_moments bm;
+                    for (unsigned z = bo.z; z < be.z; ++z) {
+                        for (unsigned y = bo.y; y < be.y; ++y) {
+                            const scm::size_t row_offset =   ((static_cast<scm::size_t>(z) * in_dimensions.y + y) * in_dimensions.x + bo.x)
+                                                           * in_channels;
+                            accumulate_moments(in_data + row_offset, row_values, bm);
+                        }
+                    }
+                    bm.to_statistics(out_bricks[i]);
+                }
+            });
+    }
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+value_statistics::value_statistics()
+  : _min(0.0f)
+  , _max(0.0f)
+  , _mean(0.0)
+  , _variance(0.0)
+  , _count(0)
+{
+}
+
+volume_statistics::volume_statistics()
+  : _histogram_min(0.0f)
+  , _histogram_max(0.0f)
+  , _brick_size(0u)
+  , _brick_grid_dimensions(0u)
+{
+}
+
+volume_statistics::~volume_statistics()
+{
+}
+
+bool
+volume_statistics::compute(const math::vec3ui&  in_dimensions,
+                           const data_format    in_format,
+                           const void*          in_data,
+                           unsigned             in_histogram_bins,
+                           const math::vec3ui&  in_brick_size)
+{
+    return compute_impl(in_dimensions, in_format, in_data, false, 0.0f, 0.0f, in_histogram_bins, in_brick_size);
+}
+
+bool
+volume_statistics::compute(const math::vec3ui&  in_dimensions,
+                           const data_format    in_format,
+                           const void*          in_data,
+                           float                in_min_value,
+                           float                in_max_value,
+                           unsigned             in_histogram_bins,
+                           const math::vec3ui&  in_brick_size)
+{
+    return compute_impl(in_dimensions, in_format, in_data, true, in_min_value, in_max_value, in_histogram_bins, in_brick_size);
+}
+
+bool
+volume_statistics::supported_format(const data_format in_format)
+{
+    switch (in_format) {
+        case FORMAT_R_8:     case FORMAT_RG_8:     case FORMAT_RGB_8:     case FORMAT_RGBA_8:
+        case FORMAT_R_8UI:   case FORMAT_RG_8UI:   case FORMAT_RGB_8UI:   case FORMAT_RGBA_8UI:
+        case FORMAT_BGR_8:   case FORMAT_BGRA_8:
+        case FORMAT_R_8S:    case FORMAT_RG_8S:    case FORMAT_RGB_8S:    case FORMAT_RGBA_8S:
+        case FORMAT_R_8I:    case FORMAT_RG_8I:    case FORMAT_RGB_8I:    case FORMAT_RGBA_8I:
+        case FORMAT_R_16:    case FORMAT_RG_16:    case FORMAT_RGB_16:    case FORMAT_RGBA_16:
+        case FORMAT_R_16UI:  case FORMAT_RG_16UI:  case FORMAT_RGB_16UI:  case FORMAT_RGBA_16UI:
+        case FORMAT_R_16S:   case FORMAT_RG_16S:   case FORMAT_RGB_16S:   case FORMAT_RGBA_16S:
+        case FORMAT_R_16I:   case FORMAT_RG_16I:   case FORMAT_RGB_16I:   case FORMAT_RGBA_16I:
+        case FORMAT_R_32I:   case FORMAT_RG_32I:   case FORMAT_RGB_32I:   case FORMAT_RGBA_32I:
+        case FORMAT_R_32UI:  case FORMAT_RG_32UI:  case FORMAT_RGB_32UI:  case FORMAT_RGBA_32UI:
+        case FORMAT_R_32F:   case FORMAT_RG_32F:   case FORMAT_RGB_32F:   case FORMAT_RGBA_32F:
+            return true;
+        default:
+            return false;
+    }
+}
+
+const value_statistics&
+volume_statistics::statistics() const
+{
+    return _statistics;
+}
+
+float
+volume_statistics::histogram_min() const
+{
+    return _histogram_min;
+}
+
+float
+volume_statistics::histogram_max() const
+{
+    return _histogram_max;
+}
+
+const std::vector<scm::uint64>&
+volume_statistics::histogram() const
+{
+    return _histogram;
+}
+
+const math::vec3ui&
+volume_statistics::brick_size() const
+{
+    return _brick_size;
+}
+
+const math::vec3ui&
+volume_statistics::brick_grid_dimensions() const
+{
+    return _brick_grid_dimensions;
+}
+
+const std::vector<value_statistics>&
+volume_statistics::brick_statistics() const
+{
+    return _brick_statistics;
+}
+
+bool
+volume_statistics::compute_impl(const math::vec3ui&  in_dimensions,
+                                const data_format    in_format,
+                                const void*          in_data,
+                                bool                 in_range_given,
+                                float                in_min_value,
+                                float                in_max_value,
+                                unsigned             in_histogram_bins,
+                                const math::vec3ui&  in_brick_size)
+{
+    using namespace scm::math;
+
+    if (!supported_format(in_format)) {
+        glerr() << log::error
+                << "volume_statistics::compute(): unsupported data format (" << format_string(in_format) << ")." << log::end;
+        return false;
+    }
+    if (!in_data) {
+        glerr() << log::error
+                << "volume_statistics::compute(): invalid data pointer." << log::end;
+        return false;
+    }
+
+    _statistics            = value_statistics();
+    _brick_size            = vec3ui(0u);
+    _brick_grid_dimensions = vec3ui(0u);
+
+    if (   in_brick_size.x > 0
+        && in_brick_size.y > 0
+        && in_brick_size.z > 0) {
+        _brick_size            = in_brick_size;
+        _brick_grid_dimensions = (in_dimensions + in_brick_size - vec3ui(1u)) / in_brick_size;
+    }
+
+    const unsigned c = static_cast<unsigned>(channel_count(in_format));
+
+#define SCM_VOLUME_STATISTICS_COMPUTE(value_type)                                                           \
+    typed_compute<value_type>(in_dimensions, c, reinterpret_cast<const value_type*>(in_data),               \
+                              in_range_given, in_min_value, in_max_value, in_histogram_bins,                \
+                              _brick_size, _brick_grid_dimensions,                                          \
+                              _statistics, _histogram, _brick_statistics, _histogram_min, _histogram_max)
+
+    if (is_float_type(in_format)) {
+        SCM_VOLUME_STATISTICS_COMPUTE(float);
+    }
+    else {
+        const bool is_signed =    (in_format >= FORMAT_R_8S  && in_format <= FORMAT_RGBA_16S)
+                               || (in_format >= FORMAT_R_8I  && in_format <= FORMAT_RGBA_32I);
+        switch (size_of_channel(in_format)) {
+            case 1:
+                if (is_signed) SCM_VOLUME_STATISTICS_COMPUTE(scm::int8);
+                else           SCM_VOLUME_STATISTICS_COMPUTE(scm::uint8);
+                break;
+            case 2:
+                if (is_signed) SCM_VOLUME_STATISTICS_COMPUTE(scm::int16);
+                else           SCM_VOLUME_STATISTICS_COMPUTE(scm::uint16);
+                break;
+            case 4:
+                if (is_signed) SCM_VOLUME_STATISTICS_COMPUTE(scm::int32);
+                else           SCM_VOLUME_STATISTICS_COMPUTE(scm::uint32);
+                break;
+        }
+    }
+
+#undef SCM_VOLUME_STATISTICS_COMPUTE
+
+    return true;
+}
+
+} // namespace gl
+} // namespace scm
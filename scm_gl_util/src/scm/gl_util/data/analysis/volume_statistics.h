@@ -0,0 +1,105 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_VOLUME_STATISTICS_H_INCLUDED
+#define SCM_GL_UTIL_VOLUME_STATISTICS_H_INCLUDED
+
+#include <vector>
+
+#include <scm/core/math.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/data_formats.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+struct __scm_export(gl_util) value_statistics
+{
+    value_statistics();
+
+    float                       _min;
+    float                       _max;
+    double                      _mean;
+    double                      _variance;
+    scm::uint64                 _count;
+}; // struct value_statistics
+
+// value range, moments and histogram of raw volume data
+//  - all channels of multi-channel formats are accumulated into the same
+//    statistics, values are reported in the units of the source type
+//    (normalized formats are not scaled to [0, 1])
+//  - the data is processed in contiguous ranges on all hardware threads,
+//    the inner loops work on independent accumulator lanes to allow the
+//    compiler to vectorize them
+//  - without a given value range two passes over the data are required,
+//    one for the range and moments and one for the histogram
+class __scm_export(gl_util) volume_statistics
+{
+public:
+    volume_statistics();
+    virtual ~volume_statistics();
+
+    bool                                    compute(const math::vec3ui&  in_dimensions,
+                                                    const data_format    in_format,
+                                                    const void*          in_data,
+                                                    unsigned             in_histogram_bins = 256,
+                                                    const math::vec3ui&  in_brick_size     = math::vec3ui(0u));
+    // single pass variant, the histogram covers [in_min_value, in_max_value]
+    // and values outside of this range are counted in the border bins
+    bool                                    compute(const math::vec3ui&  in_dimensions,
+                                                    const data_format    in_format,
+                                                    const void*          in_data,
+                                                    float                in_min_value,
+                                                    float                in_max_value,
+                                                    unsigned             in_histogram_bins = 256,
+                                                    const math::vec3ui&  in_brick_size     = math::vec3ui(0u));
+
+    static bool                             supported_format(const data_format in_format);
+
+    const value_statistics&                 statistics() const;
+
+    float                                   histogram_min() const;
+    float                                   histogram_max() const;
+    const std::vector<scm::uint64>&         histogram() const;
+
+    // per brick statistics, bricks are stored in x-y-z order. the bricks include
+    // the first voxel layer of their upper neighbors, so the brick ranges are
+    // conservative for trilinear filtering (empty-space skipping)
+    const math::vec3ui&                     brick_size() const;
+    const math::vec3ui&                     brick_grid_dimensions() const;
+    const std::vector<value_statistics>&    brick_statistics() const;
+
+protected:
+    bool                                    compute_impl(const math::vec3ui&  in_dimensions,
+                                                         const data_format    in_format,
+                                                         const void*          in_data,
+                                                         bool                 in_range_given,
+                                                         float                in_min_value,
+                                                         float                in_max_value,
+                                                         unsigned             in_histogram_bins,
+                                                         const math::vec3ui&  in_brick_size);
+
+protected:
+    value_statistics                        _statistics;
+
+    float                                   _histogram_min;
+    float                                   _histogram_max;
+    std::vector<scm::uint64>                _histogram;
+
+    math::vec3ui                            _brick_size;
+    math::vec3ui                            _brick_grid_dimensions;
+    std::vector<value_statistics>           _brick_statistics;
+
+}; // class volume_statistics
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_VOLUME_STATISTICS_H_INCLUDED
@@ -0,0 +1,692 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "block_compression.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <memory.h>
+
+#include <scm/core/memory.h>
+#include <scm/core/math/config.h>
+#include <scm/core/utilities/parallel_for.h>
+
+#include <scm/gl_core/log.h>
+
+#include <scm/gl_util/data/imaging/texture_image_data.h>
+
+#if SCM_CORE_MATH_SIMD_SSE
+#   include <xmmintrin.h>
+#   include <emmintrin.h>
+#endif
+
+namespace scm {
+namespace gl {
+namespace util {
+namespace {
+
+// blocks encoded per parallel_for range
+const scm::size_t bc_range_blocks = 256;
+
+// 4x4 texels in channel major order (r[16], g[16], b[16], a[16]), values in [0, 255]
+struct block_rgba
+{
+    scm_align(16) float _c[4][16];
+}; // struct block_rgba
+
+void
+fetch_block(const uint8*        in_src,
+            const math::vec2ui& in_size,
+            data_format         in_fmt,
+            unsigned            in_bx,
+            unsigned            in_by,
+            block_rgba&         out_block)
+{
+    const unsigned channels = channel_count(in_fmt);
+    const bool     bgr      = (in_fmt == FORMAT_BGR_8 || in_fmt == FORMAT_BGRA_8);
+
+    for (unsigned y = 0; y < 4; ++y) {
+        // border texels are replicated into partial blocks
+        const unsigned sy = (std::min)(in_by * 4 + y, in_size.y - 1);
+        for (unsigned x = 0; x < 4; ++x) {
+            const unsigned sx = (std::min)(in_bx * 4 + x, in_size.x - 1);
+            const uint8*   t  = in_src + (static_cast<scm::size_t>(sy) * in_size.x + sx) * channels;
+            const unsigned i  = y * 4 + x;
+
+            out_block._c[0][i] =                  static_cast<float>(t[bgr ? 2 : 0]);
+            out_block._c[1][i] = channels > 1 ? static_cast<float>(t[1])           : 0.0f;
+            out_block._c[2][i] = channels > 2 ? static_cast<float>(t[bgr ? 0 : 2]) : 0.0f;
+            out_block._c[3][i] = channels > 3 ? static_cast<float>(t[3])           : 255.0f;
+        }
+    }
+}
+
+// nearest palette entry for each texel over the channels [in_cbegin, in_cend),
+// returns the summed squared error
+float
+select_indices(const block_rgba&    in_block,
+               const float        (*in_palette)[4],
+               unsigned             in_palette_size,
+               unsigned             in_cbegin,
+               unsigned             in_cend,
+               uint8                out_indices[16])
+{
+    float err = 0.0f;
+
+#if SCM_CORE_MATH_SIMD_SSE
+    scm_align(16) int   best_idx[4];
+    scm_align(16) float best_err[4];
+
+    for (unsigned g = 0; g < 4; ++g) {
+        __m128  best  = _mm_set1_ps(FLT_MAX);
+        __m128i besti = _mm_setzero_si128();
+        for (unsigned p = 0; p < in_palette_size; ++p) {
+            __m128 d = _mm_setzero_ps();
+            for (unsigned c = in_cbegin; c < in_cend; ++c) {
+                const __m128 t = _mm_sub_ps(_mm_load_ps(&in_block._c[c][4 * g]), _mm_set1_ps(in_palette[p][c]));
+                d = _mm_add_ps(d, _mm_mul_ps(t, t));
+            }
+            const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(d, best));
+            best  = _mm_min_ps(d, best);
+            besti = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(static_cast<int>(p))),
+                                 _mm_andnot_si128(closer, besti));
+        }
+        _mm_store_si128(reinterpret_cast<__m128i*>(best_idx), besti);
+        _mm_store_ps(best_err, best);
+        for (unsigned k = 0; k < 4; ++k) {
+            out_indices[4 * g + k] = static_cast<uint8>(best_idx[k]);
+            err += best_err[k];
+        }
+    }
+#else // SCM_CORE_MATH_SIMD_SSE
+    for (unsigned i = 0; i < 16; ++i) {
+        float best  = FLT_MAX;
+        uint8 besti = 0;
+        for (unsigned p = 0; p < in_palette_size; ++p) {
+            float d = 0.0f;
+            for (unsigned c = in_cbegin; c < in_cend; ++c) {
+                const float t = in_block._c[c][i] - in_palette[p][c];
+                d += t * t;
+            }
+            if (d < best) {
+                best  = d;
+                besti = static_cast<uint8>(p);
+            }
+        }
+        out_indices[i] = besti;
+        err += best;
+    }
+#endif // SCM_CORE_MATH_SIMD_SSE
+
+    return err;
+}
+
+// endpoints along the principal axis of the texels selected by in_mask (null: all)
+void
+fit_endpoints(const block_rgba&    in_block,
+              unsigned             in_channels,
+              const bool*          in_mask,
+              float                out_e0[4],
+              float                out_e1[4])
+{
+    float    mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float    cov[4][4];
+    unsigned count   = 0;
+
+    for (unsigned i = 0; i < 16; ++i) {
+        if (!in_mask || in_mask[i]) {
+            for (unsigned c = 0; c < in_channels; ++c) {
+                mean[c] += in_block._c[c][i];
+            }
+            ++count;
+        }
+    }
+    if (count == 0) {
+        for (unsigned c = 0; c < 4; ++c) {
+            out_e0[c] = out_e1[c] = 0.0f;
+        }
+        return;
+    }
+    for (unsigned c = 0; c < in_channels; ++c) {
+        mean[c] /= static_cast<float>(count);
+    }
+
+    memset(cov, 0, sizeof(cov));
+    for (unsigned i = 0; i < 16; ++i) {
+        if (!in_mask || in_mask[i]) {
+            for (unsigned r = 0; r < in_channels; ++r) {
+                for (unsigned c = r; c < in_channels; ++c) {
+                    cov[r][c] += (in_block._c[r][i] - mean[r]) * (in_block._c[c][i] - mean[c]);
+                }
+            }
+        }
+    }
+    for (unsigned r = 0; r < in_channels; ++r) {
+        for (unsigned c = 0; c < r; ++c) {
+            cov[r][c] = cov[c][r];
+        }
+    }
+
+    // power iteration starting at the channel of largest variance
+    float    axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    unsigned max_c   = 0;
+    for (unsigned c = 1; c < in_channels; ++c) {
+        if (cov[c][c] > cov[max_c][max_c]) {
+            max_c = c;
+        }
+    }
+    axis[max_c] = 1.0f;
+    for (unsigned it = 0; it < 8; ++it) {
+        float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float len     = 0.0f;
+        for (unsigned r = 0; r < in_channels; ++r) {
+            for (unsigned c = 0; c < in_channels; ++c) {
+                next[r] += cov[r][c] * axis[c];
+            }
+            len += next[r] * next[r];
+        }
+        if (len < FLT_EPSILON) {
+            break; // constant block, keep the start axis
+        }
+        len = 1.0f / std::sqrt(len);
+        for (unsigned c = 0; c < in_channels; ++c) {
+            axis[c] = next[c] * len;
+        }
+    }
+
+    float tmin = FLT_MAX;
+    float tmax = -FLT_MAX;
+    for (unsigned i = 0; i < 16; ++i) {
+        if (!in_mask || in_mask[i]) {
+            float t = 0.0f;
+            for (unsigned c = 0; c < in_channels; ++c) {
+                t += (in_block._c[c][i] - mean[c]) * axis[c];
+            }
+            tmin = (std::min)(tmin, t);
+            tmax = (std::max)(tmax, t);
+        }
+    }
+
+    for (unsigned c = 0; c < 4; ++c) {
+        out_e0[c] = c < in_channels ? math::clamp(mean[c] + tmax * axis[c], 0.0f, 255.0f) : 255.0f;
+        out_e1[c] = c < in_channels ? math::clamp(mean[c] + tmin * axis[c], 0.0f, 255.0f) : 255.0f;
+    }
+}
+
+// bc1 ////////////////////////////////////////////////////////////////////////////////////////////
+inline
+unsigned
+pack_565(const float c[4])
+{
+    const unsigned r = static_cast<unsigned>(c[0] * (31.0f / 255.0f) + 0.5f);
+    const unsigned g = static_cast<unsigned>(c[1] * (63.0f / 255.0f) + 0.5f);
+    const unsigned b = static_cast<unsigned>(c[2] * (31.0f / 255.0f) + 0.5f);
+    return (r << 11) | (g << 5) | b;
+}
+
+inline
+void
+unpack_565(unsigned p, float c[4])
+{
+    const unsigned r = (p >> 11) & 0x1f;
+    const unsigned g = (p >>  5) & 0x3f;
+    const unsigned b =  p        & 0x1f;
+    c[0] = static_cast<float>((r << 3) | (r >> 2));
+    c[1] = static_cast<float>((g << 2) | (g >> 4));
+    c[2] = static_cast<float>((b << 3) | (b >> 2));
+    c[3] = 255.0f;
+}
+
+inline
+void
+bc1_palette(unsigned q0, unsigned q1, bool in_four_colors, float pal[4][4])
+{
+    unpack_565(q0, pal[0]);
+    unpack_565(q1, pal[1]);
+    for (unsigned c = 0; c < 4; ++c) {
+        if (in_four_colors) {
+            pal[2][c] = (2.0f * pal[0][c] +        pal[1][c]) / 3.0f;
+            pal[3][c] = (       pal[0][c] + 2.0f * pal[1][c]) / 3.0f;
+        }
+        else {
+            pal[2][c] = (pal[0][c] + pal[1][c]) * 0.5f;
+            pal[3][c] = 0.0f;
+        }
+    }
+}
+
+inline
+void
+write_bc1(unsigned q0, unsigned q1, const uint8 indices[16], uint8* out)
+{
+    scm::uint32 bits = 0;
+    for (unsigned i = 0; i < 16; ++i) {
+        bits |= static_cast<scm::uint32>(indices[i] & 0x3) << (2 * i);
+    }
+    out[0] = static_cast<uint8>(q0 & 0xff);
+    out[1] = static_cast<uint8>(q0 >> 8);
+    out[2] = static_cast<uint8>(q1 & 0xff);
+    out[3] = static_cast<uint8>(q1 >> 8);
+    out[4] = static_cast<uint8>( bits        & 0xff);
+    out[5] = static_cast<uint8>((bits >>  8) & 0xff);
+    out[6] = static_cast<uint8>((bits >> 16) & 0xff);
+    out[7] = static_cast<uint8>((bits >> 24) & 0xff);
+}
+
+// least squares endpoints for the given four color mode indices
+bool
+refine_bc1(const block_rgba& in_block, const uint8 in_indices[16], float out_e0[4], float out_e1[4])
+{
+    static const float w0[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+    float aa = 0.0f;
+    float bb = 0.0f;
+    float ab = 0.0f;
+    float ax[3] = { 0.0f, 0.0f, 0.0f };
+    float bx[3] = { 0.0f, 0.0f, 0.0f };
+
+    for (unsigned i = 0; i < 16; ++i) {
+        const float a = w0[in_indices[i]];
+        const float b = 1.0f - a;
+        aa += a * a;
+        bb += b * b;
+        ab += a * b;
+        for (unsigned c = 0; c < 3; ++c) {
+            ax[c] += a * in_block._c[c][i];
+            bx[c] += b * in_block._c[c][i];
+        }
+    }
+
+    const float det = aa * bb - ab * ab;
+    if (std::fabs(det) < FLT_EPSILON) {
+        return false;
+    }
+    const float rdet = 1.0f / det;
+    for (unsigned c = 0; c < 3; ++c) {
+        out_e0[c] = math::clamp((bb * ax[c] - ab * bx[c]) * rdet, 0.0f, 255.0f);
+        out_e1[c] = math::clamp((aa * bx[c] - ab * ax[c]) * rdet, 0.0f, 255.0f);
+    }
+    out_e0[3] = out_e1[3] = 255.0f;
+
+    return true;
+}
+
+void
+encode_bc1_color(const block_rgba& in_block, bool in_punch_through, uint8* out)
+{
+    bool     opaque[16];
+    unsigned opaque_count = 0;
+    for (unsigned i = 0; i < 16; ++i) {
+        opaque[i] = !in_punch_through || in_block._c[3][i] >= 128.0f;
+        opaque_count += opaque[i] ? 1 : 0;
+    }
+
+    uint8 indices[16];
+    float pal[4][4];
+    float e0[4];
+    float e1[4];
+
+    if (opaque_count == 0) {
+        std::fill(indices, indices + 16, 3);
+        write_bc1(0, 0, indices, out);
+        return;
+    }
+
+    fit_endpoints(in_block, 3, opaque, e0, e1);
+
+    unsigned q0 = pack_565(e0);
+    unsigned q1 = pack_565(e1);
+
+    if (opaque_count < 16) {
+        // three color mode, index 3 is transparent black
+        if (q0 > q1) {
+            std::swap(q0, q1);
+        }
+        bc1_palette(q0, q1, false, pal);
+        select_indices(in_block, pal, 3, 0, 3, indices);
+        for (unsigned i = 0; i < 16; ++i) {
+            if (!opaque[i]) {
+                indices[i] = 3;
+            }
+        }
+        write_bc1(q0, q1, indices, out);
+        return;
+    }
+
+    if (q0 < q1) {
+        std::swap(q0, q1);
+    }
+    if (q0 == q1) {
+        std::fill(indices, indices + 16, 0);
+        write_bc1(q0, q1, indices, out);
+        return;
+    }
+
+    bc1_palette(q0, q1, true, pal);
+    float err = select_indices(in_block, pal, 4, 0, 3, indices);
+
+    if (refine_bc1(in_block, indices, e0, e1)) {
+        unsigned r0 = pack_565(e0);
+        unsigned r1 = pack_565(e1);
+        if (r0 < r1) {
+            std::swap(r0, r1);
+        }
+        if (r0 != r1 && (r0 != q0 || r1 != q1)) {
+            uint8 rindices[16];
+            bc1_palette(r0, r1, true, pal);
+            const float rerr = select_indices(in_block, pal, 4, 0, 3, rindices);
+            if (rerr < err) {
+                q0 = r0;
+                q1 = r1;
+                std::copy(rindices, rindices + 16, indices);
+            }
+        }
+    }
+
+    write_bc1(q0, q1, indices, out);
+}
+
+// bc4 ////////////////////////////////////////////////////////////////////////////////////////////
+void
+encode_bc4(const block_rgba& in_block, unsigned in_channel, uint8* out)
+{
+    const float* v    = in_block._c[in_channel];
+    float        vmin = v[0];
+    float        vmax = v[0];
+    for (unsigned i = 1; i < 16; ++i) {
+        vmin = (std::min)(vmin, v[i]);
+        vmax = (std::max)(vmax, v[i]);
+    }
+
+    const unsigned a0 = static_cast<unsigned>(vmax + 0.5f);
+    const unsigned a1 = static_cast<unsigned>(vmin + 0.5f);
+
+    uint8 indices[16] = { 0 };
+    if (a0 != a1) {
+        // eight value mode (a0 > a1)
+        float pal[8][4];
+        pal[0][in_channel] = static_cast<float>(a0);
+        pal[1][in_channel] = static_cast<float>(a1);
+        for (unsigned p = 2; p < 8; ++p) {
+            pal[p][in_channel] = static_cast<float>((8 - p) * a0 + (p - 1) * a1) / 7.0f;
+        }
+        select_indices(in_block, pal, 8, in_channel, in_channel + 1, indices);
+    }
+
+    scm::uint64 bits = 0;
+    for (unsigned i = 0; i < 16; ++i) {
+        bits |= static_cast<scm::uint64>(indices[i]) << (3 * i);
+    }
+    out[0] = static_cast<uint8>(a0);
+    out[1] = static_cast<uint8>(a1);
+    for (unsigned b = 0; b < 6; ++b) {
+        out[2 + b] = static_cast<uint8>((bits >> (8 * b)) & 0xff);
+    }
+}
+
+// bc7 ////////////////////////////////////////////////////////////////////////////////////////////
+class bit_writer
+{
+public:
+    explicit bit_writer(uint8* out) : _out(out), _pos(0) { memset(_out, 0, 16); }
+    void write(unsigned value, unsigned bits) {
+        for (unsigned b = 0; b < bits; ++b, ++_pos) {
+            _out[_pos >> 3] |= static_cast<uint8>(((value >> b) & 1u) << (_pos & 7));
+        }
+    }
+private:
+    uint8*      _out;
+    unsigned    _pos;
+}; // class bit_writer
+
+// 7bit endpoint plus shared p-bit with the smaller error
+void
+quantize_bc7_endpoint(const float in_e[4], unsigned out_q[4], unsigned& out_p)
+{
+    float best_err = FLT_MAX;
+    for (unsigned p = 0; p < 2; ++p) {
+        unsigned q[4];
+        float    err = 0.0f;
+        for (unsigned c = 0; c < 4; ++c) {
+            const int qc = static_cast<int>((in_e[c] - static_cast<float>(p)) * 0.5f + 0.5f);
+            q[c] = static_cast<unsigned>(math::clamp(qc, 0, 127));
+            const float d = static_cast<float>(q[c] * 2 + p) - in_e[c];
+            err += d * d;
+        }
+        if (err < best_err) {
+            best_err = err;
+            out_p    = p;
+            std::copy(q, q + 4, out_q);
+        }
+    }
+}
+
+// mode 6: one subset, rgba endpoints 7bit + p-bit, 4bit indices
+void
+encode_bc7(const block_rgba& in_block, uint8* out)
+{
+    static const unsigned weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    float    e0[4];
+    float    e1[4];
+    unsigned q0[4];
+    unsigned q1[4];
+    unsigned p0 = 0;
+    unsigned p1 = 0;
+
+    fit_endpoints(in_block, 4, 0, e0, e1);
+    quantize_bc7_endpoint(e0, q0, p0);
+    quantize_bc7_endpoint(e1, q1, p1);
+
+    float pal[16][4];
+    for (unsigned i = 0; i < 16; ++i) {
+        for (unsigned c = 0; c < 4; ++c) {
+            const unsigned c0 = q0[c] * 2 + p0;
+            const unsigned c1 = q1[c] * 2 + p1;
+            pal[i][c] = static_cast<float>(((64 - weights[i]) * c0 + weights[i] * c1 + 32) >> 6);
+        }
+    }
+
+    uint8 indices[16];
+    select_indices(in_block, pal, 16, 0, 4, indices);
+
+    // the most significant bit of the anchor index is implicit zero
+    if (indices[0] & 0x8) {
+        std::swap(p0, p1);
+        for (unsigned c = 0; c < 4; ++c) {
+            std::swap(q0[c], q1[c]);
+        }
+        for (unsigned i = 0; i < 16; ++i) {
+            indices[i] = static_cast<uint8>(15 - indices[i]);
+        }
+    }
+
+    bit_writer bw(out);
+    bw.write(1u << 6, 7);
+    for (unsigned c = 0; c < 4; ++c) {
+        bw.write(q0[c], 7);
+        bw.write(q1[c], 7);
+    }
+    bw.write(p0, 1);
+    bw.write(p1, 1);
+    bw.write(indices[0], 3);
+    for (unsigned i = 1; i < 16; ++i) {
+        bw.write(indices[i], 4);
+    }
+}
+
+// compresses the block rows [row_begin, row_end)
+struct block_row_compressor
+{
+    const uint8*        _src;
+    math::vec2ui        _size;
+    data_format         _src_fmt;
+    uint8*              _dst;
+    data_format         _dst_fmt;
+
+    void operator()(scm::size_t row_begin, scm::size_t row_end, unsigned /*range_index*/) const
+    {
+        const unsigned    blocks_x   = (_size.x + 3) / 4;
+        const scm::size_t block_size = compressed_block_size(_dst_fmt);
+
+        block_rgba block;
+        for (scm::size_t by = row_begin; by < row_end; ++by) {
+            uint8* out = _dst + by * blocks_x * block_size;
+            for (unsigned bx = 0; bx < blocks_x; ++bx, out += block_size) {
+                fetch_block(_src, _size, _src_fmt, bx, static_cast<unsigned>(by), block);
+                switch (_dst_fmt) {
+                    case FORMAT_BC1_RGBA:
+                    case FORMAT_BC1_SRGBA:
+                        encode_bc1_color(block, true, out);
+                        break;
+                    case FORMAT_BC3_RGBA:
+                    case FORMAT_BC3_SRGBA:
+                        encode_bc4(block, 3, out);
+                        encode_bc1_color(block, false, out + 8);
+                        break;
+                    case FORMAT_BC4_R:
+                        encode_bc4(block, 0, out);
+                        break;
+                    case FORMAT_BC5_RG:
+                        encode_bc4(block, 0, out);
+                        encode_bc4(block, 1, out + 8);
+                        break;
+                    case FORMAT_BC7_RGBA:
+                    case FORMAT_BC7_SRGBA:
+                        encode_bc7(block, out);
+                        break;
+                    default:
+                        assert(0);
+                }
+            }
+        }
+    }
+}; // struct block_row_compressor
+
+} // namespace
+
+bool
+is_block_compression_target(data_format in_dst_fmt)
+{
+    switch (in_dst_fmt) {
+        case FORMAT_BC1_RGBA:
+        case FORMAT_BC1_SRGBA:
+        case FORMAT_BC3_RGBA:
+        case FORMAT_BC3_SRGBA:
+        case FORMAT_BC4_R:
+        case FORMAT_BC5_RG:
+        case FORMAT_BC7_RGBA:
+        case FORMAT_BC7_SRGBA:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool
+is_block_compression_source(data_format in_src_fmt)
+{
+    switch (in_src_fmt) {
+        case FORMAT_R_8:
+        case FORMAT_RG_8:
+        case FORMAT_RGB_8:
+        case FORMAT_RGBA_8:
+        case FORMAT_BGR_8:
+        case FORMAT_BGRA_8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+scm::size_t
+compressed_image_size(const math::vec2ui& in_size,
+                      data_format         in_dst_fmt)
+{
+    return   static_cast<scm::size_t>((in_size.x + 3) / 4)
+           * static_cast<scm::size_t>((in_size.y + 3) / 4)
+           * compressed_block_size(in_dst_fmt);
+}
+
+bool
+compress_image(const math::vec2ui&  in_size,
+               data_format          in_src_fmt,
+               const uint8*         in_src_data,
+               data_format          in_dst_fmt,
+               uint8*               out_dst_data,
+               bool                 in_parallel)
+{
+    if (!is_block_compression_source(in_src_fmt)) {
+        glerr() << log::error << "compress_image(): unsupported source format ("
+                << format_string(in_src_fmt) << ")." << log::end;
+        return false;
+    }
+    if (!is_block_compression_target(in_dst_fmt)) {
+        glerr() << log::error << "compress_image(): unsupported target format ("
+                << format_string(in_dst_fmt) << ")." << log::end;
+        return false;
+    }
+    if (in_size.x < 1 || in_size.y < 1) {
+        glerr() << log::error << "compress_image(): empty image." << log::end;
+        return false;
+    }
+
+    block_row_compressor c;
+    c._src     = in_src_data;
+    c._size    = in_size;
+    c._src_fmt = in_src_fmt;
+    c._dst     = out_dst_data;
+    c._dst_fmt = in_dst_fmt;
+
+    const scm::size_t blocks_x = (in_size.x + 3) / 4;
+    const scm::size_t blocks_y = (in_size.y + 3) / 4;
+
+    if (in_parallel) {
+        parallel_for(blocks_y, (std::max)(scm::size_t(1), bc_range_blocks / blocks_x), c);
+    }
+    else {
+        c(0, blocks_y, 0);
+    }
+
+    return true;
+}
+
+texture_image_data_ptr
+compress_image_data(const texture_image_data_ptr& in_img_data,
+                    data_format                   in_dst_fmt,
+                    bool                          in_parallel)
+{
+    if (!in_img_data) {
+        glerr() << log::error << "compress_image_data(): invalid image data." << log::end;
+        return texture_image_data_ptr();
+    }
+
+    texture_image_data::level_vector levels;
+
+    for (int l = 0; l < in_img_data->mip_level_count(); ++l) {
+        const texture_image_data::level& src_level  = in_img_data->mip_level(l);
+        const math::vec2ui               slice_size = math::vec2ui(src_level.size().x, src_level.size().y);
+        const scm::size_t                src_slice  = static_cast<scm::size_t>(slice_size.x) * slice_size.y * size_of_format(in_img_data->format());
+        const scm::size_t                dst_slice  = compressed_image_size(slice_size, in_dst_fmt);
+
+        shared_array<uint8> dst_data(new uint8[dst_slice * src_level.size().z]);
+
+        for (unsigned s = 0; s < src_level.size().z; ++s) {
+            if (!compress_image(slice_size, in_img_data->format(), src_level.data().get() + src_slice * s,
+                                in_dst_fmt, dst_data.get() + dst_slice * s, in_parallel)) {
+                glerr() << log::error << "compress_image_data(): error compressing level " << l << "." << log::end;
+                return texture_image_data_ptr();
+            }
+        }
+        levels.push_back(texture_image_data::level(src_level.size(), dst_data));
+    }
+
+    return texture_image_data_ptr(new texture_image_data(in_img_data->origin(), in_dst_fmt, in_img_data->array_layers(), levels));
+}
+
+} // namespace util
+} // namespace gl
+} // namespace scm
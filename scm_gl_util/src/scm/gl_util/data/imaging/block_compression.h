@@ -0,0 +1,67 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_BLOCK_COMPRESSION_H_INCLUDED
+#define SCM_GL_UTIL_BLOCK_COMPRESSION_H_INCLUDED
+
+#include <scm/core/math.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/data_formats.h>
+
+#include <scm/gl_util/data/imaging/imaging_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+namespace util {
+
+// cpu block compression of 8bit images
+//  - targets: bc1 (rgb, 1bit alpha), bc3, bc4, bc5 and bc7 (mode 6 only),
+//    srgb variants share the encoders of the linear formats
+//  - sources: r, rg, rgb, rgba and bgr(a) 8bit images, missing channels are
+//    read as 0 (alpha as 255), bc4 encodes red, bc5 red and green
+//  - endpoints are fitted along the principal axis of each block, bc1/bc3
+//    color endpoints are refined once by least squares, the index search runs
+//    over four texels at a time (sse)
+//  - block rows are distributed over all hardware threads if in_parallel is set
+bool
+__scm_export(gl_util)
+is_block_compression_target(data_format in_dst_fmt);
+
+bool
+__scm_export(gl_util)
+is_block_compression_source(data_format in_src_fmt);
+
+// size of one compressed image, partial blocks at the borders included
+scm::size_t
+__scm_export(gl_util)
+compressed_image_size(const math::vec2ui& in_size,
+                      data_format         in_dst_fmt);
+
+bool
+__scm_export(gl_util)
+compress_image(const math::vec2ui&  in_size,
+               data_format          in_src_fmt,
+               const uint8*         in_src_data,
+               data_format          in_dst_fmt,
+               uint8*               out_dst_data,
+               bool                 in_parallel = true);
+
+// compresses all mip levels (and slices) of in_img_data, null on error
+texture_image_data_ptr
+__scm_export(gl_util)
+compress_image_data(const texture_image_data_ptr& in_img_data,
+                    data_format                   in_dst_fmt,
+                    bool                          in_parallel = true);
+
+} // namespace util
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_BLOCK_COMPRESSION_H_INCLUDED
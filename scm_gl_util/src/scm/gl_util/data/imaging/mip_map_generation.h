@@ -5,8 +5,22 @@
 #ifndef SCM_GL_UTIL_MIP_MAP_GENERATION_H_INCLUDED
 #define SCM_GL_UTIL_MIP_MAP_GENERATION_H_INCLUDED
 
+#include <vector>
+
 #include <boost/numeric/conversion/bounds.hpp>
 
+#include <scm/core/math.h>
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+#include <scm/core/math/config.h>
+
+#include <scm/gl_core/texture_objects/texture_image.h>
+
+#if SCM_CORE_MATH_SIMD_SSE
+#   include <xmmintrin.h>
+#   include <emmintrin.h>
+#endif
+
 namespace scm {
 namespace gl {
 namespace util {
@@ -174,6 +188,147 @@ typed_generate_mipmaps(const math::vec3ui&        src_dim,
     }
 }
 
+// row kernels of the separable mip-map filter, shared by generate_mipmaps_2d
+// and the out-of-core volume_pyramid_builder
+
+// polyphase box filter taps for destination sample i (see typed_generate_mipmaps)
+//  - even source size: box filter of two samples
+//  - odd source size:  three samples weighted (d - i, d, 1 + i) / (2d + 1)
+inline
+unsigned
+filter_taps(unsigned src_size, unsigned dst_size, unsigned i, float weights[3])
+{
+    if (src_size == 1) {
+        weights[0] = 1.0f;
+        return 1;
+    }
+    else if ((src_size & 1) == 0) {
+        weights[0] = weights[1] = 0.5f;
+        return 2;
+    }
+    else {
+        const float scale = 1.0f / (2.0f * dst_size + 1.0f);
+        weights[0] = static_cast<float>(dst_size - i) * scale;
+        weights[1] = static_cast<float>(dst_size)     * scale;
+        weights[2] = static_cast<float>(1 + i)        * scale;
+        return 3;
+    }
+}
+
+// acc[i] += w * src[i] for whole rows
+template<typename vtype>
+inline
+void
+accumulate_row(float* acc, const vtype* src, scm::size_t count, float w)
+{
+    for (scm::size_t i = 0; i < count; ++i) {
+        acc[i] += w * static_cast<float>(src[i]);
+    }
+}
+
+#if SCM_CORE_MATH_SIMD_SSE
+template<>
+inline
+void
+accumulate_row<float>(float* acc, const float* src, scm::size_t count, float w)
+{
+    const __m128 vw = _mm_set1_ps(w);
+    scm::size_t  i  = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(vw, _mm_loadu_ps(src + i))));
+    }
+    for (; i < count; ++i) {
+        acc[i] += w * src[i];
+    }
+}
+
+template<>
+inline
+void
+accumulate_row<scm::uint8>(float* acc, const scm::uint8* src, scm::size_t count, float w)
+{
+    const __m128  vw = _mm_set1_ps(w);
+    const __m128i z  = _mm_setzero_si128();
+    scm::size_t   i  = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i v   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i vlo = _mm_unpacklo_epi8(v, z);
+        const __m128i vhi = _mm_unpackhi_epi8(v, z);
+        const __m128  f0  = _mm_cvtepi32_ps(_mm_unpacklo_epi16(vlo, z));
+        const __m128  f1  = _mm_cvtepi32_ps(_mm_unpackhi_epi16(vlo, z));
+        const __m128  f2  = _mm_cvtepi32_ps(_mm_unpacklo_epi16(vhi, z));
+        const __m128  f3  = _mm_cvtepi32_ps(_mm_unpackhi_epi16(vhi, z));
+        _mm_storeu_ps(acc + i,      _mm_add_ps(_mm_loadu_ps(acc + i),      _mm_mul_ps(vw, f0)));
+        _mm_storeu_ps(acc + i +  4, _mm_add_ps(_mm_loadu_ps(acc + i +  4), _mm_mul_ps(vw, f1)));
+        _mm_storeu_ps(acc + i +  8, _mm_add_ps(_mm_loadu_ps(acc + i +  8), _mm_mul_ps(vw, f2)));
+        _mm_storeu_ps(acc + i + 12, _mm_add_ps(_mm_loadu_ps(acc + i + 12), _mm_mul_ps(vw, f3)));
+    }
+    for (; i < count; ++i) {
+        acc[i] += w * static_cast<float>(src[i]);
+    }
+}
+
+template<>
+inline
+void
+accumulate_row<scm::uint16>(float* acc, const scm::uint16* src, scm::size_t count, float w)
+{
+    const __m128  vw = _mm_set1_ps(w);
+    const __m128i z  = _mm_setzero_si128();
+    scm::size_t   i  = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128  f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, z));
+        const __m128  f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, z));
+        _mm_storeu_ps(acc + i,     _mm_add_ps(_mm_loadu_ps(acc + i),     _mm_mul_ps(vw, f0)));
+        _mm_storeu_ps(acc + i + 4, _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(vw, f1)));
+    }
+    for (; i < count; ++i) {
+        acc[i] += w * static_cast<float>(src[i]);
+    }
+}
+#endif // SCM_CORE_MATH_SIMD_SSE
+
+// horizontal filter of a vertically filtered row of vdim channel samples
+template<const unsigned vdim>
+inline
+void
+filter_row_x(const float* src, unsigned src_width, float* dst, unsigned dst_width)
+{
+    float w[3];
+    for (unsigned x = 0; x < dst_width; ++x) {
+        const unsigned taps = filter_taps(src_width, dst_width, x, w);
+        const float*   s    = src + static_cast<scm::size_t>(2 * x) * vdim;
+        float*         d    = dst + static_cast<scm::size_t>(x) * vdim;
+        for (unsigned c = 0; c < vdim; ++c) {
+            float v = w[0] * s[c];
+            for (unsigned t = 1; t < taps; ++t) {
+                v += w[t] * s[t * vdim + c];
+            }
+            d[c] = v;
+        }
+    }
+}
+
+#if SCM_CORE_MATH_SIMD_SSE
+template<>
+inline
+void
+filter_row_x<4>(const float* src, unsigned src_width, float* dst, unsigned dst_width)
+{
+    float w[3];
+    for (unsigned x = 0; x < dst_width; ++x) {
+        const unsigned taps = filter_taps(src_width, dst_width, x, w);
+        const float*   s    = src + static_cast<scm::size_t>(8) * x;
+        __m128         v    = _mm_mul_ps(_mm_set1_ps(w[0]), _mm_loadu_ps(s));
+        for (unsigned t = 1; t < taps; ++t) {
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(w[t]), _mm_loadu_ps(s + 4 * t)));
+        }
+        _mm_storeu_ps(dst + static_cast<scm::size_t>(4) * x, v);
+    }
+}
+#endif // SCM_CORE_MATH_SIMD_SSE
+
 } // namespace util
 } // namespace gl
 } // namespace scm
@@ -6,10 +6,24 @@
 
 #include <memory.h>
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include <boost/numeric/conversion/bounds.hpp>
+
+#include <scm/core/math/config.h>
+#include <scm/core/utilities/parallel_for.h>
+
 #include <scm/gl_core/log.h>
 #include <scm/gl_core/texture_objects/texture_image.h>
 #include <scm/gl_util/data/imaging/mip_map_generation.h>
 
+#if SCM_CORE_MATH_SIMD_SSE
+#   include <xmmintrin.h>
+#   include <emmintrin.h>
+#endif
+
 namespace scm {
 namespace gl {
 namespace util {
@@ -389,6 +403,191 @@ generate_mipmaps(const math::vec3ui&        src_dim,
     return true;
 }
 
+namespace {
+
+// destination texels filtered per range of rows in generate_mipmaps_2d
+const scm::size_t mip_2d_range_texels = 64 * 1024;
+
+// rounds and clamps the filtered samples to the value range of vtype
+template<typename vtype>
+inline
+void
+store_row(vtype* dst, const float* src, scm::size_t count)
+{
+    const float vmin = static_cast<float>(boost::numeric::bounds<vtype>::lowest());
+    const float vmax = static_cast<float>(boost::numeric::bounds<vtype>::highest());
+    for (scm::size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<vtype>(std::floor(math::clamp(src[i], vmin, vmax) + 0.5f));
+    }
+}
+
+template<>
+inline
+void
+store_row<float>(float* dst, const float* src, scm::size_t count)
+{
+    memcpy(dst, src, count * sizeof(float));
+}
+
+#if SCM_CORE_MATH_SIMD_SSE
+template<>
+inline
+void
+store_row<scm::uint8>(scm::uint8* dst, const float* src, scm::size_t count)
+{
+    const __m128 vmin  = _mm_setzero_ps();
+    const __m128 vmax  = _mm_set1_ps(255.0f);
+    const __m128 vhalf = _mm_set1_ps(0.5f);
+
+    scm::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        // same rounding as the scalar path: clamp, add 0.5 and truncate (equals
+        // floor for the clamped non-negative values)
+        const __m128i i0 = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i),      vmin), vmax), vhalf));
+        const __m128i i1 = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i +  4), vmin), vmax), vhalf));
+        const __m128i i2 = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i +  8), vmin), vmax), vhalf));
+        const __m128i i3 = _mm_cvttps_epi32(_mm_add_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 12), vmin), vmax), vhalf));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_packus_epi16(_mm_packs_epi32(i0, i1), _mm_packs_epi32(i2, i3)));
+    }
+    for (; i < count; ++i) {
+        dst[i] = static_cast<scm::uint8>(std::floor(math::clamp(src[i], 0.0f, 255.0f) + 0.5f));
+    }
+}
+#endif // SCM_CORE_MATH_SIMD_SSE
+
+// filters the destination rows [row_begin, row_end) of one mip level
+template<typename vtype, const unsigned vdim>
+struct mip_level_filter_2d
+{
+    const vtype*        _src;
+    math::vec2ui        _src_dim;
+    vtype*              _dst;
+    math::vec2ui        _dst_dim;
+
+    void operator()(scm::size_t row_begin, scm::size_t row_end, unsigned /*range_index*/) const
+    {
+        const scm::size_t  src_row = static_cast<scm::size_t>(_src_dim.x) * vdim;
+        const scm::size_t  dst_row = static_cast<scm::size_t>(_dst_dim.x) * vdim;
+        std::vector<float> vrow(src_row);
+        std::vector<float> hrow(dst_row);
+
+        float w[3];
+        for (scm::size_t y = row_begin; y < row_end; ++y) {
+            const unsigned taps = filter_taps(_src_dim.y, _dst_dim.y, static_cast<unsigned>(y), w);
+
+            std::fill(vrow.begin(), vrow.end(), 0.0f);
+            for (unsigned t = 0; t < taps; ++t) {
+                accumulate_row(&vrow[0], _src + (2 * y + t) * src_row, src_row, w[t]);
+            }
+            filter_row_x<vdim>(&vrow[0], _src_dim.x, &hrow[0], _dst_dim.x);
+            store_row(_dst + y * dst_row, &hrow[0], dst_row);
+        }
+    }
+}; // struct mip_level_filter_2d
+
+template<typename vtype, const unsigned vdim>
+void
+typed_generate_mipmaps_2d(const math::vec2ui&        src_dim,
+                                unsigned             in_levels,
+                                uint8*               data,
+                                std::vector<uint8*>& dst_data,
+                                bool                 in_parallel)
+{
+    dst_data.push_back(data);
+
+    uint8* level_data = data;
+    for (unsigned l = 1; l < in_levels; ++l) {
+        mip_level_filter_2d<vtype, vdim> f;
+        f._src     = reinterpret_cast<const vtype*>(level_data);
+        f._src_dim = mip_level_dimensions(src_dim, l - 1);
+        f._dst_dim = mip_level_dimensions(src_dim, l);
+
+        level_data += static_cast<scm::size_t>(f._src_dim.x) * f._src_dim.y * vdim * sizeof(vtype);
+        f._dst      = reinterpret_cast<vtype*>(level_data);
+
+        if (in_parallel) {
+            parallel_for(f._dst_dim.y, (std::max)(scm::size_t(1), mip_2d_range_texels / f._dst_dim.x), f);
+        }
+        else {
+            f(0, f._dst_dim.y, 0);
+        }
+
+        dst_data.push_back(level_data);
+    }
+}
+
+template<typename vtype>
+bool
+typed_generate_mipmaps_2d(const math::vec2ui&        src_dim,
+                                unsigned             in_channels,
+                                unsigned             in_levels,
+                                uint8*               data,
+                                std::vector<uint8*>& dst_data,
+                                bool                 in_parallel)
+{
+    switch (in_channels) {
+        case 1: typed_generate_mipmaps_2d<vtype, 1>(src_dim, in_levels, data, dst_data, in_parallel); return true;
+        case 2: typed_generate_mipmaps_2d<vtype, 2>(src_dim, in_levels, data, dst_data, in_parallel); return true;
+        case 3: typed_generate_mipmaps_2d<vtype, 3>(src_dim, in_levels, data, dst_data, in_parallel); return true;
+        case 4: typed_generate_mipmaps_2d<vtype, 4>(src_dim, in_levels, data, dst_data, in_parallel); return true;
+        default: return false;
+    }
+}
+
+} // namespace
+
+scm::size_t
+mip_chain_size_2d(const math::vec2ui&        src_dim,
+                        gl::data_format      src_fmt,
+                        unsigned             in_levels)
+{
+    scm::size_t chain_size = 0;
+    for (unsigned l = 0; l < in_levels; ++l) {
+        const math::vec2ui lsize = mip_level_dimensions(src_dim, l);
+        chain_size += static_cast<scm::size_t>(lsize.x) * lsize.y * size_of_format(src_fmt);
+    }
+    return chain_size;
+}
+
+bool
+generate_mipmaps_2d(const math::vec2ui&        src_dim,
+                          gl::data_format      src_fmt,
+                          unsigned             in_levels,
+                          uint8*               data,
+                          std::vector<uint8*>& dst_data,
+                          bool                 in_parallel)
+{
+    assert(in_levels <= max_mip_levels(src_dim));
+
+    const unsigned channels = channel_count(src_fmt);
+    bool           ret      = false;
+
+    switch (src_fmt) {
+        case FORMAT_R_8:    case FORMAT_RG_8:   case FORMAT_RGB_8:   case FORMAT_RGBA_8:
+        case FORMAT_BGR_8:  case FORMAT_BGRA_8:
+            ret = typed_generate_mipmaps_2d<uint8>(src_dim, channels, in_levels, data, dst_data, in_parallel);
+            break;
+        case FORMAT_R_16:   case FORMAT_RG_16:  case FORMAT_RGB_16:  case FORMAT_RGBA_16:
+            ret = typed_generate_mipmaps_2d<uint16>(src_dim, channels, in_levels, data, dst_data, in_parallel);
+            break;
+        case FORMAT_R_16S:  case FORMAT_RG_16S: case FORMAT_RGB_16S: case FORMAT_RGBA_16S:
+            ret = typed_generate_mipmaps_2d<int16>(src_dim, channels, in_levels, data, dst_data, in_parallel);
+            break;
+        case FORMAT_R_32F:  case FORMAT_RG_32F: case FORMAT_RGB_32F: case FORMAT_RGBA_32F:
+            ret = typed_generate_mipmaps_2d<float>(src_dim, channels, in_levels, data, dst_data, in_parallel);
+            break;
+        default:
+            break;
+    }
+
+    if (!ret) {
+        glerr() << log::error
+                << "generate_mipmaps_2d(): error unsupported source data format (" << format_string(src_fmt) << ")." << log::end;
+    }
+    return ret;
+}
+
 } // namespace util
 } // namespace gl
 } // namespace scm
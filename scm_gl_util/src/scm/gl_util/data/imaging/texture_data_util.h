@@ -33,6 +33,30 @@ generate_mipmaps(const math::vec3ui&        src_dim,
                        uint8*               src_data,
                        std::vector<uint8*>& dst_data);
 
+// size of in_levels mip levels of a 2d image stored back to back, level 0 first
+scm::size_t
+__scm_export(gl_util)
+mip_chain_size_2d(const math::vec2ui&        src_dim,
+                        gl::data_format      src_fmt,
+                        unsigned             in_levels);
+
+// generates the mip levels 1..in_levels-1 of a 2d image in place
+//  - data holds level 0 followed by the space for the remaining levels (see
+//    mip_chain_size_2d), dst_data receives the pointers to all levels
+//  - same polyphase box filter as generate_mipmaps for non power of two sizes,
+//    vertical taps are blended over whole rows (sse), then filtered horizontally
+//  - the rows of a level are distributed over all hardware threads if
+//    in_parallel is set (leave it unset when decoding several images concurrently)
+//  - supports 8bit, 16bit and 32bit float formats with 1-4 channels (including bgr(a))
+bool
+__scm_export(gl_util)
+generate_mipmaps_2d(const math::vec2ui&        src_dim,
+                          gl::data_format      src_fmt,
+                          unsigned             in_levels,
+                          uint8*               data,
+                          std::vector<uint8*>& dst_data,
+                          bool                 in_parallel = true);
+
 } // namespace util
 } // namespace gl
 } // namespace scm
@@ -12,12 +12,15 @@
 
 #include <scm/core/math.h>
 #include <scm/core/memory.h>
+#include <scm/core/utilities/parallel_for.h>
 
 #include <scm/gl_core/data_formats.h>
 #include <scm/gl_core/log.h>
 #include <scm/gl_core/render_device.h>
 #include <scm/gl_core/texture_objects.h>
 
+#include <scm/gl_util/data/imaging/block_compression.h>
+#include <scm/gl_util/data/imaging/texture_data_util.h>
 #include <scm/gl_util/data/imaging/texture_image_data.h>
 
 namespace scm {
@@ -59,150 +62,183 @@ void scale_colors(float r, float g, float b,
     }
 }
 
-std::pair<std::vector<void*>, std::vector<shared_array<unsigned char> > > get_data(const std::string&   in_image_path,
-                            bool                 in_create_mips,
-                            bool                 in_color_mips,
-                            const data_format    in_force_internal_format,
-                            math::vec2ui&        out_image_size,
-                            data_format&         out_image_format,
-                            data_format&         out_image_internal_format,
-                            unsigned&            out_num_mipmaps) {
+// decoded image with all mip levels in one contiguous allocation
+struct decoded_image
+{
+    decoded_image()
+      : _size(0u)
+      , _format(FORMAT_NULL)
+      , _internal_format(FORMAT_NULL)
+      , _mip_count(1)
+      , _valid(false)
+    {}
+
+    math::vec2ui            _size;
+    data_format             _format;
+    data_format             _internal_format;
+    unsigned                _mip_count;
+    bool                    _valid;
+
+    shared_array<uint8>     _data;
+    std::vector<void*>      _level_data;        // pointers into _data, level 0 first
+}; // struct decoded_image
 
+bool
+decode_image(const std::string&   in_image_path,
+             bool                 in_create_mips,
+             bool                 in_color_mips,
+             const data_format    in_force_internal_format,
+             bool                 in_parallel_mips,
+             decoded_image&       out_image)
+{
     scm::scoped_ptr<fipImage>   in_image(new fipImage);
 
     if (!in_image->load(in_image_path.c_str())) {
         glerr() << log::error << "texture_loader::load_texture_2d(): "
                 << "unable to open file: " << in_image_path << log::end;
-        return {};
+        return false;
     }
 
     FREE_IMAGE_TYPE  image_type = in_image->getImageType();
-    unsigned         image_bit_count = in_image->getInfoHeader()->biBitCount;
-    out_image_size = math::vec2ui(in_image->getWidth(), in_image->getHeight());
-    //int             image_pitch     = in_image->getScanWidth();
-    
-    //glout() << log::info << "bitcount " << image_bit_count << " scan width " << static_cast<float>(image_pitch) / 3;
+    out_image._size = math::vec2ui(in_image->getWidth(), in_image->getHeight());
 
     switch (image_type) {
         case FIT_BITMAP: {
             unsigned num_components = in_image->getBitsPerPixel() / 8;
             switch (num_components) {
-                case 1: out_image_format = out_image_internal_format = FORMAT_R_8; break;
-                case 2: out_image_format = out_image_internal_format = FORMAT_RG_8; break;
-                case 3: out_image_format = FORMAT_BGR_8; out_image_internal_format = FORMAT_RGB_8; break;
-                case 4: out_image_format = FORMAT_BGRA_8; out_image_internal_format = FORMAT_RGBA_8; break;
+                case 1: out_image._format = out_image._internal_format = FORMAT_R_8; break;
+                case 2: out_image._format = out_image._internal_format = FORMAT_RG_8; break;
+                case 3: out_image._format = FORMAT_BGR_8; out_image._internal_format = FORMAT_RGB_8; break;
+                case 4: out_image._format = FORMAT_BGRA_8; out_image._internal_format = FORMAT_RGBA_8; break;
             }
         } break;
-        case FIT_INT16:     out_image_format = out_image_internal_format = FORMAT_R_16S; break;
-        case FIT_UINT16:    out_image_format = out_image_internal_format = FORMAT_R_16; break;
-        case FIT_RGB16:     out_image_format = out_image_internal_format = FORMAT_RGB_16; break;
-        case FIT_RGBA16:    out_image_format = out_image_internal_format = FORMAT_RGBA_16; break;
+        case FIT_INT16:     out_image._format = out_image._internal_format = FORMAT_R_16S; break;
+        case FIT_UINT16:    out_image._format = out_image._internal_format = FORMAT_R_16; break;
+        case FIT_RGB16:     out_image._format = out_image._internal_format = FORMAT_RGB_16; break;
+        case FIT_RGBA16:    out_image._format = out_image._internal_format = FORMAT_RGBA_16; break;
         case FIT_INT32:     break; 
         case FIT_UINT32:    break;
-        case FIT_FLOAT:     out_image_format = out_image_internal_format = FORMAT_R_32F; break;
-        case FIT_RGBF:      out_image_format = out_image_internal_format = FORMAT_RGB_32F; break;
-        case FIT_RGBAF:     out_image_format = out_image_internal_format = FORMAT_RGBA_32F; break;
+        case FIT_FLOAT:     out_image._format = out_image._internal_format = FORMAT_R_32F; break;
+        case FIT_RGBF:      out_image._format = out_image._internal_format = FORMAT_RGB_32F; break;
+        case FIT_RGBAF:     out_image._format = out_image._internal_format = FORMAT_RGBA_32F; break;
     }
 
-    if (out_image_format == FORMAT_NULL) {
+    if (out_image._format == FORMAT_NULL) {
         glerr() << log::error << "texture_loader::load_texture_2d(): "
                 << "unsupported color format: " << std::hex << in_image->getImageType() << log::end;
-        return {};
+        return false;
     }
 
-    std::vector<shared_array<unsigned char> >   image_mip_data;
-    std::vector<void*>                          image_mip_data_raw;
+    out_image._mip_count = in_create_mips ? util::max_mip_levels(out_image._size) : 1;
+    out_image._data.reset(new uint8[util::mip_chain_size_2d(out_image._size, out_image._format, out_image._mip_count)]);
 
-    if (in_create_mips) {
-        out_num_mipmaps = util::max_mip_levels(out_image_size);
+    { // copy level 0, free image scan lines are 32bit aligned
+        const size_t line_pitch = in_image->getScanWidth();
+        const size_t line_size  = static_cast<size_t>(out_image._size.x) * size_of_format(out_image._format);
+        for (unsigned l = 0; l < out_image._size.y; ++l) {
+            memcpy(out_image._data.get() + line_size * l,
+                   reinterpret_cast<uint8*>(in_image->accessPixels()) + line_pitch * l,
+                   line_size);
+        }
     }
+    in_image.reset();
 
-    for (unsigned i = 0; i < out_num_mipmaps; ++i) {
-        scm::size_t  cur_data_size = 0;
-        math::vec2ui lev_size = util::mip_level_dimensions(out_image_size, i);
+    std::vector<uint8*> level_data;
+    if (!util::generate_mipmaps_2d(out_image._size, out_image._format, out_image._mip_count,
+                                   out_image._data.get(), level_data, in_parallel_mips)) {
+        glerr() << log::error << "texture_loader::load_texture_2d(): "
+                << "unable to generate mip levels (file: " << in_image_path << ")" << log::end;
+        return false;
+    }
 
-        if (i == 0) {
-            lev_size      = out_image_size;
-            cur_data_size =   out_image_size.x * out_image_size.y;
-            cur_data_size *=  channel_count(out_image_format);
-            cur_data_size *=  size_of_channel(out_image_format);
+    for (unsigned i = 0; i < out_image._mip_count; ++i) {
+        // tint after all levels are generated, the filter reads the previous level
+        if (0 != i && in_color_mips) {
+            math::vec2ui lev_size = util::mip_level_dimensions(out_image._size, i);
+            if      (i % 6 == 1) scale_colors(1, 0, 0, lev_size.x, lev_size.y, out_image._format, level_data[i]);
+            else if (i % 6 == 2) scale_colors(0, 1, 0, lev_size.x, lev_size.y, out_image._format, level_data[i]);
+            else if (i % 6 == 3) scale_colors(0, 0, 1, lev_size.x, lev_size.y, out_image._format, level_data[i]);
+            else if (i % 6 == 4) scale_colors(1, 0, 1, lev_size.x, lev_size.y, out_image._format, level_data[i]);
+            else if (i % 6 == 5) scale_colors(0, 1, 1, lev_size.x, lev_size.y, out_image._format, level_data[i]);
+            else if (i % 6 == 0) scale_colors(1, 1, 0, lev_size.x, lev_size.y, out_image._format, level_data[i]);
         }
-        else {
-            cur_data_size =   lev_size.x * lev_size.y;
-            cur_data_size *=  channel_count(out_image_format);
-            cur_data_size *=  size_of_channel(out_image_format);
-
-            if (FALSE == in_image->rescale(lev_size.x, lev_size.y, FILTER_LANCZOS3)) {
-                glerr() << log::error << "texture_loader::load_texture_2d(): "
-                        << "unable to scale image (level: " << i << ", dim: " << lev_size << ")" << log::end;
-                return {};
-            }
-            //image_pitch     = in_image->getScanWidth();
-    
-            ////glout() << log::info << "bitcount " << image_bit_count << " scan width " << static_cast<float>(image_pitch) / 3;
+        out_image._level_data.push_back(level_data[i]);
+    }
 
-            ////std::stringstream ofn;
-            ////ofn << in_image_path << "_" << i << ".png";
-            ////in_image->save(ofn.str().c_str());
+    if (   util::is_block_compression_target(in_force_internal_format)
+        && util::is_block_compression_source(out_image._format)) {
+        // compress on the cpu instead of leaving it to the driver
+        std::vector<scm::size_t> level_offsets(out_image._mip_count);
+        scm::size_t              compressed_size = 0;
+        for (unsigned i = 0; i < out_image._mip_count; ++i) {
+            level_offsets[i]  = compressed_size;
+            compressed_size  += util::compressed_image_size(util::mip_level_dimensions(out_image._size, i), in_force_internal_format);
+        }
 
-            if (in_image->getWidth() != lev_size.x || in_image->getHeight() != lev_size.y) {
+        shared_array<uint8> compressed_data(new uint8[compressed_size]);
+        for (unsigned i = 0; i < out_image._mip_count; ++i) {
+            if (!util::compress_image(util::mip_level_dimensions(out_image._size, i), out_image._format,
+                                      reinterpret_cast<const uint8*>(out_image._level_data[i]),
+                                      in_force_internal_format, compressed_data.get() + level_offsets[i],
+                                      in_parallel_mips)) {
                 glerr() << log::error << "texture_loader::load_texture_2d(): "
-                        << "image dimensions changed after resamling (level: " << i
-                        << ", dim: " << lev_size 
-                        << ", type: " << std::hex << in_image->getImageType() << ")" << log::end;
-                return {};
+                        << "unable to compress mip level " << i << " (file: " << in_image_path << ")" << log::end;
+                return false;
             }
-            if (in_image->getInfoHeader()->biBitCount != image_bit_count) {
-                glerr() << log::error << "texture_loader::load_texture_2d(): "
-                        << "image bitcount changed after resamling (level: " << i
-                        << ", bit_count: " << image_bit_count 
-                        << ", img_bit_count: " << in_image->getInfoHeader()->biBitCount << ")" << log::end;
-                return {};
-            }
-            if (image_type != in_image->getImageType()) {
-                glerr() << log::error << "texture_loader::load_texture_2d(): "
-                        << "image type changed after resamling (level: " << i
-                        << ", dim: " << lev_size 
-                        << ", type: " << std::hex << in_image->getImageType() << ")" << log::end;
-                return {};
-            }
-        }
-
-        scm::shared_array<unsigned char> cur_data(new unsigned char[cur_data_size]);
-
-        size_t line_pitch = in_image->getScanWidth();
-        for (unsigned l = 0; l < lev_size.y; ++l) {
-            size_t ls = static_cast<size_t>(lev_size.x) * size_of_format(out_image_format);
-            uint8* s =   reinterpret_cast<uint8*>(in_image->accessPixels())
-                       + line_pitch * l;
-            uint8* d =   reinterpret_cast<uint8*>(cur_data.get())
-                       + ls * l;
-            memcpy(d, s, ls);
+            out_image._level_data[i] = compressed_data.get() + level_offsets[i];
         }
-
-        //if (memcpy(cur_data.get(), in_image->accessPixels(), cur_data_size) != cur_data.get()) {
-        //    glerr() << log::error << "texture_loader::load_texture_2d(): "
-        //            << "unable to copy image data (level: " << i << ", size: " << cur_data_size << "byte)" << log::end;
-        //    return (texture_2d_ptr());
-        //}
-        if (0 != i && in_color_mips) {
-            if      (i % 6 == 1) scale_colors(1, 0, 0, lev_size.x, lev_size.y, out_image_format, cur_data.get());
-            else if (i % 6 == 2) scale_colors(0, 1, 0, lev_size.x, lev_size.y, out_image_format, cur_data.get());
-            else if (i % 6 == 3) scale_colors(0, 0, 1, lev_size.x, lev_size.y, out_image_format, cur_data.get());
-            else if (i % 6 == 4) scale_colors(1, 0, 1, lev_size.x, lev_size.y, out_image_format, cur_data.get());
-            else if (i % 6 == 5) scale_colors(0, 1, 1, lev_size.x, lev_size.y, out_image_format, cur_data.get());
-            else if (i % 6 == 0) scale_colors(1, 1, 0, lev_size.x, lev_size.y, out_image_format, cur_data.get());
-        }
-
-        image_mip_data.push_back(cur_data);
-        image_mip_data_raw.push_back(cur_data.get());
+        out_image._data   = compressed_data;
+        out_image._format = in_force_internal_format;
     }
 
     if (in_force_internal_format != FORMAT_NULL) {
-        out_image_internal_format = in_force_internal_format;
+        out_image._internal_format = in_force_internal_format;
     }
 
-    return {image_mip_data_raw, image_mip_data};
+    out_image._valid = true;
+
+    return true;
+}
+
+// decodes one image per range item, used with parallel_for
+struct image_decoder
+{
+    const std::vector<std::string>*     _image_paths;
+    std::vector<decoded_image>*         _images;
+    bool                                _create_mips;
+    bool                                _color_mips;
+    data_format                         _force_internal_format;
+    bool                                _parallel_mips;
+
+    void operator()(scm::size_t begin, scm::size_t end, unsigned /*range_index*/) const
+    {
+        for (scm::size_t i = begin; i < end; ++i) {
+            decode_image((*_image_paths)[i], _create_mips, _color_mips, _force_internal_format,
+                         _parallel_mips, (*_images)[i]);
+        }
+    }
+}; // struct image_decoder
+
+void
+decode_images(const std::vector<std::string>&   in_image_paths,
+              bool                              in_create_mips,
+              bool                              in_color_mips,
+              const data_format                 in_force_internal_format,
+              std::vector<decoded_image>&       out_images)
+{
+    out_images.clear();
+    out_images.resize(in_image_paths.size());
+
+    image_decoder d;
+    d._image_paths           = &in_image_paths;
+    d._images                = &out_images;
+    d._create_mips           = in_create_mips;
+    d._color_mips            = in_color_mips;
+    d._force_internal_format = in_force_internal_format;
+    // only split the mip generation of single images if there are idle threads left
+    d._parallel_mips         = in_image_paths.size() < boost::thread::hardware_concurrency();
+
+    parallel_for(in_image_paths.size(), 1, d);
 }
 
 } // namespace
@@ -214,30 +250,52 @@ texture_loader::load_texture_2d(render_device&       in_device,
                                 bool                 in_color_mips,
                                 const data_format    in_force_internal_format)
 {
+    decoded_image image;
 
-    math::vec2ui    image_size(0,0);
-    data_format     image_format = FORMAT_NULL;
-    data_format     internal_format = FORMAT_NULL;
-    unsigned        num_mip_levels = 1;
+    if (!decode_image(in_image_path, in_create_mips, in_color_mips, in_force_internal_format, true, image)) {
+        return texture_2d_ptr();
+    }
 
-    auto data(get_data(in_image_path, in_create_mips, in_color_mips, 
-                       in_force_internal_format, image_size, image_format, 
-                       internal_format, num_mip_levels));
-    
-    texture_2d_ptr new_tex = in_device.create_texture_2d(image_size, internal_format, num_mip_levels, 1, 1,
-                                                         image_format, data.first);
+    texture_2d_ptr new_tex = in_device.create_texture_2d(image._size, image._internal_format, image._mip_count, 1, 1,
+                                                         image._format, image._level_data);
 
     if (!new_tex) {
         glerr() << log::error << "texture_loader::load_texture_2d(): "
                 << "unable to create texture object (file: " << in_image_path << ")" << log::end;
     }
 
-    data.first.clear();
-    data.second.clear();
-
     return (new_tex);
 }
 
+std::vector<texture_2d_ptr>
+texture_loader::load_textures_2d(render_device&                  in_device,
+                                 const std::vector<std::string>& in_image_paths,
+                                 bool                            in_create_mips,
+                                 bool                            in_color_mips,
+                                 const data_format               in_force_internal_format)
+{
+    std::vector<decoded_image>  images;
+    std::vector<texture_2d_ptr> new_texs(in_image_paths.size());
+
+    decode_images(in_image_paths, in_create_mips, in_color_mips, in_force_internal_format, images);
+
+    // the textures are created on the calling thread
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!images[i]._valid) {
+            continue;
+        }
+        new_texs[i] = in_device.create_texture_2d(images[i]._size, images[i]._internal_format, images[i]._mip_count, 1, 1,
+                                                  images[i]._format, images[i]._level_data);
+        if (!new_texs[i]) {
+            glerr() << log::error << "texture_loader::load_textures_2d(): "
+                    << "unable to create texture object (file: " << in_image_paths[i] << ")" << log::end;
+        }
+        images[i] = decoded_image();
+    }
+
+    return new_texs;
+}
+
 texture_cube_ptr
 texture_loader::load_texture_cube(render_device&       in_device,
                                   const std::string&   in_image_path_px,
@@ -250,67 +308,35 @@ texture_loader::load_texture_cube(render_device&       in_device,
                                   bool                 in_color_mips,
                                   const data_format    in_force_internal_format)
 {
-    math::vec2ui    image_size(0,0);
-    data_format     image_format = FORMAT_NULL;
-    data_format     internal_format = FORMAT_NULL;
-    unsigned        num_mip_levels = 1;
-
-    math::vec2ui    tmp_image_size(0,0);
-    data_format     tmp_image_format = FORMAT_NULL;
-    data_format     tmp_internal_format = FORMAT_NULL;
-    unsigned        tmp_num_mip_levels = 1;
-
-    bool formats_match(true);
-
-    auto data_px(get_data(in_image_path_px, in_create_mips, in_color_mips, 
-                          in_force_internal_format, image_size, image_format, 
-                          internal_format, num_mip_levels));
-
-
-    auto data_nx(get_data(in_image_path_nx, in_create_mips, in_color_mips, 
-                          in_force_internal_format, tmp_image_size, tmp_image_format, 
-                          tmp_internal_format, tmp_num_mip_levels));
-    if (tmp_image_size != image_size || tmp_image_format != image_format || tmp_internal_format != internal_format || tmp_num_mip_levels != num_mip_levels) {
-        formats_match = false;
-    }
-
-
-    auto data_py(get_data(in_image_path_py, in_create_mips, in_color_mips, 
-                          in_force_internal_format, tmp_image_size, tmp_image_format, 
-                          tmp_internal_format, tmp_num_mip_levels));
-    if (tmp_image_size != image_size || tmp_image_format != image_format || tmp_internal_format != internal_format || tmp_num_mip_levels != num_mip_levels) {
-        formats_match = false;
-    }
-
-
-    auto data_ny(get_data(in_image_path_ny, in_create_mips, in_color_mips, 
-                          in_force_internal_format, tmp_image_size, tmp_image_format, 
-                          tmp_internal_format, tmp_num_mip_levels));
-    if (tmp_image_size != image_size || tmp_image_format != image_format || tmp_internal_format != internal_format || tmp_num_mip_levels != num_mip_levels) {
-        formats_match = false;
-    }
-
-
-    auto data_pz(get_data(in_image_path_pz, in_create_mips, in_color_mips, 
-                          in_force_internal_format, tmp_image_size, tmp_image_format, 
-                          tmp_internal_format, tmp_num_mip_levels));
-    if (tmp_image_size != image_size || tmp_image_format != image_format || tmp_internal_format != internal_format || tmp_num_mip_levels != num_mip_levels) {
-        formats_match = false;
-    }
-
-
-    auto data_nz(get_data(in_image_path_nz, in_create_mips, in_color_mips, 
-                          in_force_internal_format, tmp_image_size, tmp_image_format, 
-                          tmp_internal_format, tmp_num_mip_levels));
-    if (tmp_image_size != image_size || tmp_image_format != image_format || tmp_internal_format != internal_format || tmp_num_mip_levels != num_mip_levels) {
-        formats_match = false;
+    std::vector<std::string> face_paths;
+    face_paths.push_back(in_image_path_px);
+    face_paths.push_back(in_image_path_nx);
+    face_paths.push_back(in_image_path_py);
+    face_paths.push_back(in_image_path_ny);
+    face_paths.push_back(in_image_path_pz);
+    face_paths.push_back(in_image_path_nz);
+
+    std::vector<decoded_image> faces;
+    decode_images(face_paths, in_create_mips, in_color_mips, in_force_internal_format, faces);
+
+    bool formats_match(faces[0]._valid);
+
+    for (size_t f = 1; f < faces.size(); ++f) {
+        if (   !faces[f]._valid
+            || faces[f]._size            != faces[0]._size
+            || faces[f]._format          != faces[0]._format
+            || faces[f]._internal_format != faces[0]._internal_format
+            || faces[f]._mip_count       != faces[0]._mip_count) {
+            formats_match = false;
+        }
     }
 
     texture_cube_ptr new_tex;
     
     if (formats_match) {
-        new_tex = in_device.create_texture_cube(image_size, internal_format, num_mip_levels,
-                                                image_format, data_px.first, data_nx.first, data_py.first, data_ny.first, data_pz.first, data_nz.first);
+        new_tex = in_device.create_texture_cube(faces[0]._size, faces[0]._internal_format, faces[0]._mip_count, faces[0]._format,
+                                                faces[0]._level_data, faces[1]._level_data, faces[2]._level_data,
+                                                faces[3]._level_data, faces[4]._level_data, faces[5]._level_data);
         if (!new_tex) {
             glerr() << log::error << "texture_loader::load_texture_cube(): "
                     << "unable to create texture object (file: " << in_image_path_px << ")" << log::end;
@@ -320,24 +346,6 @@ texture_loader::load_texture_cube(render_device&       in_device,
                 << "unable to create cube map object (file: " << in_image_path_px << "): all six textures must have same format" << log::end;
     }
 
-    data_px.first.clear();
-    data_px.second.clear();
-
-    data_nx.first.clear();
-    data_nx.second.clear();
-
-    data_py.first.clear();
-    data_py.second.clear();
-
-    data_ny.first.clear();
-    data_ny.second.clear();
-
-    data_pz.first.clear();
-    data_pz.second.clear();
-
-    data_nz.first.clear();
-    data_nz.second.clear();
-
     return (new_tex);
 }
 
@@ -428,60 +436,30 @@ texture_loader::load_texture_image(const render_device_ptr& in_device,
 }
 
 texture_image_data_ptr
-texture_loader::load_image_data(const std::string&  in_image_path)
+texture_loader::load_image_data(const std::string&  in_image_path,
+                                bool                in_create_mips,
+                                const data_format   in_compressed_format)
 {
-    scm::scoped_ptr<fipImage>   in_image(new fipImage);
-
-    if (!in_image->load(in_image_path.c_str())) {
-        glerr() << log::error << "texture_loader::load_image_data(): "
-                << "unable to open file: " << in_image_path << log::end;
-        return (texture_image_data_ptr());
-    }
-
-    FREE_IMAGE_TYPE image_type = in_image->getImageType();
-    math::vec2ui    image_size(in_image->getWidth(), in_image->getHeight());
-    data_format     image_format = FORMAT_NULL;
-    
-    switch (image_type) {
-        case FIT_BITMAP: {
-            unsigned num_components = in_image->getBitsPerPixel() / 8;
-            switch (num_components) {
-                case 1: image_format = FORMAT_R_8; break;
-                case 2: image_format = FORMAT_RG_8; break;
-                case 3: image_format = FORMAT_BGR_8; FORMAT_RGB_8; break;
-                case 4: image_format = FORMAT_BGRA_8; FORMAT_RGBA_8; break;
-            }
-        } break;
-        case FIT_INT16:     image_format = FORMAT_R_16S; break;
-        case FIT_UINT16:    image_format = FORMAT_R_16; break;
-        case FIT_RGB16:     image_format = FORMAT_RGB_16; break;
-        case FIT_RGBA16:    image_format = FORMAT_RGBA_16; break;
-        case FIT_INT32:     break;
-        case FIT_UINT32:    break;
-        case FIT_FLOAT:     image_format = FORMAT_R_32F; break;
-        case FIT_RGBF:      image_format = FORMAT_RGB_32F; break;
-        case FIT_RGBAF:     image_format = FORMAT_RGBA_32F; break;
-    }
+    decoded_image image;
 
-    if (image_format == FORMAT_NULL) {
-        glerr() << log::error << "texture_loader::load_image_data(): "
-                << "unsupported color format: " << std::hex << in_image->getImageType() << log::end;
+    if (!decode_image(in_image_path, in_create_mips, false, in_compressed_format, true, image)) {
         return (texture_image_data_ptr());
     }
-
-    scm::size_t                 image_data_size = static_cast<size_t>(image_size.x) * image_size.y * size_of_format(image_format);
-    scm::shared_array<uint8>    image_data(new uint8[image_data_size]);
-
-    if (memcpy(image_data.get(), in_image->accessPixels(), image_data_size) != image_data.get()) {
+    if (in_compressed_format != FORMAT_NULL && image._format != in_compressed_format) {
         glerr() << log::error << "texture_loader::load_image_data(): "
-                << "unable to copy image data." << log::end;
+                << "unable to compress image to " << format_string(in_compressed_format)
+                << " (file: " << in_image_path << ")" << log::end;
         return (texture_image_data_ptr());
     }
 
+    // the levels share the single allocation of the decoded image
     texture_image_data::level_vector    mip_vec;
-    mip_vec.push_back(texture_image_data::level(math::vec3ui(image_size, 1), image_data));
+    for (unsigned i = 0; i < image._mip_count; ++i) {
+        mip_vec.push_back(texture_image_data::level(math::vec3ui(util::mip_level_dimensions(image._size, i), 1),
+                                                    shared_array<uint8>(image._data, reinterpret_cast<uint8*>(image._level_data[i]))));
+    }
 
-    texture_image_data_ptr ret_data(new texture_image_data(texture_image_data::ORIGIN_LOWER_LEFT, image_format, mip_vec));
+    texture_image_data_ptr ret_data(new texture_image_data(texture_image_data::ORIGIN_LOWER_LEFT, image._format, mip_vec));
     
     return (ret_data);
 }
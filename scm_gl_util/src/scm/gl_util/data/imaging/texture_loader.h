@@ -5,6 +5,9 @@
 #ifndef SCM_GL_UTIL_TEXTURE_LOADER_H_INCLUDED
 #define SCM_GL_UTIL_TEXTURE_LOADER_H_INCLUDED
 
+#include <string>
+#include <vector>
+
 #include <scm/core/math.h>
 #include <scm/core/numeric_types.h>
 #include <scm/core/memory.h>
@@ -22,6 +25,13 @@
 namespace scm {
 namespace gl {
 
+// loads 2d and cube map textures through free image
+//  - mip levels are generated with util::generate_mipmaps_2d into one
+//    allocation per image
+//  - load_textures_2d and load_texture_cube decode their images concurrently,
+//    the texture objects are created on the calling thread
+//  - block compressed forced internal formats supported by util::compress_image
+//    are compressed on the cpu before the upload
 class __scm_export(gl_util) texture_loader
 {
 
@@ -32,6 +42,12 @@ public:
                                                 bool                 in_create_mips,
                                                 bool                 in_color_mips  = false,
                                                 const data_format    in_force_internal_format = FORMAT_NULL);
+    // failed images leave empty entries
+    std::vector<texture_2d_ptr> load_textures_2d(render_device&                  in_device,
+                                                 const std::vector<std::string>& in_image_paths,
+                                                 bool                            in_create_mips,
+                                                 bool                            in_color_mips  = false,
+                                                 const data_format               in_force_internal_format = FORMAT_NULL);
 
     texture_cube_ptr            load_texture_cube(render_device&       in_device,
                                                   const std::string&   in_image_path_px,
@@ -50,7 +66,11 @@ public:
                                                    const texture_region&    in_region,
                                                    const unsigned           in_level);
 
-    texture_image_data_ptr      load_image_data(const std::string&  in_image_path);
+    // in_compressed_format: block compress all levels (util::compress_image), the
+    // result can be written through texture_loader_dds::save_image_data_dx9
+    texture_image_data_ptr      load_image_data(const std::string&  in_image_path,
+                                                bool                in_create_mips       = false,
+                                                const data_format   in_compressed_format = FORMAT_NULL);
 
 }; // class texture_loader
 
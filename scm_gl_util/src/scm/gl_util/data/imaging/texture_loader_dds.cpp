@@ -10,6 +10,9 @@
 #include <string>
 
 #include <boost/static_assert.hpp>
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 #include <scm/core/numeric_types.h>
 #include <scm/core/math.h>
@@ -114,6 +117,8 @@ enum D3DFORMAT
     D3DFMT_DXT3                 = SCM_MAKEFOURCC('D', 'X', 'T', '3'),
     D3DFMT_DXT4                 = SCM_MAKEFOURCC('D', 'X', 'T', '4'),
     D3DFMT_DXT5                 = SCM_MAKEFOURCC('D', 'X', 'T', '5'),
+    D3DFMT_ATI1                 = SCM_MAKEFOURCC('A', 'T', 'I', '1'), // bc4, no official d3d9 format
+    D3DFMT_ATI2                 = SCM_MAKEFOURCC('A', 'T', 'I', '2'), // bc5, no official d3d9 format
 
     D3DFMT_D16_LOCKABLE         = 70,
     D3DFMT_D32                  = 71,
@@ -566,6 +571,8 @@ match_format(const dds_file& dds)
             case D3DFMT_DXT3                 : return FORMAT_BC2_RGBA;
             case D3DFMT_DXT4                 : return FORMAT_BC3_RGBA; // pre-mult alpha
             case D3DFMT_DXT5                 : return FORMAT_BC3_RGBA;
+            case D3DFMT_ATI1                 : return FORMAT_BC4_R;
+            case D3DFMT_ATI2                 : return FORMAT_BC5_RG;
             case D3DFMT_L16                  : return FORMAT_R_16;
             case D3DFMT_R16F                 : return FORMAT_R_16F;
             case D3DFMT_G16R16F              : return FORMAT_RG_16F;
@@ -643,6 +650,8 @@ dds_fourcc(scm::gl::data_format f)
         case FORMAT_BC1_RGBA    : return D3DFMT_DXT1;
         case FORMAT_BC2_RGBA    : return D3DFMT_DXT3;
         case FORMAT_BC3_RGBA    : return D3DFMT_DXT5;
+        case FORMAT_BC4_R       : return D3DFMT_ATI1;
+        case FORMAT_BC5_RG      : return D3DFMT_ATI2;
         //case FORMAT_R_16        : return D3DFMT_L16;
         case FORMAT_R_16F       : return D3DFMT_R16F;
         case FORMAT_RG_16F      : return D3DFMT_G16R16F;
@@ -787,48 +796,142 @@ mip_level_size(const scm::math::vec3ui& lsize, scm::gl::data_format fmt)
     }
 }
 
-} // namespace
 
-namespace scm {
-namespace gl {
+// keeps the file mapping alive as long as texture_image_data levels reference it
+struct dds_mapping_holder
+{
+    scm::shared_ptr<boost::interprocess::mapped_region> _region;
 
-texture_image_data_ptr
-texture_loader_dds::load_image_data(const std::string& in_image_path) const
+    void operator()(scm::uint8*) const {}
+}; // struct dds_mapping_holder
+
+// dds header and a private (copy on write) mapping of the whole file, levels are
+// addressed in place, the dds layout stores all mip levels of a layer in sequence
+struct dds_image
 {
-    using namespace scm::math;
+    dds_image() : _format(scm::gl::FORMAT_NULL), _size(0u), _mip_count(0), _layer_count(0), _data(0), _layer_size(0) {}
+
+    const scm::uint8*   level_data(unsigned in_layer, unsigned in_level) const {
+        return _data + _layer_size * in_layer + _level_offsets[in_level];
+    }
+    scm::math::vec3ui   level_size(unsigned in_level) const {
+        return scm::math::vec3ui(scm::math::max(1u, _size.x >> in_level),
+                                 scm::math::max(1u, _size.y >> in_level),
+                                 scm::math::max(1u, _size.z >> in_level));
+    }
 
-    ::dds_file   raw_dds = ::dds_file(in_image_path);
+    scm::gl::data_format                                _format;
+    scm::math::vec3ui                                   _size;
+    unsigned                                            _mip_count;
+    unsigned                                            _layer_count;
+
+    scm::shared_ptr<boost::interprocess::mapped_region> _region;
+    const scm::uint8*                                   _data;
+    scm::size_t                                         _layer_size;
+    std::vector<scm::size_t>                            _level_offsets;
+}; // struct dds_image
+
+bool
+open_dds_image(const std::string& in_image_path, dds_image& out_image)
+{
+    using namespace scm;
+    using namespace scm::gl;
+    namespace bip = boost::interprocess;
+
+    const ::dds_file raw_dds = ::dds_file(in_image_path);
 
     if (!raw_dds) {
         glerr() << log::error
-                << "texture_loader_dds::load_image_data(): error reading dds image data." << log::end;
-        return texture_image_data_ptr();
+                << "texture_loader_dds::open_dds_image(): error reading dds image data." << log::end;
+        return false;
     }
 
     if (!(raw_dds.dds_header()->dwSurfaceFlags & DDSCAPS_TEXTURE)) {
         glerr() << log::error
-                << "texture_loader_dds::load_image_data(): error DDSCAPS_TEXTURE not present." << log::end;
-        return texture_image_data_ptr();
+                << "texture_loader_dds::open_dds_image(): error DDSCAPS_TEXTURE not present." << log::end;
+        return false;
     }
 
-    data_format img_format = match_format(raw_dds);
-    if (img_format == FORMAT_NULL) {
+    out_image._format = match_format(raw_dds);
+    if (out_image._format == FORMAT_NULL) {
         glerr() << log::error
-                << "texture_loader_dds::load_image_data(): error matching dds data format to scm::gl::data_format." << log::end;
-        return texture_image_data_ptr();
+                << "texture_loader_dds::open_dds_image(): error matching dds data format to scm::gl::data_format." << log::end;
+        return false;
+    }
+
+    out_image._size        = retrieve_dimensions(raw_dds);
+    out_image._mip_count   = retrieve_mipmap_count(raw_dds);
+    out_image._layer_count = retrieve_layer_count(raw_dds);
+
+    out_image._layer_size = 0;
+    out_image._level_offsets.resize(out_image._mip_count);
+    for (unsigned l = 0; l < out_image._mip_count; ++l) {
+        out_image._level_offsets[l]  = out_image._layer_size;
+        out_image._layer_size       += mip_level_size(out_image.level_size(l), out_image._format);
     }
 
-    vec3ui   img_size           = retrieve_dimensions(raw_dds);
-    unsigned img_mip_count      = retrieve_mipmap_count(raw_dds);
-    unsigned img_layer_count    = retrieve_layer_count(raw_dds);
+    if (out_image._layer_size * out_image._layer_count > raw_dds.image_data_size()) {
+        glerr() << log::error
+                << "texture_loader_dds::open_dds_image(): error file too small for image data: " << in_image_path
+                << " (image data size: " << out_image._layer_size * out_image._layer_count
+                << ", file image data size: " << raw_dds.image_data_size() << ")" << log::end;
+        return false;
+    }
+
+    try {
+        // private mapping, in place flips do not reach the file
+        bip::file_mapping fmap(in_image_path.c_str(), bip::read_only);
+        out_image._region.reset(new bip::mapped_region(fmap, bip::copy_on_write));
+        out_image._region->advise(bip::mapped_region::advice_sequential);
+    }
+    catch (const bip::interprocess_exception& e) {
+        glerr() << log::error
+                << "texture_loader_dds::open_dds_image(): error mapping file: " << in_image_path
+                << " (" << e.what() << ")" << log::end;
+        return false;
+    }
+
+    out_image._data = reinterpret_cast<const uint8*>(out_image._region->get_address()) + raw_dds.image_data_offset();
+
+    return true;
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+texture_image_data_ptr
+texture_loader_dds::load_image_data(const std::string& in_image_path,
+                                    bool               in_flip_vertical) const
+{
+    using namespace scm::math;
+
+    dds_image img;
+    if (!open_dds_image(in_image_path, img)) {
+        glerr() << log::error
+                << "texture_loader_dds::load_image_data(): error opening dds file: " << in_image_path << log::end;
+        return texture_image_data_ptr();
+    }
 
     texture_image_data::level_vector    img_lev_data;
 
-    { // init image memory
-        vec3ui lsize = img_size;
-        for (unsigned l = 0; l < img_mip_count; ++l) {
+    if (img._layer_count == 1) {
+        // the levels reference the mapping directly
+        dds_mapping_holder holder;
+        holder._region = img._region;
+        for (unsigned l = 0; l < img._mip_count; ++l) {
+            shared_array<uint8> ldata(const_cast<uint8*>(img.level_data(0, l)), holder);
+            img_lev_data.push_back(texture_image_data::level(img.level_size(l), ldata));
+        }
+    }
+    else {
+        // texture_image_data stores the layers of one level in sequence
+        for (unsigned l = 0; l < img._mip_count; ++l) {
             shared_array<uint8> ldata;
-            scm::size_t         ldata_size =  mip_level_size(lsize, img_format) * img_layer_count;
+            const vec3ui        lsize         = img.level_size(l);
+            const scm::size_t   lmip_img_size = mip_level_size(lsize, img._format);
+            const scm::size_t   ldata_size    = lmip_img_size * img._layer_count;
 
             try {
                 ldata.reset(new uint8[ldata_size]);
@@ -836,51 +939,33 @@ texture_loader_dds::load_image_data(const std::string& in_image_path) const
             catch (const std::bad_alloc& e) {
                 glerr() << log::error
                         << "texture_loader_dds::load_image_data(): error allocating image memory "
-                        << "(level: " << l << ", size: " << lsize << ", layers: " << img_layer_count
-                        << ", format: " << format_string(img_format) << ", ldata_size: " << ldata_size << "), "
+                        << "(level: " << l << ", size: " << lsize << ", layers: " << img._layer_count
+                        << ", format: " << format_string(img._format) << ", ldata_size: " << ldata_size << "), "
                         << e.what() << log::end;
                 return texture_image_data_ptr();
             }
+            for (unsigned a = 0; a < img._layer_count; ++a) {
+                memcpy(ldata.get() + lmip_img_size * a, img.level_data(a, l), lmip_img_size);
+            }
 
             img_lev_data.push_back(texture_image_data::level(lsize, ldata));
-
-            lsize.x = max(1u, lsize.x / 2);
-            lsize.y = max(1u, lsize.y / 2);
-            lsize.z = max(1u, lsize.z / 2);
         }
     }
 
-    { // read image data
-        io::file::offset_type roff = raw_dds.image_data_offset();
-        for (unsigned a = 0; a < img_layer_count; ++a) {
-            for (unsigned l = 0; l < img_mip_count; ++l) {
-                const shared_array<uint8> ldata         = img_lev_data[l].data();
-                const scm::size_t         lmip_img_size = mip_level_size(img_lev_data[l].size(), img_format);
-
-                if ((roff + lmip_img_size - raw_dds.image_data_offset()) > raw_dds.image_data_size()) {
-                    glerr() << log::error
-                            << "texture_loader_dds::load_image_data(): error trying to read past file size: " << in_image_path 
-                            << " (number of bytes attempted to read: " << lmip_img_size << ", at position : " << roff << ")" << log::end;
-                    return texture_image_data_ptr();
-                }
-
-                if (raw_dds.file()->read(ldata.get() + lmip_img_size * a, roff, lmip_img_size) != lmip_img_size) {
-                    glerr() << log::error
-                            << "texture_loader_dds::load_image_data(): error reading from file: " << in_image_path 
-                            << " (number of bytes attempted to read: " << lmip_img_size << ", at position : " << roff << ")" << log::end;
-                    return texture_image_data_ptr();
-                }
-
-                roff += lmip_img_size;
-            }
+    texture_image_data_ptr ret_img(new texture_image_data(texture_image_data::ORIGIN_UPPER_LEFT, img._format, img._layer_count, img_lev_data));
+    
+    // dds files use upper-left origin
+    //  - formats without block flipping support (e.g. BC6H/BC7) fail before any
+    //    data is touched, these are returned unflipped with upper-left origin
+    if (in_flip_vertical) {
+        if (!ret_img->flip_vertical()) {
+            glout() << log::warning
+                    << "texture_loader_dds::load_image_data(): unable to flip image data "
+                    << "(format: " << format_string(ret_img->format()) << "), "
+                    << "returning data with upper-left origin: " << in_image_path << log::end;
         }
     }
 
-    texture_image_data_ptr ret_img(new texture_image_data(texture_image_data::ORIGIN_UPPER_LEFT, img_format, img_layer_count, img_lev_data));
-    
-    // dds files use upper-left origin, we flip!
-    ret_img->flip_vertical();
-
     return ret_img;
 }
 
@@ -893,7 +978,10 @@ texture_loader_dds::save_image_data_dx9(const std::string&           in_image_pa
     using namespace scm::io;
     using namespace scm::math;
 
-    if (in_img_data->origin() == texture_image_data::ORIGIN_LOWER_LEFT) {
+    // flip lower left data for writing and back afterwards, upper left data is written as is
+    const bool flip_data = (in_img_data->origin() == texture_image_data::ORIGIN_LOWER_LEFT);
+
+    if (flip_data) {
         if (!in_img_data->flip_vertical()) {
             glerr() << log::error
                     << "texture_loader_dds::save_image_data_dx9(): error flipping image data before save operation." << log::end;
@@ -940,7 +1028,9 @@ texture_loader_dds::save_image_data_dx9(const std::string&           in_image_pa
     dds9_header->dwHeight            = in_img_data->mip_level(0).size().y;
     dds9_header->dwWidth             = in_img_data->mip_level(0).size().x;
     dds9_header->dwPitchOrLinearSize = (is_compressed_format(in_img_data->format())
-                                         ? max(1u, (in_img_data->mip_level(0).size().x * 3u) / 4u) * compressed_block_size(in_img_data->format())
+                                         ? static_cast<unsigned>(mip_level_size(vec3ui(in_img_data->mip_level(0).size().x,
+                                                                                       in_img_data->mip_level(0).size().y, 1u),
+                                                                                in_img_data->format()))
                                          : (in_img_data->mip_level(0).size().x * bit_per_pixel(in_img_data->format()) + 7) / 8
                                        );
     dds9_header->dwDepth             = (in_img_data->mip_level(0).size().z > 1 ? in_img_data->mip_level(0).size().z : 0);
@@ -992,7 +1082,7 @@ texture_loader_dds::save_image_data_dx9(const std::string&           in_image_pa
 
     out_file->close();
 
-    if (in_img_data->origin() == texture_image_data::ORIGIN_UPPER_LEFT) {
+    if (flip_data) {
         if (!in_img_data->flip_vertical()) {
             glerr() << log::error
                     << "texture_loader_dds::save_image_data_dx9(): error flipping image data after save operation." << log::end;
@@ -1006,16 +1096,46 @@ texture_loader_dds::save_image_data_dx9(const std::string&           in_image_pa
 
 texture_2d_ptr
 texture_loader_dds::load_texture_2d(render_device&       in_device,
-                                    const std::string&   in_image_path) const
+                                    const std::string&   in_image_path,
+                                    bool                 in_flip_vertical) const
 {
-    texture_image_data_ptr img_data = load_image_data(in_image_path);
+    // upload single layer images straight from the mapped file, the layers of
+    // array textures are not contiguous per level in the file and are gathered
+    // by load_image_data. all uploads go through the initial data of
+    // create_texture_2d to not depend on the current context of the caller
+    if (!in_flip_vertical) {
+        dds_image img;
+        if (!open_dds_image(in_image_path, img)) {
+            glerr() << log::error
+                    << "texture_loader_dds::load_texture_2d(): error opening dds file: " << in_image_path << log::end;
+            return texture_2d_ptr();
+        }
+
+        if (img._layer_count == 1) {
+            std::vector<void*>  image_mip_data_raw;
+            for (unsigned l = 0; l < img._mip_count; ++l) {
+                image_mip_data_raw.push_back(const_cast<uint8*>(img.level_data(0, l)));
+            }
+
+            texture_2d_ptr new_tex = in_device.create_texture_2d(img._size, img._format, img._mip_count, 1, 1,
+                                                                 img._format, image_mip_data_raw);
+            if (!new_tex) {
+                glerr() << log::error << "texture_loader_dds::load_texture_2d(): "
+                        << "unable to create texture object (file: " << in_image_path << ")" << log::end;
+                return texture_2d_ptr();
+            }
+
+            return new_tex;
+        }
+    }
+
+    texture_image_data_ptr img_data = load_image_data(in_image_path, in_flip_vertical);
     if (!img_data) {
         glerr() << log::error
                 << "texture_loader_dds::load_texture_2d(): error opening dds file: " << in_image_path << log::end;
         return texture_2d_ptr();
     }
 
-
     std::vector<void*>  image_mip_data_raw;
 
     for (int i = 0; i < img_data->mip_level_count(); ++i) {
@@ -1032,24 +1152,22 @@ texture_loader_dds::load_texture_2d(render_device&       in_device,
         return texture_2d_ptr();
     }
 
-    image_mip_data_raw.clear();
-    img_data.reset();
-
     return new_tex;
 }
 
 texture_3d_ptr
 texture_loader_dds::load_texture_3d(render_device&       in_device,
-                                    const std::string&   in_image_path) const
+                                    const std::string&   in_image_path,
+                                    bool                 in_flip_vertical) const
 {
-    texture_image_data_ptr img_data = load_image_data(in_image_path);
+    // without flipping the levels reference the mapped file
+    texture_image_data_ptr img_data = load_image_data(in_image_path, in_flip_vertical);
     if (!img_data) {
         glerr() << log::error
                 << "texture_loader_dds::load_texture_3d(): error opening dds file: " << in_image_path << log::end;
         return texture_3d_ptr();
     }
 
-
     std::vector<void*>  image_mip_data_raw;
 
     for (int i = 0; i < img_data->mip_level_count(); ++i) {
@@ -1066,9 +1184,6 @@ texture_loader_dds::load_texture_3d(render_device&       in_device,
         return texture_3d_ptr();
     }
 
-    image_mip_data_raw.clear();
-    img_data.reset();
-
     return new_tex;
 }
 
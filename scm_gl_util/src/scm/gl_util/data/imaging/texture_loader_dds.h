@@ -22,14 +22,31 @@
 namespace scm {
 namespace gl {
 
+// dds image loading and saving
+//  - the files are memory mapped, the image data is not read through
+//    intermediate buffers
+//  - dds images have their origin in the upper left corner, by default they
+//    are flipped to the lower left on load. with in_flip_vertical == false the
+//    data is returned (texture_image_data::ORIGIN_UPPER_LEFT) or uploaded
+//    directly from the mapping without touching it on the cpu (array layers are
+//    gathered per level first), the renderer has to account for the flipped t
+//    coordinate. formats without flip support (BC6H, BC7) are always returned
+//    with upper left origin
+//  - textures are created with their initial data only, loading does not use
+//    the main context of the device
 class __scm_export(gl_util) texture_loader_dds
 {
 public:
 
-    texture_2d_ptr              load_texture_2d(render_device& in_device, const std::string& in_image_path) const;
-    texture_3d_ptr              load_texture_3d(render_device& in_device, const std::string& in_image_path) const;
+    texture_2d_ptr              load_texture_2d(render_device&      in_device,
+                                                const std::string&  in_image_path,
+                                                bool                in_flip_vertical = true) const;
+    texture_3d_ptr              load_texture_3d(render_device&      in_device,
+                                                const std::string&  in_image_path,
+                                                bool                in_flip_vertical = true) const;
 
-    texture_image_data_ptr      load_image_data(const std::string&  in_image_path) const;
+    texture_image_data_ptr      load_image_data(const std::string&  in_image_path,
+                                                bool                in_flip_vertical = true) const;
 
     bool                        save_image_data_dx9(const std::string&           in_image_path,
                                                     const texture_image_data_ptr in_img_data) const;
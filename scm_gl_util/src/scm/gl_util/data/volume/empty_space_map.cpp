@@ -0,0 +1,222 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "empty_space_map.h"
+
+#include <cassert>
+#include <exception>
+#include <stdexcept>
+
+#include <scm/gl_core/log.h>
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/texture_objects.h>
+
+#include <scm/gl_util/data/analysis/volume_statistics.h>
+
+namespace {
+
+// scale from raw data values to the values returned by texture lookups
+float
+sampled_value_scale(const scm::gl::data_format fmt)
+{
+    using namespace scm::gl;
+
+    if (is_normalized(fmt)) {
+        const bool  is_signed = FORMAT_R_8S <= fmt && fmt <= FORMAT_RGBA_16S;
+        const int   bits      = size_of_channel(fmt) * 8 - (is_signed ? 1 : 0);
+
+        return 1.0f / static_cast<float>((1u << bits) - 1u);
+    }
+    else {
+        return 1.0f;
+    }
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+empty_space_map::empty_space_map(const render_device_ptr&    in_device,
+                                 const volume_statistics&    in_statistics,
+                                 const data_format           in_volume_format,
+                                 const math::vec3ui&         in_volume_dimensions)
+  : _volume_dimensions(in_volume_dimensions)
+  , _brick_size(in_statistics.brick_size())
+  , _grid_dimensions(in_statistics.brick_grid_dimensions())
+  , _occupied_bricks(0)
+  , _occupied_min(1.0f)
+  , _occupied_max(0.0f)
+{
+    using namespace scm::math;
+
+    const std::vector<value_statistics>& bstats = in_statistics.brick_statistics();
+    const scm::size_t brick_count = static_cast<scm::size_t>(_grid_dimensions.x) * _grid_dimensions.y * _grid_dimensions.z;
+
+    if (brick_count < 1 || bstats.size() != brick_count) {
+        throw std::runtime_error("empty_space_map::empty_space_map(): volume statistics without brick statistics.");
+    }
+
+    const float value_scale = sampled_value_scale(in_volume_format);
+    const bool  is_signed   = FORMAT_R_8S <= in_volume_format && in_volume_format <= FORMAT_RGBA_16S;
+
+    _brick_ranges.resize(brick_count);
+    for (scm::size_t b = 0; b < brick_count; ++b) {
+        vec2f r = vec2f(bstats[b]._min, bstats[b]._max) * value_scale;
+        if (is_signed) {
+            // signed normalized values are clamped to [-1, 1] by the texture lookup
+            r = clamp(r, vec2f(-1.0f), vec2f(1.0f));
+        }
+        _brick_ranges[b] = r;
+    }
+
+    // all bricks start out occupied until the first classification
+    _occupancy.assign(brick_count, 255u);
+    _occupied_bricks = static_cast<unsigned>(brick_count);
+    _occupied_min    = vec3f(0.0f);
+    _occupied_max    = vec3f(1.0f);
+
+    std::vector<void*> init_data(1, &_occupancy.front());
+    _occupancy_texture = in_device->create_texture_3d(_grid_dimensions, FORMAT_R_8, 1, FORMAT_R_8, init_data);
+
+    if (!_occupancy_texture) {
+        throw std::runtime_error("empty_space_map::empty_space_map(): error creating occupancy texture.");
+    }
+}
+
+empty_space_map::~empty_space_map()
+{
+    _occupancy_texture.reset();
+}
+
+bool
+empty_space_map::classify(const render_context_ptr& in_context,
+                          const float*              in_alpha_lut,
+                          unsigned                  in_lut_size,
+                          float                     in_value_min,
+                          float                     in_value_max,
+                          float                     in_alpha_threshold)
+{
+    using namespace scm::math;
+
+    if (!in_alpha_lut || in_lut_size < 1) {
+        glerr() << log::error
+                << "empty_space_map::classify(): invalid alpha lookup table." << log::end;
+        return false;
+    }
+
+    // prefix counts of the opaque lookup table entries, a brick is empty
+    // if there are no opaque entries in the lookup table range it maps to
+    std::vector<unsigned> opaque_prefix(in_lut_size + 1, 0u);
+    for (unsigned i = 0; i < in_lut_size; ++i) {
+        opaque_prefix[i + 1] = opaque_prefix[i] + (in_alpha_lut[i] > in_alpha_threshold ? 1u : 0u);
+    }
+
+    const float value_range = in_value_max - in_value_min;
+    const float lut_scale   = value_range > 0.0f ? static_cast<float>(in_lut_size) / value_range : 0.0f;
+    const float max_entry   = static_cast<float>(in_lut_size - 1);
+
+    _occupied_bricks = 0;
+    _occupied_min    = vec3f(1.0f);
+    _occupied_max    = vec3f(0.0f);
+
+    const vec3f vol_dim = vec3f(_volume_dimensions);
+    const vec3f brk_dim = vec3f(_brick_size);
+
+    for (unsigned z = 0; z < _grid_dimensions.z; ++z) {
+        for (unsigned y = 0; y < _grid_dimensions.y; ++y) {
+            for (unsigned x = 0; x < _grid_dimensions.x; ++x) {
+                const scm::size_t b = (static_cast<scm::size_t>(z) * _grid_dimensions.y + y) * _grid_dimensions.x + x;
+                bool occupied = true;
+
+                if (value_range > 0.0f) {
+                    // lookup table texels touched by linear filtering of the mapped brick range
+                    const float lo = (_brick_ranges[b].x - in_value_min) * lut_scale - 0.5f;
+                    const float hi = (_brick_ranges[b].y - in_value_min) * lut_scale - 0.5f;
+                    const unsigned lo_entry = static_cast<unsigned>(clamp(floor(lo), 0.0f, max_entry));
+                    const unsigned hi_entry = static_cast<unsigned>(clamp(ceil(hi),  0.0f, max_entry));
+
+                    occupied = opaque_prefix[hi_entry + 1] > opaque_prefix[lo_entry];
+                }
+
+                _occupancy[b] = occupied ? 255u : 0u;
+
+                if (occupied) {
+                    ++_occupied_bricks;
+
+                    const vec3ui bi     = vec3ui(x, y, z);
+                    vec3f        bmin   = (vec3f(bi) * brk_dim + vec3f(0.5f)) / vol_dim;
+                    vec3f        bmax   = (vec3f(bi + vec3ui(1u)) * brk_dim + vec3f(0.5f)) / vol_dim;
+                    for (unsigned c = 0; c < 3; ++c) {
+                        if (bi[c] == 0)                         bmin[c] = 0.0f;
+                        if (bi[c] == _grid_dimensions[c] - 1)   bmax[c] = 1.0f;
+                    }
+                    _occupied_min = min(_occupied_min, bmin);
+                    _occupied_max = max(_occupied_max, min(bmax, vec3f(1.0f)));
+                }
+            }
+        }
+    }
+
+    if (_occupied_bricks == 0) {
+        // nothing to draw, collapse the bounds instead of leaving min > max
+        // behind, a ray-box test would treat the inverted bounds as the full box
+        _occupied_min = vec3f(0.0f);
+        _occupied_max = vec3f(0.0f);
+    }
+
+    texture_region ur(vec3ui(0u), _grid_dimensions);
+    if (!in_context->update_sub_texture(_occupancy_texture, ur, 0u, FORMAT_R_8, &_occupancy.front())) {
+        glerr() << log::error
+                << "empty_space_map::classify(): error uploading occupancy texture." << log::end;
+        return false;
+    }
+
+    return true;
+}
+
+const texture_3d_ptr&
+empty_space_map::occupancy_texture() const
+{
+    return _occupancy_texture;
+}
+
+const math::vec3ui&
+empty_space_map::volume_dimensions() const
+{
+    return _volume_dimensions;
+}
+
+const math::vec3ui&
+empty_space_map::brick_size() const
+{
+    return _brick_size;
+}
+
+const math::vec3ui&
+empty_space_map::grid_dimensions() const
+{
+    return _grid_dimensions;
+}
+
+unsigned
+empty_space_map::occupied_bricks() const
+{
+    return _occupied_bricks;
+}
+
+const math::vec3f&
+empty_space_map::occupied_min() const
+{
+    return _occupied_min;
+}
+
+const math::vec3f&
+empty_space_map::occupied_max() const
+{
+    return _occupied_max;
+}
+
+} // namespace gl
+} // namespace scm
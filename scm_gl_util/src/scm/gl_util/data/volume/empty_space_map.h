@@ -0,0 +1,93 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_EMPTY_SPACE_MAP_H_INCLUDED
+#define SCM_GL_UTIL_EMPTY_SPACE_MAP_H_INCLUDED
+
+#include <vector>
+
+#include <scm/core/math.h>
+#include <scm/core/numeric_types.h>
+#include <scm/core/memory.h>
+
+#include <scm/gl_core/data_formats.h>
+#include <scm/gl_core/render_device/render_device_fwd.h>
+#include <scm/gl_core/texture_objects/texture_objects_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+class volume_statistics;
+
+// coarse occupancy grid for empty-space skipping during volume ray casting
+//  - built from the per brick value ranges of a volume_statistics object
+//  - classify() marks all bricks whose value range maps only to transparent
+//    entries of the alpha lookup table as empty, it has to be called again
+//    whenever the transfer function or the value range mapping changes
+//  - the occupancy texture holds one FORMAT_R_8 texel per brick (0 = empty),
+//    brick b covers the texture space sample positions p with
+//    floor((p * volume_dimensions - 0.5) / brick_size) == b, i.e. all samples
+//    whose trilinear footprint lies inside the brick statistics
+//  - the occupied bounds enclose all non-empty bricks and can be used to
+//    clip the ray entry and exit points
+//  - if all bricks are empty, occupied_bricks() == 0 and the occupied bounds
+//    collapse to the origin, users have to check occupied_bricks() and skip
+//    the volume (or discard all rays) in this case
+class __scm_export(gl_util) empty_space_map
+{
+public:
+    empty_space_map(const render_device_ptr&    in_device,
+                    const volume_statistics&    in_statistics,
+                    const data_format           in_volume_format,
+                    const math::vec3ui&         in_volume_dimensions);
+    virtual ~empty_space_map();
+
+    // in_alpha_lut covers the normalized value range [in_value_min, in_value_max]
+    // given in sampled texture values (normalized formats map to [0, 1])
+    bool                        classify(const render_context_ptr& in_context,
+                                         const float*              in_alpha_lut,
+                                         unsigned                  in_lut_size,
+                                         float                     in_value_min,
+                                         float                     in_value_max,
+                                         float                     in_alpha_threshold = 0.0f);
+
+    const texture_3d_ptr&       occupancy_texture() const;
+
+    const math::vec3ui&         volume_dimensions() const;
+    const math::vec3ui&         brick_size() const;
+    const math::vec3ui&         grid_dimensions() const;
+
+    unsigned                    occupied_bricks() const;
+    // texture space bounds of the occupied bricks, undefined if occupied_bricks() == 0
+    const math::vec3f&          occupied_min() const;
+    const math::vec3f&          occupied_max() const;
+
+protected:
+    math::vec3ui                _volume_dimensions;
+    math::vec3ui                _brick_size;
+    math::vec3ui                _grid_dimensions;
+
+    // brick value ranges converted to sampled texture values
+    std::vector<math::vec2f>    _brick_ranges;
+    std::vector<scm::uint8>     _occupancy;
+    unsigned                    _occupied_bricks;
+    math::vec3f                 _occupied_min;
+    math::vec3f                 _occupied_max;
+
+    texture_3d_ptr              _occupancy_texture;
+
+}; // class empty_space_map
+
+typedef shared_ptr<empty_space_map>         empty_space_map_ptr;
+typedef shared_ptr<empty_space_map const>   empty_space_map_cptr;
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_EMPTY_SPACE_MAP_H_INCLUDED
@@ -27,16 +27,20 @@
 
 #include <scm/gl_util/data/analysis/transfer_function/build_lookup_table.h>
 
+#include <scm/gl_core/config.h>
 #include <scm/gl_core/data_formats.h>
 #include <scm/gl_core/math.h>
 #include <scm/gl_core/render_device.h>
 #include <scm/gl_core/state_objects.h>
+#include <scm/gl_core/sync_objects.h>
 #include <scm/gl_core/texture_objects.h>
 #include <scm/gl_core/buffer_objects/scoped_buffer_map.h>
+#include <scm/gl_core/render_device/context_guards.h>
 
 #include <scm/gl_util/data/imaging/texture_data_util.h>
 #include <scm/gl_util/primitives/box.h>
 #include <scm/gl_util/primitives/box_volume.h>
+#include <scm/gl_util/utilities/gpu_mip_map_generator.h>
 #include <scm/gl_util/viewer/camera.h>
 #include <scm/gl_util/data/volume/volume_reader_raw.h>
 #include <scm/gl_util/data/volume/volume_reader_segy.h>
@@ -265,6 +269,197 @@ volume_loader::load_volume_data(render_device&      in_device,
     return new_volume_tex;
 }
 
+texture_3d_ptr
+volume_loader::stream_volume_data(render_device&            in_device,
+                                  const render_context_ptr& in_context,
+                                  const std::string&        in_volume_path,
+                                  bool                      in_create_mips,
+                                  unsigned                  in_staging_buffers,
+                                  scm::size_t               in_staging_size,
+                                  const volume_quantizer_ptr& in_quantizer)
+{
+    using namespace scm::gl;
+    using namespace scm::math;
+    using namespace boost::filesystem;
+
+    path                    file_path(in_volume_path);
+    std::string             file_extension  = file_path.extension().string();
+
+    boost::algorithm::to_lower(file_extension);
+
+    scoped_ptr<gl::volume_reader> vol_reader;
+
+    if (file_extension == ".raw") {
+        vol_reader.reset(new volume_reader_raw(file_path.string(), false));
+    }
+    else if (file_extension == ".vol") {
+        vol_reader.reset(new volume_reader_vgeo(file_path.string(), true));
+    }
+    else if (file_extension == ".segy" || file_extension == ".sgy") {
+        vol_reader.reset(new volume_reader_segy(file_path.string(), true));
+    }
+    else {
+        err() << log::error
+              << "volume_loader::stream_volume_data(): unsupported volume file format ('" << file_extension << "')." << log::end;
+        return texture_3d_ptr();
+    }
+
+    if (!(*vol_reader)) {
+        err() << log::error
+              << "volume_loader::stream_volume_data(): unable to open file ('" << in_volume_path << "')." << log::end;
+        return texture_3d_ptr();
+    }
+
+    const vec3ui        data_dimensions = vol_reader->dimensions();
+    const data_format   data_format     = vol_reader->format();
+    const gl::data_format tex_format    = in_quantizer ? in_quantizer->target_format() : data_format;
+    const scm::size_t   src_slice_size  = static_cast<scm::size_t>(data_dimensions.x) * data_dimensions.y * size_of_format(data_format);
+    const scm::size_t   slice_size      = static_cast<scm::size_t>(data_dimensions.x) * data_dimensions.y * size_of_format(tex_format);
+    const unsigned      slab_depth      = clamp(static_cast<unsigned>(in_staging_size / max(slice_size, src_slice_size)), 1u, data_dimensions.z);
+    const scm::size_t   slab_size       = slice_size * slab_depth;
+    const unsigned      mip_count       = in_create_mips ? gl::util::max_mip_levels(data_dimensions) : 1;
+    const unsigned      staging_count   = max(1u, in_staging_buffers);
+
+    if (max(max(data_dimensions.x, data_dimensions.y), data_dimensions.z) > static_cast<unsigned>(in_device.capabilities()._max_texture_3d_size)) {
+        err() << log::error
+              << "volume_loader::stream_volume_data(): volume too large to load as single texture ('" << data_dimensions << "')." << log::end;
+        return texture_3d_ptr();
+    }
+
+    out() << log::indent;
+    time::high_res_timer timer;
+
+    if (in_quantizer && !in_quantizer->analyzed()) {
+        out() << "analyzing volume data for quantization to " << format_string(tex_format) << "..." << log::end;
+        timer.start();
+        if (!in_quantizer->analyze(*vol_reader, in_staging_size)) {
+            err() << log::error
+                  << "volume_loader::stream_volume_data(): unable to determine quantization mapping ('" << in_volume_path << "')." << log::end;
+            out() << log::outdent;
+            return texture_3d_ptr();
+        }
+        timer.stop();
+        out() << "analyzing volume data done"
+              << " (window: [" << in_quantizer->mapping()._window_min << ", " << in_quantizer->mapping()._window_max << "]"
+              << ", elapsed time: " << std::fixed << std::setprecision(3)
+              << time::to_seconds(timer.get_time()) << "s)" << log::end;
+    }
+
+    out() << "streaming volume data "
+          << "(dimensions: " << data_dimensions << ", format: " << format_string(data_format)
+          << ", texture format: " << format_string(tex_format)
+          << ", mip-level: " << mip_count
+          << ", staging: " << staging_count << "x" << std::fixed << std::setprecision(3)
+          << static_cast<double>(slab_size) / (1024.0*1024.0) << "MiB)..." << log::end;
+    timer.start();
+
+    texture_3d_ptr new_volume_tex = in_device.create_texture_3d(data_dimensions, tex_format, mip_count);
+    if (!new_volume_tex) {
+        err() << log::error
+              << "volume_loader::stream_volume_data(): unable to allocate texture storage ('" << in_volume_path << "')." << log::end;
+        out() << log::outdent;
+        return texture_3d_ptr();
+    }
+
+    std::vector<buffer_ptr>     staging_buffers(staging_count);
+    std::vector<fence_sync_ptr> staging_fences(staging_count);
+
+    for (unsigned b = 0; b < staging_count; ++b) {
+        staging_buffers[b] = in_device.create_buffer(BIND_PIXEL_UNPACK_BUFFER, USAGE_STREAM_DRAW, slab_size);
+        if (!staging_buffers[b]) {
+            err() << log::error
+                  << "volume_loader::stream_volume_data(): unable to allocate staging buffers." << log::end;
+            out() << log::outdent;
+            return texture_3d_ptr();
+        }
+    }
+
+    // full precision slab, converted into the staging buffer
+    shared_array<uint8> source_slab;
+    if (in_quantizer) {
+        source_slab.reset(new uint8[src_slice_size * slab_depth]);
+    }
+
+    { // upload slabs
+        context_unpack_buffer_guard upbg(in_context);
+
+        unsigned cur_staging = 0;
+
+        for (unsigned z = 0; z < data_dimensions.z; z += slab_depth) {
+            const vec3ui     slab_origin = vec3ui(0u, 0u, z);
+            const vec3ui     slab_dim    = vec3ui(data_dimensions.x, data_dimensions.y, min(slab_depth, data_dimensions.z - z));
+            const buffer_ptr& sbuf       = staging_buffers[cur_staging];
+
+            if (source_slab && !vol_reader->read(slab_origin, slab_dim, source_slab.get())) {
+                err() << log::error
+                      << "volume_loader::stream_volume_data(): unable to read data from file ('" << in_volume_path << "')." << log::end;
+                out() << log::outdent;
+                return texture_3d_ptr();
+            }
+
+            // wait until the transfer out of this staging buffer finished
+            if (staging_fences[cur_staging]) {
+                in_context->sync_client_wait(staging_fences[cur_staging]);
+                staging_fences[cur_staging].reset();
+            }
+
+            void* slab_data = in_context->map_buffer_range(sbuf, 0, slice_size * slab_dim.z, ACCESS_WRITE_INVALIDATE_BUFFER);
+            if (!slab_data) {
+                err() << log::error
+                      << "volume_loader::stream_volume_data(): unable to map staging buffer." << log::end;
+                out() << log::outdent;
+                return texture_3d_ptr();
+            }
+
+            const bool read_ok = source_slab ? in_quantizer->quantize(slab_dim, data_format, source_slab.get(), slab_data)
+                                             : vol_reader->read(slab_origin, slab_dim, slab_data);
+            in_context->unmap_buffer(sbuf);
+
+            if (!read_ok) {
+                err() << log::error
+                      << "volume_loader::stream_volume_data(): unable to "
+                      << (source_slab ? "quantize" : "read") << " data from file ('" << in_volume_path << "')." << log::end;
+                out() << log::outdent;
+                return texture_3d_ptr();
+            }
+
+            in_context->bind_unpack_buffer(sbuf);
+            in_context->update_sub_texture(new_volume_tex, texture_region(slab_origin, slab_dim), 0, tex_format, static_cast<size_t>(0));
+            in_context->bind_unpack_buffer(buffer_ptr());
+
+            staging_fences[cur_staging] = in_context->insert_fence_sync();
+            cur_staging = (cur_staging + 1) % staging_count;
+        }
+    }
+
+    if (mip_count > 1) {
+        // same non-power of two filter as the cpu mip-map generation, the driver
+        // filter is only the fallback for formats without image load/store support
+        bool mips_done = false;
+        if (   SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_430
+            && gpu_mip_map_generator::is_supported_format(tex_format)) {
+            if (!_mip_map_generator) {
+                _mip_map_generator.reset(new gpu_mip_map_generator());
+            }
+            mips_done = _mip_map_generator->generate_mipmaps(in_context, new_volume_tex);
+        }
+        if (!mips_done) {
+            in_context->generate_mipmaps(new_volume_tex);
+        }
+    }
+    in_context->flush();
+
+    timer.stop();
+    out() << "streaming volume data done"
+          << " (elapsed time: " << std::fixed << std::setprecision(3)
+          << time::to_seconds(timer.get_time()) << "s, "
+          << (static_cast<double>(src_slice_size * data_dimensions.z) / (1024.0*1024.0)) / time::to_seconds(timer.get_time()) << "MiB/s)" << log::end;
+
+    out() << log::outdent;
+
+    return new_volume_tex;
+}
+
 scm::math::vec3ui
 volume_loader::read_dimensions(const std::string&  in_image_path)
 {
@@ -15,6 +15,8 @@
 #include <scm/gl_core/texture_objects/texture_objects_fwd.h>
 
 #include <scm/gl_util/data/imaging/imaging_fwd.h>
+#include <scm/gl_util/data/volume/volume_quantizer.h>
+#include <scm/gl_util/utilities/utilities_fwd.h>
 
 #include <scm/core/platform/platform.h>
 #include <scm/core/utilities/platform_warning_disable.h>
@@ -36,8 +38,27 @@ public:
 	texture_3d_ptr              load_volume_data(render_device&       in_device,
 											     const std::string&  in_volume_path);
 
+    // streams the volume slab by slab through a ring of mapped pixel unpack buffers
+    // into immutable texture storage, host memory stays bounded by the staging ring,
+    // mip-maps are generated on the GPU after the upload of level 0, the generator
+    // and its compiled programs are kept by the loader for further volumes (a loader
+    // has to be used with a single render device).
+    // with a quantizer the slabs are converted to its target format on the way
+    // into the staging buffers (the volume is analyzed first if required), the
+    // mapping back to the source values is kept by the quantizer
+    texture_3d_ptr              stream_volume_data(render_device&           in_device,
+                                                   const render_context_ptr& in_context,
+                                                   const std::string&       in_volume_path,
+                                                   bool                     in_create_mips      = true,
+                                                   unsigned                 in_staging_buffers  = 2,
+                                                   scm::size_t              in_staging_size     = 64 * 1024 * 1024,
+                                                   const volume_quantizer_ptr& in_quantizer     = volume_quantizer_ptr());
+
 	scm::math::vec3ui			read_dimensions(const std::string&  in_volume_path);
 
+protected:
+    gpu_mip_map_generator_ptr   _mip_map_generator;
+
 }; // class volume_loader
 
 } // namespace gl
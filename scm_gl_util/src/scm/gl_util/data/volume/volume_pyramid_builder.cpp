@@ -0,0 +1,348 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "volume_pyramid_builder.h"
+
+#include <cstring>
+#include <vector>
+
+#include <boost/numeric/conversion/bounds.hpp>
+
+#include <scm/core/memory.h>
+#include <scm/core/io/file.h>
+#include <scm/core/utilities/parallel_for.h>
+
+#include <scm/gl_core/log.h>
+#include <scm/gl_core/texture_objects/texture_image.h>
+
+#include <scm/gl_util/data/imaging/mip_map_generation.h>
+#include <scm/gl_util/data/volume/volume_reader.h>
+
+namespace {
+
+// destination texels filtered per parallel_for range
+const scm::size_t pyramid_range_texels = 64 * 1024;
+
+// slices of one pyramid level held in memory
+//  - level 0: read window, the current slab preceded by the slices of the
+//    previous slab the z-filter of level 1 still needs
+//  - higher levels: ring of the last three slices
+struct pyramid_level
+{
+    pyramid_level()
+      : _dim(0u)
+      , _row_size(0)
+      , _slice_size(0)
+      , _file_offset(-1)
+      , _ring(0)
+      , _first(0)
+      , _available(0)
+    {}
+
+    scm::uint8* slice(unsigned z) const {
+        return _slices.get() + (_ring > 0 ? z % _ring : z - _first) * _slice_size;
+    }
+
+    scm::math::vec3ui               _dim;
+    scm::size_t                     _row_size;      // values per row
+    scm::size_t                     _slice_size;    // bytes per slice
+    scm::io::file::offset_type      _file_offset;   // of slice 0, negative if the level is not written
+    scm::shared_array<scm::uint8>   _slices;
+    unsigned                        _ring;          // ring size, 0 for the read window
+    unsigned                        _first;         // first slice in the read window
+    unsigned                        _available;     // slices of the level read or computed so far
+}; // struct pyramid_level
+
+// clamps to the value range of vtype and truncates like typed_generate_mipmaps
+template<typename vtype>
+inline
+void
+store_row_truncated(vtype* dst, const float* src, scm::size_t count)
+{
+    const float vmin = static_cast<float>(boost::numeric::bounds<vtype>::lowest());
+    const float vmax = static_cast<float>(boost::numeric::bounds<vtype>::highest());
+    for (scm::size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<vtype>(scm::math::clamp(src[i], vmin, vmax));
+    }
+}
+
+template<>
+inline
+void
+store_row_truncated<float>(float* dst, const float* src, scm::size_t count)
+{
+    memcpy(dst, src, count * sizeof(float));
+}
+
+// filters the rows [row_begin, row_end) of slice _z of the destination level
+template<typename vtype, const unsigned vdim>
+struct pyramid_slice_filter
+{
+    const pyramid_level*    _src;
+    const pyramid_level*    _dst;
+    unsigned                _z;
+    unsigned                _taps_z;
+    float                   _weights_z[3];
+
+    void operator()(scm::size_t row_begin, scm::size_t row_end, unsigned /*range_index*/) const
+    {
+        using namespace scm::gl::util;
+
+        std::vector<float> vrow(_src->_row_size);
+        std::vector<float> hrow(_dst->_row_size);
+        vtype*             dst = reinterpret_cast<vtype*>(_dst->slice(_z));
+
+        float wy[3];
+        for (scm::size_t y = row_begin; y < row_end; ++y) {
+            const unsigned taps_y = filter_taps(_src->_dim.y, _dst->_dim.y, static_cast<unsigned>(y), wy);
+
+            std::fill(vrow.begin(), vrow.end(), 0.0f);
+            for (unsigned tz = 0; tz < _taps_z; ++tz) {
+                const vtype* src = reinterpret_cast<const vtype*>(_src->slice(2 * _z + tz));
+                for (unsigned ty = 0; ty < taps_y; ++ty) {
+                    accumulate_row(&vrow[0], src + (2 * y + ty) * _src->_row_size, _src->_row_size, _weights_z[tz] * wy[ty]);
+                }
+            }
+            filter_row_x<vdim>(&vrow[0], _src->_dim.x, &hrow[0], _dst->_dim.x);
+            store_row_truncated(dst + y * _dst->_row_size, &hrow[0], _dst->_row_size);
+        }
+    }
+}; // struct pyramid_slice_filter
+
+// computes all slices of level l + 1 the available slices of level l allow,
+// every new slice is written and handed on to the following level right away
+template<typename vtype, const unsigned vdim>
+bool
+filter_levels(std::vector<pyramid_level>& levels,
+              unsigned                    l,
+              scm::io::file&              out_file)
+{
+    using namespace scm;
+    using namespace scm::gl;
+
+    if (l + 1 >= levels.size()) {
+        return true;
+    }
+
+    const pyramid_level& src = levels[l];
+    pyramid_level&       dst = levels[l + 1];
+
+    while (dst._available < dst._dim.z) {
+        pyramid_slice_filter<vtype, vdim> f;
+        f._src    = &src;
+        f._dst    = &dst;
+        f._z      = dst._available;
+        f._taps_z = util::filter_taps(src._dim.z, dst._dim.z, f._z, f._weights_z);
+
+        if (src._available < 2 * f._z + f._taps_z) {
+            break; // wait for the next slab
+        }
+
+        parallel_for(dst._dim.y, math::max<scm::size_t>(1, pyramid_range_texels / dst._dim.x), f);
+
+        if (dst._file_offset >= 0) {
+            const io::file::offset_type pos = dst._file_offset + static_cast<io::file::offset_type>(f._z) * dst._slice_size;
+            if (out_file.write(dst.slice(f._z), pos, dst._slice_size) != static_cast<io::file::size_type>(dst._slice_size)) {
+                glerr() << log::error
+                        << "volume_pyramid_builder::build(): error writing to output file ('" << out_file.file_path()
+                        << "', level: " << l + 1 << ", slice: " << f._z << ")." << log::end;
+                return false;
+            }
+        }
+
+        ++dst._available;
+
+        if (!filter_levels<vtype, vdim>(levels, l + 1, out_file)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<typename vtype, const unsigned vdim>
+bool
+typed_build(scm::gl::volume_reader& in_reader,
+            unsigned                in_slab_depth,
+            bool                    in_store_base_level,
+            scm::io::file&          out_file)
+{
+    using namespace scm;
+    using namespace scm::gl;
+    using namespace scm::math;
+
+    const vec3ui   dim         = in_reader.dimensions();
+    const unsigned level_count = util::max_mip_levels(dim);
+
+    std::vector<pyramid_level> levels(level_count);
+    io::file::offset_type      file_offset = 0;
+
+    for (unsigned l = 0; l < level_count; ++l) {
+        pyramid_level& lev = levels[l];
+
+        lev._dim        = util::mip_level_dimensions(dim, l);
+        lev._row_size   = static_cast<scm::size_t>(lev._dim.x) * vdim;
+        lev._slice_size = lev._row_size * lev._dim.y * sizeof(vtype);
+        lev._ring       = l > 0 ? 3 : 0;
+        lev._slices.reset(new uint8[lev._slice_size * (l > 0 ? 3 : in_slab_depth + 2)]);
+
+        if (l > 0 || in_store_base_level) {
+            lev._file_offset  = file_offset;
+            file_offset      += static_cast<io::file::offset_type>(lev._slice_size) * lev._dim.z;
+        }
+    }
+
+    pyramid_level& base = levels[0];
+
+    while (base._available < dim.z) {
+        // drop the slices the z-filter of level 1 no longer needs
+        const unsigned keep = level_count > 1 ? min(2 * levels[1]._available, base._available) : base._available;
+        if (keep > base._first) {
+            memmove(base._slices.get(), base.slice(keep), (base._available - keep) * base._slice_size);
+            base._first = keep;
+        }
+
+        const unsigned depth = min(in_slab_depth, dim.z - base._available);
+        uint8*         slab  = base.slice(base._available);
+
+        if (!in_reader.read(vec3ui(0u, 0u, base._available), vec3ui(dim.x, dim.y, depth), slab)) {
+            glerr() << log::error
+                    << "volume_pyramid_builder::build(): unable to read volume data (slab: " << base._available << ")." << log::end;
+            return false;
+        }
+        if (base._file_offset >= 0) {
+            const io::file::offset_type pos   = base._file_offset + static_cast<io::file::offset_type>(base._available) * base._slice_size;
+            const io::file::size_type   bytes = static_cast<io::file::size_type>(base._slice_size) * depth;
+            if (out_file.write(slab, pos, bytes) != bytes) {
+                glerr() << log::error
+                        << "volume_pyramid_builder::build(): error writing to output file ('" << out_file.file_path()
+                        << "', level: 0, slab: " << base._available << ")." << log::end;
+                return false;
+            }
+        }
+
+        base._available += depth;
+
+        if (!filter_levels<vtype, vdim>(levels, 0, out_file)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<typename vtype>
+bool
+typed_build(scm::gl::volume_reader& in_reader,
+            unsigned                in_channels,
+            unsigned                in_slab_depth,
+            bool                    in_store_base_level,
+            scm::io::file&          out_file)
+{
+    switch (in_channels) {
+        case 1: return typed_build<vtype, 1>(in_reader, in_slab_depth, in_store_base_level, out_file);
+        case 2: return typed_build<vtype, 2>(in_reader, in_slab_depth, in_store_base_level, out_file);
+        case 3: return typed_build<vtype, 3>(in_reader, in_slab_depth, in_store_base_level, out_file);
+        case 4: return typed_build<vtype, 4>(in_reader, in_slab_depth, in_store_base_level, out_file);
+        default: return false;
+    }
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+volume_pyramid_builder::volume_pyramid_builder(bool        in_store_base_level,
+                                               scm::size_t in_slab_size)
+  : _store_base_level(in_store_base_level)
+  , _slab_size(in_slab_size)
+{
+}
+
+volume_pyramid_builder::~volume_pyramid_builder()
+{
+}
+
+bool
+volume_pyramid_builder::is_supported_format(data_format in_format)
+{
+    switch (in_format) {
+        case FORMAT_R_8:    case FORMAT_RG_8:   case FORMAT_RGB_8:   case FORMAT_RGBA_8:
+        case FORMAT_R_16:   case FORMAT_RG_16:  case FORMAT_RGB_16:  case FORMAT_RGBA_16:
+        case FORMAT_R_32F:  case FORMAT_RG_32F: case FORMAT_RGB_32F: case FORMAT_RGBA_32F:
+            return true;
+        default:
+            return false;
+    }
+}
+
+scm::size_t
+volume_pyramid_builder::level_offset(const math::vec3ui& in_dimensions,
+                                     data_format         in_format,
+                                     unsigned            in_level) const
+{
+    scm::size_t offset = 0;
+    for (unsigned l = _store_base_level ? 0 : 1; l < in_level; ++l) {
+        const math::vec3ui lsize = util::mip_level_dimensions(in_dimensions, l);
+        offset += static_cast<scm::size_t>(lsize.x) * lsize.y * lsize.z * size_of_format(in_format);
+    }
+    return offset;
+}
+
+bool
+volume_pyramid_builder::build(volume_reader&     in_reader,
+                              const std::string& in_output_path)
+{
+    using namespace scm::math;
+
+    if (!in_reader) {
+        glerr() << log::error
+                << "volume_pyramid_builder::build(): invalid volume reader." << log::end;
+        return false;
+    }
+
+    const vec3ui      dim        = in_reader.dimensions();
+    const data_format fmt        = in_reader.format();
+    const scm::size_t slice_size = static_cast<scm::size_t>(dim.x) * dim.y * size_of_format(fmt);
+
+    if (!is_supported_format(fmt)) {
+        glerr() << log::error
+                << "volume_pyramid_builder::build(): unsupported volume format (" << format_string(fmt) << ")." << log::end;
+        return false;
+    }
+    if (slice_size == 0 || dim.z == 0) {
+        glerr() << log::error
+                << "volume_pyramid_builder::build(): empty volume." << log::end;
+        return false;
+    }
+
+    io::file out_file;
+    if (!out_file.open(in_output_path, std::ios_base::out | std::ios_base::trunc, false)) {
+        glerr() << log::error
+                << "volume_pyramid_builder::build(): error opening output file ('" << in_output_path << "')." << log::end;
+        return false;
+    }
+
+    const unsigned slab_depth = clamp(static_cast<unsigned>(_slab_size / slice_size), 1u, dim.z);
+    const unsigned channels   = channel_count(fmt);
+    bool           ret        = false;
+
+    if (is_float_type(fmt)) {
+        ret = typed_build<float>(in_reader, channels, slab_depth, _store_base_level, out_file);
+    }
+    else if (size_of_channel(fmt) == 2) {
+        ret = typed_build<uint16>(in_reader, channels, slab_depth, _store_base_level, out_file);
+    }
+    else {
+        ret = typed_build<uint8>(in_reader, channels, slab_depth, _store_base_level, out_file);
+    }
+
+    out_file.close();
+
+    return ret;
+}
+
+} // namespace gl
+} // namespace scm
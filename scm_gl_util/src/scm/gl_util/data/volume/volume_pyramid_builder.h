@@ -0,0 +1,67 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_VOLUME_PYRAMID_BUILDER_H_INCLUDED
+#define SCM_GL_UTIL_VOLUME_PYRAMID_BUILDER_H_INCLUDED
+
+#include <string>
+
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/math.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/data_formats.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+class volume_reader;
+
+// out-of-core generation of the mip-map pyramid of volumes larger than the
+// host memory
+//  - level 0 is consumed slab by slab through a volume_reader, only the current
+//    slab and the up to two slices of the previous slab still needed by the
+//    z-filter are held in memory, every higher level keeps three slices
+//  - each finished slice is written to the output file right away, the levels
+//    are stored consecutively in x-y-z order without header (see level_offset()),
+//    level 0 is only copied to the output if in_store_base_level is set
+//  - same filter as util::generate_mipmaps (box filter for even, polyphase box
+//    filter for odd sizes, integer results truncated), the rows of each slice
+//    are filtered on all hardware threads. results can differ by one unit from
+//    the in-memory path through the different summation order
+//  - formats: r, rg, rgb and rgba in 8 and 16 bit normalized and 32 bit float
+class __scm_export(gl_util) volume_pyramid_builder : boost::noncopyable
+{
+public:
+    volume_pyramid_builder(bool        in_store_base_level = true,
+                           scm::size_t in_slab_size        = 64 * 1024 * 1024);
+    virtual ~volume_pyramid_builder();
+
+    static bool                 is_supported_format(data_format in_format);
+
+    // position of in_level in the output file, level_offset(..., max_mip_levels())
+    // is the size of the whole output
+    scm::size_t                 level_offset(const math::vec3ui& in_dimensions,
+                                             data_format         in_format,
+                                             unsigned            in_level) const;
+
+    bool                        build(volume_reader&     in_reader,
+                                      const std::string& in_output_path);
+
+protected:
+    bool                        _store_base_level;
+    scm::size_t                 _slab_size;
+
+}; // class volume_pyramid_builder
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_VOLUME_PYRAMID_BUILDER_H_INCLUDED
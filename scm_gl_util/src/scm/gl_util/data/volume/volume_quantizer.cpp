@@ -0,0 +1,582 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "volume_quantizer.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/numeric/conversion/bounds.hpp>
+
+#include <scm/core/math/config.h>
+#include <scm/core/utilities/parallel_for.h>
+
+#include <scm/gl_core/log.h>
+
+#include <scm/gl_util/data/analysis/volume_statistics.h>
+#include <scm/gl_util/data/volume/volume_reader.h>
+
+#if SCM_CORE_MATH_SIMD_SSE
+#   include <xmmintrin.h>
+#   include <emmintrin.h>
+#endif
+
+namespace {
+
+// histogram resolution of the equalization, enough to separate all 16bit codes
+const unsigned      equalization_bins       = 64 * 1024;
+// minimal number of values converted per thread
+const scm::size_t   quantize_range_size     = 256 * 1024;
+
+// forward mapping of one source value, the same operations as in the sse path
+// so both produce the same codes
+inline
+unsigned
+linear_code(float in_value, float in_min, float in_scale, float in_max_code)
+{
+    const float f = (in_value - in_min) * in_scale;
+    // NaNs are mapped to code 0
+    return static_cast<unsigned>((f > 0.0f ? (f < in_max_code ? f : in_max_code) : 0.0f) + 0.5f);
+}
+
+// same binning as the histogram of volume_statistics
+inline
+unsigned
+histogram_bin(float in_value, float in_min, float in_bin_scale, unsigned in_bins)
+{
+    const float f       = (in_value - in_min) * in_bin_scale;
+    const float max_bin = static_cast<float>(in_bins - 1);
+    return f > 0.0f ? (f < max_bin ? static_cast<unsigned>(f) : in_bins - 1) : 0u;
+}
+
+#if SCM_CORE_MATH_SIMD_SSE
+
+template<typename value_type>
+inline
+__m128
+load4(const value_type* p)
+{
+    return _mm_setr_ps(static_cast<float>(p[0]), static_cast<float>(p[1]),
+                       static_cast<float>(p[2]), static_cast<float>(p[3]));
+}
+
+inline
+__m128
+load4(const float* p)
+{
+    return _mm_loadu_ps(p);
+}
+
+inline
+__m128
+load4(const scm::int16* p)
+{
+    const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+}
+
+inline
+__m128
+load4(const scm::uint16* p)
+{
+    const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, _mm_setzero_si128()));
+}
+
+inline
+void
+store4(__m128i in_codes, scm::uint8* p)
+{
+    const int c = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(in_codes, in_codes), _mm_setzero_si128()));
+    std::memcpy(p, &c, 4);
+}
+
+inline
+void
+store4(__m128i in_codes, scm::uint16* p)
+{
+    // no unsigned 32 to 16bit pack in sse2, shift into the signed range and back
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    const __m128i c    = _mm_packs_epi32(_mm_sub_epi32(in_codes, bias), _mm_setzero_si128());
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_xor_si128(c, _mm_set1_epi16(static_cast<short>(0x8000))));
+}
+
+#endif // SCM_CORE_MATH_SIMD_SSE
+
+template<typename src_type, typename dst_type>
+void
+quantize_linear(const src_type*     in_src,
+                scm::size_t         in_count,
+                float               in_min,
+                float               in_scale,
+                float               in_max_code,
+                dst_type*           out_dst)
+{
+    scm::size_t i = 0;
+
+#if SCM_CORE_MATH_SIMD_SSE
+    const __m128 vmin   = _mm_set1_ps(in_min);
+    const __m128 vscale = _mm_set1_ps(in_scale);
+    const __m128 vmaxc  = _mm_set1_ps(in_max_code);
+    const __m128 vhalf  = _mm_set1_ps(0.5f);
+    const __m128 vzero  = _mm_setzero_ps();
+
+    for (; i + 4 <= in_count; i += 4) {
+        __m128 f = _mm_mul_ps(_mm_sub_ps(load4(in_src + i), vmin), vscale);
+        f = _mm_min_ps(_mm_max_ps(f, vzero), vmaxc); // max(NaN, 0) returns 0
+        store4(_mm_cvttps_epi32(_mm_add_ps(f, vhalf)), out_dst + i);
+    }
+#endif // SCM_CORE_MATH_SIMD_SSE
+
+    for (; i < in_count; ++i) {
+        out_dst[i] = static_cast<dst_type>(linear_code(static_cast<float>(in_src[i]), in_min, in_scale, in_max_code));
+    }
+}
+
+template<typename src_type, typename dst_type>
+void
+quantize_equalized(const src_type*      in_src,
+                   scm::size_t          in_count,
+                   float                in_min,
+                   float                in_bin_scale,
+                   const scm::uint16*   in_codes,
+                   dst_type*            out_dst)
+{
+    scm::size_t i = 0;
+
+#if SCM_CORE_MATH_SIMD_SSE
+    const __m128 vmin    = _mm_set1_ps(in_min);
+    const __m128 vscale  = _mm_set1_ps(in_bin_scale);
+    const __m128 vmaxbin = _mm_set1_ps(static_cast<float>(equalization_bins - 1));
+    const __m128 vzero   = _mm_setzero_ps();
+
+    scm_align(16) int bins[4];
+
+    for (; i + 4 <= in_count; i += 4) {
+        __m128 f = _mm_mul_ps(_mm_sub_ps(load4(in_src + i), vmin), vscale);
+        f = _mm_min_ps(_mm_max_ps(f, vzero), vmaxbin);
+        _mm_store_si128(reinterpret_cast<__m128i*>(bins), _mm_cvttps_epi32(f));
+        out_dst[i    ] = static_cast<dst_type>(in_codes[bins[0]]);
+        out_dst[i + 1] = static_cast<dst_type>(in_codes[bins[1]]);
+        out_dst[i + 2] = static_cast<dst_type>(in_codes[bins[2]]);
+        out_dst[i + 3] = static_cast<dst_type>(in_codes[bins[3]]);
+    }
+#endif // SCM_CORE_MATH_SIMD_SSE
+
+    for (; i < in_count; ++i) {
+        out_dst[i] = static_cast<dst_type>(in_codes[histogram_bin(static_cast<float>(in_src[i]), in_min, in_bin_scale, equalization_bins)]);
+    }
+}
+
+template<typename src_type, typename dst_type>
+void
+typed_quantize(const src_type*                      in_src,
+               scm::size_t                          in_count,
+               const scm::gl::quantization_mapping& in_mapping,
+               const std::vector<scm::uint16>&      in_codes,
+               dst_type*                            out_dst)
+{
+    using namespace scm;
+
+    const float range     = in_mapping._window_max - in_mapping._window_min;
+    const float max_code  = static_cast<float>((1u << (8 * sizeof(dst_type))) - 1);
+
+    if (in_mapping._mode == gl::QUANTIZE_HISTOGRAM_EQUALIZATION) {
+        const float bin_scale = range > 0.0f ? static_cast<float>(equalization_bins) / range : 0.0f;
+        parallel_for(in_count, quantize_range_size,
+            [&](scm::size_t b, scm::size_t e, unsigned) {
+                quantize_equalized(in_src + b, e - b, in_mapping._window_min, bin_scale, &in_codes.front(), out_dst + b);
+            });
+    }
+    else {
+        const float scale = range > 0.0f ? max_code / range : 0.0f;
+        parallel_for(in_count, quantize_range_size,
+            [&](scm::size_t b, scm::size_t e, unsigned) {
+                quantize_linear(in_src + b, e - b, in_mapping._window_min, scale, max_code, out_dst + b);
+            });
+    }
+}
+
+template<typename src_type>
+void
+quantize_to_target(const src_type*                      in_src,
+                   scm::size_t                          in_count,
+                   const scm::gl::quantization_mapping& in_mapping,
+                   const std::vector<scm::uint16>&      in_codes,
+                   void*                                out_dst)
+{
+    if (scm::gl::size_of_channel(in_mapping._target_format) == 1) {
+        typed_quantize(in_src, in_count, in_mapping, in_codes, reinterpret_cast<scm::uint8*>(out_dst));
+    }
+    else {
+        typed_quantize(in_src, in_count, in_mapping, in_codes, reinterpret_cast<scm::uint16*>(out_dst));
+    }
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+quantization_mapping::quantization_mapping()
+  : _mode(QUANTIZE_LINEAR_WINDOW)
+  , _source_format(FORMAT_NULL)
+  , _target_format(FORMAT_NULL)
+  , _window_min(0.0f)
+  , _window_max(0.0f)
+  , _scale(0.0f)
+  , _bias(0.0f)
+{
+}
+
+volume_quantizer::volume_quantizer(data_format        in_target_format,
+                                   quantization_mode  in_mode)
+  : _target_format(in_target_format)
+  , _mode(in_mode)
+  , _window_fixed(false)
+  , _window_min(0.0f)
+  , _window_max(0.0f)
+  , _analyzed(false)
+{
+    if (!is_supported_target(_target_format)) {
+        std::ostringstream s;
+        s << "volume_quantizer::volume_quantizer(): unsupported target format (" << format_string(_target_format) << ").";
+        glerr() << log::error << s.str() << log::end;
+        throw std::runtime_error(s.str());
+    }
+}
+
+volume_quantizer::~volume_quantizer()
+{
+}
+
+bool
+volume_quantizer::is_supported_source(data_format in_format)
+{
+    return volume_statistics::supported_format(in_format);
+}
+
+bool
+volume_quantizer::is_supported_target(data_format in_format)
+{
+    switch (in_format) {
+        case FORMAT_R_8:  case FORMAT_RG_8:  case FORMAT_RGB_8:  case FORMAT_RGBA_8:
+        case FORMAT_R_16: case FORMAT_RG_16: case FORMAT_RGB_16: case FORMAT_RGBA_16:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void
+volume_quantizer::set_window(float in_min_value,
+                             float in_max_value)
+{
+    _window_fixed = true;
+    _window_min   = in_min_value;
+    _window_max   = in_max_value;
+    _analyzed     = false;
+}
+
+void
+volume_quantizer::reset_window()
+{
+    _window_fixed = false;
+    _analyzed     = false;
+}
+
+bool
+volume_quantizer::analyze(volume_reader& in_reader,
+                          scm::size_t    in_slab_size)
+{
+    using namespace scm::math;
+
+    _analyzed = false;
+
+    if (!in_reader) {
+        glerr() << log::error
+                << "volume_quantizer::analyze(): invalid volume reader." << log::end;
+        return false;
+    }
+
+    const vec3ui        dimensions = in_reader.dimensions();
+    const data_format   format     = in_reader.format();
+    const scm::size_t   slice_size = static_cast<scm::size_t>(dimensions.x) * dimensions.y * size_of_format(format);
+
+    if (!is_supported_source(format) || channel_count(format) != channel_count(_target_format)) {
+        glerr() << log::error
+                << "volume_quantizer::analyze(): unsupported source format (" << format_string(format)
+                << ", target format: " << format_string(_target_format) << ")." << log::end;
+        return false;
+    }
+    if (slice_size == 0 || dimensions.z == 0) {
+        glerr() << log::error
+                << "volume_quantizer::analyze(): empty volume." << log::end;
+        return false;
+    }
+
+    const unsigned      slab_depth = clamp(static_cast<unsigned>(in_slab_size / slice_size), 1u, dimensions.z);
+    shared_array<uint8> slab_data(new uint8[slice_size * slab_depth]);
+    volume_statistics   slab_stats;
+
+    float min_value = _window_min;
+    float max_value = _window_max;
+
+    if (!_window_fixed) {
+        min_value = boost::numeric::bounds<float>::highest();
+        max_value = boost::numeric::bounds<float>::lowest();
+        for (unsigned z = 0; z < dimensions.z; z += slab_depth) {
+            const vec3ui slab_dim = vec3ui(dimensions.x, dimensions.y, min(slab_depth, dimensions.z - z));
+            if (   !in_reader.read(vec3ui(0u, 0u, z), slab_dim, slab_data.get())
+                || !slab_stats.compute(slab_dim, format, slab_data.get(), 0)) {
+                glerr() << log::error
+                        << "volume_quantizer::analyze(): unable to read volume data (slab: " << z << ")." << log::end;
+                return false;
+            }
+            min_value = min(min_value, slab_stats.statistics()._min);
+            max_value = max(max_value, slab_stats.statistics()._max);
+        }
+    }
+
+    if (!build_mapping(format, min_value, max_value)) {
+        return false;
+    }
+
+    if (_mode == QUANTIZE_HISTOGRAM_EQUALIZATION) {
+        std::vector<scm::uint64> histogram(equalization_bins, 0);
+        for (unsigned z = 0; z < dimensions.z; z += slab_depth) {
+            const vec3ui slab_dim = vec3ui(dimensions.x, dimensions.y, min(slab_depth, dimensions.z - z));
+            if (   !in_reader.read(vec3ui(0u, 0u, z), slab_dim, slab_data.get())
+                || !slab_stats.compute(slab_dim, format, slab_data.get(),
+                                       _mapping._window_min, _mapping._window_max, equalization_bins)) {
+                glerr() << log::error
+                        << "volume_quantizer::analyze(): unable to read volume data (slab: " << z << ")." << log::end;
+                return false;
+            }
+            for (unsigned b = 0; b < equalization_bins; ++b) {
+                histogram[b] += slab_stats.histogram()[b];
+            }
+        }
+        build_equalization(histogram);
+    }
+
+    _analyzed = true;
+
+    return true;
+}
+
+bool
+volume_quantizer::analyze(const math::vec3ui&  in_dimensions,
+                          data_format          in_format,
+                          const void*          in_data)
+{
+    _analyzed = false;
+
+    if (!is_supported_source(in_format) || channel_count(in_format) != channel_count(_target_format)) {
+        glerr() << log::error
+                << "volume_quantizer::analyze(): unsupported source format (" << format_string(in_format)
+                << ", target format: " << format_string(_target_format) << ")." << log::end;
+        return false;
+    }
+
+    volume_statistics stats;
+
+    if (_window_fixed) {
+        if (   !build_mapping(in_format, _window_min, _window_max)
+            || !stats.compute(in_dimensions, in_format, in_data, _mapping._window_min, _mapping._window_max,
+                              _mode == QUANTIZE_HISTOGRAM_EQUALIZATION ? equalization_bins : 0)) {
+            return false;
+        }
+    }
+    else {
+        if (   !stats.compute(in_dimensions, in_format, in_data, 0)
+            || !build_mapping(in_format, stats.statistics()._min, stats.statistics()._max)) {
+            return false;
+        }
+        if (   _mode == QUANTIZE_HISTOGRAM_EQUALIZATION
+            && !stats.compute(in_dimensions, in_format, in_data, _mapping._window_min, _mapping._window_max, equalization_bins)) {
+            return false;
+        }
+    }
+
+    if (_mode == QUANTIZE_HISTOGRAM_EQUALIZATION) {
+        build_equalization(stats.histogram());
+    }
+
+    _analyzed = true;
+
+    return true;
+}
+
+bool
+volume_quantizer::analyzed() const
+{
+    return _analyzed;
+}
+
+bool
+volume_quantizer::quantize(const math::vec3ui&  in_dimensions,
+                           data_format          in_format,
+                           const void*          in_src_data,
+                           void*                out_dst_data) const
+{
+    if (!_analyzed) {
+        glerr() << log::error
+                << "volume_quantizer::quantize(): no mapping, analyze() the volume first." << log::end;
+        return false;
+    }
+    if (in_format != _mapping._source_format) {
+        glerr() << log::error
+                << "volume_quantizer::quantize(): source format does not match the analyzed volume ("
+                << format_string(in_format) << ", expected: " << format_string(_mapping._source_format) << ")." << log::end;
+        return false;
+    }
+    if (!in_src_data || !out_dst_data) {
+        glerr() << log::error
+                << "volume_quantizer::quantize(): invalid data pointer." << log::end;
+        return false;
+    }
+
+    const scm::size_t value_count =   static_cast<scm::size_t>(in_dimensions.x) * in_dimensions.y
+                                    * in_dimensions.z * channel_count(in_format);
+
+#define SCM_VOLUME_QUANTIZER_QUANTIZE(value_type)                                                           \
+    quantize_to_target(reinterpret_cast<const value_type*>(in_src_data), value_count, _mapping,            \
+                       _equalization_codes, out_dst_data)
+
+    if (is_float_type(in_format)) {
+        SCM_VOLUME_QUANTIZER_QUANTIZE(float);
+    }
+    else {
+        const bool is_signed =    (in_format >= FORMAT_R_8S  && in_format <= FORMAT_RGBA_16S)
+                               || (in_format >= FORMAT_R_8I  && in_format <= FORMAT_RGBA_32I);
+        switch (size_of_channel(in_format)) {
+            case 1:
+                if (is_signed) SCM_VOLUME_QUANTIZER_QUANTIZE(scm::int8);
+                else           SCM_VOLUME_QUANTIZER_QUANTIZE(scm::uint8);
+                break;
+            case 2:
+                if (is_signed) SCM_VOLUME_QUANTIZER_QUANTIZE(scm::int16);
+                else           SCM_VOLUME_QUANTIZER_QUANTIZE(scm::uint16);
+                break;
+            case 4:
+                if (is_signed) SCM_VOLUME_QUANTIZER_QUANTIZE(scm::int32);
+                else           SCM_VOLUME_QUANTIZER_QUANTIZE(scm::uint32);
+                break;
+        }
+    }
+
+#undef SCM_VOLUME_QUANTIZER_QUANTIZE
+
+    return true;
+}
+
+data_format
+volume_quantizer::target_format() const
+{
+    return _target_format;
+}
+
+quantization_mode
+volume_quantizer::mode() const
+{
+    return _mode;
+}
+
+const quantization_mapping&
+volume_quantizer::mapping() const
+{
+    return _mapping;
+}
+
+bool
+volume_quantizer::build_mapping(data_format in_source_format,
+                                float       in_min_value,
+                                float       in_max_value)
+{
+    if (!(in_min_value <= in_max_value)) {
+        glerr() << log::error
+                << "volume_quantizer::build_mapping(): invalid value window ("
+                << in_min_value << ", " << in_max_value << ")." << log::end;
+        return false;
+    }
+
+    _mapping                = quantization_mapping();
+    _mapping._mode          = _mode;
+    _mapping._source_format = in_source_format;
+    _mapping._target_format = _target_format;
+    _mapping._window_min    = in_min_value;
+    _mapping._window_max    = in_max_value;
+    _mapping._scale         = in_max_value - in_min_value;
+    _mapping._bias          = in_min_value;
+
+    _equalization_codes.clear();
+
+    return true;
+}
+
+void
+volume_quantizer::build_equalization(const std::vector<scm::uint64>& in_histogram)
+{
+    const unsigned      code_count = 1u << (8 * size_of_channel(_target_format));
+    const float         range      = _mapping._window_max - _mapping._window_min;
+    const float         bin_width  = range / static_cast<float>(equalization_bins);
+
+    scm::uint64 total = 0;
+    for (unsigned b = 0; b < equalization_bins; ++b) {
+        total += in_histogram[b];
+    }
+
+    _equalization_codes.resize(equalization_bins);
+    _mapping._reconstruction_table.assign(code_count, 0.0f);
+
+    if (total == 0) {
+        // nothing to equalize, fall back to the linear window
+        for (unsigned b = 0; b < equalization_bins; ++b) {
+            _equalization_codes[b] = static_cast<scm::uint16>((static_cast<scm::uint64>(b) * code_count) / equalization_bins);
+        }
+        for (unsigned c = 0; c < code_count; ++c) {
+            _mapping._reconstruction_table[c] = _mapping._bias + _mapping._scale * static_cast<float>(c) / static_cast<float>(code_count - 1);
+        }
+        return;
+    }
+
+    // each bin gets the code at the center of its interval of the cumulative
+    // histogram, the reconstructed value of a code is the mean of its values
+    std::vector<double>      code_sums(code_count, 0.0);
+    std::vector<scm::uint64> code_counts(code_count, 0);
+
+    scm::uint64 cumulative = 0;
+    for (unsigned b = 0; b < equalization_bins; ++b) {
+        const double   cdf  = (static_cast<double>(cumulative) + 0.5 * static_cast<double>(in_histogram[b])) / static_cast<double>(total);
+        const unsigned code = scm::math::min(static_cast<unsigned>(cdf * code_count), code_count - 1);
+
+        _equalization_codes[b] = static_cast<scm::uint16>(code);
+        code_sums[code]       += static_cast<double>(in_histogram[b]) * (_mapping._window_min + (b + 0.5f) * bin_width);
+        code_counts[code]     += in_histogram[b];
+        cumulative            += in_histogram[b];
+    }
+
+    // codes without values are interpolated between their used neighbors
+    std::vector<float>& table     = _mapping._reconstruction_table;
+    int                 prev_used = -1;
+    for (unsigned c = 0; c < code_count; ++c) {
+        if (code_counts[c] == 0) {
+            continue;
+        }
+        table[c] = static_cast<float>(code_sums[c] / static_cast<double>(code_counts[c]));
+        for (unsigned g = static_cast<unsigned>(prev_used + 1); g < c; ++g) {
+            const float t = static_cast<float>(static_cast<int>(g) - prev_used) / static_cast<float>(static_cast<int>(c) - prev_used);
+            table[g] = prev_used < 0 ? table[c] : table[prev_used] + t * (table[c] - table[prev_used]);
+        }
+        prev_used = static_cast<int>(c);
+    }
+    for (unsigned g = static_cast<unsigned>(prev_used + 1); g < code_count; ++g) {
+        table[g] = table[prev_used];
+    }
+}
+
+} // namespace gl
+} // namespace scm
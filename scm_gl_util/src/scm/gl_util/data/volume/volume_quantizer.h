@@ -0,0 +1,125 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_VOLUME_QUANTIZER_H_INCLUDED
+#define SCM_GL_UTIL_VOLUME_QUANTIZER_H_INCLUDED
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/math.h>
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/data_formats.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+class volume_reader;
+
+typedef enum {
+    QUANTIZE_LINEAR_WINDOW          = 0x00,
+    QUANTIZE_HISTOGRAM_EQUALIZATION
+} quantization_mode;
+
+// mapping from the quantized texture values back to the source values,
+// t is the normalized value fetched from the quantized texture
+//  - linear window:    source = t * _scale + _bias
+//  - equalization:     source = _reconstruction_table[round(t * (size - 1))],
+//    the table holds the mean source value of each quantization code and
+//    can be uploaded as 1d lookup texture
+struct __scm_export(gl_util) quantization_mapping
+{
+    quantization_mapping();
+
+    quantization_mode           _mode;
+    data_format                 _source_format;
+    data_format                 _target_format;
+    float                       _window_min;
+    float                       _window_max;
+    float                       _scale;
+    float                       _bias;
+    std::vector<float>          _reconstruction_table;
+}; // struct quantization_mapping
+
+// reduction of float and integer volume data to 8 or 16 bit normalized formats
+//  - the target format has to have the channel count of the source, all
+//    channels share the same mapping
+//  - the linear window maps [min, max] to the full code range, values outside
+//    of the window are clamped. without an explicit window the value range of
+//    the volume is used
+//  - histogram equalization distributes the codes by the cumulative histogram
+//    of the values inside the window (64k bins)
+//  - analyze() streams the volume slab by slab through the reader (one pass
+//    for the value range if no window is set, one for the histogram), only one
+//    slab of source data is held in memory
+//  - quantize() converts a block of source data on all hardware threads, float
+//    and 16bit integer sources are converted four values at a time (sse)
+class __scm_export(gl_util) volume_quantizer : boost::noncopyable
+{
+public:
+    volume_quantizer(data_format        in_target_format,
+                     quantization_mode  in_mode = QUANTIZE_LINEAR_WINDOW);
+    virtual ~volume_quantizer();
+
+    static bool                 is_supported_source(data_format in_format);
+    static bool                 is_supported_target(data_format in_format);
+
+    // fixed window instead of the value range of the volume
+    void                        set_window(float in_min_value,
+                                           float in_max_value);
+    void                        reset_window();
+
+    bool                        analyze(volume_reader& in_reader,
+                                        scm::size_t    in_slab_size = 64 * 1024 * 1024);
+    // the mapping for in-memory data
+    bool                        analyze(const math::vec3ui&  in_dimensions,
+                                        data_format          in_format,
+                                        const void*          in_data);
+    bool                        analyzed() const;
+
+    bool                        quantize(const math::vec3ui&  in_dimensions,
+                                         data_format          in_format,
+                                         const void*          in_src_data,
+                                         void*                out_dst_data) const;
+
+    data_format                 target_format() const;
+    quantization_mode           mode() const;
+    const quantization_mapping& mapping() const;
+
+protected:
+    bool                        build_mapping(data_format in_source_format,
+                                              float       in_min_value,
+                                              float       in_max_value);
+    void                        build_equalization(const std::vector<scm::uint64>& in_histogram);
+
+protected:
+    data_format                 _target_format;
+    quantization_mode           _mode;
+
+    bool                        _window_fixed;
+    float                       _window_min;
+    float                       _window_max;
+
+    bool                        _analyzed;
+    quantization_mapping        _mapping;
+    // equalization: code of each histogram bin over the window
+    std::vector<scm::uint16>    _equalization_codes;
+
+}; // class volume_quantizer
+
+typedef shared_ptr<volume_quantizer>        volume_quantizer_ptr;
+typedef shared_ptr<volume_quantizer const>  volume_quantizer_cptr;
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_VOLUME_QUANTIZER_H_INCLUDED
@@ -48,7 +48,7 @@ ft_face::set_size(unsigned point_size,
 }
 
 void
-ft_face::load_glyph(char c, unsigned f)
+ft_face::load_glyph(unsigned c, unsigned f)
 {
     if(FT_Load_Glyph(_face, FT_Get_Char_Index(_face, c), f)) {
                         //FT_LOAD_DEFAULT)) { //| FT_LOAD_TARGET_NORMAL)) {
@@ -65,8 +65,8 @@ ft_face::get_glyph() const
     return (_face->glyph);
 }
 
-char
-ft_face::get_kerning(char l, char r) const
+int
+ft_face::get_kerning(unsigned l, unsigned r) const
 {
     if (_face->face_flags & FT_FACE_FLAG_KERNING) {
         FT_UInt l_glyph_index = FT_Get_Char_Index(_face, l);
@@ -78,7 +78,7 @@ ft_face::get_kerning(char l, char r) const
         FT_Vector   delta;
         FT_Get_Kerning(_face, l_glyph_index, r_glyph_index, FT_KERNING_DEFAULT, &delta);
     
-        return (static_cast<char>(delta.x >> 6));
+        return (static_cast<int>(delta.x >> 6));
     }
     else {
         return (0);
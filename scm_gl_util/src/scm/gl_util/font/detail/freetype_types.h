@@ -39,9 +39,9 @@ public:
 
     void                set_size(unsigned           /*point_size*/,
                                  unsigned           /*display_dpi*/);
-    void                load_glyph(char c, unsigned f);
+    void                load_glyph(unsigned c, unsigned f);
     FT_GlyphSlot        get_glyph() const;
-    char                get_kerning(char l, char r) const;
+    int                 get_kerning(unsigned l, unsigned r) const;
     const FT_Face       get_face() const { return (_face); }
 
 protected:
@@ -6,19 +6,25 @@
 
 #include <iostream>
 #include <exception>
+#include <limits>
 #include <stdexcept>
 #include <set>
 #include <sstream>
 #include <string>
 
+#include <algorithm>
+
 #include <boost/filesystem.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/assign/std/vector.hpp>
 //#include <boost/tuple/tuple.hpp>
 
+#include <scm/core/unordered_containers.h>
+
 #include <scm/gl_core/log.h>
 #include <scm/gl_core/render_device.h>
 #include <scm/gl_core/texture_objects.h>
+#include <scm/gl_core/render_device/context_guards.h>
 
 #include <scm/gl_util/font/detail/freetype_types.h>
 
@@ -171,6 +177,406 @@ available_72dpi_size(const std::string& file_name,
 
 } // namesapce detail
 
+namespace {
+
+// copies a freetype bitmap into a cell buffer, the first cell row is the bottom row
+void
+copy_glyph_bitmap(const FT_Bitmap&           bitmap,
+                  int                        bitmap_ycomp,
+                  int                        components,
+                  const scm::math::vec2i&    offset,
+                  const scm::math::vec2ui&   cell_size,
+                  unsigned char*             cell)
+{
+    const int width = static_cast<int>(cell_size.x);
+    const int rows  = static_cast<int>(bitmap.rows);
+
+    for (int dy = 0; dy < rows; ++dy) {
+        const int ty = offset.y + rows - 1 - dy;
+        if (ty < 0 || ty >= static_cast<int>(cell_size.y)) {
+            continue;
+        }
+        unsigned char*       dst_row = cell + static_cast<size_t>(ty) * width * components;
+        const unsigned char* src_row = bitmap.buffer + dy * bitmap.pitch;
+
+        switch (bitmap.pixel_mode) {
+            case FT_PIXEL_MODE_GRAY:
+                for (int dx = 0; dx < static_cast<int>(bitmap.width); ++dx) {
+                    const int tx = offset.x + dx;
+                    if (0 <= tx && tx < width) {
+                        dst_row[tx * components] = src_row[dx];
+                    }
+                }
+                break;
+            case FT_PIXEL_MODE_LCD:
+                for (int dx = 0; dx < static_cast<int>(bitmap.width) / bitmap_ycomp; ++dx) {
+                    const int tx = offset.x + dx;
+                    if (0 <= tx && tx < width) {
+                        dst_row[tx * components    ] = src_row[dx * bitmap_ycomp];
+                        dst_row[tx * components + 1] = src_row[dx * bitmap_ycomp + 1];
+                        dst_row[tx * components + 2] = src_row[dx * bitmap_ycomp + 2];
+                    }
+                }
+                break;
+            case FT_PIXEL_MODE_MONO:
+                for (int dx = 0; dx < bitmap.pitch; ++dx) {
+                    const unsigned char src_byte = src_row[dx];
+                    for (int bx = 0; bx < 8; ++bx) {
+                        const int tx = offset.x + dx * 8 + bx;
+                        if (0 <= tx && tx < width) {
+                            for (int l = 0; l < components; ++l) {
+                                dst_row[tx * components + l] = (src_byte & (0x80 >> bx)) ? 255u : 0u;
+                            }
+                        }
+                    }
+                }
+                break;
+            default:
+                return;
+        }
+    }
+}
+
+inline scm::uint64
+pair_key(unsigned a, unsigned b)
+{
+    return (static_cast<scm::uint64>(a) << 32) | b;
+}
+
+} // namespace
+
+struct font_face::glyph_cache
+{
+    struct cached_glyph {
+        glyph_info      _info;
+        int             _slot;          // atlas cell, -1 for glyphs without pixels
+        scm::uint64     _last_use;
+    }; // struct cached_glyph
+
+    typedef scm::unordered_map<scm::uint64, cached_glyph>   glyph_map;
+    typedef scm::unordered_map<scm::uint64, int>            kerning_map;
+
+    glyph_cache(unsigned border_size)
+      : _format(FORMAT_NULL)
+      , _glyph_components(0)
+      , _glyph_bitmap_ycomp(1)
+      , _render_mode(FT_RENDER_MODE_NORMAL)
+      , _load_flags(FT_LOAD_DEFAULT)
+      , _border_size(border_size)
+      , _cell_size(0u)
+      , _layers(0)
+      , _use_count(0)
+      , _pin_use_count((std::numeric_limits<scm::uint64>::max)())
+      , _generation(0)
+      , _kerning(style_count)
+    {}
+
+    math::vec2ui        texture_size() const { return _cell_size * atlas_grid_size; }
+    math::vec2ui        cell_origin(int slot) const {
+        const unsigned c = static_cast<unsigned>(slot) % (atlas_grid_size * atlas_grid_size);
+        return math::vec2ui((c % atlas_grid_size) * _cell_size.x, (c / atlas_grid_size) * _cell_size.y);
+    }
+    unsigned            cell_layer(int slot) const { return static_cast<unsigned>(slot) / (atlas_grid_size * atlas_grid_size); }
+
+    const glyph_info&   find_glyph(unsigned c, style_type s);
+    int                 find_kerning(unsigned l, unsigned r, style_type s);
+
+    bool                rasterize(unsigned c, style_type s, glyph_info& out_glyph, bool& out_empty);
+    int                 acquire_slot();
+    bool                grow_atlas();
+    bool                upload_cell(int slot);
+
+    detail::ft_library                          _ft_lib;
+    std::vector<shared_ptr<detail::ft_face> >   _ft_faces;          // one per style, sized to the font
+
+    render_device_wptr          _render_device;
+    texture_2d_ptr              _texture_array;
+    texture_2d_ptr              _border_texture_array;
+
+    data_format                 _format;
+    int                         _glyph_components;
+    int                         _glyph_bitmap_ycomp;
+    FT_Render_Mode              _render_mode;
+    unsigned                    _load_flags;
+    unsigned                    _border_size;
+
+    math::vec2ui                _cell_size;
+    unsigned                    _layers;
+    std::vector<unsigned char>  _cell_core;
+    std::vector<unsigned char>  _cell_border;
+
+    glyph_map                   _glyphs;
+    std::vector<scm::uint64>    _slot_owners;       // glyph key of each used cell
+    std::vector<scm::uint64>    _slot_last_use;
+    std::vector<int>            _free_slots;
+    scm::uint64                 _use_count;
+    scm::uint64                 _pin_use_count;     // cells used at or after this are not evicted
+    unsigned                    _generation;
+
+    std::vector<kerning_map>    _kerning;
+}; // struct font_face::glyph_cache
+
+const font_face::glyph_info&
+font_face::glyph_cache::find_glyph(unsigned c, style_type s)
+{
+    const scm::uint64 key = pair_key(s, c);
+    ++_use_count;
+
+    glyph_map::iterator g = _glyphs.find(key);
+    if (g != _glyphs.end()) {
+        g->second._last_use = _use_count;
+        if (g->second._slot >= 0) {
+            _slot_last_use[g->second._slot] = _use_count;
+        }
+        return g->second._info;
+    }
+
+    cached_glyph new_glyph;
+    bool         empty = true;
+
+    new_glyph._slot     = -1;
+    new_glyph._last_use = _use_count;
+
+    try {
+        if (!rasterize(c, s, new_glyph._info, empty)) {
+            empty = true;
+        }
+    }
+    catch (const std::exception& e) {
+        // keep the empty glyph, the error is not reported again
+        glerr() << log::error << "font_face::glyph(): " << e.what() << log::end;
+        new_glyph._info = glyph_info();
+        empty           = true;
+    }
+
+    if (!empty) {
+        new_glyph._slot = acquire_slot();
+        if (new_glyph._slot >= 0) {
+            const math::vec2ui o = cell_origin(new_glyph._slot);
+            const math::vec2ui t = texture_size();
+
+            new_glyph._info._texture_origin   = math::vec2f(static_cast<float>(o.x) / t.x,
+                                                            static_cast<float>(o.y) / t.y);
+            new_glyph._info._texture_box_size = math::vec2f(static_cast<float>(new_glyph._info._box_size.x) / t.x,
+                                                            static_cast<float>(new_glyph._info._box_size.y) / t.y);
+            new_glyph._info._texture_layer    = cell_layer(new_glyph._slot);
+
+            _slot_owners[new_glyph._slot]   = key;
+            _slot_last_use[new_glyph._slot] = _use_count;
+
+            if (!upload_cell(new_glyph._slot)) {
+                glerr() << log::error << "font_face::glyph(): unable to upload glyph (code point: " << c << ")." << log::end;
+            }
+        }
+        else {
+            glerr() << log::error << "font_face::glyph(): unable to allocate atlas cell, all cells are pinned "
+                    << "(code point: " << c << ")." << log::end;
+            new_glyph._info._box_size = math::vec2i::zero();
+        }
+    }
+
+    return _glyphs.insert(glyph_map::value_type(key, new_glyph)).first->second._info;
+}
+
+int
+font_face::glyph_cache::find_kerning(unsigned l, unsigned r, style_type s)
+{
+    const scm::uint64     key = pair_key(l, r);
+    kerning_map::iterator k   = _kerning[s].find(key);
+
+    if (k == _kerning[s].end()) {
+        k = _kerning[s].insert(kerning_map::value_type(key, _ft_faces[s]->get_kerning(l, r))).first;
+    }
+    return k->second;
+}
+
+bool
+font_face::glyph_cache::rasterize(unsigned c, style_type s, glyph_info& out_glyph, bool& out_empty)
+{
+    using namespace scm::math;
+
+    detail::ft_face& ft_font = *_ft_faces[s];
+
+    std::fill(_cell_core.begin(),   _cell_core.end(),   0u);
+    std::fill(_cell_border.begin(), _cell_border.end(), 0u);
+    out_empty = true;
+
+    if (_border_size > 0) { // border
+        FT_Glyph    ft_glyph;
+        FT_Error    ft_err;
+
+        ft_font.load_glyph(c, _load_flags);
+        {
+            detail::ft_stroker stroker(_ft_lib, _border_size);
+
+            ft_err = FT_Get_Glyph(ft_font.get_glyph(), &ft_glyph);
+            if (ft_err) {
+                throw std::runtime_error("font_face::glyph(): error during FT_Get_Glyph");
+            }
+            ft_err = FT_Glyph_Stroke(&ft_glyph, stroker.get_stroker(), true);
+            if (ft_err) {
+                FT_Done_Glyph(ft_glyph);
+                throw std::runtime_error("font_face::glyph(): error during FT_Glyph_Stroke");
+            }
+            ft_err = FT_Glyph_To_Bitmap(&ft_glyph, _render_mode, 0, true);
+            if (ft_err) {
+                FT_Done_Glyph(ft_glyph);
+                throw std::runtime_error("font_face::glyph(): error during FT_Glyph_To_Bitmap");
+            }
+        }
+        FT_BitmapGlyph   ft_bitmap_glyph = (FT_BitmapGlyph)ft_glyph;
+        const FT_Bitmap& bitmap          = ft_bitmap_glyph->bitmap;
+
+        out_glyph._box_size         = vec2i(bitmap.width / _glyph_bitmap_ycomp, bitmap.rows);
+        out_glyph._border_bearing   = vec2i(ft_bitmap_glyph->left, ft_bitmap_glyph->top - bitmap.rows);
+
+        copy_glyph_bitmap(bitmap, _glyph_bitmap_ycomp, _glyph_components, vec2i(0), _cell_size, &_cell_border.front());
+
+        out_empty = out_empty && (bitmap.rows == 0 || bitmap.width == 0);
+        FT_Done_Glyph(ft_glyph);
+    }
+
+    { // core
+        ft_font.load_glyph(c, _load_flags);
+        if (FT_Render_Glyph(ft_font.get_glyph(), _render_mode)) {
+            return false;
+        }
+        const FT_Bitmap& bitmap = ft_font.get_face()->glyph->bitmap;
+
+        vec2i cur_core_box   = vec2i(bitmap.width / _glyph_bitmap_ycomp, bitmap.rows);
+        vec2i cur_bm_bearing = vec2i(ft_font.get_face()->glyph->bitmap_left, ft_font.get_face()->glyph->bitmap_top - bitmap.rows);
+        vec2i box_diff       = vec2i::zero();
+        if (_border_size > 0) {
+            box_diff.x = max(0, cur_bm_bearing.x - out_glyph._border_bearing.x);
+            box_diff.y = max(0, cur_bm_bearing.y - out_glyph._border_bearing.y);
+        }
+        out_glyph._box_size.x = max(out_glyph._box_size.x, cur_core_box.x);
+        out_glyph._box_size.y = max(out_glyph._box_size.y, cur_core_box.y);
+
+        if (ft_font.get_face()->face_flags & FT_FACE_FLAG_SCALABLE) {
+            // linearHoriAdvance contains the 16.16 representation of the horizontal advance
+            // horiAdvance contains only the rounded advance which can be off by 1 and
+            // lead to sub styles beeing rendered to narrow
+            out_glyph._advance      =  FT_CeilFix(ft_font.get_face()->glyph->linearHoriAdvance) >> 16;
+        }
+        else if (ft_font.get_face()->face_flags & FT_FACE_FLAG_FIXED_SIZES) {
+            out_glyph._advance      = ft_font.get_face()->glyph->metrics.horiAdvance >> 6;
+        }
+        out_glyph._bearing          = cur_bm_bearing - box_diff;
+
+        copy_glyph_bitmap(bitmap, _glyph_bitmap_ycomp, _glyph_components, box_diff, _cell_size, &_cell_core.front());
+
+        out_empty = out_empty && (bitmap.rows == 0 || bitmap.width == 0);
+    }
+
+    return true;
+}
+
+int
+font_face::glyph_cache::acquire_slot()
+{
+    if (_free_slots.empty() && _layers < atlas_max_layers) {
+        grow_atlas();
+    }
+    if (!_free_slots.empty()) {
+        const int slot = _free_slots.back();
+        _free_slots.pop_back();
+        return slot;
+    }
+
+    // evict the least recently used glyph that is not pinned
+    int slot = -1;
+    for (std::size_t c = 0; c < _slot_last_use.size(); ++c) {
+        if (   _slot_last_use[c] < _pin_use_count
+            && (slot < 0 || _slot_last_use[c] < _slot_last_use[slot])) {
+            slot = static_cast<int>(c);
+        }
+    }
+    if (slot < 0) {
+        return -1;
+    }
+
+    _glyphs.erase(_slot_owners[slot]);
+    ++_generation;
+
+    return slot;
+}
+
+bool
+font_face::glyph_cache::grow_atlas()
+{
+    using namespace scm::math;
+
+    render_device_ptr device = _render_device.lock();
+    if (!device) {
+        glerr() << log::error << "font_face::grow_atlas(): invalid render device." << log::end;
+        return false;
+    }
+
+    const vec2ui        tex_size    = texture_size();
+    const unsigned      new_layers  = _layers + 1;
+    const scm::size_t   layer_bytes = static_cast<scm::size_t>(tex_size.x) * tex_size.y * size_of_format(_format);
+
+    // the existing layers are read back once, the atlas only grows when all cells are used
+    std::vector<unsigned char> atlas_data(layer_bytes * new_layers, 0u);
+    std::vector<void*>         atlas_data_raw(1, &atlas_data.front());
+
+    texture_2d_ptr* atlases[2] = { &_texture_array, &_border_texture_array };
+    for (int a = 0; a < (_border_size > 0 ? 2 : 1); ++a) {
+        if (*atlases[a]) {
+            if (!device->main_context()->retrieve_texture_data(*atlases[a], 0, &atlas_data.front())) {
+                glerr() << log::error << "font_face::grow_atlas(): unable to read back glyph atlas." << log::end;
+                return false;
+            }
+        }
+        texture_2d_ptr new_atlas = device->create_texture_2d(tex_size, _format, 1, new_layers, 1,
+                                                             _format, atlas_data_raw);
+        if (!new_atlas) {
+            glerr() << log::error << "font_face::grow_atlas(): unable to create glyph atlas "
+                    << "(size: " << tex_size << ", layers: " << new_layers << ")." << log::end;
+            return false;
+        }
+        *atlases[a] = new_atlas;
+        std::fill(atlas_data.begin(), atlas_data.end(), 0u);
+    }
+
+    const int cells_per_layer = static_cast<int>(atlas_grid_size * atlas_grid_size);
+    _slot_owners.resize(new_layers * cells_per_layer, 0);
+    _slot_last_use.resize(new_layers * cells_per_layer, 0);
+    // lowest cells are handed out first
+    for (int c = cells_per_layer - 1; c >= 0; --c) {
+        _free_slots.push_back(_layers * cells_per_layer + c);
+    }
+    _layers = new_layers;
+
+    return true;
+}
+
+bool
+font_face::glyph_cache::upload_cell(int slot)
+{
+    render_device_ptr device = _render_device.lock();
+    if (!device) {
+        return false;
+    }
+    render_context_ptr          context = device->main_context();
+    context_unpack_buffer_guard upg(context);
+
+    const texture_region r(math::vec3ui(cell_origin(slot), cell_layer(slot)), math::vec3ui(_cell_size, 1u));
+
+    context->bind_unpack_buffer(buffer_ptr());
+    if (!context->update_sub_texture(_texture_array, r, 0, _format, &_cell_core.front())) {
+        return false;
+    }
+    if (_border_size > 0) {
+        if (!context->update_sub_texture(_border_texture_array, r, 0, _format, &_cell_border.front())) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 font_face::font_face(const render_device_ptr& device,
                      const std::string&       font_file,
                      unsigned                 point_size,
@@ -188,8 +594,8 @@ font_face::font_face(const render_device_ptr& device,
     using namespace scm::math;
 
     try {
-
-        detail::ft_library  ft_lib;
+        _glyph_cache.reset(new glyph_cache(_border_size));
+        _glyph_cache->_render_device = device;
 
         if (!detail::check_file(font_file)) {
             std::ostringstream s;
@@ -213,25 +619,17 @@ font_face::font_face(const render_device_ptr& device,
         std::vector<std::string>    font_style_files;
         detail::find_font_style_files(font_file, font_style_files);
 
-        // fill font styles
+        // fill font styles, the faces stay open for the lazy glyph rasterization
         math::vec2ui max_glyph_size(0u, 0u); // to store the maximal glyph size over all styles
         for (int i = 0; i < style_count; ++i) {
             _font_styles_available[i] = !font_style_files[i].empty();
 
-            std::string         cur_font_file = _font_styles_available[i] ? font_style_files[i] : font_style_files[0];
-            detail::ft_face     ft_font(ft_lib, cur_font_file);
+            std::string                 cur_font_file = _font_styles_available[i] ? font_style_files[i] : font_style_files[0];
+            shared_ptr<detail::ft_face> ft_font_ptr(new detail::ft_face(_glyph_cache->_ft_lib, cur_font_file));
+            detail::ft_face&            ft_font = *ft_font_ptr;
 
             ft_font.set_size(font_size, display_dpi);
-
-            // calculate kerning information
-            _font_styles[i]._kerning_table.resize(boost::extents[max_char][max_char]);
-            for (unsigned l = min_char; l < max_char; ++l) {
-                for (unsigned r = min_char; r < max_char; ++r) {
-                    //if (l == 'T' && r == 'e')
-                    //    std::cout << "kerning: " << int(ft_font.get_kerning(l, r)) << std::endl;
-                    _font_styles[i]._kerning_table[l][r] = ft_font.get_kerning(l, r);
-                }
-            }
+            _glyph_cache->_ft_faces.push_back(ft_font_ptr);
 
             // retrieve the maximal bounding box of all glyphs in the face
             vec2f  font_bbox_x;
@@ -276,25 +674,20 @@ font_face::font_face(const render_device_ptr& device,
         }
         // end fill font styles
 
-        // generate texture image
-        int             glyph_components     = 0;
-        int             glyph_bitmap_ycomp   = 1;
-        FT_Render_Mode  glyph_render_mode    = FT_RENDER_MODE_NORMAL;
-        unsigned        glyph_load_flags     = FT_LOAD_DEFAULT;
-        data_format     glyph_texture_format = FORMAT_NULL;
+        glyph_cache& gc = *_glyph_cache;
 
         switch (smooth_type) {
-            case smooth_normal: glyph_components     = 2;
-                                glyph_render_mode    = FT_RENDER_MODE_NORMAL; //FT_RENDER_MODE_LIGHT; //
-                                glyph_load_flags     = FT_LOAD_DEFAULT; //FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT; //
-                                glyph_texture_format = FORMAT_RG_8;
+            case smooth_normal: gc._glyph_components     = 2;
+                                gc._render_mode          = FT_RENDER_MODE_NORMAL; //FT_RENDER_MODE_LIGHT; //
+                                gc._load_flags           = FT_LOAD_DEFAULT; //FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT; //
+                                gc._format               = FORMAT_RG_8;
                                 break;
-            case smooth_lcd:    glyph_components     = 3;
-                                glyph_bitmap_ycomp   = 3;
-                                glyph_render_mode    = FT_RENDER_MODE_LCD;
-                                glyph_load_flags     = FT_LOAD_TARGET_LCD;//FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT;
-                                glyph_texture_format = FORMAT_RGB_8;
-                                FT_Library_SetLcdFilter(ft_lib.get_lib(), FT_LCD_FILTER_LIGHT);
+            case smooth_lcd:    gc._glyph_components     = 3;
+                                gc._glyph_bitmap_ycomp   = 3;
+                                gc._render_mode          = FT_RENDER_MODE_LCD;
+                                gc._load_flags           = FT_LOAD_TARGET_LCD;//FT_LOAD_FORCE_AUTOHINT | FT_LOAD_TARGET_LIGHT;
+                                gc._format               = FORMAT_RGB_8;
+                                FT_Library_SetLcdFilter(gc._ft_lib.get_lib(), FT_LCD_FILTER_LIGHT);
                                 break;
             default:
                 std::ostringstream s;
@@ -302,295 +695,33 @@ font_face::font_face(const render_device_ptr& device,
                 throw(std::runtime_error(s.str()));
         }
 
-
-        for (int i = 0; i < style_count; ++i) {
-            _font_styles[i]._glyphs.resize(max_char);
-        }
-
-        //typedef vec<unsigned char, 2> glyph_texel; // 2 components (core, border... TO BE DONE!, currently only first used)
         max_glyph_size += math::vec2ui(1u) + 2 * (_border_size >> 6); // space of at least one texel around all glyphs
 
-        int                           grid_size = static_cast<int>(ceil(math::sqrt(static_cast<double>(max_char - min_char))));
-        vec3ui                        glyph_texture_dim  = vec3ui(max_glyph_size * grid_size, style_count); // a 16x16 grid of 256 glyphs in 4 layers
-        size_t                        glyph_texture_size = static_cast<size_t>(glyph_texture_dim.x) * glyph_texture_dim.y * glyph_texture_dim.z;
-        scoped_array<unsigned char>   glyph_texture(new unsigned char[glyph_texture_size * glyph_components]);
-
-        if (_border_size > 0) { // border
-            memset(glyph_texture.get(), 0u, glyph_texture_size * glyph_components); // clear to black
-
-            for (int i = 0; i < style_count; ++i) {
-                std::string cur_font_file = _font_styles_available[i] ? font_style_files[i] : font_style_files[0];
-
-                detail::ft_face     ft_font(ft_lib, cur_font_file);
-                ft_font.set_size(font_size, display_dpi);
-                FT_Bitmap           bitmap;
-
-                for (unsigned c = min_char; c < max_char; ++c) {
-                    glyph_info& cur_glyph = _font_styles[i]._glyphs[c];
-                    FT_Glyph    ft_glyph;
-
-                    ft_font.load_glyph(c, glyph_load_flags);
-                    {
-                        detail::ft_stroker stroker(ft_lib, _border_size);
-                        FT_Error ft_err;
-
-                        ft_err = FT_Get_Glyph(ft_font.get_glyph(), &ft_glyph);
-                        if (ft_err) {
-                            throw std::runtime_error("font_face::font_face(): error during FT_Get_Glyph");
-                        }
-                        ft_err = FT_Glyph_Stroke(&ft_glyph, stroker.get_stroker(), true);
-                        if (ft_err) {
-                            throw std::runtime_error("font_face::font_face(): error during FT_Glyph_Stroke");
-                        }
-                        ft_err = FT_Glyph_To_Bitmap(&ft_glyph, glyph_render_mode, 0, true);
-                        if (ft_err) {
-                            throw std::runtime_error("font_face::font_face(): error during FT_Glyph_To_Bitmap");
-                        }
-                        FT_BitmapGlyph ft_bitmap_glyph = (FT_BitmapGlyph)ft_glyph;
-                        bitmap = ft_bitmap_glyph->bitmap;
-                    }
-
-                    // calculate the glyphs grid position in the font texture array
-                    vec3ui tex_array_dst;
-                    tex_array_dst.x = ((c - min_char) % grid_size) * max_glyph_size.x;
-                    tex_array_dst.y = glyph_texture_dim.y - (((c - min_char) / grid_size) + 1) * max_glyph_size.y;
-                    //tex_array_dst.x = (c & 0x0F) * max_glyph_size.x;
-                    //tex_array_dst.y = glyph_texture_dim.y - ((c >> 4) + 1) * max_glyph_size.y;
-                    tex_array_dst.z = i;
-
-                    FT_BitmapGlyph ft_bitmap_glyph = (FT_BitmapGlyph)ft_glyph;
-                    cur_glyph._box_size         = vec2i(bitmap.width / glyph_bitmap_ycomp, bitmap.rows);
-                    cur_glyph._border_bearing   = vec2i(ft_bitmap_glyph->left, ft_bitmap_glyph->top - ft_bitmap_glyph->bitmap.rows);
-                    cur_glyph._texture_origin   = vec2f(static_cast<float>(tex_array_dst.x) / glyph_texture_dim.x,
-                                                        static_cast<float>(tex_array_dst.y) / glyph_texture_dim.y);
-                    cur_glyph._texture_box_size = vec2f(static_cast<float>(cur_glyph._box_size.x) / glyph_texture_dim.x,
-                                                        static_cast<float>(cur_glyph._box_size.y) / glyph_texture_dim.y);
-
-                    if (ft_font.get_face()->face_flags & FT_FACE_FLAG_SCALABLE) {
-                        // linearHoriAdvance contains the 16.16 representation of the horizontal advance
-                        // horiAdvance contains only the rounded advance which can be off by 1 and
-                        // lead to sub styles beeing rendered to narrow
-                        cur_glyph._advance          =  FT_CeilFix(ft_font.get_face()->glyph->linearHoriAdvance) >> 16;
-                    }
-                    else if (ft_font.get_face()->face_flags & FT_FACE_FLAG_FIXED_SIZES) {
-                        cur_glyph._advance          = ft_font.get_face()->glyph->metrics.horiAdvance >> 6;
-                    }
-                    cur_glyph._bearing          = vec2i(   ft_font.get_face()->glyph->metrics.horiBearingX >> 6,
-                                                          (ft_font.get_face()->glyph->metrics.horiBearingY >> 6)
-                                                        - (ft_font.get_face()->glyph->metrics.height >> 6));
-                    FT_Face ff = ft_font.get_face();
-                    int ksks = ft_font.get_face()->glyph->lsb_delta;
-                    int ksds = ft_font.get_face()->glyph->rsb_delta;
-
-                    // fill texture
-                    switch (bitmap.pixel_mode) {
-                        case FT_PIXEL_MODE_GRAY:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                unsigned src_off = dy * bitmap.pitch;
-                                unsigned dst_off =    tex_array_dst.x
-                                                   + (tex_array_dst.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                   + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                for (unsigned dx = 0; dx < bitmap.width; ++dx) {
-                                    glyph_texture[(dst_off + dx) * glyph_components] = bitmap.buffer[src_off + dx];
-                                }
-                            }
-                            break;
-                        case FT_PIXEL_MODE_LCD:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                unsigned src_off = dy * bitmap.pitch;
-                                unsigned dst_off =    tex_array_dst.x
-                                                   + (tex_array_dst.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                   + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                for (unsigned dx = 0; dx < bitmap.width / glyph_bitmap_ycomp; ++dx) {
-                                    glyph_texture[(dst_off + dx) * glyph_components    ] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp];
-                                    glyph_texture[(dst_off + dx) * glyph_components + 1] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp + 1];
-                                    glyph_texture[(dst_off + dx) * glyph_components + 2] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp + 2];
-                                }
-                            }
-                            break;
-                        case FT_PIXEL_MODE_MONO:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                for (int dx = 0; dx < bitmap.pitch; ++dx) {
-                                    unsigned        src_off     = dx + dy * bitmap.pitch;
-                                    unsigned char   src_byte    = bitmap.buffer[src_off];
-                                    for (int bx = 0; bx < 8; ++bx) {
-                                        unsigned        dst_off =   (tex_array_dst.x + dx * 8 + bx)
-                                                                  + (tex_array_dst.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                                  + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                        unsigned char   src_set = src_byte & (0x80 >> bx);
-                                        unsigned char*  plah    = &src_byte;
-                                        for (int l = 0; l < glyph_components; ++l) {
-                                            glyph_texture[dst_off * glyph_components + l] = src_set ? 255u : 0u;
-                                        }
-                                    }
-                                }
-                            }
-                            break;
-                        default:
-                            continue;
-                    }
-                    FT_Done_Glyph(ft_glyph);
-                }
-            }
-            // end generate texture image
-            std::vector<void*> image_array_data_raw;
-            image_array_data_raw.push_back(glyph_texture.get());
-
-            _font_styles_border_texture_array = device->create_texture_2d(vec2ui(glyph_texture_dim.x, glyph_texture_dim.y),
-                                                                   glyph_texture_format, 1, glyph_texture_dim.z, 1,
-                                                                   glyph_texture_format, image_array_data_raw);
-
-            if (!_font_styles_border_texture_array) {
-                std::ostringstream s;
-                s << "font_face::font_face(): unable to create texture object (border).";
-                throw(std::runtime_error(s.str()));
-            }
-
-            image_array_data_raw.clear();
+        gc._cell_size = max_glyph_size;
+        gc._cell_core.resize(static_cast<size_t>(max_glyph_size.x) * max_glyph_size.y * gc._glyph_components);
+        if (_border_size > 0) {
+            gc._cell_border.resize(gc._cell_core.size());
         }
-        // TODO the bearing and box is not wrong!!! FIXME
-        { // core
-            memset(glyph_texture.get(), 0u, glyph_texture_size * glyph_components); // clear to black
-
-            for (int i = 0; i < style_count; ++i) {
-                std::string cur_font_file = _font_styles_available[i] ? font_style_files[i] : font_style_files[0];
-
-                detail::ft_face     ft_font(ft_lib, cur_font_file);
-                ft_font.set_size(font_size, display_dpi);
-                FT_Bitmap           bitmap;
-
-                for (unsigned c = min_char; c < max_char; ++c) {
-                    glyph_info&      cur_glyph = _font_styles[i]._glyphs[c];
-
-                    ft_font.load_glyph(c, glyph_load_flags);
-                    if (FT_Render_Glyph(ft_font.get_glyph(), glyph_render_mode)) {
-                        //glout() << static_cast<char>(c) << " afafaf";
-                        continue;
-                    }
-                    bitmap = ft_font.get_face()->glyph->bitmap;
-
-                    // calculate the glyphs grid position in the font texture array
-                    vec3ui tex_array_dst;
-                    tex_array_dst.x = ((c - min_char) % grid_size) * max_glyph_size.x;
-                    tex_array_dst.y = glyph_texture_dim.y - (((c - min_char) / grid_size) + 1) * max_glyph_size.y;
-                    //tex_array_dst.x = (c & 0x0F) * max_glyph_size.x;
-                    //tex_array_dst.y = glyph_texture_dim.y - ((c >> 4) + 1) * max_glyph_size.y;
-                    tex_array_dst.z = i;
-
-                    vec2i cur_core_box = vec2i(bitmap.width / glyph_bitmap_ycomp, bitmap.rows);
-                    vec2i cur_bm_bearing = vec2i(ft_font.get_face()->glyph->bitmap_left, ft_font.get_face()->glyph->bitmap_top - ft_font.get_face()->glyph->bitmap.rows);
-                    vec2i box_diff = vec2i::zero();
-                    if (_border_size > 0) {
-                        box_diff.x = max(0, cur_bm_bearing.x - cur_glyph._border_bearing.x);
-                        box_diff.y = max(0, cur_bm_bearing.y - cur_glyph._border_bearing.y);
-                    }
-                    cur_glyph._box_size.x = max(cur_glyph._box_size.x, cur_core_box.x);
-                    cur_glyph._box_size.y = max(cur_glyph._box_size.y, cur_core_box.y);
-
-                    cur_glyph._texture_origin   = vec2f(static_cast<float>(tex_array_dst.x) / glyph_texture_dim.x,
-                                                        static_cast<float>(tex_array_dst.y) / glyph_texture_dim.y);
-                    cur_glyph._texture_box_size = vec2f(static_cast<float>(cur_glyph._box_size.x) / glyph_texture_dim.x,
-                                                        static_cast<float>(cur_glyph._box_size.y) / glyph_texture_dim.y);
-
-                    if (ft_font.get_face()->face_flags & FT_FACE_FLAG_SCALABLE) {
-                        // linearHoriAdvance contains the 16.16 representation of the horizontal advance
-                        // horiAdvance contains only the rounded advance which can be off by 1 and
-                        // lead to sub styles beeing rendered to narrow
-                        cur_glyph._advance          =  FT_CeilFix(ft_font.get_face()->glyph->linearHoriAdvance) >> 16;
-                    }
-                    else if (ft_font.get_face()->face_flags & FT_FACE_FLAG_FIXED_SIZES) {
-                        cur_glyph._advance          = ft_font.get_face()->glyph->metrics.horiAdvance >> 6;
-                    }
-                    cur_glyph._bearing          = //vec2i(   ft_font.get_face()->glyph->metrics.horiBearingX >> 6,
-                                                  //        (ft_font.get_face()->glyph->metrics.horiBearingY >> 6)
-                                                  //      - (ft_font.get_face()->glyph->metrics.height >> 6))
-                                                    cur_bm_bearing
-                                                  - box_diff;
-                                                  //+ cur_glyph._border_bearing;
-                    // fill texture
-                    switch (bitmap.pixel_mode) {
-                        case FT_PIXEL_MODE_GRAY:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                unsigned src_off = dy * bitmap.pitch;
-                                unsigned dst_off =    tex_array_dst.x + box_diff.x
-                                                   + (tex_array_dst.y + box_diff.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                   + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                for (unsigned dx = 0; dx < bitmap.width; ++dx) {
-                                    glyph_texture[(dst_off + dx) * glyph_components] = bitmap.buffer[src_off + dx];
-                                }
-                            }
-                            break;
-                        case FT_PIXEL_MODE_LCD:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                unsigned src_off = dy * bitmap.pitch;
-                                unsigned dst_off =    tex_array_dst.x + box_diff.x
-                                                   + (tex_array_dst.y + box_diff.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                   + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                for (unsigned dx = 0; dx < bitmap.width / glyph_bitmap_ycomp; ++dx) {
-                                    glyph_texture[(dst_off + dx) * glyph_components    ] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp];
-                                    glyph_texture[(dst_off + dx) * glyph_components + 1] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp + 1];
-                                    glyph_texture[(dst_off + dx) * glyph_components + 2] = bitmap.buffer[src_off + dx * glyph_bitmap_ycomp + 2];
-                                }
-                            }
-                            break;
-                        case FT_PIXEL_MODE_MONO:
-                            for (unsigned dy = 0; dy < bitmap.rows; ++dy) {
-                                for (int dx = 0; dx < bitmap.pitch; ++dx) {
-                                    unsigned        src_off     = dx + dy * bitmap.pitch;
-                                    unsigned char   src_byte    = bitmap.buffer[src_off];
-                                    for (int bx = 0; bx < 8; ++bx) {
-                                        unsigned        dst_off =   (tex_array_dst.x + box_diff.x + dx * 8 + bx)
-                                                                  + (tex_array_dst.y + box_diff.y + bitmap.rows - 1 - dy) * glyph_texture_dim.x
-                                                                  + i * (glyph_texture_dim.x * glyph_texture_dim.y);
-                                        unsigned char   src_set = src_byte & (0x80 >> bx);
-                                        unsigned char*  plah    = &src_byte;
-                                        for (int l = 0; l < glyph_components; ++l) {
-                                            glyph_texture[dst_off * glyph_components + l] = src_set ? 255u : 0u;
-                                        }
-                                    }
-                                }
-                            }
-                            break;
-                        default:
-                            continue;
-                    }
-                }
-            }
-            // end generate texture image
-            std::vector<void*> image_array_data_raw;
-            image_array_data_raw.push_back(glyph_texture.get());
-
-            _font_styles_texture_array = device->create_texture_2d(vec2ui(glyph_texture_dim.x, glyph_texture_dim.y),
-                                                                   glyph_texture_format, 1, glyph_texture_dim.z, 1,
-                                                                   glyph_texture_format, image_array_data_raw);
-
-            if (!_font_styles_texture_array) {
-                std::ostringstream s;
-                s << "font_face::font_face(): unable to create texture object.";
-                throw(std::runtime_error(s.str()));
-            }
 
-            image_array_data_raw.clear();
+        // only the first atlas layer is created, no glyphs are rasterized yet
+        if (!gc.grow_atlas()) {
+            std::ostringstream s;
+            s << "font_face::font_face(): unable to create glyph atlas texture.";
+            throw(std::runtime_error(s.str()));
         }
 
-        glyph_texture.reset();
-
+        const vec2ui atlas_size = gc.texture_size();
         std::stringstream os;
         os << std::fixed << std::setprecision(2)
            << "font_face::font_face(): " << std::endl
-           << " - created font textures for font '" << font_file << "' "
+           << " - created glyph atlas for font '" << font_file << "' "
            << "(point size: " << point_size << ", border size: " << border_size << ")" << std::endl
-           << "   - style texture:  format " << gl::format_string(glyph_texture_format)
-                << ", size " <<      glyph_texture_dim
-                << ", glyph box " << max_glyph_size
-                << ", memory " <<      static_cast<double>(glyph_texture_dim.x * glyph_texture_dim.y * glyph_texture_dim.z * size_of_format(glyph_texture_format)) / 1024.0 << "KiB";
-        if (_border_size > 0) {
-            os << std::endl
-               << "   - border texture: format " << gl::format_string(glyph_texture_format)
-               << ", size " <<      glyph_texture_dim
-               << ", glyph box " << max_glyph_size
-               << ", memory " <<      static_cast<double>(glyph_texture_dim.x * glyph_texture_dim.y * glyph_texture_dim.z * size_of_format(glyph_texture_format)) / 1024.0 << "KiB";
-        }
+           << "   - atlas layer: format " << gl::format_string(gc._format)
+                << ", size " <<      atlas_size
+                << ", glyph cell " << max_glyph_size
+                << ", memory " <<      static_cast<double>(atlas_size.x * atlas_size.y * size_of_format(gc._format)) / 1024.0 << "KiB"
+                << (_border_size > 0 ? " (x2 border)" : "")
+                << ", max. layers " << atlas_max_layers;
         glout() << log::info << os.str();
 
         using namespace boost::filesystem;
@@ -647,9 +778,9 @@ font_face::has_style(style_type s) const
 }
 
 const font_face::glyph_info&
-font_face::glyph(char c, style_type s) const
+font_face::glyph(unsigned c, style_type s) const
 {
-    return (_font_styles[s]._glyphs[c]);
+    return (_glyph_cache->find_glyph(c, s));
 }
 
 unsigned
@@ -659,9 +790,9 @@ font_face::line_advance(style_type s) const
 }
 
 int
-font_face::kerning(char l, char r, style_type s) const
+font_face::kerning(unsigned l, unsigned r, style_type s) const
 {
-    return (_font_styles[s]._kerning_table[l][r]);
+    return (_glyph_cache->find_kerning(l, r, s));
 }
 
 int
@@ -681,19 +812,49 @@ font_face::cleanup()
 {
     _font_styles.clear();
     _font_styles_available.clear();
-    _font_styles_texture_array.reset();
+    _glyph_cache.reset();
 }
 
 const texture_2d_ptr&
 font_face::styles_texture_array() const
 {
-    return (_font_styles_texture_array);
+    return (_glyph_cache->_texture_array);
 }
 
 const texture_2d_ptr&
 font_face::styles_border_texture_array() const
 {
-    return (_font_styles_border_texture_array);
+    return (_glyph_cache->_border_texture_array);
+}
+
+void
+font_face::pin_glyphs() const
+{
+    _glyph_cache->_pin_use_count = _glyph_cache->_use_count + 1;
+}
+
+void
+font_face::unpin_glyphs() const
+{
+    _glyph_cache->_pin_use_count = (std::numeric_limits<scm::uint64>::max)();
+}
+
+unsigned
+font_face::atlas_generation() const
+{
+    return (_glyph_cache->_generation);
+}
+
+unsigned
+font_face::atlas_layers() const
+{
+    return (_glyph_cache->_layers);
+}
+
+unsigned
+font_face::cached_glyph_count() const
+{
+    return (static_cast<unsigned>(_glyph_cache->_glyphs.size()));
 }
 
 } // namespace gl
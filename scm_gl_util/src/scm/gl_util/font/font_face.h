@@ -10,9 +10,8 @@
 #include <string>
 #include <vector>
 
-#include <boost/multi_array.hpp>
-
 #include <scm/core/math.h>
+#include <scm/core/memory.h>
 
 #include <scm/gl_core/gl_core_fwd.h>
 
@@ -24,6 +23,18 @@
 namespace scm {
 namespace gl {
 
+// font face with a dynamic glyph atlas
+//  - glyphs of any unicode code point are rasterized on first use and packed
+//    into the cells of one texture array shared by all styles (and a second
+//    array with the same layout for the borders)
+//  - the atlas starts with a single layer of atlas_grid_size^2 cells and grows
+//    up to atlas_max_layers layers, after that the least recently used glyphs
+//    are evicted. evictions change atlas_generation(), vertex data referencing
+//    the atlas has to be rebuilt then (text_renderer does this for text objects)
+//  - glyphs looked up between pin_glyphs() and unpin_glyphs() are not evicted
+//    until the pin is released (used while building the vertex data of one
+//    text), if no unpinned cell is left the glyph is not drawn
+//  - kerning pairs are queried on first use and cached
 class __scm_export(gl_util) font_face
 {
 public:
@@ -44,6 +55,7 @@ public:
     struct glyph_info {
         math::vec2f    _texture_origin;
         math::vec2f    _texture_box_size;
+        unsigned       _texture_layer;
 
         math::vec2i    _box_size;
         math::vec2i    _border_bearing;
@@ -53,6 +65,7 @@ public:
         glyph_info()
           : _texture_origin(math::vec2f::zero())
           , _texture_box_size(math::vec2f::zero())
+          , _texture_layer(0)
           , _box_size(math::vec2i::zero())
           , _border_bearing(math::vec2i::zero())
           , _advance(0)
@@ -61,8 +74,10 @@ public:
         }
     }; // struct glyph_info
 
-    static const unsigned       min_char = 32u;
-    static const unsigned       max_char = 128u;
+    static const unsigned       min_char = 32u;         // smaller code points are control characters
+
+    static const unsigned       atlas_grid_size  = 16u; // cells per atlas layer row
+    static const unsigned       atlas_max_layers = 8u;
 
     static const unsigned       default_point_size   = 12;
     //static const float          default_border_size  = 0.0f;
@@ -70,17 +85,15 @@ public:
     static const smooth_type    default_smooth_style = smooth_normal;
 
 protected:
-    typedef std::vector<glyph_info>     glyph_container;
-    typedef boost::multi_array<char, 2> kerning_table;
     struct font_style {
-        glyph_container _glyphs;
-        kerning_table   _kerning_table;
         int             _underline_position;
         unsigned        _underline_thickness;
         unsigned        _line_spacing;
     }; // struct style_info
     typedef std::vector<font_style>     style_container;
 
+    struct glyph_cache;
+
 public:
     font_face(const render_device_ptr& device,                  
               const std::string&       font_file,
@@ -97,9 +110,11 @@ public:
     smooth_type                     smooth_style() const;
     bool                            has_style(style_type s) const;
 
-    const glyph_info&               glyph(char c, style_type s = style_regular) const;
+    // rasterizes the glyph if it is not in the atlas, the reference is only
+    // valid until the next glyph lookup
+    const glyph_info&               glyph(unsigned c, style_type s = style_regular) const;
     unsigned                        line_advance(style_type s = style_regular) const;
-    int                             kerning(char l, char r, style_type s = style_regular) const;
+    int                             kerning(unsigned l, unsigned r, style_type s = style_regular) const;
 
     int                             underline_position(style_type s = style_regular) const;
     int                             underline_thickness(style_type s = style_regular) const;
@@ -107,16 +122,20 @@ public:
     const texture_2d_ptr&           styles_texture_array() const;
     const texture_2d_ptr&           styles_border_texture_array() const;
 
-protected:
-    void                            render_glyphs();
+    void                            pin_glyphs() const;
+    void                            unpin_glyphs() const;
+
+    unsigned                        atlas_generation() const;
+    unsigned                        atlas_layers() const;
+    unsigned                        cached_glyph_count() const;
 
+protected:
     void                            cleanup();
 
 protected:
     style_container                 _font_styles;
     std::vector<bool>               _font_styles_available;
-    texture_2d_ptr                  _font_styles_texture_array;
-    texture_2d_ptr                  _font_styles_border_texture_array;
+    shared_ptr<glyph_cache>         _glyph_cache;           // atlas state, changed by const glyph lookups
     smooth_type                     _font_smooth_style;
 
     std::string                     _name;
@@ -11,6 +11,7 @@
 #include <stdexcept>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include <boost/assign/list_of.hpp>
 
@@ -30,11 +31,54 @@ struct vertex {
 #if GEOM_SHADER_FONT == 1
     scm::math::vec4f pos_bbox;
     scm::math::vec4f tex_bbox;
+    float            tex_layer;
 #else
     scm::math::vec2f pos;
-    scm::math::vec2f tex;
+    scm::math::vec3f tex;
 #endif
 };
+
+// keeps the glyphs of the text being built from evicting each other
+struct glyph_pin_guard {
+    glyph_pin_guard(const scm::gl::font_face_cptr& f) : _font(f) { _font->pin_glyphs(); }
+    ~glyph_pin_guard() { _font->unpin_glyphs(); }
+    const scm::gl::font_face_cptr& _font;
+};
+
+// decodes utf-8 into code points, malformed sequences are skipped
+void
+decode_utf8(const std::string& str, std::vector<unsigned>& code_points)
+{
+    code_points.clear();
+    code_points.reserve(str.size());
+
+    std::string::const_iterator c = str.begin();
+    while (c != str.end()) {
+        const unsigned char lead = static_cast<unsigned char>(*c++);
+        unsigned            cp   = 0;
+        int                 cont = 0;
+
+        if      (lead < 0x80)           { cp = lead;        cont = 0; }
+        else if ((lead & 0xe0) == 0xc0) { cp = lead & 0x1f; cont = 1; }
+        else if ((lead & 0xf0) == 0xe0) { cp = lead & 0x0f; cont = 2; }
+        else if ((lead & 0xf8) == 0xf0) { cp = lead & 0x07; cont = 3; }
+        else {
+            continue;
+        }
+
+        bool valid = true;
+        for (int i = 0; i < cont; ++i) {
+            if (c == str.end() || (static_cast<unsigned char>(*c) & 0xc0) != 0x80) {
+                valid = false;
+                break;
+            }
+            cp = (cp << 6) | (static_cast<unsigned char>(*c++) & 0x3f);
+        }
+        if (valid) {
+            code_points.push_back(cp);
+        }
+    }
+}
 } // namespace
 
 namespace scm {
@@ -56,6 +100,7 @@ text::text(const render_device_ptr&     device,
   , _indices_count(0)
   , _topology(PRIMITIVE_TRIANGLE_LIST)
   , _glyph_capacity(20)
+  , _glyph_generation(0)
   , _render_device(device)
   , _render_context(device->main_context())
 {
@@ -65,7 +110,8 @@ text::text(const render_device_ptr&     device,
     int num_vertices = _glyph_capacity; // one point per glyph 
     _vertex_buffer = device->create_buffer(BIND_VERTEX_BUFFER, USAGE_STREAM_DRAW, num_vertices * sizeof(vertex), 0);
     _vertex_array  = device->create_vertex_array(vertex_format(0, 0, TYPE_VEC4F, sizeof(vertex))
-                                                              (0, 2, TYPE_VEC4F, sizeof(vertex)),
+                                                              (0, 2, TYPE_VEC4F, sizeof(vertex))
+                                                              (0, 3, TYPE_FLOAT, sizeof(vertex)),
                                                  list_of(_vertex_buffer));
 #else
     int num_vertices = _glyph_capacity * 4; // one quad per glyph 
@@ -73,7 +119,7 @@ text::text(const render_device_ptr&     device,
     _vertex_buffer = device->create_buffer(BIND_VERTEX_BUFFER, USAGE_STREAM_DRAW, num_vertices * sizeof(vertex), 0);
     _index_buffer  = device->create_buffer(BIND_INDEX_BUFFER, USAGE_STREAM_DRAW,  num_indices  * sizeof(unsigned short), 0);
     _vertex_array  = device->create_vertex_array(vertex_format(0, 0, TYPE_VEC2F, sizeof(vertex))
-                                                              (0, 2, TYPE_VEC2F, sizeof(vertex)),
+                                                              (0, 2, TYPE_VEC3F, sizeof(vertex)),
                                                  list_of(_vertex_buffer));
 
     // fill index data
@@ -205,11 +251,15 @@ text::text_bounding_box() const
 void
 text::update()
 {
-    if (_glyph_capacity < _text_string.size()) {
+    glyph_pin_guard       pin(_font);
+    std::vector<unsigned> code_points;
+    decode_utf8(_text_string, code_points);
+
+    if (_glyph_capacity < code_points.size()) {
         // resize the buffers
         if (render_device_ptr device = _render_device.lock()) {
 #if GEOM_SHADER_FONT == 1
-            _glyph_capacity  = static_cast<int>(_text_string.size() + _text_string.size() / 2); // make it 50% bigger as required currently
+            _glyph_capacity  = static_cast<int>(code_points.size() + code_points.size() / 2); // make it 50% bigger as required currently
 
             int num_vertices = _glyph_capacity; 
             if (!device->resize_buffer(_vertex_buffer, num_vertices * sizeof(vertex))) {
@@ -219,7 +269,7 @@ text::update()
             }
 #else
             _indices_count   = 0;
-            _glyph_capacity  = static_cast<int>(_text_string.size() + _text_string.size() / 2); // make it 50% bigger as required currently
+            _glyph_capacity  = static_cast<int>(code_points.size() + code_points.size() / 2); // make it 50% bigger as required currently
 
             int num_vertices = _glyph_capacity * 4; 
             int num_indices  = _glyph_capacity * 6;
@@ -264,12 +314,13 @@ text::update()
         using namespace scm::math;
 
 #if GEOM_SHADER_FONT == 1
-        if (_text_string.empty()) {
+        _glyph_quads.clear();
+        if (code_points.empty()) {
             _indices_count     = 0;
             _text_bounding_box = math::vec2i(0, 0);
         }
         else {
-            scoped_buffer_map vb_map(context, _vertex_buffer, 0, _text_string.size() * sizeof(vertex), ACCESS_WRITE_INVALIDATE_BUFFER);
+            scoped_buffer_map vb_map(context, _vertex_buffer, 0, code_points.size() * sizeof(vertex), ACCESS_WRITE_INVALIDATE_BUFFER);
 
             if (!vb_map) {
                 err() << log::error
@@ -279,13 +330,13 @@ text::update()
             vertex*const    vertex_data = reinterpret_cast<vertex*const>(vb_map.data_ptr());
             vec2i           current_pos = vec2i(0, 0);
             int             current_lw  = 0;
-            char            prev_char   = 0;
+            unsigned        prev_char   = 0;
 
             _indices_count     = 0;
             _text_bounding_box = vec2i(0, _font->line_advance(_text_style));
-            assert(_text_string.size() < (6 * (std::numeric_limits<unsigned short>::max)()));
+            assert(code_points.size() < (6 * (std::numeric_limits<unsigned short>::max)()));
 
-            std::for_each(_text_string.begin(), _text_string.end(), [&](char cur_char) -> void {
+            std::for_each(code_points.begin(), code_points.end(), [&](unsigned cur_char) -> void {
                 using namespace scm::gl;
                 using namespace scm::math;
 
@@ -297,7 +348,7 @@ text::update()
                     _text_bounding_box.x  = max(current_lw, _text_bounding_box.x);
                     current_lw            = 0;
                 }
-                else if (font_face::min_char <= cur_char && cur_char < font_face::max_char) {
+                else if (font_face::min_char <= cur_char) {
                     const font_face::glyph_info& cur_glyph = _font->glyph(cur_char, _text_style);
                     // kerning
                     if (_text_kerning && prev_char) {
@@ -308,6 +359,13 @@ text::update()
                     vec2f bbox = vec2f(cur_glyph._box_size);   
                     vertex_data[_indices_count].pos_bbox = vec4f(pos, bbox.x, bbox.y);
                     vertex_data[_indices_count].tex_bbox = vec4f(cur_glyph._texture_origin, cur_glyph._texture_box_size.x, cur_glyph._texture_box_size.y);
+                    vertex_data[_indices_count].tex_layer = static_cast<float>(cur_glyph._texture_layer);
+
+                    glyph_quad q;
+                    q._pos_bbox  = vertex_data[_indices_count].pos_bbox;
+                    q._tex_bbox  = vertex_data[_indices_count].tex_bbox;
+                    q._tex_layer = cur_glyph._texture_layer;
+                    _glyph_quads.push_back(q);
 
                     _indices_count += 1;
                     // advance the position
@@ -325,7 +383,7 @@ text::update()
 #else
         vec2i           current_pos = vec2i(0, 0);
         int             current_lw  = 0;
-        char            prev_char   = 0;
+        unsigned        prev_char   = 0;
         //vertex*         vertex_data = static_cast<vertex*>(context->map_buffer_range(_vertex_buffer, 0, 4 * _text_string.size() * sizeof(vertex), ACCESS_WRITE_INVALIDATE_BUFFER));
         vertex*         vertex_data = static_cast<vertex*>(context->map_buffer(_vertex_buffer, ACCESS_WRITE_INVALIDATE_BUFFER));
 
@@ -337,10 +395,11 @@ text::update()
 
         _indices_count     = 0;
         _text_bounding_box = vec2i(0, _font->line_advance(_text_style));
-        assert(_text_string.size() < (6 * (std::numeric_limits<unsigned short>::max)()));
+        _glyph_quads.clear();
+        assert(code_points.size() < (6 * (std::numeric_limits<unsigned short>::max)()));
         //unsigned short str_size = static_cast<unsigned short>( _text_string.size());
         size_t i = 0;
-        std::for_each(_text_string.begin(), _text_string.end(), [&](char cur_char) -> void {
+        std::for_each(code_points.begin(), code_points.end(), [&](unsigned cur_char) -> void {
         //for (size_t i = 0; i < _text_string.size(); ++i) {
         //    char  cur_char = _text_string[i];
 
@@ -355,10 +414,7 @@ text::update()
                 _text_bounding_box.x  = max(current_lw, _text_bounding_box.x);
                 current_lw            = 0;
             }
-            else {
-                //if (!isalnum(cur_char) && (cur_char != ' ')) {
-                //    continue;
-                //}
+            else if (font_face::min_char <= cur_char) {
                 const font_face::glyph_info& cur_glyph = _font->glyph(cur_char, _text_style);
                 // kerning
                 if (_text_kerning && prev_char) {
@@ -370,15 +426,18 @@ text::update()
                 vertex_data[i * 4 + 2].pos = vec2f(current_pos + cur_glyph._bearing + cur_glyph._box_size);             // 11
                 vertex_data[i * 4 + 3].pos = vec2f(current_pos + cur_glyph._bearing + vec2i(0, cur_glyph._box_size.y)); // 01
 
-                vertex_data[i * 4    ].tex = cur_glyph._texture_origin;                                              // 00
-                vertex_data[i * 4 + 1].tex = cur_glyph._texture_origin + vec2f(cur_glyph._texture_box_size.x, 0.0f); // 10
-                vertex_data[i * 4 + 2].tex = cur_glyph._texture_origin + cur_glyph._texture_box_size;                // 11
-                vertex_data[i * 4 + 3].tex = cur_glyph._texture_origin + vec2f(0.0f, cur_glyph._texture_box_size.y); // 01
+                const float layer = static_cast<float>(cur_glyph._texture_layer);
+                vertex_data[i * 4    ].tex = vec3f(cur_glyph._texture_origin, layer);                                              // 00
+                vertex_data[i * 4 + 1].tex = vec3f(cur_glyph._texture_origin + vec2f(cur_glyph._texture_box_size.x, 0.0f), layer); // 10
+                vertex_data[i * 4 + 2].tex = vec3f(cur_glyph._texture_origin + cur_glyph._texture_box_size, layer);                // 11
+                vertex_data[i * 4 + 3].tex = vec3f(cur_glyph._texture_origin + vec2f(0.0f, cur_glyph._texture_box_size.y), layer); // 01
 
-                //vertex_data[i * 4    ].tex.z = static_cast<float>(_text_style);
-                //vertex_data[i * 4 + 1].tex.z = static_cast<float>(_text_style);
-                //vertex_data[i * 4 + 2].tex.z = static_cast<float>(_text_style);
-                //vertex_data[i * 4 + 3].tex.z = static_cast<float>(_text_style);
+                glyph_quad q;
+                q._pos_bbox  = vec4f(vec2f(current_pos + cur_glyph._bearing), static_cast<float>(cur_glyph._box_size.x),
+                                                                               static_cast<float>(cur_glyph._box_size.y));
+                q._tex_bbox  = vec4f(cur_glyph._texture_origin, cur_glyph._texture_box_size.x, cur_glyph._texture_box_size.y);
+                q._tex_layer = cur_glyph._texture_layer;
+                _glyph_quads.push_back(q);
 
                 _indices_count += 6;
                 ++i;
@@ -394,6 +453,9 @@ text::update()
         
         context->unmap_buffer(_vertex_buffer);
 #endif
+        // the glyphs of this text are pinned, evictions during the build only
+        // affected other vertex data
+        _glyph_generation = _font->atlas_generation();
     }
     else {
         err() << log::error
@@ -5,6 +5,8 @@
 #ifndef SCM_GL_UTIL_TEXT_H_INCLUDED
 #define SCM_GL_UTIL_TEXT_H_INCLUDED
 
+#include <vector>
+
 #include <scm/core/math.h>
 
 #include <scm/gl_core/gl_core_fwd.h>
@@ -49,6 +51,15 @@ public:
 
     const math::vec2i&          text_bounding_box() const;
 
+protected:
+    // glyph quad relative to the text origin, kept for the batched drawing
+    struct glyph_quad {
+        math::vec4f             _pos_bbox;
+        math::vec4f             _tex_bbox;
+        unsigned                _tex_layer;
+    }; // struct glyph_quad
+    typedef std::vector<glyph_quad> glyph_quad_array;
+
 protected:
     void                        update();
 
@@ -64,8 +75,10 @@ protected:
     math::vec2i                 _text_shadow_offset;
 
     math::vec2i                 _text_bounding_box;
+    glyph_quad_array            _glyph_quads;
 
     int                         _glyph_capacity;
+    unsigned                    _glyph_generation;      // font atlas generation the vertex data refers to
     buffer_ptr                  _vertex_buffer;
     buffer_ptr                  _index_buffer;
     int                         _indices_count;
@@ -4,6 +4,7 @@
 
 #include "text_renderer.h"
 
+#include <algorithm>
 #include <exception>
 #include <stdexcept>
 #include <string>
@@ -14,7 +15,9 @@
 #include <scm/log.h>
 
 #include <scm/gl_core/math.h>
+#include <scm/gl_core/buffer_objects.h>
 #include <scm/gl_core/render_device.h>
+#include <scm/gl_core/buffer_objects/scoped_buffer_map.h>
 #include <scm/gl_core/texture_objects.h>
 #include <scm/gl_core/shader_objects.h>
 
@@ -35,16 +38,19 @@ std::string v_source = "\
                                                                                                     \n\
     layout(location = 0) in vec4 in_position_bbox;                                                  \n\
     layout(location = 2) in vec4 in_texcoord_bbox;                                                  \n\
+    layout(location = 3) in float in_texcoord_layer;                                                \n\
                                                                                                     \n\
     out per_vertex {                                                                                \n\
         vec4 in_position_bbox;                                                                      \n\
         vec4 in_texcoord_bbox;                                                                      \n\
+        float in_texcoord_layer;                                                                    \n\
     } v_out;                                                                                        \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
         v_out.in_position_bbox  = in_position_bbox;                                                 \n\
         v_out.in_texcoord_bbox  = in_texcoord_bbox;                                                 \n\
+        v_out.in_texcoord_layer = in_texcoord_layer;                                                \n\
         //gl_Position             = in_mvp * vec4(in_position.xy, 0.0, 1.0);                        \n\
     }                                                                                               \n\
     ";
@@ -60,10 +66,11 @@ std::string g_source = "\
     in per_vertex {                                                                                 \n\
         vec4 in_position_bbox;                                                                      \n\
         vec4 in_texcoord_bbox;                                                                      \n\
+        float in_texcoord_layer;                                                                    \n\
     } v_in[];                                                                                       \n\
                                                                                                     \n\
     out per_vertex {                                                                                \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_out;                                                                                        \n\
                                                                                                     \n\
     void main()                                                                                     \n\
@@ -73,25 +80,26 @@ std::string g_source = "\
                                                                                                     \n\
         vec2 t  = v_in[0].in_texcoord_bbox.xy;                                                      \n\
         vec2 ts = v_in[0].in_texcoord_bbox.zw;                                                      \n\
+        float tl = v_in[0].in_texcoord_layer;                                                       \n\
                                                                                                     \n\
         // 10                                                                                       \n\
         gl_Position       = in_mvp * vec4(p + vec2(ps.x, 0.0), 0.0, 1.0);                           \n\
-        v_out.tex_coord   =          vec2(t + vec2(ts.x, 0.0));                                     \n\
+        v_out.tex_coord   =          vec3(t + vec2(ts.x, 0.0), tl);                                 \n\
         EmitVertex();                                                                               \n\
                                                                                                     \n\
         // 11                                                                                       \n\
         gl_Position       = in_mvp * vec4(p + ps, 0.0, 1.0);                                        \n\
-        v_out.tex_coord   =          vec2(t + ts);                                                  \n\
+        v_out.tex_coord   =          vec3(t + ts, tl);                                              \n\
         EmitVertex();                                                                               \n\
                                                                                                     \n\
         // 00                                                                                       \n\
         gl_Position       = in_mvp * vec4(p, 0.0, 1.0);                                             \n\
-        v_out.tex_coord   = vec2(t);                                                                \n\
+        v_out.tex_coord   = vec3(t, tl);                                                            \n\
         EmitVertex();                                                                               \n\
                                                                                                     \n\
         // 01                                                                                       \n\
         gl_Position       = in_mvp * vec4(p + vec2(0.0, ps.y), 0.0, 1.0);                           \n\
-        v_out.tex_coord   =          vec2(t + vec2(0.0, ts.y));                                     \n\
+        v_out.tex_coord   =          vec3(t + vec2(0.0, ts.y), tl);                                 \n\
         EmitVertex();                                                                               \n\
         EndPrimitive();                                                                             \n\
     }                                                                                               \n\
@@ -103,16 +111,16 @@ std::string v_source = "\
     uniform mat4  in_mvp;                                                                           \n\
                                                                                                     \n\
     layout(location = 0) in vec2 in_position;                                                       \n\
-    layout(location = 2) in vec2 in_texcoord;                                                       \n\
+    layout(location = 2) in vec3 in_texcoord;                                                       \n\
                                                                                                     \n\
     out per_vertex {                                                                                \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_out;                                                                                        \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
         //v_out.os_position   = in_position;                                                        \n\
-        v_out.tex_coord     = in_texcoord.xy;                                                       \n\
+        v_out.tex_coord     = in_texcoord.xyz;                                                      \n\
         gl_Position         = in_mvp * vec4(in_position.xy, 0.0, 1.0);                              \n\
     }                                                                                               \n\
     ";
@@ -126,11 +134,11 @@ std::string g_source = "\
     uniform mat4  in_mvp;                                                                           \n\
                                                                                                     \n\
     in per_vertex {                                                                                 \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_in[];                                                                                       \n\
                                                                                                     \n\
     out per_vertex {                                                                                \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_out;                                                                                        \n\
                                                                                                     \n\
     void main()                                                                                     \n\
@@ -150,20 +158,19 @@ std::string g_source = "\
 std::string f_source_gray = "\
     #version 330 core                                                                               \n\
                                                                                                     \n\
-    uniform int             in_style;                                                               \n\
     uniform vec4            in_color;                                                               \n\
     uniform sampler2DArray  in_font_array;                                                          \n\
                                                                                                     \n\
     layout(location = 0) out vec4 out_color;                                                        \n\
                                                                                                     \n\
     in per_vertex {                                                                                 \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_in;                                                                                         \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
         float core    = texture(in_font_array,                                                      \n\
-                                vec3(v_in.tex_coord, float(in_style))).r;                           \n\
+                                v_in.tex_coord).r;                                                  \n\
         out_color.rgb = in_color.rgb;                                                               \n\
         out_color.a   = core * in_color.a;                                                          \n\
     }                                                                                               \n\
@@ -172,7 +179,6 @@ std::string f_source_gray = "\
 std::string f_source_outline_gray = "\
     #version 330 core                                                                               \n\
                                                                                                     \n\
-    uniform int             in_style;                                                               \n\
     uniform vec4            in_color;                                                               \n\
     uniform vec4            in_outline_color;                                                       \n\
     uniform sampler2DArray  in_font_array;                                                          \n\
@@ -181,12 +187,12 @@ std::string f_source_outline_gray = "\
     layout(location = 0) out vec4 out_color;                                                        \n\
                                                                                                     \n\
     in per_vertex {                                                                                 \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_in;                                                                                         \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
-        vec3  tc      = vec3(v_in.tex_coord, float(in_style));                                      \n\
+        vec3  tc      = v_in.tex_coord;                                                             \n\
         float core    = texture(in_font_array, tc).r;                                               \n\
         float outline = texture(in_font_border_array, tc).r;                                        \n\
                                                                                                     \n\
@@ -204,7 +210,6 @@ std::string f_source_lcd = "\
                                                                                                     \n\
     in vec2 tex_coord;                                                                              \n\
                                                                                                     \n\
-    uniform int             in_style;                                                               \n\
     uniform vec4            in_color;                                                               \n\
     uniform sampler2DArray  in_font_array;                                                          \n\
                                                                                                     \n\
@@ -212,13 +217,13 @@ std::string f_source_lcd = "\
     layout(location = 0, index = 1) out vec4 out_sup_pixel_blend;                                   \n\
                                                                                                     \n\
     in per_vertex {                                                                                 \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_in;                                                                                         \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
         vec3 core           = texture(in_font_array,                                                \n\
-                                      vec3(v_in.tex_coord, float(in_style))).rgb;                   \n\
+                                      v_in.tex_coord).rgb;                                          \n\
                                                                                                     \n\
         out_color           = in_color;                                                             \n\
         out_sup_pixel_blend = vec4(core.rgb * in_color.a, 1.0);                                     \n\
@@ -230,7 +235,6 @@ std::string f_source_outline_lcd = "\
                                                                                                     \n\
     in vec2 tex_coord;                                                                              \n\
                                                                                                     \n\
-    uniform int             in_style;                                                               \n\
     uniform vec4            in_color;                                                               \n\
     uniform vec4            in_outline_color;                                                       \n\
     uniform sampler2DArray  in_font_array;                                                          \n\
@@ -240,12 +244,12 @@ std::string f_source_outline_lcd = "\
     layout(location = 0, index = 1) out vec4 out_sup_pixel_blend;                                   \n\
                                                                                                     \n\
     in per_vertex {                                                                                 \n\
-        vec2 tex_coord;                                                                             \n\
+        vec3 tex_coord;                                                                             \n\
     } v_in;                                                                                         \n\
                                                                                                     \n\
     void main()                                                                                     \n\
     {                                                                                               \n\
-        vec3 tc      = vec3(v_in.tex_coord, float(in_style));                                       \n\
+        vec3 tc      = v_in.tex_coord;                                                              \n\
         vec3 core    = texture(in_font_array, tc).rgb;                                              \n\
         vec3 outline = texture(in_font_border_array, tc).rgb;                                       \n\
                                                                                                     \n\
@@ -258,6 +262,151 @@ std::string f_source_outline_lcd = "\
     }                                                                                               \n\
     ";
 
+
+// batched drawing, one point per glyph carrying all per text attributes
+std::string v_source_batch = "\
+    #version 330 core                                                                               \n\
+                                                                                                    \n\
+    layout(location = 0) in vec4 in_position_bbox;                                                  \n\
+    layout(location = 1) in vec4 in_texcoord_bbox;                                                  \n\
+    layout(location = 2) in vec4 in_color;                                                          \n\
+    layout(location = 3) in vec4 in_outline_color;                                                  \n\
+    layout(location = 4) in vec2 in_layer_outline;                                                  \n\
+                                                                                                    \n\
+    out per_vertex {                                                                                \n\
+        vec4 position_bbox;                                                                         \n\
+        vec4 texcoord_bbox;                                                                         \n\
+        vec4 color;                                                                                 \n\
+        vec4 outline_color;                                                                         \n\
+        vec2 layer_outline;                                                                         \n\
+    } v_out;                                                                                        \n\
+                                                                                                    \n\
+    void main()                                                                                     \n\
+    {                                                                                               \n\
+        v_out.position_bbox = in_position_bbox;                                                     \n\
+        v_out.texcoord_bbox = in_texcoord_bbox;                                                     \n\
+        v_out.color         = in_color;                                                             \n\
+        v_out.outline_color = in_outline_color;                                                     \n\
+        v_out.layer_outline = in_layer_outline;                                                     \n\
+    }                                                                                               \n\
+    ";
+
+std::string g_source_batch = "\
+    #version 330 core                                                                               \n\
+                                                                                                    \n\
+    layout(points, invocations = 1)          in;                                                    \n\
+    layout(triangle_strip, max_vertices = 4) out;                                                   \n\
+                                                                                                    \n\
+    uniform mat4  in_mvp;                                                                           \n\
+                                                                                                    \n\
+    in per_vertex {                                                                                 \n\
+        vec4 position_bbox;                                                                         \n\
+        vec4 texcoord_bbox;                                                                         \n\
+        vec4 color;                                                                                 \n\
+        vec4 outline_color;                                                                         \n\
+        vec2 layer_outline;                                                                         \n\
+    } v_in[];                                                                                       \n\
+                                                                                                    \n\
+    out per_vertex {                                                                                \n\
+        vec3       tex_coord;                                                                       \n\
+        flat vec4  color;                                                                           \n\
+        flat vec4  outline_color;                                                                   \n\
+        flat float outline;                                                                         \n\
+    } v_out;                                                                                        \n\
+                                                                                                    \n\
+    void emit(vec2 p, vec2 t)                                                                       \n\
+    {                                                                                               \n\
+        gl_Position         = in_mvp * vec4(p, 0.0, 1.0);                                           \n\
+        v_out.tex_coord     = vec3(t, v_in[0].layer_outline.x);                                     \n\
+        v_out.color         = v_in[0].color;                                                        \n\
+        v_out.outline_color = v_in[0].outline_color;                                                \n\
+        v_out.outline       = v_in[0].layer_outline.y;                                              \n\
+        EmitVertex();                                                                               \n\
+    }                                                                                               \n\
+                                                                                                    \n\
+    void main()                                                                                     \n\
+    {                                                                                               \n\
+        vec2 p  = v_in[0].position_bbox.xy;                                                         \n\
+        vec2 ps = v_in[0].position_bbox.zw;                                                         \n\
+        vec2 t  = v_in[0].texcoord_bbox.xy;                                                         \n\
+        vec2 ts = v_in[0].texcoord_bbox.zw;                                                         \n\
+                                                                                                    \n\
+        emit(p + vec2(ps.x, 0.0), t + vec2(ts.x, 0.0)); // 10                                       \n\
+        emit(p + ps,              t + ts);              // 11                                       \n\
+        emit(p,                   t);                   // 00                                       \n\
+        emit(p + vec2(0.0, ps.y), t + vec2(0.0, ts.y)); // 01                                       \n\
+        EndPrimitive();                                                                             \n\
+    }                                                                                               \n\
+    ";
+
+std::string f_source_batch_gray = "\
+    #version 330 core                                                                               \n\
+                                                                                                    \n\
+    uniform sampler2DArray  in_font_array;                                                          \n\
+    uniform sampler2DArray  in_font_border_array;                                                   \n\
+                                                                                                    \n\
+    layout(location = 0) out vec4 out_color;                                                        \n\
+                                                                                                    \n\
+    in per_vertex {                                                                                 \n\
+        vec3       tex_coord;                                                                       \n\
+        flat vec4  color;                                                                           \n\
+        flat vec4  outline_color;                                                                   \n\
+        flat float outline;                                                                         \n\
+    } v_in;                                                                                         \n\
+                                                                                                    \n\
+    void main()                                                                                     \n\
+    {                                                                                               \n\
+        float core    = texture(in_font_array, v_in.tex_coord).r;                                   \n\
+        float outline = texture(in_font_border_array, v_in.tex_coord).r * v_in.outline;             \n\
+        float a       = core + outline - core * outline;                                            \n\
+                                                                                                    \n\
+        if (a <= 0.0) {                                                                             \n\
+            discard;                                                                                \n\
+        }                                                                                           \n\
+        out_color.rgb = mix(v_in.outline_color.rgb * outline, v_in.color.rgb, core) / a;            \n\
+        out_color.a   = a * v_in.color.a;                                                           \n\
+    }                                                                                               \n\
+    ";
+
+std::string f_source_batch_lcd = "\
+    #version 330 core                                                                               \n\
+                                                                                                    \n\
+    uniform sampler2DArray  in_font_array;                                                          \n\
+    uniform sampler2DArray  in_font_border_array;                                                   \n\
+                                                                                                    \n\
+    layout(location = 0, index = 0) out vec4 out_color;                                             \n\
+    layout(location = 0, index = 1) out vec4 out_sup_pixel_blend;                                   \n\
+                                                                                                    \n\
+    in per_vertex {                                                                                 \n\
+        vec3       tex_coord;                                                                       \n\
+        flat vec4  color;                                                                           \n\
+        flat vec4  outline_color;                                                                   \n\
+        flat float outline;                                                                         \n\
+    } v_in;                                                                                         \n\
+                                                                                                    \n\
+    void main()                                                                                     \n\
+    {                                                                                               \n\
+        vec3 core    = texture(in_font_array, v_in.tex_coord).rgb;                                  \n\
+        vec3 outline = texture(in_font_border_array, v_in.tex_coord).rgb * v_in.outline;            \n\
+        vec3 a       = core + outline - core * outline;                                             \n\
+                                                                                                    \n\
+        out_sup_pixel_blend = vec4(a * v_in.color.a, 1.0);                                          \n\
+        out_color.rgb       =   mix(v_in.outline_color.rgb * outline, v_in.color.rgb, core)         \n\
+                              / max(a, vec3(1.0 / 255.0));                                          \n\
+        out_color.a         = v_in.color.a;                                                         \n\
+    }                                                                                               \n\
+    ";
+
+struct batch_vertex {
+    scm::math::vec4f pos_bbox;
+    scm::math::vec4f tex_bbox;
+    scm::math::vec4f color;
+    scm::math::vec4f outline_color;
+    scm::math::vec2f layer_outline;
+};
+
+const scm::size_t initial_batch_capacity = 4096; // glyphs
+
 } // namespace
 
 
@@ -265,6 +414,8 @@ namespace scm {
 namespace gl {
 
 text_renderer::text_renderer(const render_device_ptr& device)
+  : _batch_capacity(initial_batch_capacity)
+  , _render_device(device)
 {
     using namespace scm;
     using namespace scm::gl;
@@ -304,6 +455,35 @@ text_renderer::text_renderer(const render_device_ptr& device)
         throw std::runtime_error("font_renderer::font_renderer(): error creating shader programs.");
     }
 
+    _batch_program_gray = device->create_program(list_of(device->create_shader(STAGE_VERTEX_SHADER,   v_source_batch,      "text_renderer::v_source_batch"))
+                                                        (device->create_shader(STAGE_GEOMETRY_SHADER, g_source_batch,      "text_renderer::g_source_batch"))
+                                                        (device->create_shader(STAGE_FRAGMENT_SHADER, f_source_batch_gray, "text_renderer::f_source_batch_gray")),
+                                                 "text_renderer::batch_program_gray");
+    _batch_program_lcd  = device->create_program(list_of(device->create_shader(STAGE_VERTEX_SHADER,   v_source_batch,      "text_renderer::v_source_batch"))
+                                                        (device->create_shader(STAGE_GEOMETRY_SHADER, g_source_batch,      "text_renderer::g_source_batch"))
+                                                        (device->create_shader(STAGE_FRAGMENT_SHADER, f_source_batch_lcd,  "text_renderer::f_source_batch_lcd")),
+                                                 "text_renderer::batch_program_lcd");
+
+    if (   !_batch_program_gray
+        || !_batch_program_lcd) {
+        scm::err() << "font_renderer::font_renderer(): error creating batch shader programs." << log::end;
+        throw std::runtime_error("font_renderer::font_renderer(): error creating batch shader programs.");
+    }
+
+    _batch_vertex_buffer = device->create_buffer(BIND_VERTEX_BUFFER, USAGE_STREAM_DRAW, _batch_capacity * sizeof(batch_vertex), 0);
+    _batch_vertex_array  = device->create_vertex_array(vertex_format(0, 0, TYPE_VEC4F, sizeof(batch_vertex))
+                                                                    (0, 1, TYPE_VEC4F, sizeof(batch_vertex))
+                                                                    (0, 2, TYPE_VEC4F, sizeof(batch_vertex))
+                                                                    (0, 3, TYPE_VEC4F, sizeof(batch_vertex))
+                                                                    (0, 4, TYPE_VEC2F, sizeof(batch_vertex)),
+                                                       list_of(_batch_vertex_buffer));
+
+    if (   !_batch_vertex_buffer
+        || !_batch_vertex_array) {
+        scm::err() << "font_renderer::font_renderer(): error creating batch vertex buffer." << log::end;
+        throw std::runtime_error("font_renderer::font_renderer(): error creating batch vertex buffer.");
+    }
+
     _font_sampler_state = device->create_sampler_state(FILTER_MIN_MAG_NEAREST, WRAP_CLAMP_TO_EDGE);
     _font_blend_gray    = device->create_blend_state(true, FUNC_SRC_ALPHA,  FUNC_ONE_MINUS_SRC_ALPHA,  FUNC_ONE, FUNC_ZERO);
     _font_blend_lcd     = device->create_blend_state(true, FUNC_SRC1_COLOR, FUNC_ONE_MINUS_SRC1_COLOR, FUNC_ONE, FUNC_ZERO);
@@ -333,6 +513,12 @@ text_renderer::~text_renderer()
     _font_blend_gray.reset();
     _font_blend_lcd.reset();
 
+    _batch_groups.clear();
+    _batch_vertex_array.reset();
+    _batch_vertex_buffer.reset();
+    _batch_program_gray.reset();
+    _batch_program_lcd.reset();
+
     //_quad.reset();
 }
 
@@ -341,6 +527,11 @@ text_renderer::draw(const render_context_ptr& context,
                     const math::vec2i&        pos,
                     const text_ptr&           txt) const
 {
+    // glyphs of the text were evicted from the font atlas
+    if (txt->_glyph_generation != txt->font()->atlas_generation()) {
+        txt->update();
+    }
+
     using namespace scm;
     using namespace scm::gl;
     using namespace scm::math;
@@ -362,7 +553,6 @@ text_renderer::draw(const render_context_ptr& context,
     switch (txt->font()->smooth_style()) {
         case font_face::smooth_normal:
             _font_program_gray->uniform("in_mvp", mvp);
-            _font_program_gray->uniform("in_style", static_cast<int>(txt->text_style()));
             _font_program_gray->uniform("in_color", txt->text_color());
             _font_program_gray->uniform_sampler("in_font_array", 0);
 
@@ -371,7 +561,6 @@ text_renderer::draw(const render_context_ptr& context,
            break;
         case font_face::smooth_lcd:
             _font_program_lcd->uniform("in_mvp", mvp);
-            _font_program_lcd->uniform("in_style", static_cast<int>(txt->text_style()));
             _font_program_lcd->uniform("in_color", txt->text_color());
             _font_program_lcd->uniform_sampler("in_font_array", 0);
 
@@ -408,6 +597,10 @@ text_renderer::draw_outlined(const render_context_ptr& context,
     if (!txt->font()->styles_border_texture_array()) {
         return draw(context, pos, txt);
     }
+    // glyphs of the text were evicted from the font atlas
+    if (txt->_glyph_generation != txt->font()->atlas_generation()) {
+        txt->update();
+    }
 
     using namespace scm;
     using namespace scm::gl;
@@ -433,7 +626,6 @@ text_renderer::draw_outlined(const render_context_ptr& context,
     switch (txt->font()->smooth_style()) {
         case font_face::smooth_normal:
             _font_program_outline_gray->uniform("in_mvp",               mvp);
-            _font_program_outline_gray->uniform("in_style",             static_cast<int>(txt->text_style()));
             _font_program_outline_gray->uniform("in_color",             txt->text_color());
             _font_program_outline_gray->uniform("in_outline_color",     txt->text_outline_color());
             _font_program_outline_gray->uniform_sampler("in_font_array",        0);
@@ -494,7 +686,6 @@ text_renderer::draw_outlined(const render_context_ptr& context,
             break;
         case font_face::smooth_lcd:
             _font_program_outline_lcd->uniform("in_mvp",               mvp);
-            _font_program_outline_lcd->uniform("in_style",             static_cast<int>(txt->text_style()));
             _font_program_outline_lcd->uniform("in_color",             txt->text_color());
             _font_program_outline_lcd->uniform("in_outline_color",     txt->text_outline_color());
             _font_program_outline_lcd->uniform_sampler("in_font_array",        0);
@@ -570,6 +761,11 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
                              const math::vec2i&        pos,
                              const text_ptr&           txt) const
 {
+    // glyphs of the text were evicted from the font atlas
+    if (txt->_glyph_generation != txt->font()->atlas_generation()) {
+        txt->update();
+    }
+
     using namespace scm;
     using namespace scm::gl;
     using namespace scm::math;
@@ -600,7 +796,6 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
                 mat4f mvp = _projection_matrix * v;
 
                 _font_program_gray->uniform("in_mvp", mvp);
-                _font_program_gray->uniform("in_style", static_cast<int>(txt->text_style()));
                 _font_program_gray->uniform("in_color", txt->text_shadow_color());
 
 #if GEOM_SHADER_FONT == 1
@@ -621,7 +816,6 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
                 mat4f mvp = _projection_matrix * v;
 
                 _font_program_gray->uniform("in_mvp", mvp);
-                _font_program_gray->uniform("in_style", static_cast<int>(txt->text_style()));
                 _font_program_gray->uniform("in_color", txt->text_color());
 
 #if GEOM_SHADER_FONT == 1
@@ -645,7 +839,6 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
                 mat4f mvp = _projection_matrix * v;
 
                 _font_program_lcd->uniform("in_mvp", mvp);
-                _font_program_lcd->uniform("in_style", static_cast<int>(txt->text_style()));
                 _font_program_lcd->uniform("in_color", txt->text_shadow_color());
                 context->set_blend_state(_font_blend_lcd/*, txt->text_shadow_color()*/);
 
@@ -667,7 +860,6 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
                 mat4f mvp = _projection_matrix * v;
 
                 _font_program_lcd->uniform("in_mvp", mvp);
-                _font_program_lcd->uniform("in_style", static_cast<int>(txt->text_style()));
                 _font_program_lcd->uniform("in_color", txt->text_color());
                 context->set_blend_state(_font_blend_lcd/*, txt->text_color()*/);
 
@@ -691,6 +883,222 @@ text_renderer::draw_shadowed(const render_context_ptr& context,
     //_quad->draw(context, geometry::MODE_SOLID);
 }
 
+void
+text_renderer::queue_draw(const math::vec2i&        pos,
+                          const text_ptr&           txt)
+{
+    queue(pos, txt, effect_none);
+}
+
+void
+text_renderer::queue_draw_shadowed(const math::vec2i&        pos,
+                                   const text_ptr&           txt)
+{
+    queue(pos, txt, effect_shadow);
+}
+
+void
+text_renderer::queue_draw_outlined(const math::vec2i&        pos,
+                                   const text_ptr&           txt)
+{
+    queue(pos, txt, effect_outline);
+}
+
+void
+text_renderer::queue(const math::vec2i&        pos,
+                     const text_ptr&           txt,
+                     text_effect               effect)
+{
+    if (!txt) {
+        return;
+    }
+
+    batch_item item;
+    item._pos    = pos;
+    item._text   = txt;
+    item._effect = effect;
+
+    // only a handful of fonts are in use at a time
+    batch_group_array::iterator g = _batch_groups.begin();
+    while (g != _batch_groups.end() && g->_font != txt->font()) {
+        ++g;
+    }
+    if (g == _batch_groups.end()) {
+        g = _batch_groups.insert(_batch_groups.end(), batch_group());
+        g->_font = txt->font();
+    }
+    g->_items.push_back(item);
+}
+
+unsigned
+text_renderer::queued_text_count() const
+{
+    unsigned c = 0;
+    for (batch_group_array::const_iterator g = _batch_groups.begin(); g != _batch_groups.end(); ++g) {
+        c += static_cast<unsigned>(g->_items.size());
+    }
+    return c;
+}
+
+void
+text_renderer::draw_queued(const render_context_ptr& context)
+{
+    using namespace scm;
+    using namespace scm::gl;
+    using namespace scm::math;
+
+    if (_batch_groups.empty()) {
+        return;
+    }
+
+    // rebuild texts whose glyphs were evicted from the font atlas. a text pins
+    // its own glyphs while it is rebuilt, but can evict the glyphs of another
+    // queued text, so repeat until no text was rebuilt. if the queued texts of
+    // one font use more glyphs than the atlas holds they keep evicting each
+    // other, this is stopped after every text had its turn
+    const scm::size_t max_passes  = queued_text_count() + 1;
+    scm::size_t       glyph_count = 0;
+    bool              rebuilt     = true;
+    for (scm::size_t pass = 0; pass < max_passes && rebuilt; ++pass) {
+        rebuilt     = false;
+        glyph_count = 0;
+        for (batch_group_array::const_iterator g = _batch_groups.begin(); g != _batch_groups.end(); ++g) {
+            for (std::vector<batch_item>::const_iterator i = g->_items.begin(); i != g->_items.end(); ++i) {
+                const text_ptr& txt = i->_text;
+                if (txt->_glyph_generation != txt->font()->atlas_generation()) {
+                    txt->update();
+                    rebuilt = true;
+                }
+                glyph_count += txt->_glyph_quads.size() * (i->_effect == effect_shadow ? 2 : 1);
+            }
+        }
+    }
+    if (rebuilt) {
+        bool stale = false;
+        for (batch_group_array::const_iterator g = _batch_groups.begin(); g != _batch_groups.end(); ++g) {
+            for (std::vector<batch_item>::const_iterator i = g->_items.begin(); i != g->_items.end(); ++i) {
+                stale = stale || (i->_text->_glyph_generation != i->_text->font()->atlas_generation());
+            }
+        }
+        if (stale) {
+            err() << log::error
+                  << "text_renderer::draw_queued(): the queued texts use more glyphs than the font atlas holds, "
+                  << "texts with evicted glyphs are drawn with wrong glyphs." << log::end;
+        }
+    }
+
+    if (glyph_count == 0) {
+        _batch_groups.clear();
+        return;
+    }
+
+    if (_batch_capacity < glyph_count) {
+        render_device_ptr device = _render_device.lock();
+        if (!device) {
+            err() << log::error
+                  << "text_renderer::draw_queued(): unable to optain render device from weak pointer." << log::end;
+            _batch_groups.clear();
+            return;
+        }
+        scm::size_t new_capacity = glyph_count + glyph_count / 2; // make it 50% bigger as required currently
+        if (!device->resize_buffer(_batch_vertex_buffer, new_capacity * sizeof(batch_vertex))) {
+            err() << log::error
+                  << "text_renderer::draw_queued(): unable to resize vertex buffer (size : " << new_capacity * sizeof(batch_vertex) << ")." << log::end;
+            _batch_groups.clear();
+            return;
+        }
+        _batch_capacity = new_capacity;
+    }
+
+    std::vector<int> group_first(_batch_groups.size(), 0);
+    std::vector<int> group_count(_batch_groups.size(), 0);
+    {
+        scoped_buffer_map vb_map(context, _batch_vertex_buffer, 0, glyph_count * sizeof(batch_vertex), ACCESS_WRITE_INVALIDATE_BUFFER);
+
+        if (!vb_map) {
+            err() << log::error
+                  << "text_renderer::draw_queued(): unable to map vertex buffer." << log::end;
+            _batch_groups.clear();
+            return;
+        }
+        batch_vertex*const vertex_data = reinterpret_cast<batch_vertex*const>(vb_map.data_ptr());
+        int                cur_glyph   = 0;
+
+        for (size_t g = 0; g < _batch_groups.size(); ++g) {
+            const bool has_border = static_cast<bool>(_batch_groups[g]._font->styles_border_texture_array());
+            group_first[g] = cur_glyph;
+
+            for (std::vector<batch_item>::const_iterator i = _batch_groups[g]._items.begin(); i != _batch_groups[g]._items.end(); ++i) {
+                const text&                     txt    = *i->_text;
+                const text::glyph_quad_array&   quads  = txt._glyph_quads;
+
+                const int   passes         = i->_effect == effect_shadow ? 2 : 1;
+                const float outline        = (i->_effect == effect_outline && has_border) ? 1.0f : 0.0f;
+                for (int p = 0; p < passes; ++p) {
+                    const bool  shadow     = p == 0 && passes == 2;
+                    const vec2f offset     = vec2f(shadow ? i->_pos + txt.text_shadow_offset() : i->_pos);
+                    const vec4f color      = shadow ? txt.text_shadow_color() : txt.text_color();
+
+                    for (text::glyph_quad_array::const_iterator q = quads.begin(); q != quads.end(); ++q) {
+                        batch_vertex& v = vertex_data[cur_glyph++];
+                        v.pos_bbox      = vec4f(q->_pos_bbox.x + offset.x, q->_pos_bbox.y + offset.y, q->_pos_bbox.z, q->_pos_bbox.w);
+                        v.tex_bbox      = q->_tex_bbox;
+                        v.color         = color;
+                        v.outline_color = txt.text_outline_color();
+                        v.layer_outline = vec2f(static_cast<float>(q->_tex_layer), shadow ? 0.0f : outline);
+                    }
+                }
+            }
+            group_count[g] = cur_glyph - group_first[g];
+        }
+    }
+
+    context_vertex_input_guard  vig(context);
+    context_state_objects_guard csg(context);
+    context_texture_units_guard tug(context);
+    context_program_guard       cpg(context);
+
+    context->set_depth_stencil_state(_font_dstate);
+    context->set_rasterizer_state(_font_raster_state);
+    context->bind_vertex_array(_batch_vertex_array);
+
+    for (size_t g = 0; g < _batch_groups.size(); ++g) {
+        if (group_count[g] < 1) {
+            continue;
+        }
+        const font_face_cptr& font   = _batch_groups[g]._font;
+        const texture_2d_ptr& border = font->styles_border_texture_array() ? font->styles_border_texture_array()
+                                                                           : font->styles_texture_array();
+        program_ptr           prog;
+
+        switch (font->smooth_style()) {
+            case font_face::smooth_normal:
+                prog = _batch_program_gray;
+                context->set_blend_state(_font_blend_gray);
+                break;
+            case font_face::smooth_lcd:
+                prog = _batch_program_lcd;
+                context->set_blend_state(_font_blend_lcd);
+                break;
+            default:
+                continue;
+        }
+
+        prog->uniform("in_mvp", _projection_matrix);
+        prog->uniform_sampler("in_font_array",        0);
+        prog->uniform_sampler("in_font_border_array", 1);
+
+        context->bind_texture(font->styles_texture_array(), _font_sampler_state, 0);
+        context->bind_texture(border,                       _font_sampler_state, 1);
+        context->bind_program(prog);
+
+        context->apply();
+        context->draw_arrays(PRIMITIVE_POINT_LIST, group_first[g], group_count[g]);
+    }
+
+    _batch_groups.clear();
+}
+
 void
 text_renderer::projection_matrix(const math::mat4f& m)
 {
@@ -5,7 +5,11 @@
 #ifndef SCM_GL_UTIL_TEXT_RENDERER_H_INCLUDED
 #define SCM_GL_UTIL_TEXT_RENDERER_H_INCLUDED
 
+#include <vector>
+
 #include <scm/core/math.h>
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
 
 #include <scm/gl_core/gl_core_fwd.h>
 
@@ -18,8 +22,35 @@
 namespace scm {
 namespace gl {
 
+// text drawing
+//  - draw(), draw_shadowed() and draw_outlined() render a single text object
+//    immediately using its own vertex array
+//  - queue_draw(), queue_draw_shadowed() and queue_draw_outlined() only record
+//    the text, draw_queued() streams the glyphs of all recorded texts into
+//    one shared vertex buffer (one point per glyph, expanded to quads in the
+//    geometry shader) and issues one draw per font face. shadows and outlines
+//    are per glyph attributes, all effects share the same draw. texts of the
+//    same font are drawn in queue order, different fonts in order of their
+//    first queued text
 class __scm_export(gl_util) text_renderer
 {
+protected:
+    typedef enum {
+        effect_none     = 0x00,
+        effect_shadow,
+        effect_outline
+    } text_effect;
+    struct batch_item {
+        math::vec2i             _pos;
+        text_ptr                _text;
+        text_effect             _effect;
+    }; // struct batch_item
+    struct batch_group {
+        font_face_cptr          _font;
+        std::vector<batch_item> _items;
+    }; // struct batch_group
+    typedef std::vector<batch_group> batch_group_array;
+
 public:
     text_renderer(const render_device_ptr& device);
     virtual ~text_renderer();
@@ -34,8 +65,23 @@ public:
                                   const math::vec2i&        pos,
                                   const text_ptr&           txt) const;
 
+    void            queue_draw(const math::vec2i&        pos,
+                               const text_ptr&           txt);
+    void            queue_draw_shadowed(const math::vec2i&        pos,
+                                        const text_ptr&           txt);
+    void            queue_draw_outlined(const math::vec2i&        pos,
+                                        const text_ptr&           txt);
+    // draws and clears all queued texts
+    void            draw_queued(const render_context_ptr& context);
+    unsigned        queued_text_count() const;
+
     void            projection_matrix(const math::mat4f& m);
 
+protected:
+    void            queue(const math::vec2i&        pos,
+                          const text_ptr&           txt,
+                          text_effect               effect);
+
 protected:
     program_ptr                 _font_program_gray;
     program_ptr                 _font_program_lcd;
@@ -47,6 +93,14 @@ protected:
     blend_state_ptr             _font_blend_gray;
     blend_state_ptr             _font_blend_lcd;
 
+    program_ptr                 _batch_program_gray;
+    program_ptr                 _batch_program_lcd;
+    buffer_ptr                  _batch_vertex_buffer;
+    vertex_array_ptr            _batch_vertex_array;
+    scm::size_t                 _batch_capacity;        // in glyphs
+    batch_group_array           _batch_groups;
+    render_device_wptr          _render_device;
+
     math::mat4f                 _projection_matrix;
 
     //// temporary
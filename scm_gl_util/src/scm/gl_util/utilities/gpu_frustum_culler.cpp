@@ -0,0 +1,292 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "gpu_frustum_culler.h"
+
+#include <cassert>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+#include <boost/assign/list_of.hpp>
+
+#include <scm/gl_core/config.h>
+#include <scm/gl_core/log.h>
+#include <scm/gl_core/buffer_objects.h>
+#include <scm/gl_core/primitives/frustum.h>
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/shader_objects.h>
+
+namespace {
+
+const unsigned cull_group_size = 64;
+
+std::string cull_c_source = "\
+    #version 430 core\n\
+    \n\
+    layout(local_size_x = 64) in;\n\
+    \n\
+    struct cull_object {\n\
+        vec4  bbox_min;\n\
+        vec4  bbox_max;\n\
+        mat4  transform;\n\
+        ivec4 draw;\n\
+    };\n\
+    struct draw_command {\n\
+        uint  count;\n\
+        uint  instance_count;\n\
+        uint  first_index;\n\
+        int   base_vertex;\n\
+        uint  base_instance;\n\
+    };\n\
+    \n\
+    layout(std430, binding = 0) readonly  buffer object_buffer      { cull_object  objects[];      };\n\
+    layout(std430, binding = 1) writeonly buffer command_buffer     { draw_command commands[];     };\n\
+    layout(std430, binding = 2) writeonly buffer instance_id_buffer { uint         instance_ids[]; };\n\
+    \n\
+    layout(binding = 0, offset = 0) uniform atomic_uint visible_count;\n\
+    \n\
+    uniform uint object_count;\n\
+    uniform vec4 frustum_planes[6];\n\
+    \n\
+    void main()\n\
+    {\n\
+        uint o = gl_GlobalInvocationID.x;\n\
+        if (o >= object_count) {\n\
+            return;\n\
+        }\n\
+        \n\
+        // world space center and extent of the transformed bounding box\n\
+        mat4 t = objects[o].transform;\n\
+        vec3 c = (objects[o].bbox_max.xyz + objects[o].bbox_min.xyz) * 0.5;\n\
+        vec3 e = (objects[o].bbox_max.xyz - objects[o].bbox_min.xyz) * 0.5;\n\
+        \n\
+        vec3 wc = (t * vec4(c, 1.0)).xyz;\n\
+        vec3 we = abs(t[0].xyz) * e.x + abs(t[1].xyz) * e.y + abs(t[2].xyz) * e.z;\n\
+        \n\
+        // plane normals point inside the frustum, outside if the\n\
+        // positive vertex lies behind any of the planes\n\
+        for (int p = 0; p < 6; ++p) {\n\
+            vec4 pl = frustum_planes[p];\n\
+            if (dot(pl.xyz, wc) + dot(abs(pl.xyz), we) + pl.w < 0.0) {\n\
+                return;\n\
+            }\n\
+        }\n\
+        \n\
+        uint  k = atomicCounterIncrement(visible_count);\n\
+        ivec4 d = objects[o].draw;\n\
+        \n\
+        commands[k]     = draw_command(uint(d.x), 1u, uint(d.y), d.z, k);\n\
+        instance_ids[k] = o;\n\
+    }\n\
+    ";
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+gpu_frustum_culler::gpu_frustum_culler(const render_device_ptr& in_device,
+                                       unsigned                 in_max_objects)
+  : _max_objects(in_max_objects)
+  , _object_count(0)
+{
+    using boost::assign::list_of;
+
+    if (SCM_GL_CORE_OPENGL_CORE_VERSION < SCM_GL_CORE_OPENGL_CORE_VERSION_430) {
+        throw std::runtime_error("gpu_frustum_culler::gpu_frustum_culler(): "
+                                 "requires scm_gl_core with OpenGL4.3 capabilities enabled.");
+    }
+    if (_max_objects < 1) {
+        throw std::runtime_error("gpu_frustum_culler::gpu_frustum_culler(): invalid maximum object count.");
+    }
+
+    _cull_program = in_device->create_program(list_of(in_device->create_shader(STAGE_COMPUTE_SHADER, cull_c_source)),
+                                              "gpu_frustum_culler::cull_program");
+
+    if (!_cull_program) {
+        throw std::runtime_error("gpu_frustum_culler::gpu_frustum_culler(): error creating culling program.");
+    }
+
+    const scm::size_t max_obj = _max_objects;
+
+    _object_buffer        = in_device->create_buffer(BIND_STORAGE_BUFFER,        USAGE_DYNAMIC_DRAW, max_obj * sizeof(cull_object));
+    _draw_command_buffer  = in_device->create_buffer(BIND_DRAW_INDIRECT_BUFFER,  USAGE_DYNAMIC_COPY, max_obj * sizeof(render_context::draw_elements_indirect_command));
+    _instance_id_buffer   = in_device->create_buffer(BIND_STORAGE_BUFFER,        USAGE_DYNAMIC_COPY, max_obj * sizeof(unsigned));
+    _visible_count_buffer = in_device->create_buffer(BIND_ATOMIC_COUNTER_BUFFER, USAGE_DYNAMIC_COPY, sizeof(unsigned));
+
+    if (   !_object_buffer
+        || !_draw_command_buffer
+        || !_instance_id_buffer
+        || !_visible_count_buffer) {
+        throw std::runtime_error("gpu_frustum_culler::gpu_frustum_culler(): error creating culling buffers.");
+    }
+}
+
+gpu_frustum_culler::~gpu_frustum_culler()
+{
+    _cull_program.reset();
+
+    _object_buffer.reset();
+    _draw_command_buffer.reset();
+    _instance_id_buffer.reset();
+    _visible_count_buffer.reset();
+}
+
+bool
+gpu_frustum_culler::set_objects(const render_context_ptr& in_context,
+                                const cull_object*        in_objects,
+                                unsigned                  in_object_count)
+{
+    _object_count = 0;
+
+    if (in_object_count < 1) {
+        return true;
+    }
+    if (!update_objects(in_context, 0, in_object_count, in_objects)) {
+        return false;
+    }
+
+    _object_count = in_object_count;
+
+    return true;
+}
+
+bool
+gpu_frustum_culler::update_objects(const render_context_ptr& in_context,
+                                   unsigned                  in_first_object,
+                                   unsigned                  in_object_count,
+                                   const cull_object*        in_objects)
+{
+    if (   !in_objects
+        || in_first_object + in_object_count > _max_objects) {
+        glerr() << log::error
+                << "gpu_frustum_culler::update_objects(): "
+                << "invalid object range (max objects: " << _max_objects << ")." << log::end;
+        return false;
+    }
+
+    const scm::size_t offset = in_first_object * sizeof(cull_object);
+    const scm::size_t size   = in_object_count * sizeof(cull_object);
+
+    void* data = in_context->map_buffer_range(_object_buffer, offset, size, ACCESS_WRITE_INVALIDATE_RANGE);
+    if (!data) {
+        glerr() << log::error
+                << "gpu_frustum_culler::update_objects(): error mapping object buffer." << log::end;
+        return false;
+    }
+    memcpy(data, in_objects, size);
+    in_context->unmap_buffer(_object_buffer);
+
+    return true;
+}
+
+void
+gpu_frustum_culler::cull(const render_context_ptr& in_context,
+                         const frustumf&           in_frustum)
+{
+#if SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_430
+    const unsigned zero = 0u;
+
+    // everything behind the compacted commands draws nothing
+    in_context->clear_buffer_data(_draw_command_buffer,  FORMAT_R_32UI, &zero);
+    in_context->clear_buffer_data(_visible_count_buffer, FORMAT_R_32UI, &zero);
+
+    if (_object_count < 1) {
+        return;
+    }
+
+    context_program_guard                 cpg(in_context);
+    context_storage_buffer_guard          csbg(in_context);
+    context_atomic_counter_buffer_guard   cacg(in_context);
+
+    _cull_program->uniform("object_count", _object_count);
+    for (unsigned p = 0; p < 6; ++p) {
+        _cull_program->uniform("frustum_planes", p, in_frustum.get_plane(p).vector());
+    }
+
+    in_context->bind_program(_cull_program);
+    in_context->bind_storage_buffer(_object_buffer,       0);
+    in_context->bind_storage_buffer(_draw_command_buffer, 1);
+    in_context->bind_storage_buffer(_instance_id_buffer,  2);
+    in_context->bind_atomic_counter_buffer(_visible_count_buffer, 0);
+    in_context->apply();
+
+    in_context->dispatch_compute(math::vec3ui((_object_count + cull_group_size - 1) / cull_group_size, 1, 1));
+
+    in_context->memory_barrier(  BARRIER_COMMAND
+                               | BARRIER_VERTEX_ATTRIB_ARRAY
+                               | BARRIER_SHADER_STORAGE
+                               | BARRIER_ATOMIC_COUNTER);
+#endif // SCM_GL_CORE_OPENGL_CORE_VERSION >= SCM_GL_CORE_OPENGL_CORE_VERSION_430
+}
+
+void
+gpu_frustum_culler::draw(const render_context_ptr& in_context) const
+{
+    if (_object_count < 1) {
+        return;
+    }
+
+    context_vertex_input_guard cvg(in_context);
+
+    in_context->bind_draw_indirect_buffer(_draw_command_buffer);
+    in_context->apply();
+
+    in_context->multi_draw_elements_indirect(0, static_cast<int>(_object_count));
+}
+
+unsigned
+gpu_frustum_culler::read_visible_count(const render_context_ptr& in_context) const
+{
+    unsigned visible_count = 0u;
+
+    if (!in_context->get_buffer_sub_data(_visible_count_buffer, 0, sizeof(unsigned), &visible_count)) {
+        glerr() << log::error
+                << "gpu_frustum_culler::read_visible_count(): error reading visible count." << log::end;
+        return 0u;
+    }
+
+    return visible_count;
+}
+
+unsigned
+gpu_frustum_culler::max_objects() const
+{
+    return _max_objects;
+}
+
+unsigned
+gpu_frustum_culler::object_count() const
+{
+    return _object_count;
+}
+
+const buffer_ptr&
+gpu_frustum_culler::object_buffer() const
+{
+    return _object_buffer;
+}
+
+const buffer_ptr&
+gpu_frustum_culler::draw_command_buffer() const
+{
+    return _draw_command_buffer;
+}
+
+const buffer_ptr&
+gpu_frustum_culler::instance_id_buffer() const
+{
+    return _instance_id_buffer;
+}
+
+const buffer_ptr&
+gpu_frustum_culler::visible_count_buffer() const
+{
+    return _visible_count_buffer;
+}
+
+} // namespace gl
+} // namespace scm
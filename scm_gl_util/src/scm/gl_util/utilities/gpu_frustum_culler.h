@@ -0,0 +1,103 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_GPU_FRUSTUM_CULLER_H_INCLUDED
+#define SCM_GL_UTIL_GPU_FRUSTUM_CULLER_H_INCLUDED
+
+#include <scm/core/math.h>
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/buffer_objects/buffer_objects_fwd.h>
+#include <scm/gl_core/primitives/primitives_fwd.h>
+#include <scm/gl_core/render_device/render_device_fwd.h>
+#include <scm/gl_core/shader_objects/shader_objects_fwd.h>
+
+#include <scm/gl_util/utilities/utilities_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// frustum culling and draw command compaction in a compute pass
+//  - the object buffer holds one cull_object per scene object: the object space
+//    bounding box, the object transform and the index range of its geometry
+//  - cull() tests all objects against the frustum planes on the gpu and appends a
+//    draw_elements_indirect_command for each visible object to the draw command
+//    buffer, the base instance of command k is k and entry k of the instance id
+//    buffer holds the index of the object drawn by it
+//  - draw() issues all commands with a single multi draw indirect call, the
+//    unused tail of the command buffer is cleared to empty draws, so the cpu
+//    work per frame is independent of the number of objects
+//  - the vertex shader finds its object by reading the instance id buffer as
+//    shader storage buffer at gl_BaseInstanceARB (ARB_shader_draw_parameters)
+//  - requires OpenGL4.3 capabilities (compute shaders, multi draw indirect)
+class __scm_export(gl_util) gpu_frustum_culler
+{
+public:
+    // std430 layout of the culling shader object buffer
+    struct cull_object {
+        math::vec3f             _bbox_min;      // object space
+        float                   _pad0;
+        math::vec3f             _bbox_max;
+        float                   _pad1;
+        math::mat4f             _transform;     // object to world space
+        unsigned                _index_count;
+        unsigned                _first_index;
+        int                     _base_vertex;
+        unsigned                _pad2;
+    }; // struct cull_object
+
+public:
+    gpu_frustum_culler(const render_device_ptr& in_device,
+                       unsigned                 in_max_objects);
+    virtual ~gpu_frustum_culler();
+
+    bool                        set_objects(const render_context_ptr& in_context,
+                                            const cull_object*        in_objects,
+                                            unsigned                  in_object_count);
+    bool                        update_objects(const render_context_ptr& in_context,
+                                               unsigned                  in_first_object,
+                                               unsigned                  in_object_count,
+                                               const cull_object*        in_objects);
+
+    // in_frustum in world space, e.g. camera::view_frustum()
+    void                        cull(const render_context_ptr& in_context,
+                                     const frustumf&           in_frustum);
+    // draws the visible objects using the vertex array, index buffer and
+    // program currently bound to in_context
+    void                        draw(const render_context_ptr& in_context) const;
+
+    // reads back the number of visible objects of the last cull() (stalls the pipeline)
+    unsigned                    read_visible_count(const render_context_ptr& in_context) const;
+
+    unsigned                    max_objects() const;
+    unsigned                    object_count() const;
+
+    const buffer_ptr&           object_buffer() const;
+    const buffer_ptr&           draw_command_buffer() const;
+    const buffer_ptr&           instance_id_buffer() const;
+    const buffer_ptr&           visible_count_buffer() const;
+
+protected:
+    unsigned                    _max_objects;
+    unsigned                    _object_count;
+
+    program_ptr                 _cull_program;
+
+    buffer_ptr                  _object_buffer;
+    buffer_ptr                  _draw_command_buffer;
+    buffer_ptr                  _instance_id_buffer;
+    buffer_ptr                  _visible_count_buffer;
+
+}; // class gpu_frustum_culler
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_GPU_FRUSTUM_CULLER_H_INCLUDED
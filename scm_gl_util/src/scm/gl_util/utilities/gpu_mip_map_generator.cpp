@@ -0,0 +1,315 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "gpu_mip_map_generator.h"
+
+#include <exception>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+
+#include <boost/assign/list_of.hpp>
+
+#include <scm/gl_core/config.h>
+#include <scm/gl_core/log.h>
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/shader_objects.h>
+#include <scm/gl_core/texture_objects.h>
+#include <scm/gl_core/render_device/context_guards.h>
+
+namespace {
+
+// per axis taps of the cpu filter (mip_map_generation.h), the weights are
+// normalized after the sum like in the cpu path
+std::string filter_c_source = "\
+    uniform ivec3 in_src_size;\n\
+    uniform ivec3 in_dst_size;\n\
+    uniform float in_quantize;\n\
+    \n\
+    void taps(int d, int ds, int ss, out ivec3 i, out vec3 w, out float s)\n\
+    {\n\
+        if (ss == 1) {\n\
+            i = ivec3(0);\n\
+            w = vec3(1.0, 0.0, 0.0);\n\
+            s = 1.0;\n\
+        }\n\
+        else if ((ss & 1) == 0) { // box filter\n\
+            i = ivec3(2 * d, 2 * d + 1, 2 * d + 1);\n\
+            w = vec3(1.0, 1.0, 0.0);\n\
+            s = 0.5;\n\
+        }\n\
+        else { // polyphase box filter\n\
+            i = ivec3(2 * d, 2 * d + 1, 2 * d + 2);\n\
+            w = vec3(float(ds - d), float(ds), float(1 + d));\n\
+            s = 1.0 / (2.0 * float(ds) + 1.0);\n\
+        }\n\
+    }\n\
+    \n\
+    void main()\n\
+    {\n\
+        ivec3 d = ivec3(gl_GlobalInvocationID);\n\
+        if (any(greaterThanEqual(d, in_dst_size))) {\n\
+            return;\n\
+        }\n\
+        \n\
+        ivec3 ix, iy, iz;\n\
+        vec3  wx, wy, wz;\n\
+        float sx, sy, sz;\n\
+        \n\
+        taps(d.x, in_dst_size.x, in_src_size.x, ix, wx, sx);\n\
+        taps(d.y, in_dst_size.y, in_src_size.y, iy, wy, sy);\n\
+    #if FILTER_Z == 1\n\
+        taps(d.z, in_dst_size.z, in_src_size.z, iz, wz, sz);\n\
+    #else\n\
+        iz = ivec3(d.z);\n\
+        wz = vec3(1.0, 0.0, 0.0);\n\
+        sz = 1.0;\n\
+    #endif\n\
+        \n\
+        vec4 rz = vec4(0.0);\n\
+        for (int k = 0; k < 3; ++k) {\n\
+            if (wz[k] == 0.0) continue;\n\
+            vec4 ry = vec4(0.0);\n\
+            for (int j = 0; j < 3; ++j) {\n\
+                if (wy[j] == 0.0) continue;\n\
+                vec4 rx = vec4(0.0);\n\
+                for (int i = 0; i < 3; ++i) {\n\
+                    if (wx[i] == 0.0) continue;\n\
+                    rx += wx[i] * load(ivec3(ix[i], iy[j], iz[k]));\n\
+                }\n\
+                ry += wy[j] * (rx * sx);\n\
+            }\n\
+            rz += wz[k] * (ry * sy);\n\
+        }\n\
+        rz *= sz;\n\
+        \n\
+        // the cpu path truncates to the integer range of normalized formats\n\
+        if (in_quantize > 0.0) {\n\
+            rz = floor(rz * in_quantize + 1.0 / 1024.0) / in_quantize;\n\
+        }\n\
+        store(d, rz);\n\
+    }\n\
+    ";
+
+const char*
+image_format_qualifier(scm::gl::data_format f)
+{
+    using namespace scm::gl;
+
+    switch (f) {
+        case FORMAT_R_8:        return "r8";
+        case FORMAT_RG_8:       return "rg8";
+        case FORMAT_RGBA_8:     return "rgba8";
+        case FORMAT_R_16:       return "r16";
+        case FORMAT_RG_16:      return "rg16";
+        case FORMAT_RGBA_16:    return "rgba16";
+        case FORMAT_R_16F:      return "r16f";
+        case FORMAT_RG_16F:     return "rg16f";
+        case FORMAT_RGBA_16F:   return "rgba16f";
+        case FORMAT_R_32F:      return "r32f";
+        case FORMAT_RG_32F:     return "rg32f";
+        case FORMAT_RGBA_32F:   return "rgba32f";
+        default:                return 0;
+    }
+}
+
+float
+quantization_range(scm::gl::data_format f)
+{
+    using namespace scm::gl;
+
+    switch (f) {
+        case FORMAT_R_8:
+        case FORMAT_RG_8:
+        case FORMAT_RGBA_8:     return 255.0f;
+        case FORMAT_R_16:
+        case FORMAT_RG_16:
+        case FORMAT_RGBA_16:    return 65535.0f;
+        default:                return 0.0f;
+    }
+}
+
+const scm::math::vec3ui group_size_2d = scm::math::vec3ui(8, 8, 1);
+const scm::math::vec3ui group_size_3d = scm::math::vec3ui(4, 4, 4);
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+gpu_mip_map_generator::gpu_mip_map_generator()
+{
+    if (SCM_GL_CORE_OPENGL_CORE_VERSION < SCM_GL_CORE_OPENGL_CORE_VERSION_430) {
+        throw std::runtime_error("gpu_mip_map_generator::gpu_mip_map_generator(): "
+                                 "requires scm_gl_core with OpenGL4.3 capabilities enabled.");
+    }
+}
+
+gpu_mip_map_generator::~gpu_mip_map_generator()
+{
+    _filter_programs.clear();
+}
+
+bool
+gpu_mip_map_generator::is_supported_format(data_format in_format)
+{
+    return 0 != image_format_qualifier(in_format);
+}
+
+bool
+gpu_mip_map_generator::generate_mipmaps(const render_context_ptr& in_context,
+                                        const texture_2d_ptr&     in_texture,
+                                        unsigned                  in_base_level)
+{
+    if (!in_texture) {
+        glerr() << log::error << "gpu_mip_map_generator::generate_mipmaps(): invalid texture." << log::end;
+        return false;
+    }
+    const texture_2d_desc& desc = in_texture->descriptor();
+
+    return generate(in_context, in_texture, desc._array_layers > 1 ? image_2d_array : image_2d, desc._format,
+                    math::vec3ui(desc._size, desc._array_layers), desc._mip_levels, in_base_level);
+}
+
+bool
+gpu_mip_map_generator::generate_mipmaps(const render_context_ptr& in_context,
+                                        const texture_3d_ptr&     in_texture,
+                                        unsigned                  in_base_level)
+{
+    if (!in_texture) {
+        glerr() << log::error << "gpu_mip_map_generator::generate_mipmaps(): invalid texture." << log::end;
+        return false;
+    }
+    const texture_3d_desc& desc = in_texture->descriptor();
+
+    return generate(in_context, in_texture, image_3d, desc._format,
+                    desc._size, desc._mip_levels, in_base_level);
+}
+
+bool
+gpu_mip_map_generator::generate(const render_context_ptr& in_context,
+                                const texture_ptr&        in_texture,
+                                image_type                in_type,
+                                data_format               in_format,
+                                const math::vec3ui&       in_size,
+                                unsigned                  in_mip_levels,
+                                unsigned                  in_base_level)
+{
+    using namespace scm::math;
+
+    if (!is_supported_format(in_format)) {
+        glerr() << log::error
+                << "gpu_mip_map_generator::generate(): unsupported texture format (" << format_string(in_format) << ")." << log::end;
+        return false;
+    }
+    if (in_base_level + 1 >= in_mip_levels) {
+        return true; // nothing to do
+    }
+
+    const program_ptr& prog = filter_program(in_context->parent_device(), in_type, in_format);
+    if (!prog) {
+        return false;
+    }
+
+    context_program_guard       cpg(in_context);
+    context_image_units_guard   ciug(in_context);
+
+    const bool   filter_z   = in_type == image_3d;
+    const vec3ui group_size = filter_z ? group_size_3d : group_size_2d;
+
+    prog->uniform("in_quantize", quantization_range(in_format));
+    in_context->bind_program(prog);
+
+    for (unsigned l = in_base_level + 1; l < in_mip_levels; ++l) {
+        // layers of 2d arrays are not reduced
+        const vec3ui src_size = filter_z ? util::mip_level_dimensions(in_size, l - 1)
+                                         : vec3ui(util::mip_level_dimensions(vec2ui(in_size), l - 1), in_size.z);
+        const vec3ui dst_size = filter_z ? util::mip_level_dimensions(in_size, l)
+                                         : vec3ui(util::mip_level_dimensions(vec2ui(in_size), l), in_size.z);
+
+        prog->uniform("in_src_size", vec3i(src_size));
+        prog->uniform("in_dst_size", vec3i(dst_size));
+
+        // a layer index >= 0 binds all layers of arrays and 3d textures
+        in_context->bind_image(in_texture, in_format, ACCESS_READ_ONLY,  0, l - 1, 0);
+        in_context->bind_image(in_texture, in_format, ACCESS_WRITE_ONLY, 1, l,     0);
+        in_context->apply();
+
+        in_context->dispatch_compute((dst_size + group_size - vec3ui(1u)) / group_size);
+
+        // the next level reads the results of this one
+        in_context->memory_barrier(BARRIER_SHADER_IMAGE_ACCESS);
+    }
+
+    in_context->memory_barrier(  BARRIER_TEXTURE_FETCH
+                               | BARRIER_TEXTURE_UPDATE
+                               | BARRIER_FRAMEBUFFER);
+
+    return true;
+}
+
+const program_ptr&
+gpu_mip_map_generator::filter_program(render_device& in_device,
+                                      image_type     in_type,
+                                      data_format    in_format)
+{
+    using boost::assign::list_of;
+
+    static const program_ptr null_program;
+
+    const program_key     key(in_type, in_format);
+    program_map::iterator p = _filter_programs.find(key);
+
+    if (p != _filter_programs.end()) {
+        return p->second;
+    }
+
+    const char*         fq = image_format_qualifier(in_format);
+    std::ostringstream  s;
+
+    s << "#version 430 core\n"
+      << "\n";
+    switch (in_type) {
+        case image_2d:
+            s << "#define FILTER_Z 0\n"
+              << "layout(local_size_x = " << group_size_2d.x << ", local_size_y = " << group_size_2d.y << ") in;\n"
+              << "layout(binding = 0, " << fq << ") readonly  uniform image2D in_src;\n"
+              << "layout(binding = 1, " << fq << ") writeonly uniform image2D in_dst;\n"
+              << "vec4 load(ivec3 c)          { return imageLoad(in_src, c.xy); }\n"
+              << "void store(ivec3 c, vec4 v) { imageStore(in_dst, c.xy, v); }\n";
+            break;
+        case image_2d_array:
+            s << "#define FILTER_Z 0\n"
+              << "layout(local_size_x = " << group_size_2d.x << ", local_size_y = " << group_size_2d.y << ") in;\n"
+              << "layout(binding = 0, " << fq << ") readonly  uniform image2DArray in_src;\n"
+              << "layout(binding = 1, " << fq << ") writeonly uniform image2DArray in_dst;\n"
+              << "vec4 load(ivec3 c)          { return imageLoad(in_src, c); }\n"
+              << "void store(ivec3 c, vec4 v) { imageStore(in_dst, c, v); }\n";
+            break;
+        case image_3d:
+            s << "#define FILTER_Z 1\n"
+              << "layout(local_size_x = " << group_size_3d.x << ", local_size_y = " << group_size_3d.y
+                                         << ", local_size_z = " << group_size_3d.z << ") in;\n"
+              << "layout(binding = 0, " << fq << ") readonly  uniform image3D in_src;\n"
+              << "layout(binding = 1, " << fq << ") writeonly uniform image3D in_dst;\n"
+              << "vec4 load(ivec3 c)          { return imageLoad(in_src, c); }\n"
+              << "void store(ivec3 c, vec4 v) { imageStore(in_dst, c, v); }\n";
+            break;
+    }
+    s << filter_c_source;
+
+    program_ptr prog = in_device.create_program(list_of(in_device.create_shader(STAGE_COMPUTE_SHADER, s.str())),
+                                                std::string("gpu_mip_map_generator::filter_program_") + fq);
+    if (!prog) {
+        glerr() << log::error
+                << "gpu_mip_map_generator::filter_program(): error creating filter program "
+                << "(format: " << format_string(in_format) << ")." << log::end;
+        return null_program;
+    }
+
+    return _filter_programs[key] = prog;
+}
+
+} // namespace gl
+} // namespace scm
@@ -0,0 +1,91 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_GPU_MIP_MAP_GENERATOR_H_INCLUDED
+#define SCM_GL_UTIL_GPU_MIP_MAP_GENERATOR_H_INCLUDED
+
+#include <map>
+#include <utility>
+
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/math.h>
+#include <scm/core/memory.h>
+
+#include <scm/gl_core/data_formats.h>
+#include <scm/gl_core/render_device/render_device_fwd.h>
+#include <scm/gl_core/shader_objects/shader_objects_fwd.h>
+#include <scm/gl_core/texture_objects/texture_objects_fwd.h>
+
+#include <scm/gl_util/utilities/utilities_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// mip-map generation in compute passes
+//  - uses the same filter as util::generate_mipmaps: a 2 texel box filter for
+//    even source sizes and the 3 texel polyphase box filter for odd source
+//    sizes (separable, applied per axis), unlike the implementation defined
+//    filter of render_context::generate_mipmaps
+//  - 8 and 16 bit normalized results are truncated like the cpu path, results
+//    can differ by one unit from the cpu path through rounding of the float
+//    intermediates
+//  - each level is computed from the previous one in a single dispatch,
+//    levels above in_base_level are overwritten
+//  - formats: r, rg and rgba in 8 and 16 bit normalized, 16 and 32 bit float,
+//    rgb formats are not supported by image load/store
+//  - 2d texture arrays are filtered per layer
+//  - programs are compiled on first use per format and texture type on the
+//    device of the context passed in
+//  - requires OpenGL4.3 capabilities (compute shaders)
+class __scm_export(gl_util) gpu_mip_map_generator : boost::noncopyable
+{
+protected:
+    typedef enum {
+        image_2d        = 0x00,
+        image_2d_array,
+        image_3d
+    } image_type;
+    typedef std::pair<image_type, data_format>      program_key;
+    typedef std::map<program_key, program_ptr>      program_map;
+
+public:
+    gpu_mip_map_generator();
+    virtual ~gpu_mip_map_generator();
+
+    static bool                 is_supported_format(data_format in_format);
+
+    bool                        generate_mipmaps(const render_context_ptr& in_context,
+                                                 const texture_2d_ptr&     in_texture,
+                                                 unsigned                  in_base_level = 0);
+    bool                        generate_mipmaps(const render_context_ptr& in_context,
+                                                 const texture_3d_ptr&     in_texture,
+                                                 unsigned                  in_base_level = 0);
+
+protected:
+    bool                        generate(const render_context_ptr& in_context,
+                                         const texture_ptr&        in_texture,
+                                         image_type                in_type,
+                                         data_format               in_format,
+                                         const math::vec3ui&       in_size,
+                                         unsigned                  in_mip_levels,
+                                         unsigned                  in_base_level);
+    const program_ptr&          filter_program(render_device& in_device,
+                                               image_type     in_type,
+                                               data_format    in_format);
+
+protected:
+    program_map                 _filter_programs;
+
+}; // class gpu_mip_map_generator
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_GPU_MIP_MAP_GENERATOR_H_INCLUDED
@@ -0,0 +1,547 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "render_queue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#include <boost/functional/hash.hpp>
+
+#include <scm/gl_core/buffer_objects.h>
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/shader_objects.h>
+#include <scm/gl_core/state_objects.h>
+#include <scm/gl_core/texture_objects.h>
+
+namespace {
+
+const unsigned      id_bits        = 12;
+const unsigned      max_id         = (1u << id_bits) - 1;
+const unsigned      depth_bits     = 16;
+const unsigned      radix_bits     = 8;
+const unsigned      radix_buckets  = 1u << radix_bits;
+const unsigned      radix_passes   = 64 / radix_bits;
+
+template<typename T>
+inline std::size_t
+ptr_value(const scm::shared_ptr<T>& p)
+{
+    return reinterpret_cast<std::size_t>(p.get());
+}
+
+// positive ieee floats order like their bit patterns, the upper 16bit keep
+// the sign, exponent and 7bit of the mantissa
+inline scm::uint64
+quantize_depth(float d)
+{
+    if (!(d > 0.0f)) {
+        return 0;
+    }
+    scm::uint32 b;
+    std::memcpy(&b, &d, sizeof(scm::uint32));
+    return static_cast<scm::uint64>(b >> (32 - depth_bits));
+}
+
+inline bool
+program_differs(const scm::gl::render_queue::draw_item& a,
+                const scm::gl::render_queue::draw_item& b)
+{
+    return a._program != b._program;
+}
+
+inline bool
+depth_stencil_differs(const scm::gl::render_queue::draw_item& a,
+                      const scm::gl::render_queue::draw_item& b)
+{
+    return    a._depth_stencil_state != b._depth_stencil_state
+           || a._stencil_ref         != b._stencil_ref;
+}
+
+inline bool
+rasterizer_differs(const scm::gl::render_queue::draw_item& a,
+                   const scm::gl::render_queue::draw_item& b)
+{
+    return    a._rasterizer_state != b._rasterizer_state
+           || a._line_width       != b._line_width
+           || a._point_size       != b._point_size;
+}
+
+inline bool
+blend_differs(const scm::gl::render_queue::draw_item& a,
+              const scm::gl::render_queue::draw_item& b)
+{
+    return    a._blend_state != b._blend_state
+           || a._blend_color != b._blend_color;
+}
+
+inline bool
+vertex_array_differs(const scm::gl::render_queue::draw_item& a,
+                     const scm::gl::render_queue::draw_item& b)
+{
+    return a._vertex_array != b._vertex_array;
+}
+
+inline bool
+index_buffer_differs(const scm::gl::render_queue::draw_item& a,
+                     const scm::gl::render_queue::draw_item& b)
+{
+    return    a._index_buffer != b._index_buffer
+           || a._index_type   != b._index_type
+           || a._index_offset != b._index_offset
+           || a._topology     != b._topology;
+}
+
+inline bool
+texture_binding_differs(const scm::gl::render_queue::texture_binding* a,
+                        const scm::gl::render_queue::texture_binding& b)
+{
+    return    0 == a
+           || a->_texture != b._texture
+           || a->_sampler != b._sampler;
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+render_queue::texture_binding::texture_binding()
+  : _unit(0)
+{
+}
+
+render_queue::texture_binding::texture_binding(const texture_ptr&       in_texture,
+                                               const sampler_state_ptr& in_sampler,
+                                               unsigned                 in_unit)
+  : _texture(in_texture)
+  , _sampler(in_sampler)
+  , _unit(in_unit)
+{
+}
+
+render_queue::draw_item::draw_item()
+  : _stencil_ref(0)
+  , _line_width(1.0f)
+  , _point_size(1.0f)
+  , _blend_color(1.0f, 1.0f, 1.0f, 1.0f)
+  , _index_type(TYPE_UINT)
+  , _index_offset(0)
+  , _topology(PRIMITIVE_TRIANGLE_LIST)
+  , _first(0)
+  , _count(0)
+  , _base_vertex(0)
+  , _instance_count(1)
+  , _depth(0.0f)
+{
+}
+
+render_queue::frame_statistics::frame_statistics()
+  : _draw_items(0)
+  , _program_changes(0)
+  , _state_changes(0)
+  , _texture_changes(0)
+  , _vertex_input_changes(0)
+  , _unsorted_program_changes(0)
+  , _unsorted_state_changes(0)
+  , _unsorted_texture_changes(0)
+  , _unsorted_vertex_input_changes(0)
+{
+}
+
+unsigned
+render_queue::frame_statistics::program_changes_saved() const
+{
+    return _unsorted_program_changes > _program_changes ? _unsorted_program_changes - _program_changes : 0;
+}
+
+unsigned
+render_queue::frame_statistics::state_changes_saved() const
+{
+    return _unsorted_state_changes > _state_changes ? _unsorted_state_changes - _state_changes : 0;
+}
+
+unsigned
+render_queue::frame_statistics::texture_changes_saved() const
+{
+    return _unsorted_texture_changes > _texture_changes ? _unsorted_texture_changes - _texture_changes : 0;
+}
+
+unsigned
+render_queue::frame_statistics::vertex_input_changes_saved() const
+{
+    return _unsorted_vertex_input_changes > _vertex_input_changes ? _unsorted_vertex_input_changes - _vertex_input_changes : 0;
+}
+
+unsigned
+render_queue::frame_statistics::total_changes() const
+{
+    return _program_changes + _state_changes + _texture_changes + _vertex_input_changes;
+}
+
+unsigned
+render_queue::frame_statistics::total_changes_saved() const
+{
+    unsigned unsorted =   _unsorted_program_changes + _unsorted_state_changes
+                        + _unsorted_texture_changes + _unsorted_vertex_input_changes;
+    return unsorted > total_changes() ? unsorted - total_changes() : 0;
+}
+
+render_queue::render_queue(sort_mode in_sort_mode)
+  : _sort_mode(in_sort_mode)
+  , _sorted(false)
+{
+}
+
+render_queue::~render_queue()
+{
+}
+
+render_queue::sort_mode
+render_queue::mode() const
+{
+    return _sort_mode;
+}
+
+void
+render_queue::mode(sort_mode in_sort_mode)
+{
+    if (_sort_mode != in_sort_mode) {
+        _sort_mode = in_sort_mode;
+        _sorted    = false;
+    }
+}
+
+void
+render_queue::clear()
+{
+    _items.clear();
+    _item_entries.clear();
+    _textures.clear();
+
+    _program_ids.clear();
+    _state_ids.clear();
+    _texture_ids.clear();
+    _vertex_input_ids.clear();
+
+    _sort_entries.clear();
+    _sorted_order.clear();
+    _sorted     = false;
+    _statistics = frame_statistics();
+}
+
+unsigned
+render_queue::push(const draw_item& in_item)
+{
+    return push(in_item, 0, 0);
+}
+
+unsigned
+render_queue::push(const draw_item&       in_item,
+                   const texture_binding* in_textures,
+                   unsigned               in_texture_count)
+{
+    item_entry e;
+
+    e._texture_offset = static_cast<unsigned>(_textures.size());
+    e._texture_count  = in_texture_count;
+
+    std::size_t texture_hash = 0;
+    for (unsigned t = 0; t < in_texture_count; ++t) {
+        _textures.push_back(in_textures[t]);
+        boost::hash_combine(texture_hash, ptr_value(in_textures[t]._texture));
+        boost::hash_combine(texture_hash, ptr_value(in_textures[t]._sampler));
+        boost::hash_combine(texture_hash, in_textures[t]._unit);
+    }
+
+    std::size_t state_hash = 0;
+    boost::hash_combine(state_hash, ptr_value(in_item._depth_stencil_state));
+    boost::hash_combine(state_hash, in_item._stencil_ref);
+    boost::hash_combine(state_hash, ptr_value(in_item._rasterizer_state));
+    boost::hash_combine(state_hash, in_item._line_width);
+    boost::hash_combine(state_hash, in_item._point_size);
+    boost::hash_combine(state_hash, ptr_value(in_item._blend_state));
+    for (unsigned c = 0; c < 4; ++c) {
+        boost::hash_combine(state_hash, in_item._blend_color[c]);
+    }
+
+    std::size_t vertex_input_hash = 0;
+    boost::hash_combine(vertex_input_hash, ptr_value(in_item._vertex_array));
+    boost::hash_combine(vertex_input_hash, ptr_value(in_item._index_buffer));
+    boost::hash_combine(vertex_input_hash, static_cast<int>(in_item._index_type));
+    boost::hash_combine(vertex_input_hash, in_item._index_offset);
+    boost::hash_combine(vertex_input_hash, static_cast<int>(in_item._topology));
+
+    e._program_id      = frame_id(_program_ids,      ptr_value(in_item._program));
+    e._state_id        = frame_id(_state_ids,        state_hash);
+    e._texture_id      = frame_id(_texture_ids,      texture_hash);
+    e._vertex_input_id = frame_id(_vertex_input_ids, vertex_input_hash);
+
+    _items.push_back(in_item);
+    _item_entries.push_back(e);
+    _sorted = false;
+
+    return static_cast<unsigned>(_items.size() - 1);
+}
+
+void
+render_queue::sort()
+{
+    const unsigned item_count = static_cast<unsigned>(_items.size());
+
+    _sort_entries.resize(item_count);
+    _sort_scratch.resize(item_count);
+
+    for (unsigned i = 0; i < item_count; ++i) {
+        _sort_entries[i]._key  = (_sort_mode == sort_none) ? 0 : make_key(i);
+        _sort_entries[i]._item = i;
+    }
+
+    // lsd radix sort, stable so equal keys keep their submission order
+    if (_sort_mode != sort_none && item_count > 1) {
+        unsigned histogram[radix_buckets];
+
+        for (unsigned p = 0; p < radix_passes; ++p) {
+            const unsigned shift = p * radix_bits;
+
+            std::fill(histogram, histogram + radix_buckets, 0u);
+            for (unsigned i = 0; i < item_count; ++i) {
+                ++histogram[(_sort_entries[i]._key >> shift) & (radix_buckets - 1)];
+            }
+            // all keys share this digit
+            if (histogram[(_sort_entries[0]._key >> shift) & (radix_buckets - 1)] == item_count) {
+                continue;
+            }
+            unsigned offset = 0;
+            for (unsigned b = 0; b < radix_buckets; ++b) {
+                unsigned c   = histogram[b];
+                histogram[b] = offset;
+                offset      += c;
+            }
+            for (unsigned i = 0; i < item_count; ++i) {
+                const sort_entry& s = _sort_entries[i];
+                _sort_scratch[histogram[(s._key >> shift) & (radix_buckets - 1)]++] = s;
+            }
+            _sort_entries.swap(_sort_scratch);
+        }
+    }
+
+    _sorted_order.resize(item_count);
+    for (unsigned i = 0; i < item_count; ++i) {
+        _sorted_order[i] = _sort_entries[i]._item;
+    }
+
+    // transitions in submission and in sorted order
+    std::vector<unsigned> unsorted_order(item_count);
+    for (unsigned i = 0; i < item_count; ++i) {
+        unsorted_order[i] = i;
+    }
+
+    _statistics._draw_items = item_count;
+    count_transitions(_sorted_order,
+                      _statistics._program_changes,
+                      _statistics._state_changes,
+                      _statistics._texture_changes,
+                      _statistics._vertex_input_changes);
+    count_transitions(unsorted_order,
+                      _statistics._unsorted_program_changes,
+                      _statistics._unsorted_state_changes,
+                      _statistics._unsorted_texture_changes,
+                      _statistics._unsorted_vertex_input_changes);
+
+    _sorted = true;
+}
+
+void
+render_queue::submit(const render_context_ptr& in_context)
+{
+    if (!_sorted) {
+        sort();
+    }
+    if (_sorted_order.empty()) {
+        return;
+    }
+
+    context_program_guard       cpg(in_context);
+    context_state_objects_guard csg(in_context);
+    context_texture_units_guard ctg(in_context);
+    context_vertex_input_guard  cvg(in_context);
+
+    std::vector<const texture_binding*> bound_units;
+    const draw_item*                    prev_item = 0;
+
+    for (std::size_t o = 0; o < _sorted_order.size(); ++o) {
+        const unsigned    i    = _sorted_order[o];
+        const draw_item&  item = _items[i];
+        const item_entry& e    = _item_entries[i];
+
+        if (0 == prev_item || program_differs(*prev_item, item)) {
+            in_context->bind_program(item._program);
+        }
+        if (0 == prev_item || depth_stencil_differs(*prev_item, item)) {
+            in_context->set_depth_stencil_state(item._depth_stencil_state, item._stencil_ref);
+        }
+        if (0 == prev_item || rasterizer_differs(*prev_item, item)) {
+            in_context->set_rasterizer_state(item._rasterizer_state, item._line_width, item._point_size);
+        }
+        if (0 == prev_item || blend_differs(*prev_item, item)) {
+            in_context->set_blend_state(item._blend_state, item._blend_color);
+        }
+        for (unsigned t = 0; t < e._texture_count; ++t) {
+            const texture_binding& b = _textures[e._texture_offset + t];
+            if (b._unit >= bound_units.size()) {
+                bound_units.resize(b._unit + 1, 0);
+            }
+            if (texture_binding_differs(bound_units[b._unit], b)) {
+                in_context->bind_texture(b._texture, b._sampler, b._unit);
+                bound_units[b._unit] = &b;
+            }
+        }
+        if (0 == prev_item || vertex_array_differs(*prev_item, item)) {
+            in_context->bind_vertex_array(item._vertex_array);
+        }
+        if (0 == prev_item || index_buffer_differs(*prev_item, item)) {
+            in_context->bind_index_buffer(item._index_buffer, item._topology, item._index_type, item._index_offset);
+        }
+
+        if (item._setup) {
+            item._setup(in_context);
+        }
+
+        in_context->apply();
+
+        if (item._index_buffer) {
+            if (item._instance_count > 1) {
+                in_context->draw_elements_instanced(item._count, item._first, item._instance_count, item._base_vertex);
+            }
+            else {
+                in_context->draw_elements(item._count, item._first, item._base_vertex);
+            }
+        }
+        else {
+            if (item._instance_count > 1) {
+                in_context->draw_arrays_instanced(item._topology, item._first, item._count, item._instance_count);
+            }
+            else {
+                in_context->draw_arrays(item._topology, item._first, item._count);
+            }
+        }
+
+        prev_item = &item;
+    }
+}
+
+unsigned
+render_queue::size() const
+{
+    return static_cast<unsigned>(_items.size());
+}
+
+bool
+render_queue::empty() const
+{
+    return _items.empty();
+}
+
+const std::vector<unsigned>&
+render_queue::sorted_order() const
+{
+    return _sorted_order;
+}
+
+scm::uint64
+render_queue::sort_key(unsigned in_item) const
+{
+    assert(in_item < _items.size());
+    return make_key(in_item);
+}
+
+const render_queue::frame_statistics&
+render_queue::statistics() const
+{
+    return _statistics;
+}
+
+unsigned
+render_queue::frame_id(id_map& in_map, scm::uint64 in_value) const
+{
+    id_map::const_iterator i = in_map.find(in_value);
+    if (i != in_map.end()) {
+        return i->second;
+    }
+    // more than 4096 distinct objects per frame share the last id, the
+    // submission stays correct, only the grouping gets coarser
+    unsigned id = (std::min)(static_cast<unsigned>(in_map.size()), max_id);
+    in_map.insert(id_map::value_type(in_value, id));
+    return id;
+}
+
+scm::uint64
+render_queue::make_key(unsigned in_item) const
+{
+    const item_entry& e = _item_entries[in_item];
+    const scm::uint64 d = quantize_depth(_items[in_item]._depth);
+
+    scm::uint64 state_key =   (static_cast<scm::uint64>(e._program_id)      << (3 * id_bits))
+                            | (static_cast<scm::uint64>(e._state_id)        << (2 * id_bits))
+                            | (static_cast<scm::uint64>(e._texture_id)      << (1 * id_bits))
+                            |  static_cast<scm::uint64>(e._vertex_input_id);
+
+    switch (_sort_mode) {
+        case sort_state_order:   return (state_key << depth_bits) | d;
+        case sort_back_to_front: return (((1ull << depth_bits) - 1 - d) << (4 * id_bits)) | state_key;
+        default:                 return 0;
+    }
+}
+
+void
+render_queue::count_transitions(const std::vector<unsigned>& in_order,
+                                unsigned&                    out_program_changes,
+                                unsigned&                    out_state_changes,
+                                unsigned&                    out_texture_changes,
+                                unsigned&                    out_vertex_input_changes) const
+{
+    out_program_changes      = 0;
+    out_state_changes        = 0;
+    out_texture_changes      = 0;
+    out_vertex_input_changes = 0;
+
+    std::vector<const texture_binding*> bound_units;
+    const draw_item*                    prev_item = 0;
+
+    for (std::size_t o = 0; o < in_order.size(); ++o) {
+        const draw_item&  item = _items[in_order[o]];
+        const item_entry& e    = _item_entries[in_order[o]];
+
+        if (0 == prev_item) {
+            out_program_changes      += 1;
+            out_state_changes        += 3;
+            out_vertex_input_changes += 1;
+        }
+        else {
+            out_program_changes      += program_differs(*prev_item, item) ? 1 : 0;
+            out_state_changes        += depth_stencil_differs(*prev_item, item) ? 1 : 0;
+            out_state_changes        += rasterizer_differs(*prev_item, item) ? 1 : 0;
+            out_state_changes        += blend_differs(*prev_item, item) ? 1 : 0;
+            out_vertex_input_changes += (   vertex_array_differs(*prev_item, item)
+                                         || index_buffer_differs(*prev_item, item)) ? 1 : 0;
+        }
+        for (unsigned t = 0; t < e._texture_count; ++t) {
+            const texture_binding& b = _textures[e._texture_offset + t];
+            if (b._unit >= bound_units.size()) {
+                bound_units.resize(b._unit + 1, 0);
+            }
+            if (texture_binding_differs(bound_units[b._unit], b)) {
+                ++out_texture_changes;
+                bound_units[b._unit] = &b;
+            }
+        }
+        prev_item = &item;
+    }
+}
+
+} // namespace gl
+} // namespace scm
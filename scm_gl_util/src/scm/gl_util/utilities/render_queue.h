@@ -0,0 +1,200 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_RENDER_QUEUE_H_INCLUDED
+#define SCM_GL_UTIL_RENDER_QUEUE_H_INCLUDED
+
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <scm/core/math.h>
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/constants.h>
+#include <scm/gl_core/data_types.h>
+#include <scm/gl_core/buffer_objects/buffer_objects_fwd.h>
+#include <scm/gl_core/render_device/render_device_fwd.h>
+#include <scm/gl_core/shader_objects/shader_objects_fwd.h>
+#include <scm/gl_core/state_objects/state_objects_fwd.h>
+#include <scm/gl_core/texture_objects/texture_objects_fwd.h>
+
+#include <scm/gl_util/utilities/utilities_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// sorted submission of draw calls to minimize state transitions
+//  - draw items are collected per frame, each item holds the complete state it
+//    requires (program, state objects, texture bindings, vertex input) and its
+//    draw parameters
+//  - every item gets a 64bit sort key, the program, state object combination,
+//    texture set and vertex input are mapped to per frame ids of 12bit each in
+//    the order of their first appearance, the view depth is quantized to 16bit
+//      sort_state_order:  [program|states|textures|vertex input|depth front to back]
+//      sort_back_to_front:[depth back to front|program|states|textures|vertex input]
+//  - submit() radix sorts the keys and issues only the state that differs from
+//    the previous item through the render_context, the context state in effect
+//    before submit() is restored afterwards
+//  - per item uniforms are set in the optional setup function of an item, it is
+//    called with the item program bound right before the draw call
+class __scm_export(gl_util) render_queue : boost::noncopyable
+{
+public:
+    enum sort_mode {
+        sort_state_order    = 0x00, // opaque geometry, state first, then front to back
+        sort_back_to_front,         // blended geometry, depth first
+        sort_none                   // submission order
+    }; // enum sort_mode
+
+    typedef boost::function<void (const render_context_ptr&)>  setup_func;
+
+    struct texture_binding {
+        texture_binding();
+        texture_binding(const texture_ptr&       in_texture,
+                        const sampler_state_ptr& in_sampler,
+                        unsigned                 in_unit);
+
+        texture_ptr             _texture;
+        sampler_state_ptr       _sampler;
+        unsigned                _unit;
+    }; // struct texture_binding
+
+    struct draw_item {
+        draw_item();
+
+        program_ptr             _program;
+
+        depth_stencil_state_ptr _depth_stencil_state;
+        unsigned                _stencil_ref;
+        rasterizer_state_ptr    _rasterizer_state;
+        float                   _line_width;
+        float                   _point_size;
+        blend_state_ptr         _blend_state;
+        math::vec4f             _blend_color;
+
+        vertex_array_ptr        _vertex_array;
+        buffer_ptr              _index_buffer;  // 0 for draw_arrays
+        data_type               _index_type;
+        scm::size_t             _index_offset;
+
+        primitive_topology      _topology;
+        int                     _first;         // first vertex or first index
+        int                     _count;
+        int                     _base_vertex;
+        int                     _instance_count;// > 1 for instanced draw calls
+
+        float                   _depth;         // view space distance of the item
+        setup_func              _setup;
+    }; // struct draw_item
+
+    struct frame_statistics {
+        frame_statistics();
+
+        unsigned                program_changes_saved() const;
+        unsigned                state_changes_saved() const;
+        unsigned                texture_changes_saved() const;
+        unsigned                vertex_input_changes_saved() const;
+        unsigned                total_changes() const;
+        unsigned                total_changes_saved() const;
+
+        unsigned                _draw_items;
+        // transitions issued in sorted order
+        unsigned                _program_changes;
+        unsigned                _state_changes;         // state object changes
+        unsigned                _texture_changes;       // texture unit bindings
+        unsigned                _vertex_input_changes;  // vertex array and index buffer
+        // transitions the items would have caused in submission order
+        unsigned                _unsorted_program_changes;
+        unsigned                _unsorted_state_changes;
+        unsigned                _unsorted_texture_changes;
+        unsigned                _unsorted_vertex_input_changes;
+    }; // struct frame_statistics
+
+protected:
+    struct item_entry {
+        unsigned                _texture_offset;
+        unsigned                _texture_count;
+        unsigned                _program_id;
+        unsigned                _state_id;
+        unsigned                _texture_id;
+        unsigned                _vertex_input_id;
+    }; // struct item_entry
+    struct sort_entry {
+        scm::uint64             _key;
+        unsigned                _item;
+    }; // struct sort_entry
+
+    typedef boost::unordered_map<scm::uint64, unsigned>    id_map;
+
+public:
+    render_queue(sort_mode in_sort_mode = sort_state_order);
+    virtual ~render_queue();
+
+    sort_mode                   mode() const;
+    void                        mode(sort_mode in_sort_mode);
+
+    // starts a new frame, drops all items
+    void                        clear();
+
+    // returns the index of the item in submission order
+    unsigned                    push(const draw_item&       in_item);
+    unsigned                    push(const draw_item&       in_item,
+                                     const texture_binding* in_textures,
+                                     unsigned               in_texture_count);
+
+    void                        sort();
+    void                        submit(const render_context_ptr& in_context);
+
+    unsigned                    size() const;
+    bool                        empty() const;
+    // item indices in submission order after sort() or submit()
+    const std::vector<unsigned>& sorted_order() const;
+    scm::uint64                 sort_key(unsigned in_item) const;
+
+    const frame_statistics&     statistics() const;
+
+protected:
+    unsigned                    frame_id(id_map& in_map, scm::uint64 in_value) const;
+    scm::uint64                 make_key(unsigned in_item) const;
+
+    void                        count_transitions(const std::vector<unsigned>& in_order,
+                                                  unsigned&                    out_program_changes,
+                                                  unsigned&                    out_state_changes,
+                                                  unsigned&                    out_texture_changes,
+                                                  unsigned&                    out_vertex_input_changes) const;
+
+protected:
+    sort_mode                   _sort_mode;
+
+    std::vector<draw_item>      _items;
+    std::vector<item_entry>     _item_entries;
+    std::vector<texture_binding> _textures;
+
+    id_map                      _program_ids;
+    id_map                      _state_ids;
+    id_map                      _texture_ids;
+    id_map                      _vertex_input_ids;
+
+    std::vector<sort_entry>     _sort_entries;
+    std::vector<sort_entry>     _sort_scratch;
+    std::vector<unsigned>       _sorted_order;
+    bool                        _sorted;
+
+    frame_statistics            _statistics;
+
+}; // class render_queue
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_RENDER_QUEUE_H_INCLUDED
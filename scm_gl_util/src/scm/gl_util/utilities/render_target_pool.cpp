@@ -0,0 +1,349 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "render_target_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include <scm/gl_core/log.h>
+#include <scm/gl_core/frame_buffer_objects.h>
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/texture_objects.h>
+
+namespace {
+
+inline std::size_t
+target_key(const scm::gl::texture_2d_ptr& t)
+{
+    return reinterpret_cast<std::size_t>(t.get());
+}
+
+} // namespace
+
+namespace scm {
+namespace gl {
+
+render_target_pool::target_desc::target_desc(const math::vec2ui& in_size,
+                                             data_format         in_format,
+                                             unsigned            in_samples)
+  : _size(in_size)
+  , _format(in_format)
+  , _samples(in_samples)
+{
+}
+
+bool
+render_target_pool::target_desc::operator==(const target_desc& rhs) const
+{
+    return (   (_size    == rhs._size)
+            && (_format  == rhs._format)
+            && (_samples == rhs._samples));
+}
+
+bool
+render_target_pool::target_desc::operator!=(const target_desc& rhs) const
+{
+    return !(*this == rhs);
+}
+
+render_target_pool::pool_statistics::pool_statistics()
+  : _targets(0)
+  , _targets_in_use(0)
+  , _target_bytes(0)
+  , _frame_buffers(0)
+  , _acquires(0)
+  , _reuses(0)
+  , _allocations(0)
+  , _peak_targets_in_use(0)
+{
+}
+
+render_target_pool::scoped_target::scoped_target(render_target_pool& in_pool,
+                                                 const target_desc&  in_desc)
+  : _pool(in_pool)
+  , _target(in_pool.acquire(in_desc))
+  , _generation(in_pool._generation)
+{
+}
+
+render_target_pool::scoped_target::~scoped_target()
+{
+    if (_target) {
+        _pool.release(_target, _generation);
+    }
+}
+
+const texture_2d_ptr&
+render_target_pool::scoped_target::target() const
+{
+    return _target;
+}
+
+render_target_pool::render_target_pool(const render_device_ptr& in_device,
+                                       unsigned                 in_max_unused_frames)
+  : _render_device(in_device)
+  , _max_unused_frames(in_max_unused_frames)
+  , _frame(0)
+  , _generation(0)
+{
+}
+
+render_target_pool::~render_target_pool()
+{
+    _frame_buffers.clear();
+    _entries.clear();
+}
+
+void
+render_target_pool::begin_frame()
+{
+    ++_frame;
+
+    _statistics._acquires            = 0;
+    _statistics._reuses              = 0;
+    _statistics._allocations         = 0;
+    _statistics._peak_targets_in_use = 0;
+
+    // free targets that were not used for a while, back to front keeps the indices valid
+    for (std::size_t e = _entries.size(); e > 0; --e) {
+        const pool_entry& pe = _entries[e - 1];
+        if (!pe._in_use && (_frame - pe._last_used_frame) > _max_unused_frames) {
+            free_entry(e - 1);
+        }
+    }
+
+    update_statistics();
+}
+
+void
+render_target_pool::end_frame()
+{
+    for (std::size_t e = 0; e < _entries.size(); ++e) {
+        _entries[e]._in_use = false;
+    }
+    ++_generation;
+
+    // drop frame buffers that were not requested for a while
+    frame_buffer_map::iterator f = _frame_buffers.begin();
+    while (f != _frame_buffers.end()) {
+        if ((_frame - f->second._last_used_frame) > _max_unused_frames) {
+            f = _frame_buffers.erase(f);
+        }
+        else {
+            ++f;
+        }
+    }
+
+    update_statistics();
+}
+
+unsigned
+render_target_pool::frame() const
+{
+    return _frame;
+}
+
+texture_2d_ptr
+render_target_pool::acquire(const target_desc& in_desc)
+{
+    ++_statistics._acquires;
+
+    // prefer the most recently used matching target
+    std::size_t match = _entries.size();
+    for (std::size_t e = 0; e < _entries.size(); ++e) {
+        const pool_entry& pe = _entries[e];
+        if (!pe._in_use && pe._desc == in_desc) {
+            if (match == _entries.size() || pe._last_used_frame > _entries[match]._last_used_frame) {
+                match = e;
+            }
+        }
+    }
+
+    if (match < _entries.size()) {
+        ++_statistics._reuses;
+    }
+    else {
+        render_device_ptr device = _render_device.lock();
+        if (!device) {
+            glerr() << log::error << "render_target_pool::acquire(): invalid render device." << log::end;
+            return texture_2d_ptr();
+        }
+        texture_2d_ptr new_target = device->create_texture_2d(in_desc._size, in_desc._format, 1, 1, in_desc._samples);
+        if (!new_target) {
+            glerr() << log::error << "render_target_pool::acquire(): unable to create render target ("
+                    << "size: " << in_desc._size << ", format: " << format_string(in_desc._format)
+                    << ", samples: " << in_desc._samples << ")." << log::end;
+            return texture_2d_ptr();
+        }
+
+        pool_entry pe;
+        pe._texture         = new_target;
+        pe._desc            = in_desc;
+        pe._bytes           =   static_cast<scm::size_t>(in_desc._size.x) * in_desc._size.y
+                              * size_of_format(in_desc._format) * (std::max)(1u, in_desc._samples);
+        pe._in_use          = false;
+        pe._last_used_frame = _frame;
+        pe._generation      = _generation;
+
+        _entries.push_back(pe);
+        match = _entries.size() - 1;
+
+        ++_statistics._allocations;
+    }
+
+    pool_entry& pe = _entries[match];
+    pe._in_use          = true;
+    pe._last_used_frame = _frame;
+    pe._generation      = _generation;
+
+    update_statistics();
+
+    return pe._texture;
+}
+
+texture_2d_ptr
+render_target_pool::acquire(const math::vec2ui& in_size,
+                            data_format         in_format,
+                            unsigned            in_samples)
+{
+    return acquire(target_desc(in_size, in_format, in_samples));
+}
+
+void
+render_target_pool::release(const texture_2d_ptr& in_target)
+{
+    release(in_target, _generation);
+}
+
+frame_buffer_ptr
+render_target_pool::cached_frame_buffer(const texture_2d_ptr* in_color_targets,
+                                        unsigned              in_color_target_count,
+                                        const texture_2d_ptr& in_depth_stencil_target)
+{
+    attachment_key key(in_color_target_count + 1);
+    for (unsigned c = 0; c < in_color_target_count; ++c) {
+        key[c] = target_key(in_color_targets[c]);
+    }
+    key[in_color_target_count] = target_key(in_depth_stencil_target);
+
+    frame_buffer_map::iterator f = _frame_buffers.find(key);
+    if (f != _frame_buffers.end()) {
+        f->second._last_used_frame = _frame;
+        return f->second._frame_buffer;
+    }
+
+    render_device_ptr device = _render_device.lock();
+    if (!device) {
+        glerr() << log::error << "render_target_pool::cached_frame_buffer(): invalid render device." << log::end;
+        return frame_buffer_ptr();
+    }
+    frame_buffer_ptr new_fbo = device->create_frame_buffer();
+    if (!new_fbo) {
+        glerr() << log::error << "render_target_pool::cached_frame_buffer(): unable to create frame buffer." << log::end;
+        return frame_buffer_ptr();
+    }
+    for (unsigned c = 0; c < in_color_target_count; ++c) {
+        if (in_color_targets[c]) {
+            new_fbo->attach_color_buffer(c, in_color_targets[c]);
+        }
+    }
+    if (in_depth_stencil_target) {
+        new_fbo->attach_depth_stencil_buffer(in_depth_stencil_target);
+    }
+
+    frame_buffer_entry fe;
+    fe._frame_buffer    = new_fbo;
+    fe._last_used_frame = _frame;
+
+    _frame_buffers.insert(frame_buffer_map::value_type(key, fe));
+    _statistics._frame_buffers = static_cast<unsigned>(_frame_buffers.size());
+
+    return new_fbo;
+}
+
+frame_buffer_ptr
+render_target_pool::cached_frame_buffer(const texture_2d_ptr& in_color_target,
+                                        const texture_2d_ptr& in_depth_stencil_target)
+{
+    return cached_frame_buffer(&in_color_target, 1, in_depth_stencil_target);
+}
+
+void
+render_target_pool::trim()
+{
+    for (std::size_t e = _entries.size(); e > 0; --e) {
+        if (!_entries[e - 1]._in_use) {
+            free_entry(e - 1);
+        }
+    }
+    update_statistics();
+}
+
+const render_target_pool::pool_statistics&
+render_target_pool::statistics() const
+{
+    return _statistics;
+}
+
+void
+render_target_pool::release(const texture_2d_ptr& in_target,
+                            unsigned              in_generation)
+{
+    if (in_generation != _generation) {
+        // already returned by end_frame(), the target may be in use by a later frame
+        // or may have been freed since
+        return;
+    }
+    for (std::size_t e = 0; e < _entries.size(); ++e) {
+        if (_entries[e]._texture == in_target) {
+            assert(_entries[e]._in_use && _entries[e]._generation == in_generation);
+            _entries[e]._in_use = false;
+            update_statistics();
+            return;
+        }
+    }
+    glerr() << log::warning << "render_target_pool::release(): target not owned by this pool." << log::end;
+}
+
+void
+render_target_pool::free_entry(std::size_t in_entry)
+{
+    assert(in_entry < _entries.size());
+
+    // the cached frame buffers keep their attachments alive
+    const std::size_t      tk = target_key(_entries[in_entry]._texture);
+    frame_buffer_map::iterator f = _frame_buffers.begin();
+    while (f != _frame_buffers.end()) {
+        if (std::find(f->first.begin(), f->first.end(), tk) != f->first.end()) {
+            f = _frame_buffers.erase(f);
+        }
+        else {
+            ++f;
+        }
+    }
+
+    _entries.erase(_entries.begin() + in_entry);
+}
+
+void
+render_target_pool::update_statistics()
+{
+    _statistics._targets        = static_cast<unsigned>(_entries.size());
+    _statistics._targets_in_use = 0;
+    _statistics._target_bytes   = 0;
+    _statistics._frame_buffers  = static_cast<unsigned>(_frame_buffers.size());
+
+    for (std::size_t e = 0; e < _entries.size(); ++e) {
+        _statistics._target_bytes += _entries[e]._bytes;
+        if (_entries[e]._in_use) {
+            ++_statistics._targets_in_use;
+        }
+    }
+    _statistics._peak_targets_in_use = (std::max)(_statistics._peak_targets_in_use, _statistics._targets_in_use);
+}
+
+} // namespace gl
+} // namespace scm
@@ -0,0 +1,163 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_RENDER_TARGET_POOL_H_INCLUDED
+#define SCM_GL_UTIL_RENDER_TARGET_POOL_H_INCLUDED
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <scm/core/math.h>
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/data_formats.h>
+#include <scm/gl_core/frame_buffer_objects/frame_buffer_objects_fwd.h>
+#include <scm/gl_core/render_device/render_device_fwd.h>
+#include <scm/gl_core/texture_objects/texture_objects_fwd.h>
+
+#include <scm/gl_util/utilities/utilities_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// pool of transient render targets for multi pass frames
+//  - acquire() hands out a 2d texture of the requested size, format and sample
+//    count for the current frame, release() returns it to the pool, a later
+//    pass of the same frame requesting an equal target then aliases the storage
+//  - all targets still acquired are returned at end_frame(), targets unused for
+//    more than max_unused_frames frames are freed in begin_frame()
+//  - cached_frame_buffer() returns a cached frame buffer for a set of attachments, the
+//    cached frame buffers of freed targets are dropped with them, frame buffers not
+//    requested for more than max_unused_frames frames are dropped in end_frame()
+//    (they keep their attachments alive, this releases textures not owned by the pool)
+//  - a pass must not keep using a target after releasing it, its contents are
+//    undefined as soon as another pass acquires it
+//  - release() has to be called in the frame of the acquire(), a scoped_target
+//    outliving end_frame() does not release the target again (the acquisitions
+//    carry the generation of the frame they were made in)
+class __scm_export(gl_util) render_target_pool : boost::noncopyable
+{
+public:
+    struct target_desc {
+        target_desc(const math::vec2ui& in_size    = math::vec2ui(0u),
+                    data_format         in_format  = FORMAT_RGBA_8,
+                    unsigned            in_samples = 1);
+
+        bool                    operator==(const target_desc& rhs) const;
+        bool                    operator!=(const target_desc& rhs) const;
+
+        math::vec2ui            _size;
+        data_format             _format;
+        unsigned                _samples;
+    }; // struct target_desc
+
+    struct pool_statistics {
+        pool_statistics();
+
+        unsigned                _targets;           // allocated targets
+        unsigned                _targets_in_use;
+        scm::size_t             _target_bytes;      // estimated storage of all targets
+        unsigned                _frame_buffers;     // cached frame buffers
+        // current frame
+        unsigned                _acquires;
+        unsigned                _reuses;            // acquires served from the pool
+        unsigned                _allocations;
+        unsigned                _peak_targets_in_use;
+    }; // struct pool_statistics
+
+    // returns the target to the pool when leaving the scope
+    class __scm_export(gl_util) scoped_target : boost::noncopyable
+    {
+    public:
+        scoped_target(render_target_pool& in_pool,
+                      const target_desc&  in_desc);
+        ~scoped_target();
+
+        const texture_2d_ptr&   target() const;
+
+    private:
+        render_target_pool&     _pool;
+        texture_2d_ptr          _target;
+        unsigned                _generation;
+    }; // class scoped_target
+
+protected:
+    struct pool_entry {
+        texture_2d_ptr          _texture;
+        target_desc             _desc;
+        scm::size_t             _bytes;
+        bool                    _in_use;
+        unsigned                _last_used_frame;
+        unsigned                _generation;        // of the current acquisition
+    }; // struct pool_entry
+
+    struct frame_buffer_entry {
+        frame_buffer_ptr        _frame_buffer;
+        unsigned                _last_used_frame;
+    }; // struct frame_buffer_entry
+
+    typedef std::vector<pool_entry>                                     pool_entry_array;
+    typedef std::vector<std::size_t>                                    attachment_key;
+    typedef boost::unordered_map<attachment_key, frame_buffer_entry>    frame_buffer_map;
+
+public:
+    render_target_pool(const render_device_ptr& in_device,
+                       unsigned                 in_max_unused_frames = 3);
+    virtual ~render_target_pool();
+
+    void                        begin_frame();
+    void                        end_frame();
+    unsigned                    frame() const;
+
+    texture_2d_ptr              acquire(const target_desc& in_desc);
+    texture_2d_ptr              acquire(const math::vec2ui& in_size,
+                                        data_format         in_format,
+                                        unsigned            in_samples = 1);
+    void                        release(const texture_2d_ptr& in_target);
+
+    // in_color_targets may contain empty entries for unused attachments
+    frame_buffer_ptr            cached_frame_buffer(const texture_2d_ptr*   in_color_targets,
+                                                    unsigned                in_color_target_count,
+                                                    const texture_2d_ptr&   in_depth_stencil_target = texture_2d_ptr());
+    frame_buffer_ptr            cached_frame_buffer(const texture_2d_ptr&   in_color_target,
+                                                    const texture_2d_ptr&   in_depth_stencil_target = texture_2d_ptr());
+
+    // frees all targets and frame buffers not in use
+    void                        trim();
+
+    const pool_statistics&      statistics() const;
+
+protected:
+    // stale releases of an earlier generation are ignored
+    void                        release(const texture_2d_ptr& in_target,
+                                        unsigned              in_generation);
+    void                        free_entry(std::size_t in_entry);
+    void                        update_statistics();
+
+protected:
+    render_device_wptr          _render_device;
+    unsigned                    _max_unused_frames;
+    unsigned                    _frame;
+    unsigned                    _generation;        // advanced by end_frame()
+
+    pool_entry_array            _entries;
+    frame_buffer_map            _frame_buffers;
+
+    pool_statistics             _statistics;
+
+}; // class render_target_pool
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_RENDER_TARGET_POOL_H_INCLUDED
@@ -0,0 +1,290 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "resource_upload_service.h"
+
+#include <cassert>
+#include <deque>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <scm/gl_core/log.h>
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/sync_objects.h>
+#include <scm/gl_core/texture_objects.h>
+#include <scm/gl_core/window_management/context.h>
+#include <scm/gl_core/window_management/headless_surface.h>
+#include <scm/gl_core/window_management/window.h>
+
+#include <scm/gl_util/data/imaging/texture_loader.h>
+#include <scm/gl_util/data/volume/volume_loader.h>
+
+namespace scm {
+namespace gl {
+
+// upload_ticket //////////////////////////////////////////////////////////////////////////////////
+upload_ticket::upload_ticket()
+  : _state(TICKET_PENDING)
+  , _upload_succeeded(false)
+{
+}
+
+upload_ticket::~upload_ticket()
+{
+}
+
+upload_ticket::ticket_state
+upload_ticket::state() const
+{
+    return _state;
+}
+
+bool
+upload_ticket::ready() const
+{
+    return _state == TICKET_READY;
+}
+
+bool
+upload_ticket::failed() const
+{
+    return _state == TICKET_FAILED;
+}
+
+// resource_upload_service ////////////////////////////////////////////////////////////////////////
+struct resource_upload_service::upload_job
+{
+    upload_ticket_ptr               _ticket;
+    job_function                    _job;
+    ready_function                  _ready;
+}; // struct resource_upload_service::upload_job
+
+struct resource_upload_service::upload_queue
+{
+    upload_queue() : _running(true), _pending(0) {}
+
+    std::deque<upload_job>          _submitted;
+    std::deque<upload_job>          _finished;
+    bool                            _running;
+    unsigned                        _pending;
+
+    mutable boost::mutex            _mutex;
+    boost::condition_variable       _job_submitted;
+    scoped_ptr<boost::thread>       _thread;
+
+    // upload thread only, keeps the gpu mip-map programs across volumes
+    scoped_ptr<volume_loader>       _volume_loader;
+}; // struct resource_upload_service::upload_queue
+
+resource_upload_service::resource_upload_service(const render_device_ptr& in_device,
+                                                 const wm::context_cptr&  in_main_context,
+                                                 const wm::window_cptr&   in_parent_window)
+  : _device(in_device)
+  , _queue(new upload_queue)
+{
+    assert(_device);
+    assert(in_main_context);
+    assert(in_parent_window);
+
+    try {
+        _upload_surface.reset(new wm::headless_surface(in_parent_window));
+        _upload_context.reset(new wm::context(_upload_surface, in_main_context->context_attributes(), in_main_context));
+    }
+    catch (const std::exception& e) {
+        throw std::runtime_error(std::string("resource_upload_service::resource_upload_service(): "
+                                             "error creating upload context (") + e.what() + ").");
+    }
+
+    _queue->_thread.reset(new boost::thread(boost::bind(&resource_upload_service::upload_thread_entry, this)));
+}
+
+resource_upload_service::~resource_upload_service()
+{
+    { // stop the upload thread, jobs not yet started are dropped
+        boost::mutex::scoped_lock lock(_queue->_mutex);
+        _queue->_running = false;
+        _queue->_submitted.clear();
+    }
+    _queue->_job_submitted.notify_all();
+    _queue->_thread->join();
+    _queue->_thread.reset();
+
+    _queue->_finished.clear();
+
+    _upload_context.reset();
+    _upload_surface.reset();
+    _device.reset();
+}
+
+upload_ticket_ptr
+resource_upload_service::submit(const job_function&      in_job,
+                                const ready_function&    in_ready)
+{
+    return submit_ticket(make_shared<upload_ticket>(), in_job, in_ready);
+}
+
+texture_2d_ticket_ptr
+resource_upload_service::load_texture_2d(const std::string&      in_image_path,
+                                         bool                    in_create_mips,
+                                         bool                    in_color_mips,
+                                         const data_format       in_force_internal_format,
+                                         const ready_function&   in_ready)
+{
+    texture_2d_ticket_ptr ticket = make_shared<resource_ticket<texture_2d_ptr> >();
+    resource_ticket<texture_2d_ptr>* t = ticket.get();
+
+    submit_ticket(ticket,
+        [=](const render_device_ptr& device, const render_context_ptr&) -> bool {
+            texture_loader tl;
+            t->_resource = tl.load_texture_2d(*device, in_image_path, in_create_mips, in_color_mips, in_force_internal_format);
+            return 0 != t->_resource;
+        },
+        in_ready);
+
+    return ticket;
+}
+
+texture_3d_ticket_ptr
+resource_upload_service::load_volume(const std::string&      in_volume_path,
+                                     bool                    in_create_mips,
+                                     const ready_function&   in_ready)
+{
+    texture_3d_ticket_ptr ticket = make_shared<resource_ticket<texture_3d_ptr> >();
+    resource_ticket<texture_3d_ptr>* t = ticket.get();
+
+    submit_ticket(ticket,
+        [=](const render_device_ptr& device, const render_context_ptr& context) -> bool {
+            t->_resource = _queue->_volume_loader->stream_volume_data(*device, context, in_volume_path, in_create_mips);
+            return 0 != t->_resource;
+        },
+        in_ready);
+
+    return ticket;
+}
+
+unsigned
+resource_upload_service::publish(const render_context_ptr& in_context)
+{
+    std::deque<upload_job> finished;
+    {
+        boost::mutex::scoped_lock lock(_queue->_mutex);
+        finished.swap(_queue->_finished);
+        _queue->_pending -= static_cast<unsigned>(finished.size());
+    }
+
+    for (std::deque<upload_job>::iterator j = finished.begin(); j != finished.end(); ++j) {
+        upload_ticket& t = *(j->_ticket);
+
+        if (t._upload_succeeded && t._upload_fence) {
+            // no client side stall, the commands following on in_context wait for the upload
+            in_context->sync_server_wait(t._upload_fence);
+            t._state = upload_ticket::TICKET_READY;
+        }
+        else {
+            t._state = upload_ticket::TICKET_FAILED;
+        }
+        t._upload_fence.reset();
+
+        if (j->_ready) {
+            j->_ready(j->_ticket);
+        }
+    }
+
+    return static_cast<unsigned>(finished.size());
+}
+
+unsigned
+resource_upload_service::pending_uploads() const
+{
+    boost::mutex::scoped_lock lock(_queue->_mutex);
+    return _queue->_pending;
+}
+
+upload_ticket_ptr
+resource_upload_service::submit_ticket(const upload_ticket_ptr& in_ticket,
+                                       const job_function&      in_job,
+                                       const ready_function&    in_ready)
+{
+    upload_job job;
+    job._ticket = in_ticket;
+    job._job    = in_job;
+    job._ready  = in_ready;
+
+    {
+        boost::mutex::scoped_lock lock(_queue->_mutex);
+        _queue->_submitted.push_back(job);
+        ++_queue->_pending;
+    }
+    _queue->_job_submitted.notify_one();
+
+    return in_ticket;
+}
+
+void
+resource_upload_service::upload_thread_entry()
+{
+    if (!_upload_context->make_current(_upload_surface, true)) {
+        glerr() << log::error
+                << "resource_upload_service::upload_thread_entry(): "
+                << "unable to make upload context current, all uploads will fail." << log::end;
+    }
+
+    render_context_ptr context = _device->create_context();
+    context->apply();
+
+    _queue->_volume_loader.reset(new volume_loader());
+
+    boost::mutex::scoped_lock lock(_queue->_mutex);
+
+    while (_queue->_running) {
+        if (_queue->_submitted.empty()) {
+            _queue->_job_submitted.wait(lock);
+            continue;
+        }
+
+        upload_job job = _queue->_submitted.front();
+        _queue->_submitted.pop_front();
+
+        lock.unlock();
+        {
+            upload_ticket& t = *job._ticket;
+            try {
+                t._upload_succeeded = job._job(_device, context);
+            }
+            catch (const std::exception& e) {
+                glerr() << log::error
+                        << "resource_upload_service::upload_thread_entry(): "
+                        << "error processing upload job (" << e.what() << ")." << log::end;
+                t._upload_succeeded = false;
+            }
+            if (t._upload_succeeded) {
+                // the fence has to reach the server before other contexts can wait on it
+                t._upload_fence = context->insert_fence_sync();
+                context->flush();
+                t._upload_succeeded = 0 != t._upload_fence;
+            }
+        }
+        lock.lock();
+
+        _queue->_finished.push_back(job);
+    }
+
+    lock.unlock();
+
+    // release the gl objects of the loader while the upload context is current
+    _queue->_volume_loader.reset();
+
+    context->reset();
+    context.reset();
+    _upload_context->make_current(_upload_surface, false);
+}
+
+} // namespace gl
+} // namespace scm
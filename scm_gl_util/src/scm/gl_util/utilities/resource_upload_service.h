@@ -0,0 +1,141 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_RESOURCE_UPLOAD_SERVICE_H_INCLUDED
+#define SCM_GL_UTIL_RESOURCE_UPLOAD_SERVICE_H_INCLUDED
+
+#include <string>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/data_formats.h>
+#include <scm/gl_core/render_device/render_device_fwd.h>
+#include <scm/gl_core/sync_objects/sync_objects_fwd.h>
+#include <scm/gl_core/texture_objects/texture_objects_fwd.h>
+#include <scm/gl_core/window_management/wm_fwd.h>
+
+#include <scm/gl_util/utilities/utilities_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+class __scm_export(gl_util) upload_ticket : boost::noncopyable
+{
+public:
+    enum ticket_state {
+        TICKET_PENDING      = 0x00,     // queued or being processed by the upload thread
+        TICKET_READY,                   // published, resources are usable on the publishing context
+        TICKET_FAILED
+    }; // enum ticket_state
+
+public:
+    upload_ticket();
+    virtual ~upload_ticket();
+
+    ticket_state                state() const;
+    bool                        ready() const;
+    bool                        failed() const;
+
+private:
+    ticket_state                _state;
+    bool                        _upload_succeeded;
+    fence_sync_ptr              _upload_fence;
+
+    friend class resource_upload_service;
+}; // class upload_ticket
+
+template<typename resource_ptr_type>
+class resource_ticket : public upload_ticket
+{
+public:
+    // only valid once the ticket is ready
+    const resource_ptr_type&    resource() const { return _resource; }
+
+protected:
+    resource_ptr_type           _resource;
+
+    friend class resource_upload_service;
+}; // class resource_ticket
+
+typedef shared_ptr<upload_ticket>                     upload_ticket_ptr;
+typedef shared_ptr<resource_ticket<texture_2d_ptr> >  texture_2d_ticket_ptr;
+typedef shared_ptr<resource_ticket<texture_3d_ptr> >  texture_3d_ticket_ptr;
+
+// creates and fills gl resources on a dedicated thread
+//  - the upload thread owns a context sharing its objects with the main
+//    window context, current on an offscreen (headless) surface
+//  - jobs are processed in submission order, each finished job is fenced on
+//    the upload context and handed back to the main thread in publish(), which
+//    makes the main context wait server-side for the upload fence, so the
+//    main thread never blocks on uploads in flight
+//  - only sharable objects (textures, buffers, samplers, programs) can be
+//    created by jobs, container objects like vertex arrays and frame buffers
+//    have to be created on the context they are used with
+class __scm_export(gl_util) resource_upload_service : boost::noncopyable
+{
+public:
+    // runs on the upload thread with the upload context current, returns false on failure
+    typedef boost::function<bool (const render_device_ptr&,
+                                  const render_context_ptr&)>   job_function;
+    // runs on the publishing thread when the ticket becomes ready or failed
+    typedef boost::function<void (const upload_ticket_ptr&)>    ready_function;
+
+public:
+    resource_upload_service(const render_device_ptr& in_device,
+                            const wm::context_cptr&  in_main_context,
+                            const wm::window_cptr&   in_parent_window);
+    virtual ~resource_upload_service();
+
+    upload_ticket_ptr           submit(const job_function&      in_job,
+                                       const ready_function&    in_ready = ready_function());
+
+    texture_2d_ticket_ptr       load_texture_2d(const std::string&      in_image_path,
+                                                bool                    in_create_mips,
+                                                bool                    in_color_mips            = false,
+                                                const data_format       in_force_internal_format = FORMAT_NULL,
+                                                const ready_function&   in_ready                 = ready_function());
+    // streams the volume through the staging ring of volume_loader::stream_volume_data
+    texture_3d_ticket_ptr       load_volume(const std::string&      in_volume_path,
+                                            bool                    in_create_mips = true,
+                                            const ready_function&   in_ready       = ready_function());
+
+    // hand finished uploads over to in_context (typically once per frame on
+    // the main thread), returns the number of published tickets
+    unsigned                    publish(const render_context_ptr& in_context);
+
+    // number of submitted but not yet published tickets
+    unsigned                    pending_uploads() const;
+
+private:
+    struct upload_job;
+    struct upload_queue;
+
+    void                        upload_thread_entry();
+
+    upload_ticket_ptr           submit_ticket(const upload_ticket_ptr& in_ticket,
+                                              const job_function&      in_job,
+                                              const ready_function&    in_ready);
+
+private:
+    render_device_ptr           _device;
+    wm::surface_ptr             _upload_surface;
+    wm::context_ptr             _upload_context;
+
+    shared_ptr<upload_queue>    _queue;
+
+}; // class resource_upload_service
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_RESOURCE_UPLOAD_SERVICE_H_INCLUDED
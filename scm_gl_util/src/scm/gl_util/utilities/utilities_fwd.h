@@ -22,10 +22,30 @@ class geometry_highlight;
 typedef shared_ptr<geometry_highlight>              geometry_highlight_ptr;
 typedef shared_ptr<geometry_highlight const>        geometry_highlight_cptr;
 
+class gpu_frustum_culler;
+typedef shared_ptr<gpu_frustum_culler>              gpu_frustum_culler_ptr;
+typedef shared_ptr<gpu_frustum_culler const>        gpu_frustum_culler_cptr;
+
+class gpu_mip_map_generator;
+typedef shared_ptr<gpu_mip_map_generator>           gpu_mip_map_generator_ptr;
+typedef shared_ptr<gpu_mip_map_generator const>     gpu_mip_map_generator_cptr;
+
+class render_queue;
+typedef shared_ptr<render_queue>                    render_queue_ptr;
+typedef shared_ptr<render_queue const>              render_queue_cptr;
+
+class render_target_pool;
+typedef shared_ptr<render_target_pool>              render_target_pool_ptr;
+typedef shared_ptr<render_target_pool const>        render_target_pool_cptr;
+
 class texture_output;
 typedef shared_ptr<texture_output>                  texture_output_ptr;
 typedef shared_ptr<texture_output const>            texture_output_cptr;
 
+class resource_upload_service;
+typedef shared_ptr<resource_upload_service>         resource_upload_service_ptr;
+typedef shared_ptr<resource_upload_service const>   resource_upload_service_cptr;
+
 namespace util {
 
 class  profiling_host;
@@ -0,0 +1,294 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#include "screen_capture.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <deque>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <FreeImagePlus.h>
+
+#include <scm/gl_core/log.h>
+#include <scm/gl_core/buffer_objects.h>
+#include <scm/gl_core/render_device.h>
+#include <scm/gl_core/sync_objects.h>
+#include <scm/gl_core/texture_objects.h>
+#include <scm/gl_core/render_device/context_guards.h>
+
+namespace scm {
+namespace gl {
+
+struct screen_capture::encoder_queue
+{
+    struct encode_job {
+        shared_array<uint8>         _data;
+        std::string                 _file_name;
+        math::vec2ui                _size;
+        data_format                 _format;
+    }; // struct encode_job
+
+    encoder_queue() : _running(true), _encoding(0), _written(0), _failed(0) {}
+
+    std::deque<encode_job>          _jobs;
+    bool                            _running;
+    unsigned                        _encoding;
+    unsigned                        _written;
+    unsigned                        _failed;
+
+    mutable boost::mutex            _mutex;
+    boost::condition_variable       _job_queued;
+    boost::condition_variable       _job_done;
+    scoped_ptr<boost::thread>       _thread;
+}; // struct screen_capture::encoder_queue
+
+screen_capture::readback_slot::readback_slot()
+  : _size(0u)
+  , _format(FORMAT_NULL)
+{
+}
+
+screen_capture::screen_capture(const render_device_ptr& in_device,
+                               unsigned                 in_readback_slots,
+                               unsigned                 in_max_queued_images)
+  : _render_device(in_device)
+  , _slots((std::max)(1u, in_readback_slots))
+  , _slots_head(0)
+  , _slots_in_flight(0)
+  , _max_queued_images((std::max)(1u, in_max_queued_images))
+  , _encoder(new encoder_queue)
+{
+    _encoder->_thread.reset(new boost::thread(boost::bind(&screen_capture::encoder_thread_entry, this)));
+}
+
+screen_capture::~screen_capture()
+{
+    // readbacks still in flight are lost without a context, images already
+    // handed to the encoder are still written
+    {
+        boost::mutex::scoped_lock lock(_encoder->_mutex);
+        _encoder->_running = false;
+    }
+    _encoder->_job_queued.notify_all();
+    _encoder->_thread->join();
+    _encoder->_thread.reset();
+
+    _slots.clear();
+}
+
+bool
+screen_capture::capture(const render_context_ptr& in_context,
+                        const texture_2d_ptr&     in_source,
+                        const std::string&        in_file_name)
+{
+    assert(in_context);
+
+    if (!in_source) {
+        glerr() << log::error << "screen_capture::capture(): invalid source texture." << log::end;
+        return false;
+    }
+
+    // all slots in flight, wait for the oldest instead of dropping this capture
+    if (_slots_in_flight == _slots.size()) {
+        complete_oldest(in_context, true);
+    }
+
+    readback_slot&      slot   = _slots[(_slots_head + _slots_in_flight) % _slots.size()];
+    const math::vec2ui  size   = in_source->descriptor()._size;
+    const data_format   format = in_source->format();
+    const scm::size_t   bytes  = static_cast<scm::size_t>(size.x) * size.y * size_of_format(format);
+
+    if (!slot._buffer || slot._buffer->descriptor()._size < bytes) {
+        render_device_ptr device = _render_device.lock();
+        if (!device) {
+            glerr() << log::error << "screen_capture::capture(): invalid render device." << log::end;
+            return false;
+        }
+        slot._buffer = device->create_buffer(BIND_PIXEL_PACK_BUFFER, USAGE_STREAM_READ, bytes);
+        if (!slot._buffer) {
+            glerr() << log::error << "screen_capture::capture(): unable to create readback buffer "
+                    << "(size: " << bytes << "byte)." << log::end;
+            return false;
+        }
+    }
+
+    {
+        context_pack_buffer_guard ppg(in_context);
+
+        in_context->bind_pack_buffer(slot._buffer);
+        if (!in_context->retrieve_texture_data(in_source, 0, static_cast<size_t>(0))) {
+            glerr() << log::error << "screen_capture::capture(): unable to read back texture data." << log::end;
+            return false;
+        }
+    }
+
+    slot._fence     = in_context->insert_fence_sync();
+    slot._file_name = in_file_name;
+    slot._size      = size;
+    slot._format    = format;
+
+    ++_slots_in_flight;
+
+    return true;
+}
+
+unsigned
+screen_capture::update(const render_context_ptr& in_context)
+{
+    unsigned completed = 0;
+
+    // readbacks finish in submission order
+    while (   _slots_in_flight > 0
+           && in_context->sync_signal_status(_slots[_slots_head]._fence) == SYNC_SIGNALED) {
+        complete_oldest(in_context, false);
+        ++completed;
+    }
+
+    return completed;
+}
+
+void
+screen_capture::flush(const render_context_ptr& in_context)
+{
+    while (_slots_in_flight > 0) {
+        complete_oldest(in_context, true);
+    }
+
+    boost::mutex::scoped_lock lock(_encoder->_mutex);
+    while (!_encoder->_jobs.empty() || _encoder->_encoding > 0) {
+        _encoder->_job_done.wait(lock);
+    }
+}
+
+unsigned
+screen_capture::pending_readbacks() const
+{
+    return _slots_in_flight;
+}
+
+unsigned
+screen_capture::pending_images() const
+{
+    boost::mutex::scoped_lock lock(_encoder->_mutex);
+    return static_cast<unsigned>(_encoder->_jobs.size()) + _encoder->_encoding;
+}
+
+unsigned
+screen_capture::written_images() const
+{
+    boost::mutex::scoped_lock lock(_encoder->_mutex);
+    return _encoder->_written;
+}
+
+unsigned
+screen_capture::failed_images() const
+{
+    boost::mutex::scoped_lock lock(_encoder->_mutex);
+    return _encoder->_failed;
+}
+
+bool
+screen_capture::complete_oldest(const render_context_ptr& in_context,
+                                bool                      in_wait)
+{
+    assert(_slots_in_flight > 0);
+
+    readback_slot& slot = _slots[_slots_head];
+
+    _slots_head = (_slots_head + 1) % _slots.size();
+    --_slots_in_flight;
+
+    if (in_wait) {
+        in_context->sync_client_wait(slot._fence);
+    }
+    slot._fence.reset();
+
+    encoder_queue::encode_job job;
+    const scm::size_t         bytes = static_cast<scm::size_t>(slot._size.x) * slot._size.y * size_of_format(slot._format);
+
+    job._data.reset(new uint8[bytes]);
+    job._file_name = slot._file_name;
+    job._size      = slot._size;
+    job._format    = slot._format;
+
+    const void* data = in_context->map_buffer_range(slot._buffer, 0, bytes, ACCESS_READ_ONLY);
+    if (!data) {
+        glerr() << log::error << "screen_capture::complete_oldest(): unable to map readback buffer "
+                << "('" << slot._file_name << "')." << log::end;
+        boost::mutex::scoped_lock lock(_encoder->_mutex);
+        ++_encoder->_failed;
+        return false;
+    }
+    std::memcpy(job._data.get(), data, bytes);
+    in_context->unmap_buffer(slot._buffer);
+
+    {
+        boost::mutex::scoped_lock lock(_encoder->_mutex);
+        // never drop images, wait for the encoder to catch up instead
+        while (_encoder->_jobs.size() + _encoder->_encoding >= _max_queued_images) {
+            _encoder->_job_done.wait(lock);
+        }
+        _encoder->_jobs.push_back(job);
+    }
+    _encoder->_job_queued.notify_one();
+
+    return true;
+}
+
+void
+screen_capture::encoder_thread_entry()
+{
+    for (;;) {
+        encoder_queue::encode_job job;
+        {
+            boost::mutex::scoped_lock lock(_encoder->_mutex);
+            while (_encoder->_running && _encoder->_jobs.empty()) {
+                _encoder->_job_queued.wait(lock);
+            }
+            if (_encoder->_jobs.empty()) {
+                return; // stopped and all queued images written
+            }
+            job = _encoder->_jobs.front();
+            _encoder->_jobs.pop_front();
+            ++_encoder->_encoding;
+        }
+
+        // the pack alignment of the contexts is 1, free image scan lines are 32bit aligned
+        const scm::size_t row_bytes = static_cast<scm::size_t>(job._size.x) * size_of_format(job._format);
+        fipImage          img(FIT_BITMAP, job._size.x, job._size.y, bit_per_pixel(job._format));
+
+        bool saved = false;
+        if (img.isValid()) {
+            for (unsigned y = 0; y < job._size.y; ++y) {
+                std::memcpy(img.getScanLine(y), job._data.get() + y * row_bytes, row_bytes);
+            }
+            saved = (TRUE == img.save(job._file_name.c_str()));
+        }
+        if (!saved) {
+            glerr() << log::error << "screen_capture::encoder_thread_entry(): unable to write image file "
+                    << "('" << job._file_name << "')." << log::end;
+        }
+
+        {
+            boost::mutex::scoped_lock lock(_encoder->_mutex);
+            --_encoder->_encoding;
+            if (saved) {
+                ++_encoder->_written;
+            }
+            else {
+                ++_encoder->_failed;
+            }
+        }
+        _encoder->_job_done.notify_all();
+    }
+}
+
+} // namespace gl
+} // namespace scm
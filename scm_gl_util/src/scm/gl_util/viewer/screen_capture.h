@@ -0,0 +1,96 @@
+
+// Copyright (c) 2012 Christopher Lux <christopherlux@gmail.com>
+// Distributed under the Modified BSD License, see license.txt.
+
+#ifndef SCM_GL_UTIL_SCREEN_CAPTURE_H_INCLUDED
+#define SCM_GL_UTIL_SCREEN_CAPTURE_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include <scm/core/math.h>
+#include <scm/core/memory.h>
+#include <scm/core/numeric_types.h>
+
+#include <scm/gl_core/data_formats.h>
+#include <scm/gl_core/buffer_objects/buffer_objects_fwd.h>
+#include <scm/gl_core/render_device/render_device_fwd.h>
+#include <scm/gl_core/sync_objects/sync_objects_fwd.h>
+#include <scm/gl_core/texture_objects/texture_objects_fwd.h>
+
+#include <scm/gl_util/viewer/viewer_fwd.h>
+
+#include <scm/core/platform/platform.h>
+#include <scm/core/utilities/platform_warning_disable.h>
+
+namespace scm {
+namespace gl {
+
+// asynchronous texture to image file capture
+//  - capture() copies level 0 of the source texture into a pixel pack buffer
+//    of a small ring of readback slots and fences the copy, the rendering
+//    thread does not wait for the transfer
+//  - update() (once per frame) maps the readbacks whose fences signaled and
+//    hands the pixels to an encoder thread writing the image files
+//  - no capture is ever dropped: if all readback slots are in flight capture()
+//    waits for the oldest one, if the encoder falls too far behind the
+//    rendering thread waits for it to catch up
+class __scm_export(gl_util) screen_capture : boost::noncopyable
+{
+protected:
+    struct readback_slot {
+        readback_slot();
+
+        buffer_ptr              _buffer;
+        fence_sync_ptr          _fence;
+        std::string             _file_name;
+        math::vec2ui            _size;
+        data_format             _format;
+    }; // struct readback_slot
+
+    struct encoder_queue;
+
+public:
+    screen_capture(const render_device_ptr& in_device,
+                   unsigned                 in_readback_slots    = 3,
+                   unsigned                 in_max_queued_images = 8);
+    virtual ~screen_capture();
+
+    bool                        capture(const render_context_ptr& in_context,
+                                        const texture_2d_ptr&     in_source,
+                                        const std::string&        in_file_name);
+    // hand finished readbacks to the encoder thread, returns their number
+    unsigned                    update(const render_context_ptr& in_context);
+    // finish all readbacks and wait until all images are written
+    void                        flush(const render_context_ptr& in_context);
+
+    unsigned                    pending_readbacks() const;
+    unsigned                    pending_images() const;
+    unsigned                    written_images() const;
+    unsigned                    failed_images() const;
+
+protected:
+    bool                        complete_oldest(const render_context_ptr& in_context,
+                                                bool                      in_wait);
+    void                        encoder_thread_entry();
+
+protected:
+    render_device_wptr          _render_device;
+
+    std::vector<readback_slot>  _slots;
+    unsigned                    _slots_head;            // oldest readback in flight
+    unsigned                    _slots_in_flight;
+
+    unsigned                    _max_queued_images;
+    shared_ptr<encoder_queue>   _encoder;
+
+}; // class screen_capture
+
+} // namespace gl
+} // namespace scm
+
+#include <scm/core/utilities/platform_warning_enable.h>
+
+#endif // SCM_GL_UTIL_SCREEN_CAPTURE_H_INCLUDED
@@ -4,6 +4,7 @@
 
 #include "viewer.h"
 
+#include <iomanip>
 #include <iostream>
 #include <cassert>
 #include <exception>
@@ -13,8 +14,6 @@
 
 #include <boost/assign/list_of.hpp>
 
-#include <FreeImagePlus.h>
-
 #include <scm/log.h>
 #include <scm/core/math.h>
 #include <scm/core/io/file.h>
@@ -36,6 +35,7 @@
 #include <scm/gl_util/font/text_renderer.h>
 #include <scm/gl_util/primitives/fullscreen_triangle.h>
 #include <scm/gl_util/primitives/quad.h>
+#include <scm/gl_util/viewer/screen_capture.h>
 #include <scm/gl_core/window_management/context.h>
 #include <scm/gl_core/window_management/display.h>
 #include <scm/gl_core/window_management/window.h>
@@ -133,6 +133,8 @@ viewer::viewer(const math::vec2ui&                  vp_dim,
   , _trackball_enabled(true)
   , _render_target(new render_target())
   , _attributes(view_attrib)
+  , _capture_sequence(false)
+  , _capture_sequence_frame(0)
 {
 
     _attributes._multi_samples = math::max(1u, _attributes._multi_samples);
@@ -155,6 +157,8 @@ viewer::viewer(const math::vec2ui&                  vp_dim,
         initialize_shader_includes();
         initialize_render_target();
 
+        _screen_capture.reset(new screen_capture(_device));
+
         font_face_ptr counter_font(new font_face(_device, "../../../res/fonts/Consola.ttf", 12, 0.7f, font_face::smooth_lcd));
         _text_renderer.reset(new text_renderer(_device));
         _frame_counter_text.reset(new text(_device, counter_font, font_face::style_regular, "sick, sad world..."));
@@ -179,6 +183,10 @@ viewer::viewer(const math::vec2ui&                  vp_dim,
 
 viewer::~viewer()
 {
+    if (_screen_capture) {
+        _screen_capture->flush(_context);
+        _screen_capture.reset();
+    }
     _render_target.reset();
     _text_renderer.reset();
     _frame_counter_text.reset();
@@ -299,48 +307,50 @@ viewer::swap_buffers(int interval)
 bool
 viewer::take_screenshot(const std::string& f) const
 {
-    if (!_render_target) {
+    if (!_render_target || !_render_target->_color_buffer_resolved) {
         glerr() << log::error 
                 << "viewer::take_screenshot(): only working if using anti aliasing and therefore a texture render target."
                 << log::end;
         return false;
     }
 
-    size_t img_size =  _render_target->_color_buffer_resolved->descriptor()._size.x
-                     * _render_target->_color_buffer_resolved->descriptor()._size.y
-                     * size_of_format(_render_target->_color_buffer_resolved->format());
-    shared_ptr<uint8>   data(new uint8[img_size]);
-
-    if (!context()->retrieve_texture_data(_render_target->_color_buffer_resolved, 0, data.get())) {
+    if (!_screen_capture->capture(context(), _render_target->_color_buffer_resolved, f)) {
         glerr() << log::error 
                 << "viewer::take_screenshot(): unable to read back texture data." << log::end;
         return false;
     }
 
-#if 0
-    io::file_ptr of(new io::file());
-
-    if (!of->open(f, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc, false)) {
-        glerr() << log::error 
-                << "viewer::take_screenshot(): error opening output file : " << f << log::end;
-        return false;
-    }
-    if (of->write(data.get(), 0, img_size) != img_size) {
-        glerr() << log::error 
-                << "viewer::take_screenshot(): unable to write out texture data." << log::end;
-        return false;
-    }
-#else
-    fipImage of(FIT_BITMAP,
-                _render_target->_color_buffer_resolved->descriptor()._size.x,
-                _render_target->_color_buffer_resolved->descriptor()._size.y,
-                bit_per_pixel(_render_target->_color_buffer_resolved->format()));
-    memcpy(of.accessPixels(), data.get(), img_size);
-    of.save(f.c_str());
-#endif
     return true;
 }
 
+void
+viewer::flush_screenshots() const
+{
+    _screen_capture->flush(context());
+}
+
+void
+viewer::start_capture_sequence(const std::string& prefix,
+                               const std::string& ext)
+{
+    _capture_sequence        = true;
+    _capture_sequence_prefix = prefix;
+    _capture_sequence_ext    = ext;
+    _capture_sequence_frame  = 0;
+}
+
+void
+viewer::stop_capture_sequence()
+{
+    _capture_sequence = false;
+}
+
+bool
+viewer::capturing_sequence() const
+{
+    return _capture_sequence;
+}
+
 void
 viewer::render_update_func(const update_func& f)
 {
@@ -525,6 +535,15 @@ viewer::send_render_display()
             _render_target->_fs_geom->draw(context());
         }
 
+        if (_capture_sequence) {
+            std::stringstream seq_file;
+            seq_file << _capture_sequence_prefix << "_"
+                     << std::setw(6) << std::setfill('0') << _capture_sequence_frame << "." << _capture_sequence_ext;
+            if (take_screenshot(seq_file.str())) {
+                ++_capture_sequence_frame;
+            }
+        }
+
         if (_settings._show_frame_times) {
             mat4f   fs_projection = make_ortho_matrix(0.0f, _viewport._dimensions.x,
                                                       0.0f, _viewport._dimensions.y, -1.0f, 1.0f);
@@ -567,6 +586,9 @@ viewer::send_render_display()
         }
     }
 
+    // hand finished screenshot readbacks over to the encoder
+    _screen_capture->update(context());
+
     if (!_settings._swap_explicit) {
         const int32 swap_interval = math::max(1, _settings._vsync_swap_interval);
         swap_buffers(_settings._vsync ? swap_interval : 0);
@@ -20,6 +20,7 @@
 #include <scm/gl_util/font/font_fwd.h>
 #include <scm/gl_util/primitives/primitives_fwd.h>
 #include <scm/gl_util/viewer/camera.h>
+#include <scm/gl_util/viewer/viewer_fwd.h>
 #include <scm/gl_core/window_management/wm_fwd.h>
 #include <scm/gl_core/window_management/surface.h>
 #include <scm/gl_core/window_management/window.h>
@@ -143,7 +144,15 @@ public:
 
     void                            swap_buffers(int interval = 0);
 
+    // the screenshot is read back and written asynchronously, the file is
+    // complete a few frames later (or after flush_screenshots())
     bool                            take_screenshot(const std::string& f) const;
+    void                            flush_screenshots() const;
+    // capture every following frame to <prefix>_<frame number>.<ext>
+    void                            start_capture_sequence(const std::string& prefix,
+                                                           const std::string& ext = "png");
+    void                            stop_capture_sequence();
+    bool                            capturing_sequence() const;
     
     // callbacks
     void                            render_update_func(const update_func& f);
@@ -239,6 +248,12 @@ protected:
     time::cpu_accum_timer           _frame_timer;
     float                           _frame_time_us;
 
+    gl::screen_capture_ptr          _screen_capture;
+    bool                            _capture_sequence;
+    std::string                     _capture_sequence_prefix;
+    std::string                     _capture_sequence_ext;
+    unsigned                        _capture_sequence_frame;
+
     gl::text_renderer_ptr           _text_renderer;
     gl::text_ptr                    _frame_counter_text;
 
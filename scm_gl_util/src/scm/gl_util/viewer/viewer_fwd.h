@@ -12,10 +12,13 @@ namespace gl {
 
 class camera;
 class camera_uniform_block;
+class screen_capture;
 class viewer;
 
 typedef shared_ptr<camera_uniform_block>        camera_uniform_block_ptr;
 typedef shared_ptr<camera_uniform_block const>  camera_uniform_block_cptr;
+typedef shared_ptr<screen_capture>              screen_capture_ptr;
+typedef shared_ptr<screen_capture const>        screen_capture_cptr;
 
 } // namespace gl
 } // namespace scm